@@ -0,0 +1,363 @@
+/*
+ * SmartStop - comparação de políticas de despacho no mesmo tráfego (A/B)
+ *
+ * Cada política (policy.h) roda num braço com o estado clonado de uma
+ * simulação base: mesmo prédio, mesma semente, mesmo gerador. O tráfego vem
+ * de um só fluxo (sim_traffic_stream da base), copiado para cada braço:
+ *   - por ciclo (--traffic): o k-ésimo ciclo de todos os braços recebe o
+ *     mesmo lote de chegadas (fila de lotes, como no --split do host);
+ *   - por perfil (--profile): as mesmas chegadas nos mesmos instantes
+ *     simulados, com destino, o que também alinha os passageiros de
+ *     --passengers.
+ * Só as decisões mudam entre os braços. O relatório compara os
+ * indicadores e o custo por decisão de cada política.
+ *
+ * Uso:
+ *   smartstop_ab [--policy [NOME=]SPEC]... [--cycles N] [--floors N]
+ *                [--traffic low|medium|high] [--profile PERFIL] [--rate R]
+ *                [--duration S] [--passengers] [--lookahead H] [--budget US]
+ *                [--seed S]
+ *
+ * SPEC é "cascade", "lookahead" ou uma lista de estágios separados por
+ * vírgula (ver dispatch_policy_parse). Sem --policy compara "cascade" com
+ * "lookahead".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dispatch.h"
+#include "hal.h"
+#include "lookahead.h"
+#include "policy.h"
+
+#define AB_MAX_ARMS 8
+
+typedef struct {
+    const char *name;
+    const char *spec;
+
+    DispatchPolicy policy;
+    Lookahead lookahead;
+    SimContext sim;
+    SimClock clock;
+    SimRng stream;                  // cópia do fluxo de tráfego compartilhado
+    TrafficQueue queue;
+    TrafficProfile profile;
+    TrafficSource source;
+    PassengerModel pax;
+
+    // Indicadores amostrados a cada ciclo
+    uint64_t cycles;
+    uint64_t waiting_sum;           // chamadas esperando
+    uint64_t age_sum;               // soma das esperas (ciclos) das chamadas
+    double wall_s;
+} Arm;
+
+static Arm arms[AB_MAX_ARMS];
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [--policy [NOME=]SPEC]... [--cycles N] [--floors N]\n"
+            "          [--traffic low|medium|high] [--profile PERFIL] [--rate R]\n"
+            "          [--duration S] [--passengers] [--lookahead H] [--budget US]\n"
+            "          [--seed S]\n"
+            "  SPEC = cascade | lookahead | estágios separados por vírgula:\n"
+            "         emergency,button,internal,forced,proximity,smartstop,full,empty,lookahead\n",
+            prog);
+}
+
+static void sample(Arm *a) {
+    const SimContext *s = &a->sim;
+    a->cycles++;
+    FLOORSET_FOREACH(&s->reg.active, i) {
+        a->waiting_sum++;
+        a->age_sum += (uint64_t)sim_call_wait(s, i);
+    }
+}
+
+static void run_arm(Arm *a, bool by_profile, long long cycles, uint64_t until_us,
+                    const BuildingConfig *cfg, TrafficMode mode) {
+    uint64_t start = hal_time_us();
+    if (by_profile) {
+        while (sim_clock_now_us(&a->clock) < until_us) {
+            sim_step(&a->sim);
+            sample(a);
+        }
+    } else {
+        for (long long c = 0; c < cycles; c++) {
+            traffic_queue_fill(&a->queue, cfg, &a->stream, mode);
+            sim_step(&a->sim);
+            sample(a);
+        }
+    }
+    a->wall_s = (double)(hal_time_us() - start) / 1e6;
+}
+
+// Uma linha da tabela: rótulo e um valor por braço
+static void row_label(const char *label) {
+    printf("%-30s", label);
+}
+
+static void row_end(void) {
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    BuildingConfig building;
+    building_config_default(&building);
+
+    int num_arms = 0;
+    long long cycles = 100000;
+    TrafficMode traffic = TRAFFIC_MEDIUM;
+    int profile = -1;
+    uint32_t rate = 0;
+    double duration_s = 86400.0;
+    bool passengers = false;
+    int horizon = 4;
+    uint32_t budget_us = 0;
+    uint64_t seed = hal_time_us();
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--policy") == 0 && val) {
+            if (num_arms == AB_MAX_ARMS) {
+                fprintf(stderr, "No máximo %d políticas\n", AB_MAX_ARMS);
+                return 1;
+            }
+            Arm *a = &arms[num_arms++];
+            const char *eq = strchr(val, '=');
+            if (eq) {
+                static char names[AB_MAX_ARMS][32];
+                size_t len = (size_t)(eq - val);
+                if (len >= sizeof(names[0])) len = sizeof(names[0]) - 1;
+                memcpy(names[num_arms - 1], val, len);
+                names[num_arms - 1][len] = '\0';
+                a->name = names[num_arms - 1];
+                a->spec = eq + 1;
+            } else {
+                a->name = val;
+                a->spec = val;
+            }
+            i++;
+        } else if (strcmp(arg, "--cycles") == 0 && val) {
+            cycles = atoll(val);
+            i++;
+        } else if (strcmp(arg, "--floors") == 0 && val) {
+            building.num_floors = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--traffic") == 0 && val) {
+            if (strcmp(val, "low") == 0) traffic = TRAFFIC_LOW;
+            else if (strcmp(val, "medium") == 0) traffic = TRAFFIC_MEDIUM;
+            else if (strcmp(val, "high") == 0) traffic = TRAFFIC_HIGH;
+            else {
+                usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(arg, "--profile") == 0 && val) {
+            profile = traffic_profile_parse(val);
+            if (profile < 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(arg, "--rate") == 0 && val) {
+            rate = (uint32_t)strtoul(val, NULL, 0);
+            i++;
+        } else if (strcmp(arg, "--duration") == 0 && val) {
+            duration_s = atof(val);
+            i++;
+        } else if (strcmp(arg, "--passengers") == 0) {
+            passengers = true;
+        } else if (strcmp(arg, "--lookahead") == 0 && val) {
+            horizon = atoi(val);
+            if (horizon < 1 || horizon > LOOKAHEAD_MAX_HORIZON) {
+                fprintf(stderr, "--lookahead deve estar entre 1 e %d\n", LOOKAHEAD_MAX_HORIZON);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(arg, "--budget") == 0 && val) {
+            budget_us = (uint32_t)strtoul(val, NULL, 0);
+            i++;
+        } else if (strcmp(arg, "--seed") == 0 && val) {
+            seed = strtoull(val, NULL, 0);
+            i++;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!building_config_apply(&building)) {
+        fprintf(stderr, "Configuração inválida: andares 2..%d\n", MAX_FLOORS);
+        return 1;
+    }
+    if (num_arms == 0) {
+        arms[0].name = arms[0].spec = "cascade";
+        arms[1].name = arms[1].spec = "lookahead";
+        num_arms = 2;
+    }
+    const bool by_profile = profile >= 0;
+    const uint64_t until_us = (uint64_t)(duration_s * 1e6);
+
+    // Simulação base: os braços partem de cópias dela
+    static SimClock base_clock;
+    static SimContext base;
+    sim_clock_init(&base_clock, SIM_CLOCK_FAST, 1.0f);
+    sim_init(&base, &building, &base_clock, traffic, seed, false);
+    SimRng shared;
+    sim_traffic_stream(&base, &shared);
+
+    for (int k = 0; k < num_arms; k++) {
+        Arm *a = &arms[k];
+        lookahead_init(&a->lookahead, horizon, budget_us);
+        if (!dispatch_policy_parse(&a->policy, a->name, a->spec, &a->lookahead)) {
+            usage(argv[0]);
+            return 1;
+        }
+        a->policy.timed = true;
+
+        a->clock = base_clock;
+        a->sim = base;
+        a->sim.clock = &a->clock;
+        a->sim.policy = &a->policy;
+        if (passengers) {
+            sim_attach_passengers(&a->sim, &a->pax);
+        }
+        a->stream = shared;
+        if (by_profile) {
+            traffic_profile_init(&a->profile, &a->source, (TrafficProfileKind)profile,
+                                 a->sim.cfg.num_floors, rate, &a->stream);
+            sim_attach_source(&a->sim, &a->source);
+        } else {
+            traffic_queue_init(&a->queue);
+            a->sim.traffic = &a->queue;
+        }
+    }
+
+    for (int k = 0; k < num_arms; k++) {
+        run_arm(&arms[k], by_profile, cycles, until_us, &building, traffic);
+    }
+
+    // ---- Relatório ----
+    static const char *const traffic_names[] = { "low", "medium", "high" };
+    printf("=== Comparação de políticas (mesmo tráfego) ===\n");
+    printf("Prédio: %d andares, capacidade %d | semente %llu\n", building.num_floors,
+           building.car_capacity, (unsigned long long)seed);
+    if (by_profile) {
+        printf("Tráfego: perfil %s, %u grupos/h no pico, %.1f h simuladas%s\n",
+               arms[0].source.name, arms[0].profile.arrivals_per_hour, duration_s / 3600.0,
+               passengers ? ", passageiros individuais" : "");
+    } else {
+        printf("Tráfego: %s por ciclo, %lld ciclos%s\n", traffic_names[traffic], cycles,
+               passengers ? ", passageiros individuais" : "");
+    }
+    for (int k = 0; k < num_arms; k++) {
+        char stages[160];
+        dispatch_policy_describe(&arms[k].policy, stages, (int)sizeof(stages));
+        printf("  %-14s %s\n", arms[k].name, stages);
+    }
+    printf("\n");
+
+    row_label("");
+    for (int k = 0; k < num_arms; k++) printf("%14s", arms[k].name);
+    row_end();
+
+    row_label("Ciclos");
+    for (int k = 0; k < num_arms; k++) printf("%14llu", (unsigned long long)arms[k].cycles);
+    row_end();
+    row_label("Tempo simulado (h)");
+    for (int k = 0; k < num_arms; k++) {
+        printf("%14.1f", (double)sim_clock_now_us(&arms[k].clock) / 3.6e9);
+    }
+    row_end();
+    row_label("Paradas");
+    for (int k = 0; k < num_arms; k++) printf("%14d", arms[k].sim.stats.total_stops);
+    row_end();
+    row_label("Paradas evitadas");
+    for (int k = 0; k < num_arms; k++) printf("%14d", arms[k].sim.stats.skipped_stops);
+    row_end();
+    row_label("Embarques");
+    for (int k = 0; k < num_arms; k++) printf("%14d", arms[k].sim.stats.total_boarded);
+    row_end();
+    row_label("Embarques por hora");
+    for (int k = 0; k < num_arms; k++) {
+        double h = (double)sim_clock_now_us(&arms[k].clock) / 3.6e9;
+        printf("%14.1f", h > 0.0 ? arms[k].sim.stats.total_boarded / h : 0.0);
+    }
+    row_end();
+    row_label("Chamadas esperando (média)");
+    for (int k = 0; k < num_arms; k++) {
+        printf("%14.2f", arms[k].cycles ? (double)arms[k].waiting_sum / arms[k].cycles : 0.0);
+    }
+    row_end();
+    row_label("Espera das chamadas (ciclos)");
+    for (int k = 0; k < num_arms; k++) {
+        printf("%14.2f", arms[k].waiting_sum ? (double)arms[k].age_sum / arms[k].waiting_sum
+                                             : 0.0);
+    }
+    row_end();
+    if (passengers) {
+        row_label("Espera média (s)");
+        for (int k = 0; k < num_arms; k++) {
+            printf("%14.1f", duration_hist_mean_ms(&arms[k].pax.wait) / 1000.0);
+        }
+        row_end();
+        row_label("Espera p90 (s)");
+        for (int k = 0; k < num_arms; k++) {
+            printf("%14u", duration_hist_percentile_s(&arms[k].pax.wait, 90));
+        }
+        row_end();
+        row_label("Viagem média (s)");
+        for (int k = 0; k < num_arms; k++) {
+            printf("%14.1f", duration_hist_mean_ms(&arms[k].pax.journey) / 1000.0);
+        }
+        row_end();
+        row_label("Viagem p90 (s)");
+        for (int k = 0; k < num_arms; k++) {
+            printf("%14u", duration_hist_percentile_s(&arms[k].pax.journey, 90));
+        }
+        row_end();
+        row_label("Entregues");
+        for (int k = 0; k < num_arms; k++) {
+            printf("%14llu", (unsigned long long)arms[k].pax.delivered);
+        }
+        row_end();
+    }
+
+    printf("\nDecisões por regra (%%):\n");
+    for (int r = 0; r <= PRIORITY_LOOKAHEAD; r++) {
+        bool any = false;
+        for (int k = 0; k < num_arms; k++) any = any || arms[k].policy.by_priority[r] > 0;
+        if (!any) continue;
+        printf("  %-28s", dispatch_priority_name((DispatchPriority)r));
+        for (int k = 0; k < num_arms; k++) {
+            const DispatchPolicy *p = &arms[k].policy;
+            printf("%14.1f", p->decisions ? 100.0 * (double)p->by_priority[r] / p->decisions
+                                          : 0.0);
+        }
+        row_end();
+    }
+
+    printf("\nCusto por decisão:\n");
+    row_label("  média (ns)");
+    for (int k = 0; k < num_arms; k++) {
+        const DispatchPolicy *p = &arms[k].policy;
+        printf("%14.0f", p->decisions ? (double)p->time_sum_ns / p->decisions : 0.0);
+    }
+    row_end();
+    row_label("  pior (ns)");
+    for (int k = 0; k < num_arms; k++) {
+        printf("%14llu", (unsigned long long)arms[k].policy.time_max_ns);
+    }
+    row_end();
+    row_label("  tempo real do braço (s)");
+    for (int k = 0; k < num_arms; k++) printf("%14.3f", arms[k].wall_s);
+    row_end();
+
+    return 0;
+}
@@ -0,0 +1,285 @@
+/*
+ * Microbenchmarks dos caminhos quentes do despacho (host e Pico)
+ */
+
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dispatch.h"
+#include "hal.h"
+
+typedef struct {
+    HallCall calls[MAX_FLOORS];
+    CallRegistry reg;
+    ElevatorState e;
+    int cycles_full;
+    int stop_floor;                 // andar atendido por smartstop_handle_stop
+    CallOrder order;                // chamadas em ordem de chegada
+} BenchState;
+
+static BenchState ring[BENCH_RING];
+static SimClock work_clock;
+static SimContext work;
+static double samples[BENCH_MAX_SAMPLES];
+
+static const char *const op_names[BENCH_COUNT] = {
+    "smartstop_decide_next_floor",
+    "find_emergency_call",
+    "call_order_emergency",
+    "generate_random_hall_calls",
+    "cleanup_empty_calls",
+    "smartstop_handle_stop",
+    "choose_next_floor_realistic",
+};
+
+void bench_config_default(BenchConfig *bc) {
+    bc->samples = 30;
+    bc->min_sample_us = 2000;
+    bc->seed = 1;
+}
+
+const char *bench_op_name(BenchOp op) {
+    return (unsigned)op < BENCH_COUNT ? op_names[op] : "?";
+}
+
+// Relógio de espera dos estados: cada chegada fica em now - espera
+static uint32_t bench_wait_clock(const BuildingConfig *cfg) {
+    return (uint32_t)cfg->emergency_wait_time + 5u;
+}
+
+// Sorteia o anel de estados: andar, direção e ocupação do carro, chamadas
+// em density_pct% dos andares (estimativa 0..5, com zeros para a limpeza;
+// espera até passar da emergência) e, em um estado a cada quatro, destinos
+// internos
+static void prepare(const BuildingConfig *cfg, SimRng *rng, int density_pct) {
+    const int n = cfg->num_floors;
+    const uint32_t now = bench_wait_clock(cfg);
+
+    for (int k = 0; k < BENCH_RING; k++) {
+        BenchState *st = &ring[k];
+        call_registry_clear(&st->reg);
+
+        st->e.current_floor = sim_rng_below(rng, (uint32_t)n);
+        st->e.direction = sim_rng_below(rng, 2) ? 1 : -1;
+        st->e.occupancy = sim_rng_below(rng, (uint32_t)cfg->car_capacity + 1);
+        st->cycles_full = st->e.occupancy >= cfg->car_capacity
+                        ? sim_rng_below(rng, (uint32_t)cfg->cycles_full_max + 2) : 0;
+
+        for (int i = 0; i < MAX_FLOORS; i++) {
+            HallCall *c = &st->calls[i];
+            c->floor = i;
+            c->active = i < n && i != st->e.current_floor &&
+                        sim_rng_below(rng, 100) < density_pct;
+            c->est_passengers = c->active ? sim_rng_below(rng, 6) : 0;
+            c->arrival = now - (c->active
+                ? sim_rng_below(rng, (uint32_t)cfg->emergency_wait_time + 5) : 0);
+            if (c->active) floorset_set(&st->reg.active, i);
+            if (i < n && (k & 3) == 3 && sim_rng_below(rng, 10) == 0) {
+                floorset_set(&st->reg.internal, i);
+            }
+        }
+
+        st->stop_floor = floorset_nearest(&st->reg.active, st->e.current_floor);
+        if (st->stop_floor < 0) st->stop_floor = st->e.current_floor;
+
+        call_order_init(&st->order, cfg->emergency_wait_time, now);
+        call_order_sync(&st->order, st->calls, &st->reg.active);
+    }
+}
+
+// with_order: também a ordem de chegada (só a decisão completa a consulta)
+static inline void restore(const BenchState *st, int n, bool with_order) {
+    memcpy(work.calls, st->calls, (size_t)n * sizeof(HallCall));
+    work.reg = st->reg;
+    work.elevator = st->e;
+    work.cycles_at_full_capacity = st->cycles_full;
+    if (with_order) work.order = st->order;
+}
+
+static bool op_restores(BenchOp op) {
+    return op == BENCH_GENERATE || op == BENCH_CLEANUP || op == BENCH_HANDLE_STOP ||
+           op == BENCH_CHOOSE;
+}
+
+// Lote de n chamadas de op (ou só a restauração, com baseline); tempo em ns
+static uint64_t run_batch(BenchOp op, uint32_t n, bool baseline) {
+    const BuildingConfig *cfg = &work.cfg;
+    const int nf = cfg->num_floors;
+    const uint32_t now = work.wait_clock;
+    const bool with_order = op == BENCH_CHOOSE;
+    volatile int sink = 0;
+    int acc = 0;
+
+#define BENCH_LOOP(body)                                                  \
+    for (uint32_t i = 0; i < n; i++) {                                    \
+        BenchState *st = &ring[i & (BENCH_RING - 1)];                     \
+        (void)st;                                                         \
+        body;                                                             \
+    }
+
+    uint64_t start = hal_time_ns();
+    if (baseline) {
+        BENCH_LOOP(restore(st, nf, with_order); acc += work.elevator.occupancy);
+    } else {
+        switch (op) {
+            case BENCH_DECIDE:
+                BENCH_LOOP(acc += smartstop_decide_next_floor(cfg, st->calls, &st->reg.active,
+                                                              &st->e, now, &work.stats));
+                break;
+            case BENCH_EMERGENCY:
+                BENCH_LOOP(acc += find_emergency_call(cfg, st->calls, &st->reg.active, now));
+                break;
+            case BENCH_EMERGENCY_ORDER:
+                BENCH_LOOP(acc += call_order_emergency(&st->order, st->calls));
+                break;
+            case BENCH_GENERATE:
+                BENCH_LOOP(restore(st, nf, false);
+                           generate_random_hall_calls(cfg, &work.rng, work.calls,
+                                                      &work.reg.active, &work.elevator,
+                                                      TRAFFIC_MEDIUM, now);
+                           acc += work.elevator.occupancy);
+                break;
+            case BENCH_CLEANUP:
+                BENCH_LOOP(restore(st, nf, false);
+                           cleanup_empty_calls(work.calls, &work.reg.active, &work.reg.active);
+                           acc += work.elevator.occupancy);
+                break;
+            case BENCH_HANDLE_STOP:
+                BENCH_LOOP(restore(st, nf, false);
+                           smartstop_handle_stop(cfg, work.calls, &work.reg.active,
+                                                 &work.elevator, &work.stats, st->stop_floor);
+                           acc += work.elevator.occupancy);
+                break;
+            case BENCH_CHOOSE:
+                BENCH_LOOP(restore(st, nf, true);
+                           acc += choose_next_floor_realistic(&work, NULL));
+                break;
+            default:
+                break;
+        }
+    }
+    uint64_t elapsed = hal_time_ns() - start;
+#undef BENCH_LOOP
+
+    sink = acc;
+    (void)sink;
+    return elapsed;
+}
+
+// Quantil 0,975 da t de Student com df graus de liberdade
+static double t_975(int df) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (df < 1) return 0.0;
+    if (df <= 30) return table[df - 1];
+    if (df <= 60) return 2.00;
+    if (df <= 120) return 1.98;
+    return 1.96;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Média, desvio, mediana, mínimo e IC95 de ns/op em samples[0..count)
+static void summarize(int count, double *mean, double *sd, double *median, double *min,
+                      double *ci) {
+    double sum = 0.0, sq = 0.0;
+    for (int i = 0; i < count; i++) sum += samples[i];
+    *mean = sum / count;
+    for (int i = 0; i < count; i++) sq += (samples[i] - *mean) * (samples[i] - *mean);
+    *sd = count > 1 ? sqrt(sq / (count - 1)) : 0.0;
+    *ci = t_975(count - 1) * *sd / sqrt((double)count);
+
+    qsort(samples, (size_t)count, sizeof(samples[0]), cmp_double);
+    *min = samples[0];
+    *median = (count & 1) ? samples[count / 2]
+                          : 0.5 * (samples[count / 2 - 1] + samples[count / 2]);
+}
+
+// Amostras de ns/op de op (ou da restauração) com o lote calibrado
+static void measure(const BenchConfig *bc, BenchOp op, bool baseline, uint32_t *ops,
+                    double *mean, double *sd, double *median, double *min, double *ci) {
+    const uint64_t min_ns = (uint64_t)bc->min_sample_us * 1000u;
+
+    // Calibração (também aquece caches e preditores)
+    uint32_t n = BENCH_RING * 4u;
+    while (run_batch(op, n, baseline) < min_ns && n < (1u << 28)) {
+        n *= 2u;
+    }
+
+    for (int s = 0; s < bc->samples; s++) {
+        samples[s] = (double)run_batch(op, n, baseline) / (double)n;
+    }
+    *ops = n;
+    summarize(bc->samples, mean, sd, median, min, ci);
+}
+
+bool bench_run(const BenchConfig *bc, BenchOp op, int num_floors, int density_pct,
+               BenchResult *out) {
+    if ((unsigned)op >= BENCH_COUNT || density_pct < 0 || density_pct > 100 ||
+        bc->samples < 2 || bc->samples > BENCH_MAX_SAMPLES) {
+        return false;
+    }
+
+    BuildingConfig cfg;
+    building_config_default(&cfg);
+    cfg.num_floors = num_floors;
+    if (!building_config_apply(&cfg)) return false;
+
+    sim_clock_init(&work_clock, SIM_CLOCK_FAST, 1.0f);
+    sim_init(&work, &cfg, &work_clock, TRAFFIC_MEDIUM, bc->seed, false);
+
+    SimRng rng;
+    sim_rng_seed(&rng, bc->seed ^ ((uint64_t)num_floors << 32) ^ (uint64_t)density_pct);
+    prepare(&work.cfg, &rng, density_pct);
+    work.wait_clock = bench_wait_clock(&work.cfg);
+
+    memset(out, 0, sizeof(*out));
+    out->op = op;
+    out->num_floors = num_floors;
+    out->density_pct = density_pct;
+    out->samples = bc->samples;
+
+    double sd, ci, median, min;
+    measure(bc, op, false, &out->ops_per_sample, &out->mean_ns, &sd, &median, &min, &ci);
+
+    if (op_restores(op)) {
+        uint32_t n;
+        double b_mean, b_sd, b_median, b_min, b_ci;
+        measure(bc, op, true, &n, &b_mean, &b_sd, &b_median, &b_min, &b_ci);
+        out->overhead_ns = b_mean;
+        out->mean_ns -= b_mean;
+        median -= b_median;
+        min -= b_min;
+        // Diferença de médias independentes: as variâncias somam
+        ci = sqrt(ci * ci + b_ci * b_ci);
+        sd = sqrt(sd * sd + b_sd * b_sd);
+    }
+    out->ci95_ns = ci;
+    out->median_ns = median;
+    out->stddev_ns = sd;
+    out->min_ns = min;
+    return true;
+}
+
+void bench_print_json(const BenchResult *r, uint32_t cpu_mhz) {
+    printf("{\"bench\": \"%s\", \"floors\": %d, \"density_pct\": %d, \"samples\": %d, "
+           "\"ops_per_sample\": %u, \"ns_per_op\": %.3f, \"ci95_ns\": %.3f, "
+           "\"median_ns\": %.3f, \"stddev_ns\": %.3f, \"min_ns\": %.3f, \"overhead_ns\": %.3f",
+           bench_op_name(r->op), r->num_floors, r->density_pct, r->samples, r->ops_per_sample,
+           r->mean_ns, r->ci95_ns, r->median_ns, r->stddev_ns, r->min_ns, r->overhead_ns);
+    if (cpu_mhz > 0) {
+        printf(", \"cycles_per_op\": %.1f, \"cpu_mhz\": %u",
+               r->mean_ns * (double)cpu_mhz / 1000.0, cpu_mhz);
+    }
+    printf("}");
+}
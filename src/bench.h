@@ -0,0 +1,69 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Microbenchmarks dos caminhos quentes do despacho, portáveis entre host e
+// Pico (só hal_time_ns e memória estática).
+//
+// Cada caso é uma operação num prédio de N andares com D% dos andares com
+// chamada ativa. Os estados de entrada (anel de BENCH_RING estados sorteados)
+// variam andar, direção, ocupação, estimativas e esperas, para que os
+// ramos não fiquem todos previsíveis. Operações que alteram o estado
+// (gerar, limpar, embarcar, a cascata) restauram o estado antes de cada
+// chamada; o custo da restauração é medido à parte e descontado.
+//
+// Cada amostra cronometra um lote de chamadas com duração mínima
+// calibrada (min_sample_us); o resultado traz média, mediana, desvio e o
+// intervalo de confiança de 95% (t de Student) das amostras.
+
+#define BENCH_RING        8         // estados de entrada (potência de 2)
+#define BENCH_MAX_SAMPLES 200
+
+typedef enum {
+    BENCH_DECIDE = 0,               // smartstop_decide_next_floor
+    BENCH_EMERGENCY,                // find_emergency_call
+    BENCH_EMERGENCY_ORDER,          // call_order_emergency
+    BENCH_GENERATE,                 // generate_random_hall_calls
+    BENCH_CLEANUP,                  // cleanup_empty_calls
+    BENCH_HANDLE_STOP,              // smartstop_handle_stop
+    BENCH_CHOOSE,                   // choose_next_floor_realistic
+    BENCH_COUNT
+} BenchOp;
+
+typedef struct {
+    int samples;                    // amostras por caso (até BENCH_MAX_SAMPLES)
+    uint32_t min_sample_us;         // duração mínima de uma amostra
+    uint64_t seed;
+} BenchConfig;
+
+typedef struct {
+    BenchOp op;
+    int num_floors;
+    int density_pct;
+    int samples;
+    uint32_t ops_per_sample;
+    double mean_ns;                 // por operação, já sem a restauração
+    double ci95_ns;                 // meia largura do intervalo de 95%
+    double median_ns;
+    double stddev_ns;
+    double min_ns;
+    double overhead_ns;             // restauração descontada (0 se não há)
+} BenchResult;
+
+void bench_config_default(BenchConfig *bc);
+
+// Nome da função medida
+const char *bench_op_name(BenchOp op);
+
+// Mede op num prédio de num_floors andares com density_pct% de chamadas.
+// Retorna false se os parâmetros forem inválidos.
+bool bench_run(const BenchConfig *bc, BenchOp op, int num_floors, int density_pct,
+               BenchResult *out);
+
+// Um resultado como objeto JSON (sem vírgula nem quebra de linha). Com
+// cpu_mhz > 0 inclui ciclos por operação.
+void bench_print_json(const BenchResult *r, uint32_t cpu_mhz);
+
+#endif
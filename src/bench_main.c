@@ -0,0 +1,124 @@
+/*
+ * SmartStop - microbenchmarks do despacho (host)
+ *
+ * Mede ns por operação de cada caminho quente (bench.h) para cada tamanho
+ * de prédio e densidade de chamadas, com média, mediana e intervalo de
+ * confiança de 95%. Com --json a saída é um documento só, para guardar e
+ * comparar entre versões (regressões de desempenho).
+ *
+ * Uso:
+ *   smartstop_bench [--floors 10,16,32,64,256] [--density 10,50,90]
+ *                   [--samples N] [--min-sample-us U] [--only NOME]
+ *                   [--seed S] [--json]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "smartstop.h"
+#include "value_list.h"
+
+#define BENCH_MAX_LIST 16
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [--floors L] [--density L] [--samples N] [--min-sample-us U]\n"
+            "          [--only NOME] [--seed S] [--json]\n"
+            "  L: lista separada por vírgula (ex.: 10,32,64)\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    BenchConfig bc;
+    bench_config_default(&bc);
+
+    int floors[BENCH_MAX_LIST] = { DEFAULT_NUM_FLOORS, 16, 32, 64, MAX_FLOORS };
+    int num_floors = 5;
+    int density[BENCH_MAX_LIST] = { 10, 50, 90 };
+    int num_density = 3;
+    const char *only = NULL;
+    bool json = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--floors") == 0 && val) {
+            num_floors = int_list_parse(val, floors, BENCH_MAX_LIST);
+            i++;
+        } else if (strcmp(arg, "--density") == 0 && val) {
+            num_density = int_list_parse(val, density, BENCH_MAX_LIST);
+            i++;
+        } else if (strcmp(arg, "--samples") == 0 && val) {
+            bc.samples = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--min-sample-us") == 0 && val) {
+            bc.min_sample_us = (uint32_t)strtoul(val, NULL, 0);
+            i++;
+        } else if (strcmp(arg, "--only") == 0 && val) {
+            only = val;
+            i++;
+        } else if (strcmp(arg, "--seed") == 0 && val) {
+            bc.seed = strtoull(val, NULL, 0);
+            i++;
+        } else if (strcmp(arg, "--json") == 0) {
+            json = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (num_floors <= 0 || num_density <= 0 || bc.samples < 2 ||
+        bc.samples > BENCH_MAX_SAMPLES) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (json) {
+        printf("{\"suite\": \"smartstop_bench\", \"platform\": \"host\", "
+               "\"fixed_point\": %s, \"samples\": %d, \"min_sample_us\": %u, "
+               "\"results\": [\n",
+#ifdef SMARTSTOP_FIXED_POINT
+               "true",
+#else
+               "false",
+#endif
+               bc.samples, bc.min_sample_us);
+    } else {
+        printf("Amostras: %d por caso, mínimo de %u us cada\n\n", bc.samples, bc.min_sample_us);
+        printf("função                       andares densidade      ns/op    ± IC95    mediana"
+               "  restauração\n");
+    }
+
+    bool first = true;
+    for (int op = 0; op < BENCH_COUNT; op++) {
+        if (only && strstr(bench_op_name((BenchOp)op), only) == NULL) continue;
+
+        for (int f = 0; f < num_floors; f++) {
+            for (int d = 0; d < num_density; d++) {
+                BenchResult r;
+                if (!bench_run(&bc, (BenchOp)op, floors[f], density[d], &r)) {
+                    fprintf(stderr, "Caso inválido: %d andares (2..%d), densidade %d%% (0..100)\n",
+                            floors[f], MAX_FLOORS, density[d]);
+                    return 1;
+                }
+
+                if (json) {
+                    printf("%s  ", first ? "" : ",\n");
+                    bench_print_json(&r, 0);
+                } else {
+                    printf("%-28s %7d %8d%% %10.1f %9.2f %10.1f %12.1f\n",
+                           bench_op_name(r.op), r.num_floors, r.density_pct,
+                           r.mean_ns, r.ci95_ns, r.median_ns, r.overhead_ns);
+                }
+                fflush(stdout);
+                first = false;
+            }
+        }
+    }
+
+    if (json) printf("\n]}\n");
+    return 0;
+}
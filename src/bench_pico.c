@@ -0,0 +1,60 @@
+/*
+ * SmartStop - microbenchmarks do despacho no RP2040
+ *
+ * Firmware à parte (smartstop_bench, com -DSMARTSTOP_BENCH=ON): roda os
+ * casos de bench.h no M0+ e envia pela USB o mesmo JSON do host, com os
+ * ciclos por operação no clock do sistema. O relógio é o timer de 1 us do
+ * RP2040; cada amostra dura pelo menos 20 ms, então a resolução não pesa.
+ */
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "bench.h"
+#include "smartstop.h"
+
+#define BENCH_PICO_SAMPLES   20
+#define BENCH_PICO_SAMPLE_US 20000
+
+int main() {
+    stdio_init_all();
+    sleep_ms(3000);     // tempo para abrir o monitor serial
+
+    BenchConfig bc;
+    bench_config_default(&bc);
+    bc.samples = BENCH_PICO_SAMPLES;
+    bc.min_sample_us = BENCH_PICO_SAMPLE_US;
+
+    static const int floors[] = { DEFAULT_NUM_FLOORS, 32, 64 };
+    static const int density[] = { 10, 50, 90 };
+    const uint32_t mhz = clock_get_hz(clk_sys) / 1000000u;
+
+    printf("{\"suite\": \"smartstop_bench\", \"platform\": \"rp2040\", "
+           "\"fixed_point\": %s, \"samples\": %d, \"min_sample_us\": %u, "
+           "\"results\": [\n",
+#ifdef SMARTSTOP_FIXED_POINT
+           "true",
+#else
+           "false",
+#endif
+           bc.samples, (unsigned)bc.min_sample_us);
+
+    bool first = true;
+    for (int op = 0; op < BENCH_COUNT; op++) {
+        for (unsigned f = 0; f < sizeof(floors) / sizeof(floors[0]); f++) {
+            for (unsigned d = 0; d < sizeof(density) / sizeof(density[0]); d++) {
+                BenchResult r;
+                if (!bench_run(&bc, (BenchOp)op, floors[f], density[d], &r)) continue;
+                printf("%s  ", first ? "" : ",\n");
+                bench_print_json(&r, mhz);
+                first = false;
+            }
+        }
+    }
+    printf("\n]}\n");
+
+    while (true) {
+        sleep_ms(1000);
+    }
+}
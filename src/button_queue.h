@@ -0,0 +1,89 @@
+#ifndef BUTTON_QUEUE_H
+#define BUTTON_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fila SPSC de pressões dos botões A/B. No Pico o produtor é o alarme de
+// debounce (interrupção, núcleo 0) e o consumidor é o laço de controle,
+// que esvazia a fila entre as pausas, inclusive durante a viagem
+// (sim_poll_buttons). Cada evento leva o instante da borda de descida,
+// para medir a latência até o registro e até o atendimento.
+
+#define BUTTON_QUEUE_DEPTH 16           // potência de 2
+
+typedef enum {
+    BUTTON_ID_A = 0,                    // chamada interna
+    BUTTON_ID_B                         // chamada externa (hall)
+} ButtonId;
+
+typedef struct {
+    uint64_t press_us;                  // hal_time_us da borda
+    uint8_t button;                     // ButtonId
+} ButtonEvent;
+
+typedef struct {
+    _Atomic uint32_t head;              // só o produtor escreve
+    _Atomic uint32_t tail;              // só o consumidor escreve
+    _Atomic uint32_t dropped;           // produtor: fila cheia
+    ButtonEvent ev[BUTTON_QUEUE_DEPTH];
+} ButtonQueue;
+
+static inline void button_queue_init(ButtonQueue *q) {
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->dropped, 0);
+}
+
+// Produtor (contexto de interrupção): nunca bloqueia
+static inline bool button_queue_push(ButtonQueue *q, ButtonId button, uint64_t press_us) {
+    uint32_t h = atomic_load_explicit(&q->head, memory_order_relaxed);
+    uint32_t t = atomic_load_explicit(&q->tail, memory_order_acquire);
+    if (h - t >= BUTTON_QUEUE_DEPTH) {
+        uint32_t d = atomic_load_explicit(&q->dropped, memory_order_relaxed);
+        atomic_store_explicit(&q->dropped, d + 1, memory_order_relaxed);
+        return false;
+    }
+    ButtonEvent *e = &q->ev[h & (BUTTON_QUEUE_DEPTH - 1)];
+    e->press_us = press_us;
+    e->button = (uint8_t)button;
+    atomic_store_explicit(&q->head, h + 1, memory_order_release);
+    return true;
+}
+
+// Consumidor: retira o evento mais antigo; false se a fila está vazia
+static inline bool button_queue_pop(ButtonQueue *q, ButtonEvent *out) {
+    uint32_t t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    uint32_t h = atomic_load_explicit(&q->head, memory_order_acquire);
+    if (t == h) return false;
+    *out = q->ev[t & (BUTTON_QUEUE_DEPTH - 1)];
+    atomic_store_explicit(&q->tail, t + 1, memory_order_release);
+    return true;
+}
+
+// Latência acumulada (contagem, soma e máximo)
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+} LatencyStat;
+
+static inline void latency_reset(LatencyStat *l) {
+    l->count = 0;
+    l->max_us = 0;
+    l->sum_us = 0;
+}
+
+static inline void latency_add(LatencyStat *l, uint64_t us) {
+    uint32_t v = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+    l->count++;
+    l->sum_us += v;
+    if (v > l->max_us) l->max_us = v;
+}
+
+static inline uint32_t latency_avg_us(const LatencyStat *l) {
+    return l->count ? (uint32_t)(l->sum_us / l->count) : 0;
+}
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * Chamadas ativas em ordem de chegada (espera e emergências incrementais)
+ */
+
+#include "callorder.h"
+
+// (chegada, andar) de a vem antes do de b
+static inline bool order_before(const CallOrder *o, int a, int b) {
+    if (o->arrival[a] != o->arrival[b]) {
+        return (int32_t)(o->arrival[a] - o->arrival[b]) < 0;
+    }
+    return a < b;
+}
+
+static inline bool order_emergency(const CallOrder *o, int f) {
+    return (int32_t)(o->now - o->arrival[f]) >= o->emergency_wait;
+}
+
+void call_order_init(CallOrder *o, int emergency_wait, uint32_t now) {
+    floorset_clear(&o->tracked);
+    o->head = o->tail = o->boundary = CALL_ORDER_NONE;
+    o->emergencies = 0;
+    o->emergency_wait = emergency_wait;
+    o->now = now;
+}
+
+// Liga f logo depois de p (p = NONE: na cabeça) e atualiza o prefixo
+static void order_link_after(CallOrder *o, int f, uint16_t p) {
+    uint16_t n = (p == CALL_ORDER_NONE) ? o->head : o->next[p];
+    o->prev[f] = p;
+    o->next[f] = n;
+    if (p == CALL_ORDER_NONE) o->head = (uint16_t)f;
+    else o->next[p] = (uint16_t)f;
+    if (n == CALL_ORDER_NONE) o->tail = (uint16_t)f;
+    else o->prev[n] = (uint16_t)f;
+    floorset_set(&o->tracked, f);
+
+    // Uma chamada em emergência cai sempre antes de boundary (chega antes de
+    // todas as que estão fora)
+    if (order_emergency(o, f)) {
+        o->emergencies++;
+    } else if (o->boundary == CALL_ORDER_NONE || order_before(o, f, o->boundary)) {
+        o->boundary = (uint16_t)f;
+    }
+}
+
+static void order_unlink(CallOrder *o, int f) {
+    if (order_emergency(o, f)) o->emergencies--;
+    if (o->boundary == f) o->boundary = o->next[f];
+
+    uint16_t p = o->prev[f];
+    uint16_t n = o->next[f];
+    if (p == CALL_ORDER_NONE) o->head = n;
+    else o->next[p] = n;
+    if (n == CALL_ORDER_NONE) o->tail = p;
+    else o->prev[n] = p;
+    floorset_reset(&o->tracked, f);
+}
+
+// Chegadas novas ficam no fim: procura a posição a partir da cauda
+static void order_insert_from_tail(CallOrder *o, int f) {
+    uint16_t p = o->tail;
+    while (p != CALL_ORDER_NONE && order_before(o, f, p)) {
+        p = o->prev[p];
+    }
+    order_link_after(o, f, p);
+}
+
+void call_order_advance(CallOrder *o, uint32_t now) {
+    o->now = now;
+    while (o->boundary != CALL_ORDER_NONE && order_emergency(o, o->boundary)) {
+        o->emergencies++;
+        o->boundary = o->next[o->boundary];
+    }
+}
+
+void call_order_sync(CallOrder *o, const HallCall calls[], const FloorSet *active) {
+    FloorSet changed;
+
+    floorset_minus(&changed, &o->tracked, active);
+    FLOORSET_FOREACH(&changed, f) {
+        order_unlink(o, f);
+    }
+
+    floorset_minus(&changed, active, &o->tracked);
+    FLOORSET_FOREACH(&changed, f) {
+        o->arrival[f] = calls[f].arrival;
+        order_insert_from_tail(o, f);
+    }
+}
+
+void call_order_restamp(CallOrder *o, int floor, uint32_t arrival) {
+    if (!floorset_test(&o->tracked, floor) || o->arrival[floor] == arrival) return;
+
+    bool later = (int32_t)(arrival - o->arrival[floor]) > 0;
+    uint16_t p = o->prev[floor];
+    order_unlink(o, floor);
+    o->arrival[floor] = arrival;
+
+    if (!later) {
+        order_insert_from_tail(o, floor);
+        return;
+    }
+    // Mais recente: avança a partir da posição antiga
+    uint16_t n = (p == CALL_ORDER_NONE) ? o->head : o->next[p];
+    while (n != CALL_ORDER_NONE && order_before(o, n, floor)) {
+        p = n;
+        n = o->next[n];
+    }
+    order_link_after(o, floor, p);
+}
+
+int call_order_emergency(const CallOrder *o, const HallCall calls[]) {
+    if (o->emergencies == 0) return -1;
+
+    // A primeira com passageiros no prefixo é a de maior espera; espera 0
+    // não conta como emergência (find_emergency_call exige espera > 0)
+    for (uint16_t f = o->head; f != o->boundary; f = o->next[f]) {
+        if (calls[f].active && calls[f].est_passengers > 0) {
+            return o->now != o->arrival[f] ? f : -1;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,58 @@
+#ifndef CALLORDER_H
+#define CALLORDER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "callset.h"
+#include "smartstop.h"
+
+// Chamadas ativas em ordem de chegada.
+//
+// Lista duplamente ligada pelos andares, ordenada por (chegada, andar): a
+// cabeça é a chamada que espera há mais tempo (a de find_emergency_call) e
+// as chamadas em emergência (espera >= emergency_wait) formam um prefixo da
+// lista, delimitado por boundary. O prefixo avança com o relógio de espera
+// (call_order_advance) e a contagem de emergências vem junto, sem varrer
+// as chamadas.
+//
+// A lista acompanha o bitmask de chamadas ativas por diferença
+// (call_order_sync), com custo proporcional às palavras do bitmask e às
+// chamadas que entraram ou saíram. Sincronize antes de ativar uma chamada:
+// assim uma chamada atendida e reativada entre duas sincronizações não fica
+// na lista com a chegada antiga.
+
+#define CALL_ORDER_NONE 0xFFFFu
+
+typedef struct {
+    FloorSet tracked;                   // andares na lista
+    uint32_t arrival[MAX_FLOORS];       // chegada registrada de cada um
+    uint16_t prev[MAX_FLOORS];
+    uint16_t next[MAX_FLOORS];
+    uint16_t head;                      // espera há mais tempo
+    uint16_t tail;                      // chegada mais recente
+    uint16_t boundary;                  // primeira fora de emergência
+    int emergencies;                    // chamadas com espera >= emergency_wait
+    int emergency_wait;
+    uint32_t now;                       // relógio de espera (call_order_advance)
+} CallOrder;
+
+void call_order_init(CallOrder *o, int emergency_wait, uint32_t now);
+
+// O relógio de espera chegou a now: as chamadas que alcançaram a espera de
+// emergência passam ao prefixo
+void call_order_advance(CallOrder *o, uint32_t now);
+
+// Remove os andares que saíram de active e insere os novos, com a chegada
+// de calls[f].arrival
+void call_order_sync(CallOrder *o, const HallCall calls[], const FloorSet *active);
+
+// A chegada de uma chamada da lista mudou (carro parado no andar, fila
+// reduzida aos que não couberam)
+void call_order_restamp(CallOrder *o, int floor, uint32_t arrival);
+
+// Chamada em emergência que espera há mais tempo, entre as que têm
+// passageiros; -1 se não houver. Mesma resposta de find_emergency_call.
+int call_order_emergency(const CallOrder *o, const HallCall calls[]);
+
+#endif
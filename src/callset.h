@@ -0,0 +1,189 @@
+#ifndef CALLSET_H
+#define CALLSET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Conjunto de andares em bitmask de palavras de máquina, com um nível de
+// resumo (bit k do resumo = palavra k não vazia). "Próximo andar com chamada
+// acima/abaixo", "existe chamada" e "mais próximo" viram ctz/clz em no máximo
+// duas palavras, independentemente do número de andares (até 256). A
+// quantidade de andares é mantida a cada inclusão/remoção.
+
+#if UINTPTR_MAX > 0xFFFFFFFFu
+typedef uint64_t floorset_word_t;
+#define FLOORSET_WORD_BITS 64
+#define FLOORSET_CTZ(x)      __builtin_ctzll(x)
+#define FLOORSET_CLZ(x)      __builtin_clzll(x)
+#define FLOORSET_POPCOUNT(x) __builtin_popcountll(x)
+#else
+typedef uint32_t floorset_word_t;
+#define FLOORSET_WORD_BITS 32
+#define FLOORSET_CTZ(x)      __builtin_ctz(x)
+#define FLOORSET_CLZ(x)      __builtin_clz(x)
+#define FLOORSET_POPCOUNT(x) __builtin_popcount(x)
+#endif
+
+#define FLOORSET_CAPACITY 256
+#define FLOORSET_WORDS    (FLOORSET_CAPACITY / FLOORSET_WORD_BITS)
+
+#define FLOORSET_ONE ((floorset_word_t)1)
+#define FLOORSET_TOP(x) (FLOORSET_WORD_BITS - 1 - FLOORSET_CLZ(x))
+
+typedef struct {
+    floorset_word_t summary;
+    floorset_word_t w[FLOORSET_WORDS];
+    int count;                       // andares no conjunto
+} FloorSet;
+
+// Registro de chamadas do elevador: hall calls ativas, destinos internos e
+// andares pedidos pelos botões A/B
+typedef struct {
+    FloorSet active;     // hall calls ativas (após a limpeza, todas com passageiros)
+    FloorSet internal;   // destinos de passageiros a bordo
+    FloorSet button;     // andares pedidos manualmente (botão A ou B)
+} CallRegistry;
+
+static inline void floorset_clear(FloorSet *s) {
+    s->summary = 0;
+    for (int k = 0; k < FLOORSET_WORDS; k++) {
+        s->w[k] = 0;
+    }
+    s->count = 0;
+}
+
+static inline void floorset_set(FloorSet *s, int f) {
+    int k = f / FLOORSET_WORD_BITS;
+    floorset_word_t bit = FLOORSET_ONE << (f % FLOORSET_WORD_BITS);
+    s->count += !(s->w[k] & bit);
+    s->w[k] |= bit;
+    s->summary |= FLOORSET_ONE << k;
+}
+
+static inline void floorset_reset(FloorSet *s, int f) {
+    int k = f / FLOORSET_WORD_BITS;
+    floorset_word_t bit = FLOORSET_ONE << (f % FLOORSET_WORD_BITS);
+    s->count -= !!(s->w[k] & bit);
+    s->w[k] &= ~bit;
+    if (s->w[k] == 0) {
+        s->summary &= ~(FLOORSET_ONE << k);
+    }
+}
+
+static inline bool floorset_test(const FloorSet *s, int f) {
+    return (s->w[f / FLOORSET_WORD_BITS] >> (f % FLOORSET_WORD_BITS)) & 1u;
+}
+
+static inline bool floorset_any(const FloorSet *s) {
+    return s->summary != 0;
+}
+
+static inline int floorset_count(const FloorSet *s) {
+    return s->count;
+}
+
+// Menor andar >= f no conjunto, ou -1
+static inline int floorset_next_up(const FloorSet *s, int f) {
+    if (f < 0) f = 0;
+    if (f >= FLOORSET_CAPACITY) return -1;
+
+    int k = f / FLOORSET_WORD_BITS;
+    floorset_word_t m = s->w[k] & (~(floorset_word_t)0 << (f % FLOORSET_WORD_BITS));
+    if (m) {
+        return k * FLOORSET_WORD_BITS + FLOORSET_CTZ(m);
+    }
+
+    floorset_word_t rest = s->summary & (~(floorset_word_t)0 << (k + 1));
+    if (!rest) return -1;
+    k = FLOORSET_CTZ(rest);
+    return k * FLOORSET_WORD_BITS + FLOORSET_CTZ(s->w[k]);
+}
+
+// Maior andar <= f no conjunto, ou -1
+static inline int floorset_next_down(const FloorSet *s, int f) {
+    if (f < 0) return -1;
+    if (f >= FLOORSET_CAPACITY) f = FLOORSET_CAPACITY - 1;
+
+    int k = f / FLOORSET_WORD_BITS;
+    int bit = f % FLOORSET_WORD_BITS;
+    floorset_word_t mask = (bit == FLOORSET_WORD_BITS - 1)
+                               ? ~(floorset_word_t)0
+                               : ((FLOORSET_ONE << (bit + 1)) - 1);
+    floorset_word_t m = s->w[k] & mask;
+    if (m) {
+        return k * FLOORSET_WORD_BITS + FLOORSET_TOP(m);
+    }
+
+    floorset_word_t rest = s->summary & ((FLOORSET_ONE << k) - 1);
+    if (!rest) return -1;
+    k = FLOORSET_TOP(rest);
+    return k * FLOORSET_WORD_BITS + FLOORSET_TOP(s->w[k]);
+}
+
+// Andar mais próximo de f (em empate vence o andar de baixo), ou -1
+static inline int floorset_nearest(const FloorSet *s, int f) {
+    int below = floorset_next_down(s, f);
+    int above = floorset_next_up(s, f + 1);
+    if (below < 0) return above;
+    if (above < 0) return below;
+    return (f - below <= above - f) ? below : above;
+}
+
+// Quantidade de andares do conjunto no intervalo [lo, hi)
+static inline int floorset_count_range(const FloorSet *s, int lo, int hi) {
+    if (lo < 0) lo = 0;
+    if (hi > FLOORSET_CAPACITY) hi = FLOORSET_CAPACITY;
+    if (lo >= hi) return 0;
+
+    int klo = lo / FLOORSET_WORD_BITS;
+    int khi = (hi - 1) / FLOORSET_WORD_BITS;
+    int n = 0;
+    for (int k = klo; k <= khi; k++) {
+        floorset_word_t m = s->w[k];
+        if (k == klo) {
+            m &= ~(floorset_word_t)0 << (lo % FLOORSET_WORD_BITS);
+        }
+        if (k == khi) {
+            int top = (hi - 1) % FLOORSET_WORD_BITS;
+            if (top != FLOORSET_WORD_BITS - 1) {
+                m &= (FLOORSET_ONE << (top + 1)) - 1;
+            }
+        }
+        n += FLOORSET_POPCOUNT(m);
+    }
+    return n;
+}
+
+// out = andares de a que não estão em b
+static inline void floorset_minus(FloorSet *out, const FloorSet *a, const FloorSet *b) {
+    out->summary = 0;
+    out->count = 0;
+    for (int k = 0; k < FLOORSET_WORDS; k++) {
+        out->w[k] = a->w[k] & ~b->w[k];
+        if (out->w[k]) {
+            out->summary |= FLOORSET_ONE << k;
+            out->count += FLOORSET_POPCOUNT(out->w[k]);
+        }
+    }
+}
+
+// out = out ∪ a
+static inline void floorset_or(FloorSet *out, const FloorSet *a) {
+    for (int k = 0; k < FLOORSET_WORDS; k++) {
+        out->count += FLOORSET_POPCOUNT(a->w[k] & ~out->w[k]);
+        out->w[k] |= a->w[k];
+    }
+    out->summary |= a->summary;
+}
+
+// Percorre os andares do conjunto em ordem crescente
+#define FLOORSET_FOREACH(s, f) \
+    for (int f = floorset_next_up((s), 0); f >= 0; f = floorset_next_up((s), f + 1))
+
+static inline void call_registry_clear(CallRegistry *r) {
+    floorset_clear(&r->active);
+    floorset_clear(&r->internal);
+    floorset_clear(&r->button);
+}
+
+#endif
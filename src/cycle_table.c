@@ -0,0 +1,258 @@
+/*
+ * Tabela colunar por ciclo: blocos de colunas empacotadas com mínimo/máximo
+ */
+
+#include "cycle_table.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void cycle_table_init(CycleTable *t, TraceSinkFn sink, void *user) {
+    t->sink = sink;
+    t->user = user;
+    t->car_capacity = 0;
+    t->rows = 0;
+    t->open = false;
+    t->cycle_base = 0;
+    memset(&t->metrics, 0, sizeof(t->metrics));
+    memset(t->decisions, 0, sizeof(t->decisions));
+    t->bytes = 0;
+}
+
+static void emit(CycleTable *t, const void *data, size_t len) {
+    if (!t->sink) return;
+    t->sink(t->user, data, len);
+    t->bytes += len;
+}
+
+void cycle_table_begin(CycleTable *t, int num_floors, int car_capacity, uint64_t seed) {
+    CycleTableHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = CYCLE_TABLE_MAGIC;
+    h.version = CYCLE_TABLE_VERSION;
+    h.num_columns = CT_COL_COUNT;
+    h.group_rows = CYCLE_TABLE_GROUP_ROWS;
+    h.num_floors = (uint16_t)num_floors;
+    h.car_capacity = (uint16_t)car_capacity;
+    h.seed = seed;
+    t->car_capacity = car_capacity;
+    emit(t, &h, sizeof(h));
+}
+
+// Bits para representar 0..range
+static int bit_width(uint64_t range) {
+    return range ? 64 - __builtin_clzll(range) : 0;
+}
+
+static uint32_t packed_bytes(int rows, int bits) {
+    if (bits == 0) return 0;
+    int per_word = 64 / bits;
+    return (uint32_t)((rows + per_word - 1) / per_word) * 8u;
+}
+
+// Estatísticas e codificação de uma coluna do bloco (a de menos bits)
+static void plan_column(const int32_t *v, int rows, CycleColumnChunk *c) {
+    int32_t lo = v[0], hi = v[0];
+    int64_t dlo = 0, dhi = 0;
+    for (int i = 1; i < rows; i++) {
+        if (v[i] < lo) lo = v[i];
+        if (v[i] > hi) hi = v[i];
+        int64_t d = (int64_t)v[i] - v[i - 1];
+        if (i == 1 || d < dlo) dlo = d;
+        if (i == 1 || d > dhi) dhi = d;
+    }
+
+    memset(c, 0, sizeof(*c));
+    c->min = lo;
+    c->max = hi;
+    c->encoding = CT_ENC_FOR;
+    c->ref = lo;
+    c->bits = (uint8_t)bit_width((uint64_t)((int64_t)hi - lo));
+
+    int delta_bits = bit_width((uint64_t)(dhi - dlo));
+    if (rows > 1 && dlo >= INT32_MIN && dhi <= INT32_MAX && delta_bits < c->bits) {
+        c->encoding = CT_ENC_DELTA;
+        c->ref = (int32_t)dlo;
+        c->first = v[0];
+        c->bits = (uint8_t)delta_bits;
+    }
+    c->bytes = packed_bytes(rows, c->bits);
+}
+
+// Empacota a coluna em t->packed conforme o plano
+static void pack_column(CycleTable *t, const int32_t *v, int rows, const CycleColumnChunk *c) {
+    const int bits = c->bits;
+    const int per_word = 64 / bits;
+    const int words = (int)(c->bytes / 8u);
+    memset(t->packed, 0, (size_t)words * sizeof(uint64_t));
+
+    for (int i = 0; i < rows; i++) {
+        int64_t x = (c->encoding == CT_ENC_DELTA)
+                  ? (i == 0 ? c->ref : (int64_t)v[i] - v[i - 1])
+                  : (int64_t)v[i];
+        uint64_t off = (uint64_t)(x - c->ref);
+        t->packed[i / per_word] |= off << ((i % per_word) * bits);
+    }
+}
+
+static void write_group(CycleTable *t) {
+    const int rows = t->rows;
+    t->metrics.groups++;
+    t->rows = 0;
+    if (!t->sink) return;
+
+    CycleColumnChunk chunks[CT_COL_COUNT];
+    uint32_t bytes = sizeof(CycleGroupHeader) + sizeof(chunks);
+    for (int k = 0; k < CT_COL_COUNT; k++) {
+        plan_column(t->col[k], rows, &chunks[k]);
+        bytes += chunks[k].bytes;
+    }
+
+    CycleGroupHeader g = { CYCLE_GROUP_MAGIC, (uint32_t)rows, bytes, 0, t->cycle_base };
+    emit(t, &g, sizeof(g));
+    emit(t, chunks, sizeof(chunks));
+    for (int k = 0; k < CT_COL_COUNT; k++) {
+        if (chunks[k].bytes == 0) continue;
+        pack_column(t, t->col[k], rows, &chunks[k]);
+        emit(t, t->packed, chunks[k].bytes);
+    }
+}
+
+// Fecha a linha aberta: soma nas métricas e grava o bloco se encheu
+static void close_row(CycleTable *t) {
+    const int r = t->rows;
+    CycleMetrics *m = &t->metrics;
+    int32_t occupancy = t->col[CT_COL_OCCUPANCY][r];
+    int32_t skipped = t->col[CT_COL_SKIPPED][r];
+    int32_t decision = t->col[CT_COL_DECISION][r];
+
+    m->rows++;
+    m->occupancy_sum += (uint64_t)occupancy;
+    if ((uint32_t)occupancy > m->occupancy_max) m->occupancy_max = (uint32_t)occupancy;
+    if ((int64_t)occupancy * 5 >= (int64_t)t->car_capacity * 4) m->rows_above_80++;
+    m->emergencies += (uint64_t)t->col[CT_COL_EMERGENCY][r];
+    m->skips += (uint64_t)skipped;
+    if (skipped > 0) m->rows_with_skip++;
+    m->embarked += (uint64_t)t->col[CT_COL_EMBARKED][r];
+    m->disembarked += (uint64_t)t->col[CT_COL_DISEMBARKED][r];
+    if (decision >= 0 && decision < MAX_FLOORS) t->decisions[decision]++;
+
+    t->open = false;
+    if (++t->rows == CYCLE_TABLE_GROUP_ROWS) {
+        write_group(t);
+    }
+}
+
+// Ciclo da linha t->rows, relativo ao primeiro do bloco. Se não couber em
+// 32 bits, grava o bloco e começa outro a partir deste ciclo
+static void set_cycle(CycleTable *t, int64_t cycle) {
+    if (t->rows > 0) {
+        int64_t off = cycle - t->cycle_base;
+        if (off < INT32_MIN || off > INT32_MAX) write_group(t);
+    }
+    if (t->rows == 0) t->cycle_base = cycle;
+    t->col[CT_COL_CYCLE][t->rows] = (int32_t)(cycle - t->cycle_base);
+}
+
+void cycle_table_event(CycleTable *t, int64_t cycle, TraceEventType type, int floor,
+                       int occupancy, int aux, int value) {
+    if (type == TRACE_EV_CYCLE) {
+        if (t->open) close_row(t);
+        set_cycle(t, cycle);
+        const int r = t->rows;
+        t->col[CT_COL_FLOOR][r] = floor;
+        t->col[CT_COL_DIRECTION][r] = aux > 0 ? 1 : -1;
+        t->col[CT_COL_OCCUPANCY][r] = occupancy;
+        t->col[CT_COL_DECISION][r] = -1;
+        t->col[CT_COL_EMBARKED][r] = 0;
+        t->col[CT_COL_DISEMBARKED][r] = 0;
+        t->col[CT_COL_EMERGENCY][r] = 0;
+        t->col[CT_COL_SKIPPED][r] = 0;
+        t->open = true;
+        return;
+    }
+    if (!t->open) return;
+
+    const int r = t->rows;
+    switch (type) {
+        case TRACE_EV_DECISION:  t->col[CT_COL_DECISION][r] = value; break;
+        case TRACE_EV_BOARD:     t->col[CT_COL_EMBARKED][r]++; break;
+        case TRACE_EV_DISEMBARK: t->col[CT_COL_DISEMBARKED][r] += value; break;
+        case TRACE_EV_SKIP:      t->col[CT_COL_SKIPPED][r]++; break;
+        case TRACE_EV_EMERGENCY: t->col[CT_COL_EMERGENCY][r] = 1; break;
+        default: break;
+    }
+}
+
+void cycle_table_append(CycleTable *t, const int64_t row[CT_COL_COUNT]) {
+    if (t->open) close_row(t);
+    set_cycle(t, row[CT_COL_CYCLE]);
+    for (int k = CT_COL_CYCLE + 1; k < CT_COL_COUNT; k++) {
+        t->col[k][t->rows] = (int32_t)row[k];
+    }
+    close_row(t);
+}
+
+// Três andares com mais paradas decididas (empate: o andar mais baixo)
+static void top_floors(const CycleTable *t, CycleMetrics *m) {
+    for (int k = 0; k < 3; k++) {
+        m->top_floor[k] = -1;
+        m->top_count[k] = 0;
+    }
+    for (int f = 0; f < MAX_FLOORS; f++) {
+        uint64_t n = t->decisions[f];
+        if (n == 0) continue;
+        for (int k = 0; k < 3; k++) {
+            if (m->top_floor[k] >= 0 && n <= m->top_count[k]) continue;
+            for (int j = 2; j > k; j--) {
+                m->top_floor[j] = m->top_floor[j - 1];
+                m->top_count[j] = m->top_count[j - 1];
+            }
+            m->top_floor[k] = f;
+            m->top_count[k] = (uint32_t)(n > UINT32_MAX ? UINT32_MAX : n);
+            break;
+        }
+    }
+}
+
+void cycle_table_finish(CycleTable *t) {
+    if (t->open) close_row(t);
+    if (t->rows > 0) write_group(t);
+    top_floors(t, &t->metrics);
+
+    CycleTableFooter f;
+    memset(&f, 0, sizeof(f));
+    f.magic = CYCLE_FOOTER_MAGIC;
+    f.metrics = t->metrics;
+    emit(t, &f, sizeof(f));
+
+    uint32_t tail[2] = { (uint32_t)sizeof(f), CYCLE_TABLE_END_MAGIC };
+    emit(t, tail, sizeof(tail));
+}
+
+void cycle_table_print_metrics(const CycleMetrics *m, int car_capacity) {
+    double rows = (double)m->rows;
+    double pct = rows > 0 ? 100.0 / rows : 0.0;
+    double cap = car_capacity > 0 ? (double)car_capacity : 1.0;
+
+    printf("\n--- Métricas por ciclo ---\n");
+    printf("Ciclos:              %llu (%u bloco(s))\n", (unsigned long long)m->rows, m->groups);
+    printf("Ocupação média:      %.1f %%\n",
+           rows > 0 ? 100.0 * (double)m->occupancy_sum / rows / cap : 0.0);
+    printf("Ocupação máxima:     %.1f %%\n", 100.0 * m->occupancy_max / cap);
+    printf("Ciclos com >= 80%%:   %llu (%.1f %%)\n",
+           (unsigned long long)m->rows_above_80, (double)m->rows_above_80 * pct);
+    printf("Emergências:         %llu (%.2f %%)\n",
+           (unsigned long long)m->emergencies, (double)m->emergencies * pct);
+    printf("Chamadas ignoradas:  %llu, em %llu ciclos (%.2f %%)\n",
+           (unsigned long long)m->skips, (unsigned long long)m->rows_with_skip,
+           (double)m->rows_with_skip * pct);
+    printf("Embarques:           %llu\n", (unsigned long long)m->embarked);
+    printf("Desembarques:        %llu\n", (unsigned long long)m->disembarked);
+    printf("Andares mais atendidos:");
+    if (m->top_floor[0] < 0) printf(" sem dados suficientes");
+    for (int k = 0; k < 3 && m->top_floor[k] >= 0; k++) {
+        printf("%s andar %d: %u paradas", k ? "," : "", m->top_floor[k], m->top_count[k]);
+    }
+    printf("\n--------------------------\n");
+}
@@ -0,0 +1,158 @@
+#ifndef CYCLE_TABLE_H
+#define CYCLE_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "smartstop.h"
+#include "trace.h"
+
+// Tabela colunar por ciclo (.ssc).
+//
+// As mesmas linhas que tools/analisar_smartstop.py monta a partir do log
+// (ciclo, andar, direção, ocupação, andar decidido, embarques,
+// desembarques, emergência, chamadas ignoradas), escritas direto pelo
+// simulador a partir dos eventos do traço. As linhas são agrupadas em blocos
+// de CYCLE_TABLE_GROUP_ROWS. Cada bloco é gravado assim que enche, então a
+// memória não cresce com o número de ciclos.
+//
+// Dentro do bloco cada coluna é gravada à parte, com mínimo e máximo no
+// cabeçalho. Um leitor que filtra por valor pula o bloco inteiro sem
+// decodificar. Os valores são empacotados em palavras de 64 bits, com a
+// largura de bits da faixa do bloco (referência + deslocamento), sem que
+// um valor atravesse duas palavras. Colunas que andam aos poucos (o número
+// do ciclo) guardam as diferenças. O número do ciclo é guardado em relação
+// ao primeiro ciclo do bloco (cycle_base, 64 bits), então não estoura com
+// mais de 2^31 ciclos; um salto que não cabe em 32 bits fecha o bloco.
+//
+// No fim vem um rodapé com as métricas de calcular_metricas, calculadas na
+// mesma passada. Os últimos 8 bytes do arquivo dão o tamanho do rodapé.
+//
+// Layout (little-endian, sem padding):
+//   CycleTableHeader
+//   blocos: CycleGroupHeader, CycleColumnChunk[CT_COL_COUNT], dados das colunas
+//   CycleTableFooter, uint32 tamanho do rodapé, uint32 CYCLE_TABLE_END_MAGIC
+
+#define CYCLE_TABLE_MAGIC     0x54435353u   // "SSCT"
+#define CYCLE_GROUP_MAGIC     0x47525353u   // "SSRG"
+#define CYCLE_FOOTER_MAGIC    0x544D5353u   // "SSMT"
+#define CYCLE_TABLE_END_MAGIC 0x45435353u   // "SSCE"
+#define CYCLE_TABLE_VERSION   2
+
+#define CYCLE_TABLE_GROUP_ROWS 16384        // linhas por bloco
+
+typedef enum {
+    CT_COL_CYCLE = 0,           // ciclo - cycle_base do bloco
+    CT_COL_FLOOR,
+    CT_COL_DIRECTION,           // 1 subindo, -1 descendo
+    CT_COL_OCCUPANCY,
+    CT_COL_DECISION,            // andar decidido (-1 = movimento contínuo)
+    CT_COL_EMBARKED,            // eventos de embarque no ciclo
+    CT_COL_DISEMBARKED,         // passageiros desembarcados
+    CT_COL_EMERGENCY,           // 1 se houve emergência (atendida ou adiada)
+    CT_COL_SKIPPED,             // chamadas ignoradas no caminho
+    CT_COL_COUNT
+} CycleColumn;
+
+typedef enum {
+    CT_ENC_FOR = 0,             // valor = ref + empacotado
+    CT_ENC_DELTA                // valor = anterior + ref + empacotado (o 1º é first)
+} CycleEncoding;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t num_columns;       // CT_COL_COUNT
+    uint32_t group_rows;        // CYCLE_TABLE_GROUP_ROWS
+    uint16_t num_floors;
+    uint16_t car_capacity;
+    uint64_t seed;
+    uint64_t reserved;
+} CycleTableHeader;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t rows;
+    uint32_t bytes;             // bloco inteiro, com os cabeçalhos
+    uint32_t reserved;
+    int64_t cycle_base;         // ciclo da primeira linha; CT_COL_CYCLE é relativa a ele
+} CycleGroupHeader;
+
+typedef struct {
+    uint8_t encoding;           // CycleEncoding
+    uint8_t bits;               // largura por valor (0 = todos iguais)
+    uint16_t reserved;
+    int32_t min;                // estatísticas dos valores do bloco
+    int32_t max;
+    int32_t ref;
+    int32_t first;              // CT_ENC_DELTA: primeiro valor
+    uint32_t bytes;             // dados empacotados (múltiplo de 8)
+} CycleColumnChunk;
+
+// Métricas de calcular_metricas (somas; as porcentagens saem delas)
+typedef struct {
+    uint64_t rows;
+    uint64_t occupancy_sum;
+    uint32_t occupancy_max;
+    uint32_t groups;
+    uint64_t rows_above_80;     // ocupação >= 80% da capacidade
+    uint64_t emergencies;       // ciclos com emergência
+    uint64_t skips;
+    uint64_t rows_with_skip;
+    uint64_t embarked;
+    uint64_t disembarked;
+    int32_t top_floor[3];       // andares mais decididos (-1 = nenhum)
+    uint32_t top_count[3];
+} CycleMetrics;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t reserved;
+    CycleMetrics metrics;
+} CycleTableFooter;
+
+_Static_assert(sizeof(CycleTableHeader) == 32, "CycleTableHeader deve ter 32 bytes");
+_Static_assert(sizeof(CycleGroupHeader) == 24, "CycleGroupHeader deve ter 24 bytes");
+_Static_assert(sizeof(CycleColumnChunk) == 24, "CycleColumnChunk deve ter 24 bytes");
+_Static_assert(sizeof(CycleTableFooter) == 104, "CycleTableFooter deve ter 104 bytes");
+
+typedef struct CycleTable {
+    TraceSinkFn sink;
+    void *user;
+    int car_capacity;
+
+    // Bloco em montagem: uma linha por ciclo, a última ainda aberta
+    int rows;
+    bool open;
+    int64_t cycle_base;                            // ciclo da primeira linha do bloco
+    int32_t col[CT_COL_COUNT][CYCLE_TABLE_GROUP_ROWS];
+    uint64_t packed[CYCLE_TABLE_GROUP_ROWS / 2];   // uma coluna empacotada (até 32 bits)
+
+    CycleMetrics metrics;
+    uint64_t decisions[MAX_FLOORS];                // paradas por andar decidido
+    uint64_t bytes;                                // total gravado
+} CycleTable;
+
+// Sink NULL: só as métricas, sem gravar nada
+void cycle_table_init(CycleTable *t, TraceSinkFn sink, void *user);
+
+// Escreve o cabeçalho; chamar uma vez antes do primeiro ciclo
+void cycle_table_begin(CycleTable *t, int num_floors, int car_capacity, uint64_t seed);
+
+// Um evento do traço (SIM_TRACE): TRACE_EV_CYCLE abre a linha do ciclo, os
+// outros somam nela
+void cycle_table_event(CycleTable *t, int64_t cycle, TraceEventType type, int floor,
+                       int occupancy, int aux, int value);
+
+// Uma linha completa, já montada (valores na ordem de CycleColumn, com o
+// ciclo absoluto)
+void cycle_table_append(CycleTable *t, const int64_t row[CT_COL_COUNT]);
+
+// Fecha a última linha, grava o bloco pendente e o rodapé
+void cycle_table_finish(CycleTable *t);
+
+// Relatório das métricas, como o resumo de analisar_smartstop.py
+void cycle_table_print_metrics(const CycleMetrics *m, int car_capacity);
+
+#endif
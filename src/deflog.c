@@ -0,0 +1,140 @@
+/*
+ * Log diferido: formatação e escrita fora do laço de controle
+ */
+
+#include "deflog.h"
+#include "hal.h"
+
+#include <stdio.h>
+
+_Static_assert((DEFLOG_CAPACITY & (DEFLOG_CAPACITY - 1)) == 0,
+               "DEFLOG_CAPACITY deve ser potência de 2");
+
+#define DEFLOG_LINE_MAX 256
+#define DEFLOG_IDLE_MARGIN_US 200
+
+#define DEFLOG_TEXT(id, text) text,
+
+static const char *const deflog_formats[LOG_FMT_COUNT] = {
+    DEFLOG_FORMATS(DEFLOG_TEXT)
+};
+
+static const char *const deflog_strings[LOG_STR_COUNT] = {
+    DEFLOG_STRINGS(DEFLOG_TEXT)
+};
+
+void deflog_init(DeferredLog *l) {
+    atomic_init(&l->head, 0);
+    atomic_init(&l->tail, 0);
+    atomic_init(&l->dropped, 0);
+    l->dropped_reported = 0;
+    l->high_water = 0;
+}
+
+int deflog_format(char *buf, size_t size, LogFmtId fmt, int nargs, const int32_t *args) {
+    const char *f = (unsigned)fmt < LOG_FMT_COUNT ? deflog_formats[fmt] : "?\n";
+    size_t n = 0;
+    int next = 0;
+
+    // Copia o texto literal e formata cada especificação com o tipo que
+    // a conversão pede
+    while (*f && n + 1 < size) {
+        if (*f != '%') {
+            buf[n++] = *f++;
+            continue;
+        }
+
+        char spec[16];
+        size_t s = 0;
+        spec[s++] = *f++;
+        while (*f && strchr("-+ #0123456789.", *f) && s < sizeof(spec) - 2) {
+            spec[s++] = *f++;
+        }
+        char conv = *f ? *f++ : '%';
+        spec[s++] = conv;
+        spec[s] = '\0';
+
+        int32_t arg = (conv != '%' && next < nargs) ? args[next++] : 0;
+        int w;
+        switch (conv) {
+            case 's':
+                w = snprintf(buf + n, size - n, spec,
+                             (unsigned)arg < LOG_STR_COUNT ? deflog_strings[arg] : "?");
+                break;
+            case 'f': case 'e': case 'g': {
+                float v;
+                memcpy(&v, &arg, sizeof(v));
+                w = snprintf(buf + n, size - n, spec, (double)v);
+                break;
+            }
+            case 'u': case 'x': case 'X':
+                w = snprintf(buf + n, size - n, spec, (unsigned)arg);
+                break;
+            case '%':
+                w = snprintf(buf + n, size - n, "%%");
+                break;
+            default:
+                w = snprintf(buf + n, size - n, spec, (int)arg);
+                break;
+        }
+        if (w < 0) break;
+        n += (size_t)w;
+        if (n >= size) n = size - 1;
+    }
+
+    buf[n] = '\0';
+    return (int)n;
+}
+
+void deflog_print(LogFmtId fmt, int nargs, const int32_t *args) {
+    char line[DEFLOG_LINE_MAX];
+    deflog_format(line, sizeof(line), fmt, nargs, args);
+    printf("%s", line);
+}
+
+// Bytes na saída: o stdio do Pico converte cada \n em \r\n
+static int output_size(const char *line, int len) {
+    int size = len;
+    for (const char *p = line; *p; p++) {
+        if (*p == '\n') size++;
+    }
+    return size;
+}
+
+int deflog_drain(DeferredLog *l, int max_records) {
+    char line[DEFLOG_LINE_MAX];
+    int written = 0;
+
+    uint32_t dropped = atomic_load_explicit(&l->dropped, memory_order_relaxed);
+    if (dropped != l->dropped_reported) {
+        int32_t lost = (int32_t)(dropped - l->dropped_reported);
+        int len = deflog_format(line, sizeof(line), LOG_DROPPED, 1, &lost);
+        if (hal_console_room() < output_size(line, len)) return 0;
+        printf("%s", line);
+        l->dropped_reported = dropped;
+    }
+
+    uint32_t t = atomic_load_explicit(&l->tail, memory_order_relaxed);
+    uint32_t h = atomic_load_explicit(&l->head, memory_order_acquire);
+
+    while (t != h && written < max_records) {
+        const LogRecord *r = &l->buf[t & (DEFLOG_CAPACITY - 1)];
+        int len = deflog_format(line, sizeof(line), (LogFmtId)r->fmt, r->nargs, r->args);
+
+        // Sem espaço na saída: o registro fica no anel para a próxima vez
+        if (hal_console_room() < output_size(line, len)) break;
+
+        printf("%s", line);
+        t++;
+        written++;
+        atomic_store_explicit(&l->tail, t, memory_order_release);
+    }
+    return written;
+}
+
+void deflog_idle(void *log, uint64_t deadline_us) {
+    DeferredLog *l = log;
+    while (hal_time_us() + DEFLOG_IDLE_MARGIN_US < deadline_us) {
+        if (deflog_drain(l, 1) == 0) break;
+    }
+}
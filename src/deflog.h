@@ -0,0 +1,181 @@
+#ifndef DEFLOG_H
+#define DEFLOG_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Log diferido.
+//
+// O laço de controle não formata nem transmite texto: só empilha um
+// registro compacto (id do formato + até DEFLOG_MAX_ARGS inteiros) em um
+// anel SPSC sem locks. A formatação e a escrita na USB acontecem depois,
+// em deflog_drain, fora do caminho crítico. Se o anel enche (host lento ou
+// desconectado) o registro é descartado e contado em vez de bloquear.
+//
+// Argumentos são int32: %d/%u/%x recebem o inteiro, %s recebe um LogStrId
+// e %f recebe os bits de um float (deflog_f32).
+
+#define DEFLOG_MAX_ARGS 6
+
+#ifndef DEFLOG_CAPACITY
+#define DEFLOG_CAPACITY 256         // potência de 2
+#endif
+
+// Tabela de formatos: X(id, formato)
+#define DEFLOG_FORMATS(X)                                                                          \
+    X(LOG_DISEMBARK,         "  >> DESEMBARQUE: %d passageiro(s) saiu/saíram no andar %d\n")       \
+    X(LOG_EMERGENCY,         "  [EMERGÊNCIA] Andar %d esperando %d ciclos - atendimento prioritário!\n") \
+    X(LOG_EMERGENCY_DEFER,   "  [EMERGÊNCIA DETECTADA] Mas há %d chamadas no caminho - atendendo caminho primeiro\n") \
+    X(LOG_PRIO_BUTTON,       "  [PRIORIDADE BOTÃO] Atendendo chamada manual no andar %d\n")        \
+    X(LOG_PRIO_INTERNAL,     "  [PRIORIDADE INTERNA] Atendendo destino interno: andar %d\n")       \
+    X(LOG_FORCED_DISEMBARK,  "  [DESEMBARQUE FORÇADO] Elevador lotado há %d ciclos - parando no andar %d\n") \
+    X(LOG_PROXIMITY,         "  [PROXIMIDADE] Chamada próxima detectada no andar %d\n")            \
+    X(LOG_SMARTSTOP,         "  [SmartStop] Parada eficiente calculada: andar %d\n")               \
+    X(LOG_FULL,              "  [LOTADO] Buscando desembarque - andar %d na direção\n")            \
+    X(LOG_FALLBACK_EMPTY,    "  [FALLBACK VAZIO] Elevador sem passageiros - indo atender andar %d\n") \
+    X(LOG_LOOKAHEAD,         "  [ANTECIPAÇÃO] Melhor sequência de paradas começa no andar %d\n")  \
+    X(LOG_BUTTON_A,          "\n🔵 [BOTÃO A] Passageiro solicitou andar %d (chamada interna)\n")   \
+    X(LOG_BUTTON_B,          "\n🟢 [BOTÃO B] Chamada HALL no andar %d (%d pessoa(s) esperando)\n") \
+    X(LOG_CONTINUE,          "\n→ Movimento contínuo (sem paradas eficientes detectadas)\n")       \
+    X(LOG_REVERSE_GROUND,    "  ↻ Invertendo direção no térreo\n")                                 \
+    X(LOG_REVERSE_TOP,       "  ↻ Invertendo direção no último andar\n")                           \
+    X(LOG_DECISION,          "\n🎯 DECISÃO: Parar no andar %d\n")                                  \
+    X(LOG_MOVING,            "  ├─ Deslocando: andar %d → %d")                                     \
+    X(LOG_SKIPPING,          " [ignorando chamada do andar %d]")                                   \
+    X(LOG_NEWLINE,           "\n")                                                                 \
+    X(LOG_ARRIVED,           "  └─ 🚪 PARADA no andar %d\n")                                       \
+    X(LOG_BOARDING,          "  >> EMBARQUE: Passageiros entraram no elevador\n")                  \
+    X(LOG_EMPTY_CALL,        "  >> Chamada vazia removida (sem passageiros)\n")                    \
+    X(LOG_CAR_FULL,          "  ⚠️  Elevador LOTADO - passageiros aguardam próximo elevador\n")     \
+    X(LOG_RETARGET,          "  ↪ Novo destino em viagem: andar %d no lugar do %d\n")              \
+    X(LOG_DOOR_REOPEN,       "  🚪 Reabrindo as portas: chamada nova no andar %d\n")               \
+    X(LOG_OCCUPANCY,         "  📊 Ocupação atual: %d/%d\n")                                       \
+    X(LOG_STATUS_TOP,        "\n┌─────────────────────────────────────────────────────────┐\n")    \
+    X(LOG_STATUS,            "│ Ciclo: %3u | Andar: %2d | Dir: %-7s | Ocupação: %d/%d %s│\n")      \
+    X(LOG_STATUS_BOTTOM,     "└─────────────────────────────────────────────────────────┘\n")      \
+    X(LOG_CALLS_HEADER,      "Chamadas ativas:\n")                                                 \
+    X(LOG_CALL,              "  • Andar %2d: %d pessoa(s) | Espera: %2d ciclos %s\n")              \
+    X(LOG_NO_CALLS,          "(Nenhuma chamada externa ativa)\n")                                  \
+    X(LOG_STATS_HEADER,      "\n--- Estatisticas aproximadas ---\n")                               \
+    X(LOG_STATS_CYCLES,      "Ciclos simulados:  %u\n")                                            \
+    X(LOG_STATS_STOPS,       "Paradas realizadas:%d\n")                                            \
+    X(LOG_STATS_SKIPPED,     "Paradas ignoradas: %d\n")                                            \
+    X(LOG_STATS_BOARDED,     "Passageiros embarcados (simulados): %d\n")                           \
+    X(LOG_STATS_SKIP_RATE,   "Taxa de paradas evitadas: %.1f %%\n")                                \
+    X(LOG_STATS_FOOTER,      "--------------------------------\n\n")                               \
+    X(LOG_CYCLE_SEPARATOR,   "\n════════════════════════════════════════════════════════════\n\n") \
+    X(LOG_LOOP_METER,        "\n[LAÇO] %u ciclos | trabalho por ciclo: mín %u / média %u / máx %u us | atraso máx. das pausas: %u us\n") \
+    X(LOG_BUTTON_LATENCY,    "[BOTÕES] %u pressão(ões) | até o registro: média %u / máx %u us | %u atendida(s): média %u / máx %u ms\n") \
+    X(LOG_PAX_DIST,          "[PASSAGEIROS] %s: %u | média %u ms | p50 %u s | p90 %u s | máx %u ms\n") \
+    X(LOG_LOOKAHEAD_STATS,   "[ANTECIPAÇÃO] %u pela busca | %u pela cascata | %u orçamento(s) estourado(s) | média %u / máx %u us\n") \
+    X(LOG_MOTION_STATS,      "[PRAZOS] %u decisão(ões) | %u por minuto | %u destino(s) trocado(s) em viagem | %u reabertura(s)\n") \
+    X(LOG_DROPPED,           "\n[LOG] %u mensagem(ns) descartada(s): link serial lento ou desconectado\n")
+
+// Strings usadas como argumento %s: X(id, texto)
+#define DEFLOG_STRINGS(X)            \
+    X(LOG_STR_EMPTY, "")             \
+    X(LOG_STR_UP, "Subindo")         \
+    X(LOG_STR_DOWN, "Descendo")      \
+    X(LOG_STR_FULL, "🔴")            \
+    X(LOG_STR_PAD, "  ")             \
+    X(LOG_STR_WARN, "⚠️")              \
+    X(LOG_STR_WAIT, "espera")        \
+    X(LOG_STR_JOURNEY, "viagem")
+
+#define DEFLOG_ENUM(id, text) id,
+
+typedef enum {
+    DEFLOG_FORMATS(DEFLOG_ENUM)
+    LOG_FMT_COUNT
+} LogFmtId;
+
+typedef enum {
+    DEFLOG_STRINGS(DEFLOG_ENUM)
+    LOG_STR_COUNT
+} LogStrId;
+
+typedef struct {
+    uint16_t fmt;               // LogFmtId
+    uint16_t nargs;
+    int32_t args[DEFLOG_MAX_ARGS];
+} LogRecord;
+
+// Anel SPSC: só o produtor escreve head e dropped, só o consumidor escreve
+// tail. Índices crescem livremente; a posição é índice & (capacidade - 1).
+typedef struct {
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    _Atomic uint32_t dropped;
+    uint32_t dropped_reported;  // consumidor
+    uint32_t high_water;        // maior ocupação vista pelo produtor
+    LogRecord buf[DEFLOG_CAPACITY];
+} DeferredLog;
+
+void deflog_init(DeferredLog *l);
+
+// Produtor: nunca bloqueia. Retorna false (e conta) se o anel estiver cheio.
+static inline bool deflog_push(DeferredLog *l, LogFmtId fmt, int nargs, const int32_t *args) {
+    uint32_t h = atomic_load_explicit(&l->head, memory_order_relaxed);
+    uint32_t t = atomic_load_explicit(&l->tail, memory_order_acquire);
+    uint32_t used = h - t;
+
+    if (used >= DEFLOG_CAPACITY) {
+        // load + store: o produtor é o único a escrever (o M0+ não tem RMW atômico)
+        uint32_t d = atomic_load_explicit(&l->dropped, memory_order_relaxed);
+        atomic_store_explicit(&l->dropped, d + 1, memory_order_relaxed);
+        return false;
+    }
+    if (used + 1 > l->high_water) l->high_water = used + 1;
+
+    if (nargs > DEFLOG_MAX_ARGS) nargs = DEFLOG_MAX_ARGS;
+
+    LogRecord *r = &l->buf[h & (DEFLOG_CAPACITY - 1)];
+    r->fmt = (uint16_t)fmt;
+    r->nargs = (uint16_t)nargs;
+    memcpy(r->args, args, sizeof(int32_t) * (size_t)nargs);
+    atomic_store_explicit(&l->head, h + 1, memory_order_release);
+    return true;
+}
+
+// Consumidor: formata e escreve até max_records registros, parando antes
+// se a saída não tiver espaço livre (hal_console_room). Retorna quantos
+// foram escritos. Informa descartes acumulados desde a última chamada.
+int deflog_drain(DeferredLog *l, int max_records);
+
+// Esvazia o anel até deadline_us (hal_time_us), deixando uma folga para a
+// última linha. Assinatura compatível com SimClockIdleFn: as pausas do
+// relógio da simulação viram tempo de transmissão.
+void deflog_idle(void *log, uint64_t deadline_us);
+
+// Registros ainda no anel
+static inline uint32_t deflog_pending(DeferredLog *l) {
+    return atomic_load_explicit(&l->head, memory_order_acquire) -
+           atomic_load_explicit(&l->tail, memory_order_relaxed);
+}
+
+// Formata um registro em buf (sempre terminado em '\0'). Retorna o tamanho.
+int deflog_format(char *buf, size_t size, LogFmtId fmt, int nargs, const int32_t *args);
+
+// Formata e imprime na hora (sem anel)
+void deflog_print(LogFmtId fmt, int nargs, const int32_t *args);
+
+// Argumento %f
+static inline int32_t deflog_f32(float f) {
+    int32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+// Uso: DEFLOG_PRINT(LOG_STATS_CYCLES, s->total_cycles)
+#define DEFLOG_PRINT(...)                                                         \
+    do {                                                                          \
+        const int32_t deflog_a_[] = { __VA_ARGS__ };                              \
+        deflog_print((LogFmtId)deflog_a_[0],                                      \
+                     (int)(sizeof(deflog_a_) / sizeof(deflog_a_[0])) - 1,         \
+                     deflog_a_ + 1);                                              \
+    } while (0)
+
+#endif
@@ -0,0 +1,676 @@
+/*
+ * Lógica de despacho do SmartStop (independente de plataforma)
+ *
+ * Extraída do laço principal do main.c para poder rodar tanto no
+ * Pico (tempo real) quanto no host Linux (tempo virtual acelerado).
+ * Todas as pausas passam pelo SimClock e o LED pela camada hal.
+ */
+
+#include "dispatch.h"
+#include "hal.h"
+#include "lookahead.h"
+#include "policy.h"
+#include "stageprof.h"
+
+static void set_yellow(void) {
+    hal_set_rgb(true, true, false);
+}
+
+static void set_cyan(void) {
+    hal_set_rgb(false, true, true);
+}
+
+void sim_init(SimContext *ctx, const BuildingConfig *cfg, SimClock *clock,
+              TrafficMode mode, uint64_t seed, bool verbose) {
+    ctx->cfg = *cfg;
+    call_registry_clear(&ctx->reg);
+    smartstop_init(&ctx->cfg, ctx->calls, &ctx->reg.active, &ctx->elevator, &ctx->stats);
+
+    ctx->wait_clock = 0;
+    call_order_init(&ctx->order, ctx->cfg.emergency_wait_time, 0);
+    floorset_clear(&ctx->fresh_calls);
+
+    ctx->cycles_at_full_capacity = 0;
+    ctx->total_cycles = 0;
+    ctx->mode = mode;
+    sim_rng_seed(&ctx->rng, seed);
+    ctx->clock = clock;
+    ctx->verbose = verbose;
+    ctx->log = NULL;
+    ctx->trace = NULL;
+    ctx->table = NULL;
+    ctx->traffic = NULL;
+    ctx->traffic_stalls = 0;
+    ctx->buttons = NULL;
+    latency_reset(&ctx->button_register);
+    latency_reset(&ctx->button_service);
+    for (int f = 0; f < MAX_FLOORS; f++) {
+        ctx->button_press_us[f] = 0;
+    }
+    ctx->pax = NULL;
+    ctx->source = NULL;
+    ctx->source_pending = false;
+    ctx->source_start_us = 0;
+    ctx->lookahead = NULL;
+    ctx->policy = NULL;
+    ctx->prof = NULL;
+}
+
+void sim_attach_passengers(SimContext *ctx, PassengerModel *m) {
+    passenger_model_init(m);
+    ctx->pax = m;
+}
+
+// Cria os passageiros de uma chamada recém-ativada (modelo individual).
+// A estimativa sorteada vira o número de pessoas na fila.
+static void spawn_call_passengers(SimContext *ctx, int floor) {
+    HallCall *call = &ctx->calls[floor];
+    if (passenger_waiting(ctx->pax, floor) > 0) return;
+
+    call->est_passengers = passenger_spawn(ctx->pax, &ctx->rng, ctx->cfg.num_floors, floor, -1,
+                                           call->est_passengers, sim_clock_now_us(ctx->clock));
+    if (call->est_passengers == 0) {
+        call->active = false;
+        floorset_reset(&ctx->reg.active, floor);
+    }
+}
+
+void sim_attach_source(SimContext *ctx, TrafficSource *src) {
+    ctx->source = src;
+    ctx->source_start_us = sim_clock_now_us(ctx->clock);
+    ctx->source_pending = traffic_source_next(src, &ctx->source_next);
+}
+
+int sim_add_arrival(SimContext *ctx, const TrafficArrival *a, uint64_t now_us) {
+    int floor = a->origin;
+    int people = a->group;
+
+    if (ctx->pax && people > 0) {
+        int dest = a->dest == TRAFFIC_DEST_ANY ? -1 : a->dest;
+        people = passenger_spawn(ctx->pax, &ctx->rng, ctx->cfg.num_floors, floor, dest,
+                                 people, now_us);
+    }
+    if (people <= 0) return 0;
+
+    // Chegada num andar com chamada ativa só aumenta o grupo esperando;
+    // a espera continua contando da primeira chegada
+    HallCall *call = &ctx->calls[floor];
+    if (!call->active) {
+        call_order_sync(&ctx->order, ctx->calls, &ctx->reg.active);
+        call->active = true;
+        call->floor = floor;
+        call->est_passengers = people;
+        call->arrival = ctx->wait_clock;
+        floorset_set(&ctx->reg.active, floor);
+        floorset_set(&ctx->fresh_calls, floor);
+    } else {
+        call->est_passengers += people;
+    }
+    return people;
+}
+
+// Tráfego do ciclo vindo da fonte: aplica as chegadas já alcançadas pelo
+// relógio
+static void apply_source_arrivals(SimContext *ctx) {
+    uint64_t now = sim_clock_now_us(ctx->clock);
+    while (ctx->source_pending && ctx->source_start_us + ctx->source_next.time_us <= now) {
+        sim_add_arrival(ctx, &ctx->source_next, now);
+        ctx->source_pending = traffic_source_next(ctx->source, &ctx->source_next);
+    }
+}
+
+void sim_traffic_stream(const SimContext *ctx, SimRng *out) {
+    *out = ctx->rng;
+    sim_rng_long_jump(out);
+}
+
+void sim_log_emit(const SimContext *ctx, LogFmtId fmt, int nargs, const int32_t *args) {
+    if (ctx->log) {
+        deflog_push(ctx->log, fmt, nargs, args);
+    } else {
+        deflog_print(fmt, nargs, args);
+    }
+}
+
+// Pausa do ciclo; ao acordar registra os botões pressionados durante ela
+static void sim_pause_ms(SimContext *ctx, uint32_t ms) {
+    PROF_SCOPE(ctx, PROF_SLEEP) {
+        sim_clock_sleep_ms(ctx->clock, ms);
+    }
+    if (ctx->buttons) {
+        sim_poll_buttons(ctx);
+    }
+}
+
+// Sorteia o desembarque no andar (sem LED nem pausa)
+int sim_disembark(SimContext *ctx, int floor, bool has_call) {
+    ElevatorState *elevator = &ctx->elevator;
+
+    // Modelo individual: desce quem tem destino neste andar
+    if (ctx->pax) {
+        int alighted = passenger_alight(ctx->pax, floor, sim_clock_now_us(ctx->clock));
+        floorset_reset(&ctx->reg.internal, floor);
+        elevator->occupancy -= alighted;
+        if (alighted > 0) {
+            SIM_LOG(ctx, LOG_DISEMBARK, alighted, floor);
+            SIM_TRACE(ctx, TRACE_EV_DISEMBARK, floor, 0, alighted, 0);
+        }
+        return alighted;
+    }
+
+    if (elevator->occupancy <= 2) return 0;
+
+    // Chance de alguém descer neste andar
+    bool someone_exits = false;
+
+    // Térreo e último andar têm maior probabilidade de desembarque
+    int exit_probability = 35; // 35% base
+    if (floor == 0 || floor == (ctx->cfg.num_floors - 1)) {
+        exit_probability = 70; // 70% nos extremos
+    }
+
+    // Se há chamada externa no andar, aumenta probabilidade (pessoas chegando = pessoas saindo)
+    if (has_call) {
+        exit_probability += 25; // Aumenta 25% se há chamada no andar
+    }
+
+    // Se há chamada interna para este andar, garantido desembarque
+    if (floorset_test(&ctx->reg.internal, floor)) {
+        someone_exits = true;
+        floorset_reset(&ctx->reg.internal, floor);
+    } else {
+        someone_exits = sim_rng_below(&ctx->rng, 100) < exit_probability;
+    }
+
+    if (someone_exits) {
+        int disembark_count = MIN_DISEMBARK_PASSENGERS +
+                             sim_rng_below(&ctx->rng, MAX_DISEMBARK_PASSENGERS - MIN_DISEMBARK_PASSENGERS + 1);
+
+        // Não pode desembarcar mais que a ocupação atual
+        if (disembark_count > elevator->occupancy) {
+            disembark_count = elevator->occupancy;
+        }
+
+        elevator->occupancy -= disembark_count;
+
+        SIM_LOG(ctx, LOG_DISEMBARK, disembark_count, floor);
+        SIM_TRACE(ctx, TRACE_EV_DISEMBARK, floor, 0, disembark_count, 0);
+        return disembark_count;
+    }
+    return 0;
+}
+
+int sim_board(SimContext *ctx, int floor) {
+    if (!ctx->pax) {
+        int boarded_before = ctx->stats.total_boarded;
+        smartstop_handle_stop(&ctx->cfg, ctx->calls, &ctx->reg.active, &ctx->elevator,
+                              &ctx->stats, floor);
+        return ctx->stats.total_boarded - boarded_before;
+    }
+
+    // Modelo individual: embarca pela ordem de chegada; quem não coube
+    // continua esperando com a chamada ativa
+    ElevatorState *elevator = &ctx->elevator;
+    HallCall *call = &ctx->calls[floor];
+    int room = ctx->cfg.car_capacity - elevator->occupancy;
+    int boarded = passenger_board(ctx->pax, floor, room > 0 ? room : 0,
+                                  sim_clock_now_us(ctx->clock), &ctx->reg.internal);
+
+    elevator->occupancy += boarded;
+    ctx->stats.total_boarded += boarded;
+    ctx->stats.total_stops++;
+
+    call->est_passengers = passenger_waiting(ctx->pax, floor);
+    if (call->est_passengers == 0) {
+        call->active = false;
+        floorset_reset(&ctx->reg.active, floor);
+    }
+    return boarded;
+}
+
+// Simula desembarque realista de passageiros
+static void simulate_disembark(SimContext *ctx, int floor, bool has_call) {
+    if (sim_disembark(ctx, floor, has_call) > 0) {
+        // LED ciano para desembarque
+        set_cyan();
+        sim_pause_ms(ctx, 300);
+        hal_set_rgb(false, false, false);
+    }
+}
+
+// Encontra chamadas em emergência (esperando muito tempo)
+// IGNORA chamadas sem passageiros (est_passengers == 0)
+int find_emergency_call(const BuildingConfig *cfg,
+                        const HallCall calls[], const FloorSet *active, uint32_t now) {
+    int worst_floor = -1;
+    int worst_wait = 0;
+
+    FLOORSET_FOREACH(active, i) {
+        int wait = hall_call_wait(&calls[i], now);
+        if (calls[i].est_passengers > 0 && wait > worst_wait) {
+            worst_wait = wait;
+            worst_floor = i;
+        }
+    }
+
+    if (worst_wait >= cfg->emergency_wait_time) {
+        return worst_floor;
+    }
+
+    return -1;
+}
+
+int sim_emergency_call(const SimContext *ctx) {
+    return call_order_emergency(&ctx->order, ctx->calls);
+}
+
+void sim_set_wait_clock(SimContext *ctx, uint32_t now) {
+    ctx->wait_clock = now;
+    call_order_sync(&ctx->order, ctx->calls, &ctx->reg.active);
+    call_order_advance(&ctx->order, now);
+}
+
+void sim_restamp_call(SimContext *ctx, int floor, uint32_t arrival) {
+    ctx->calls[floor].arrival = arrival;
+    call_order_restamp(&ctx->order, floor, arrival);
+}
+
+// Um ciclo de espera para as chamadas ativas, menos a do andar do carro
+// (ela não envelhece: a chegada anda junto com o relógio)
+static void sim_age_calls(SimContext *ctx) {
+    sim_set_wait_clock(ctx, ctx->wait_clock + 1);
+    const int cur = ctx->elevator.current_floor;
+    if (floorset_test(&ctx->reg.active, cur)) {
+        sim_restamp_call(ctx, cur, ctx->calls[cur].arrival + 1);
+    }
+}
+
+// Escolhe o próximo andar com base em prioridades realistas: a cascata
+// padrão de estágios (policy.c)
+int choose_next_floor_realistic(SimContext *ctx, DispatchPriority *priority) {
+    DispatchPriority unused;
+    if (!priority) priority = &unused;
+    return dispatch_cascade_decide(ctx, priority);
+}
+
+int sim_choose_next_floor(SimContext *ctx, DispatchPriority *priority) {
+    if (ctx->policy) {
+        return dispatch_policy_decide(ctx->policy, ctx, priority);
+    }
+    if (ctx->lookahead) {
+        int floor = lookahead_decide(ctx->lookahead, ctx);
+        if (floor != -1) {
+            SIM_LOG(ctx, LOG_LOOKAHEAD, floor);
+            *priority = PRIORITY_LOOKAHEAD;
+            return floor;
+        }
+    }
+    return choose_next_floor_realistic(ctx, priority);
+}
+
+const char *dispatch_priority_name(DispatchPriority priority) {
+    switch (priority) {
+        case PRIORITY_EMERGENCY:        return "EMERGENCIA";
+        case PRIORITY_BUTTON:           return "BOTAO";
+        case PRIORITY_INTERNAL:         return "INTERNA";
+        case PRIORITY_FORCED_DISEMBARK: return "DESEMBARQUE_FORCADO";
+        case PRIORITY_PROXIMITY:        return "PROXIMIDADE";
+        case PRIORITY_SMARTSTOP:        return "SMARTSTOP";
+        case PRIORITY_FULL:             return "LOTADO";
+        case PRIORITY_FALLBACK_EMPTY:   return "FALLBACK_VAZIO";
+        case PRIORITY_NONE:             return "MOVIMENTO_CONTINUO";
+        case PRIORITY_LOOKAHEAD:        return "ANTECIPACAO";
+        default:                        return "?";
+    }
+}
+
+// Remove chamadas "vazias": ativas mas com 0 passageiros
+void cleanup_empty_calls(HallCall calls[], FloorSet *active, const FloorSet *candidates) {
+    FLOORSET_FOREACH(candidates, i) {
+        if (floorset_test(active, i) && calls[i].est_passengers <= 0) {
+            calls[i].active = false;
+            calls[i].est_passengers = 0;
+            floorset_reset(active, i);
+        }
+    }
+}
+
+int sim_press_internal_button(SimContext *ctx) {
+    int n = ctx->cfg.num_floors;
+    int dest = sim_rng_below(&ctx->rng, n);
+    if (dest == ctx->elevator.current_floor) {
+        dest = (dest + 1) % n;
+    }
+    floorset_set(&ctx->reg.internal, dest);
+    floorset_set(&ctx->reg.button, dest);     // 🔴 marca como chamada vinda do botão A
+    SIM_LOG(ctx, LOG_BUTTON_A, dest);
+    return dest;
+}
+
+int sim_press_external_button(SimContext *ctx) {
+    HallCall *calls = ctx->calls;
+    int floor = sim_rng_below(&ctx->rng, ctx->cfg.num_floors);
+    if (calls[floor].active) {
+        return -1;
+    }
+    call_order_sync(&ctx->order, calls, &ctx->reg.active);
+    calls[floor].active = true;
+    calls[floor].floor = floor;
+    calls[floor].est_passengers = estimate_passengers(&ctx->rng, ctx->mode);
+    calls[floor].arrival = ctx->wait_clock;
+    floorset_set(&ctx->reg.active, floor);
+    floorset_set(&ctx->fresh_calls, floor);
+    floorset_set(&ctx->reg.button, floor);    // 🔴 marca como chamada vinda do botão B
+    if (ctx->pax) {
+        spawn_call_passengers(ctx, floor);
+    }
+    SIM_LOG(ctx, LOG_BUTTON_B, floor, calls[floor].est_passengers);
+    return floor;
+}
+
+void sim_poll_buttons(SimContext *ctx) {
+    ButtonEvent ev;
+    PROF_SCOPE(ctx, PROF_BUTTONS) {
+        while (button_queue_pop(ctx->buttons, &ev)) {
+            int floor = ev.button == BUTTON_ID_A ? sim_press_internal_button(ctx)
+                                                 : sim_press_external_button(ctx);
+            uint64_t now = hal_time_us();
+            latency_add(&ctx->button_register, now - ev.press_us);
+
+            // Guarda a pressão mais antiga ainda não atendida no andar
+            if (floor >= 0 && ctx->button_press_us[floor] == 0) {
+                ctx->button_press_us[floor] = ev.press_us;
+            }
+        }
+    }
+}
+
+// Movimento contínuo: nenhum andar escolhido neste ciclo
+static void continue_moving(SimContext *ctx) {
+    ElevatorState *elevator = &ctx->elevator;
+
+    SIM_LOG(ctx, LOG_CONTINUE);
+
+    // Simula desembarque probabilístico durante movimento (só no modelo
+    // anônimo: passageiros individuais descem no destino)
+    if (elevator->occupancy > 0 && !ctx->pax && sim_rng_below(&ctx->rng, 100) < 15) {
+        simulate_disembark(ctx, elevator->current_floor, false);
+    }
+
+    elevator->current_floor += elevator->direction;
+
+    if (elevator->current_floor <= 0) {
+        elevator->current_floor = 0;
+        elevator->direction = 1;
+        SIM_LOG(ctx, LOG_REVERSE_GROUND);
+    } else if (elevator->current_floor >= (ctx->cfg.num_floors - 1)) {
+        elevator->current_floor = ctx->cfg.num_floors - 1;
+        elevator->direction = -1;
+        SIM_LOG(ctx, LOG_REVERSE_TOP);
+    }
+
+    set_yellow();
+    sim_pause_ms(ctx, 150);
+    hal_set_rgb(false, false, false);
+}
+
+void sim_serve_stop(SimContext *ctx, int floor) {
+    const BuildingConfig *cfg = &ctx->cfg;
+    HallCall *calls = ctx->calls;
+    ElevatorState *elevator = &ctx->elevator;
+
+    // EMBARQUE (só se houver chamada externa e espaço)
+    if (calls[floor].active && elevator->occupancy < cfg->car_capacity) {
+        // Só embarca se realmente tem pessoas esperando
+        if (calls[floor].est_passengers > 0) {
+            int boarded = sim_board(ctx, floor);
+            SIM_LOG(ctx, LOG_BOARDING);
+            SIM_TRACE(ctx, TRACE_EV_BOARD, floor, 0, boarded, calls[floor].est_passengers);
+        } else {
+            // Chamada vazia, apenas remove
+            calls[floor].active = false;
+            floorset_reset(&ctx->reg.active, floor);
+            SIM_LOG(ctx, LOG_EMPTY_CALL);
+        }
+    } else if (calls[floor].active && elevator->occupancy >= cfg->car_capacity) {
+        SIM_LOG(ctx, LOG_CAR_FULL);
+        // Chamada permanece ativa
+    } else if (calls[floor].active && calls[floor].est_passengers == 0) {
+        // Remove chamadas vazias mesmo sem embarque
+        calls[floor].active = false;
+        floorset_reset(&ctx->reg.active, floor);
+        SIM_LOG(ctx, LOG_EMPTY_CALL);
+    }
+
+    // 🔴 LIMPA flags de botão para esse andar, pois já foi atendido
+    floorset_reset(&ctx->reg.button, floor);
+    if (ctx->button_press_us[floor] != 0) {
+        latency_add(&ctx->button_service, hal_time_us() - ctx->button_press_us[floor]);
+        ctx->button_press_us[floor] = 0;
+    }
+
+    SIM_LOG(ctx, LOG_OCCUPANCY, elevator->occupancy, cfg->car_capacity);
+}
+
+// Desloca o elevador até target_floor e faz desembarque/embarque
+static void travel_and_stop(SimContext *ctx, int target_floor) {
+    const BuildingConfig *cfg = &ctx->cfg;
+    HallCall *calls = ctx->calls;
+    ElevatorState *elevator = &ctx->elevator;
+
+    SIM_LOG(ctx, LOG_DECISION, target_floor);
+
+    // Ajuste inteligente de direção baseado no destino
+    if (target_floor > elevator->current_floor) {
+        elevator->direction = 1;   // Sobe diretamente ao destino
+    } else if (target_floor < elevator->current_floor) {
+        elevator->direction = -1;  // Desce diretamente ao destino
+    }
+
+    // Movimento andar por andar
+    while (elevator->current_floor != target_floor) {
+        int prev_floor = elevator->current_floor;
+        elevator->current_floor += elevator->direction;
+
+        SIM_LOG(ctx, LOG_MOVING, prev_floor, elevator->current_floor);
+
+        // Verifica passagem por chamadas ativas (um teste de bit por andar)
+        bool skipped = false;
+        int f = elevator->current_floor;
+        if (f != target_floor && floorset_test(&ctx->reg.active, f) &&
+            calls[f].est_passengers > 0) {
+            SIM_LOG(ctx, LOG_SKIPPING, f);
+            SIM_TRACE(ctx, TRACE_EV_SKIP, f, 0, calls[f].est_passengers, 0);
+            ctx->stats.skipped_stops++;
+            skipped = true;
+        }
+        SIM_LOG(ctx, LOG_NEWLINE);
+
+        if (skipped) {
+            set_yellow();
+            sim_pause_ms(ctx, 100);
+            hal_set_rgb(false, false, false);
+        }
+
+        // Inverte nos extremos
+        if (elevator->current_floor <= 0) {
+            elevator->current_floor = 0;
+            elevator->direction = 1;
+        } else if (elevator->current_floor >= (cfg->num_floors - 1)) {
+            elevator->current_floor = (cfg->num_floors - 1);
+            elevator->direction = -1;
+        }
+
+        sim_pause_ms(ctx, cfg->travel_time_ms);
+    }
+
+    // CHEGOU NO ANDAR
+    SIM_LOG(ctx, LOG_ARRIVED, target_floor);
+
+    // LED verde
+    hal_set_rgb(false, true, false);
+    sim_pause_ms(ctx, cfg->door_time_ms / 2);
+
+    // 1º: SEMPRE tenta desembarcar (prioridade máxima!)
+    if (elevator->occupancy > 0) {
+        simulate_disembark(ctx, target_floor, calls[target_floor].active);
+    }
+
+    // 2º: EMBARQUE
+    sim_serve_stop(ctx, target_floor);
+
+    if (elevator->occupancy >= cfg->car_capacity) {
+        hal_set_rgb(true, false, false);
+        sim_pause_ms(ctx, 300);
+    }
+
+    sim_pause_ms(ctx, cfg->door_time_ms / 2);
+    hal_set_rgb(false, false, false);
+}
+
+static void print_status(const SimContext *ctx) {
+    const HallCall *calls = ctx->calls;
+    const ElevatorState *elevator = &ctx->elevator;
+
+    // Interface de status
+    SIM_LOG(ctx, LOG_STATUS_TOP);
+    // Os argumentos do log são de 32 bits: o número no cabeçalho volta a
+    // zero depois de 2^32 ciclos (o traço e a tabela guardam o contador todo)
+    SIM_LOG(ctx, LOG_STATUS,
+            (int32_t)ctx->total_cycles,
+            elevator->current_floor,
+            elevator->direction == 1 ? LOG_STR_UP : LOG_STR_DOWN,
+            elevator->occupancy,
+            ctx->cfg.car_capacity,
+            elevator->occupancy >= ctx->cfg.car_capacity ? LOG_STR_FULL : LOG_STR_PAD);
+    SIM_LOG(ctx, LOG_STATUS_BOTTOM);
+
+    // Lista chamadas ativas
+    bool has_calls = false;
+    FLOORSET_FOREACH(&ctx->reg.active, i) {
+        if (calls[i].est_passengers > 0) {
+            if (!has_calls) {
+                SIM_LOG(ctx, LOG_CALLS_HEADER);
+                has_calls = true;
+            }
+            int wait = sim_call_wait(ctx, i);
+            SIM_LOG(ctx, LOG_CALL,
+                    i, calls[i].est_passengers, wait,
+                    wait >= ctx->cfg.emergency_wait_time ? LOG_STR_WARN : LOG_STR_EMPTY);
+        }
+    }
+
+    if (!has_calls) {
+        SIM_LOG(ctx, LOG_NO_CALLS);
+    }
+}
+
+static void log_stats(const SimContext *ctx) {
+    const Stats *s = &ctx->stats;
+
+    SIM_LOG(ctx, LOG_STATS_HEADER);
+    SIM_LOG(ctx, LOG_STATS_CYCLES, (int32_t)s->total_cycles);
+    SIM_LOG(ctx, LOG_STATS_STOPS, s->total_stops);
+    SIM_LOG(ctx, LOG_STATS_SKIPPED, s->skipped_stops);
+    SIM_LOG(ctx, LOG_STATS_BOARDED, s->total_boarded);
+    if (s->total_stops + s->skipped_stops > 0) {
+        SIM_LOG(ctx, LOG_STATS_SKIP_RATE, deflog_f32(stats_skip_rate(s)));
+    }
+    SIM_LOG(ctx, LOG_STATS_FOOTER);
+}
+
+void sim_begin_cycle(SimContext *ctx) {
+    ctx->total_cycles++;
+
+    if (ctx->buttons) {
+        sim_poll_buttons(ctx);
+    }
+
+    PROF_SCOPE(ctx, PROF_TRAFFIC) {
+        sim_age_calls(ctx);
+
+        // Gera tráfego aleatório (ou aplica o lote já sorteado pelo gerador,
+        // ou as chegadas do perfil/traço)
+        FloorSet before = ctx->reg.active;
+        if (ctx->source) {
+            apply_source_arrivals(ctx);
+        } else if (ctx->traffic) {
+            const TrafficBatch *batch = traffic_queue_front(ctx->traffic);
+            if (!batch) {
+                ctx->traffic_stalls++;
+                // gerador atrasado: o próximo lote é determinístico, então espera
+                while ((batch = traffic_queue_front(ctx->traffic)) == NULL) {
+                    hal_cpu_relax();
+                }
+            }
+            traffic_apply_batch(&ctx->cfg, batch, ctx->calls, &ctx->reg.active, &ctx->elevator,
+                                ctx->wait_clock);
+            traffic_queue_pop(ctx->traffic);
+        } else {
+            generate_random_hall_calls(&ctx->cfg, &ctx->rng, ctx->calls, &ctx->reg.active,
+                                       &ctx->elevator, ctx->mode, ctx->wait_clock);
+        }
+        FloorSet added;
+        floorset_minus(&added, &ctx->reg.active, &before);
+        floorset_or(&ctx->fresh_calls, &added);
+
+        // Limpa chamadas vazias antes de decidir o próximo andar: as que
+        // vieram de ciclos anteriores já passaram pela limpeza
+        cleanup_empty_calls(ctx->calls, &ctx->reg.active, &ctx->fresh_calls);
+
+        // Chamadas novas ganham passageiros com destino
+        if (ctx->pax) {
+            FLOORSET_FOREACH(&ctx->fresh_calls, i) {
+                if (floorset_test(&ctx->reg.active, i)) spawn_call_passengers(ctx, i);
+            }
+        }
+        floorset_clear(&ctx->fresh_calls);
+        call_order_sync(&ctx->order, ctx->calls, &ctx->reg.active);
+    }
+
+    if (ctx->verbose) {
+        PROF_SCOPE(ctx, PROF_CONSOLE) {
+            print_status(ctx);
+        }
+    }
+    SIM_TRACE(ctx, TRACE_EV_CYCLE, ctx->elevator.current_floor, ctx->elevator.direction,
+              floorset_count(&ctx->reg.active), ctx->cycles_at_full_capacity);
+
+    if (ctx->elevator.occupancy >= ctx->cfg.car_capacity) {
+        ctx->cycles_at_full_capacity++;
+    } else {
+        ctx->cycles_at_full_capacity = 0;
+    }
+}
+
+void sim_step(SimContext *ctx) {
+    PROF_BEGIN(ctx);
+    hal_set_rgb(false, false, false);
+    sim_begin_cycle(ctx);
+
+    // Decide próxima parada
+    DispatchPriority priority = PRIORITY_NONE;
+    int target_floor = -1;
+    PROF_SCOPE(ctx, PROF_DECISION) {
+        target_floor = sim_choose_next_floor(ctx, &priority);
+    }
+    SIM_TRACE(ctx, TRACE_EV_DECISION, ctx->elevator.current_floor, priority, target_floor, 0);
+
+    PROF_SCOPE(ctx, PROF_MOVE) {
+        if (target_floor == -1) {
+            continue_moving(ctx);
+        } else {
+            travel_and_stop(ctx, target_floor);
+        }
+    }
+
+    if (ctx->verbose) {
+        PROF_SCOPE(ctx, PROF_CONSOLE) {
+            log_stats(ctx);
+            SIM_LOG(ctx, LOG_CYCLE_SEPARATOR);
+        }
+    }
+
+    sim_pause_ms(ctx, CYCLE_PAUSE_MS);
+    PROF_END(ctx);
+}
@@ -0,0 +1,232 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "smartstop.h"
+#include "callorder.h"
+#include "sim_clock.h"
+#include "sim_rng.h"
+#include "trace.h"
+#include "cycle_table.h"
+#include "deflog.h"
+#include "traffic_queue.h"
+#include "button_queue.h"
+#include "passenger.h"
+#include "traffic_source.h"
+
+// Constantes realistas (tempos e limites do prédio ficam em BuildingConfig)
+#define MIN_DISEMBARK_PASSENGERS 1 // Mínimo que desembarca por parada
+#define MAX_DISEMBARK_PASSENGERS 4 // Máximo que desembarca por parada
+#define CYCLE_PAUSE_MS 800         // Pausa no fim de cada ciclo (ms)
+
+// Regra que decidiu o próximo andar (as PRIORIDADES 0..7 de
+// choose_next_floor_realistic). Vai no traço binário (TRACE_EV_DECISION).
+typedef enum {
+    PRIORITY_EMERGENCY = 0,      // chamada esperando demais
+    PRIORITY_BUTTON,             // botões A/B
+    PRIORITY_INTERNAL,           // destino de passageiro a bordo
+    PRIORITY_FORCED_DISEMBARK,   // lotado há cycles_full_max ciclos
+    PRIORITY_PROXIMITY,          // chamada a até 2 andares na direção
+    PRIORITY_SMARTSTOP,          // eficiência acima do limiar
+    PRIORITY_FULL,               // lotado: próxima chamada na direção
+    PRIORITY_FALLBACK_EMPTY,     // vazio: chamada mais próxima
+    PRIORITY_NONE,               // movimento contínuo
+    PRIORITY_LOOKAHEAD           // busca de sequências (lookahead.h)
+} DispatchPriority;
+
+typedef struct Lookahead Lookahead;
+typedef struct DispatchPolicy DispatchPolicy;
+typedef struct StageProfiler StageProfiler;
+
+// Estado completo de uma simulação (antes espalhado em globais do main.c)
+typedef struct {
+    BuildingConfig cfg;              // cópia da configuração do prédio
+    HallCall calls[MAX_FLOORS];
+    ElevatorState elevator;
+    Stats stats;
+
+    // Chamadas ativas, destinos internos e andares pedidos pelos botões A/B
+    // em bitmasks (ver callset.h)
+    CallRegistry reg;
+
+    // Relógio de espera (um tique por ciclo; HallCall.arrival conta nele),
+    // chamadas ativas em ordem de chegada e as ativadas desde a última
+    // limpeza (só elas podem estar vazias ou sem passageiros criados)
+    uint32_t wait_clock;
+    CallOrder order;
+    FloorSet fresh_calls;
+
+    int cycles_at_full_capacity;
+    int64_t total_cycles;
+
+    TrafficMode mode;
+    SimRng rng;          // gerador próprio: mesma semente => mesmo traço
+    SimClock *clock;
+    bool verbose;        // false = sem log (modo rápido no host)
+    DeferredLog *log;    // log diferido (NULL = formata e imprime na hora)
+    TraceWriter *trace;  // traço binário opcional (NULL = desligado)
+    CycleTable *table;   // tabela colunar por ciclo (NULL = desligada)
+
+    // Tráfego gerado fora do laço (núcleo 1 / thread). NULL = gera aqui
+    // mesmo, com ctx->rng.
+    TrafficQueue *traffic;
+    uint32_t traffic_stalls;         // ciclos que esperaram o gerador
+
+    // Botões físicos capturados por interrupção (NULL = sem botões).
+    // Latências em tempo real (hal_time_us), a partir da borda do botão.
+    ButtonQueue *buttons;
+    LatencyStat button_register;     // pressão -> registro da chamada
+    LatencyStat button_service;      // pressão -> parada no andar
+    uint64_t button_press_us[MAX_FLOORS];  // pressão pendente por andar (0 = nenhuma)
+
+    // Passageiros individuais (NULL = só a contagem anônima de HallCall).
+    // Com o modelo ligado, est_passengers é o tamanho da fila do andar e
+    // reg.internal são os destinos de quem está a bordo.
+    PassengerModel *pax;
+
+    // Chegadas de um perfil ou traço gravado (NULL = sorteio por TrafficMode).
+    // A próxima chegada fica lida em source_next até o relógio alcançá-la.
+    TrafficSource *source;
+    TrafficArrival source_next;
+    bool source_pending;             // false = fonte esgotada
+    uint64_t source_start_us;        // instante do relógio que vale t = 0 na fonte
+
+    // Despacho com antecipação (NULL = só a cascata de prioridades)
+    Lookahead *lookahead;
+
+    // Política de estágios (policy.h) no lugar da busca e da cascata
+    // (NULL = lookahead, se houver, seguida de choose_next_floor_realistic)
+    DispatchPolicy *policy;
+
+    // Tempo por estágio de sim_step (stageprof.h; só com SMARTSTOP_PROFILE,
+    // NULL = desligado)
+    StageProfiler *prof;
+} SimContext;
+
+// Log condicional: só registra quando a simulação está em modo verboso.
+// Uso: SIM_LOG(ctx, LOG_DECISION, target_floor) com um formato de deflog.h
+// e argumentos inteiros (LogStrId para %s).
+#define SIM_LOG(ctx, ...)                                                       \
+    do {                                                                        \
+        if ((ctx)->verbose) {                                                   \
+            const int32_t sim_log_a_[] = { __VA_ARGS__ };                       \
+            sim_log_emit((ctx), (LogFmtId)sim_log_a_[0],                        \
+                         (int)(sizeof(sim_log_a_) / sizeof(sim_log_a_[0])) - 1, \
+                         sim_log_a_ + 1);                                       \
+        }                                                                       \
+    } while (0)
+
+// Evento no traço binário e na tabela por ciclo, se houver um anexado
+#define SIM_TRACE(ctx, type, floor, aux, value, extra)                        \
+    do {                                                                      \
+        if ((ctx)->trace)                                                     \
+            trace_emit((ctx)->trace, (uint32_t)(ctx)->total_cycles,           \
+                       sim_clock_now_us((ctx)->clock), (type), (floor),       \
+                       (ctx)->elevator.occupancy, (aux), (value), (extra));   \
+        if ((ctx)->table)                                                     \
+            cycle_table_event((ctx)->table, (ctx)->total_cycles,              \
+                              (type), (floor), (ctx)->elevator.occupancy,     \
+                              (aux), (value));                                \
+    } while (0)
+
+// Inicializa chamadas, elevador, estatísticas e flags para o prédio cfg,
+// com o gerador pseudoaleatório semeado por seed
+void sim_init(SimContext *ctx, const BuildingConfig *cfg, SimClock *clock,
+              TrafficMode mode, uint64_t seed, bool verbose);
+
+// Fluxo do gerador de tráfego externo: o gerador de ctx->rng avançado
+// 2^96 passos (salto longo), independente dos sorteios que ficam no laço e
+// dos fluxos de réplica do ensemble (semente + k saltos de 2^64)
+void sim_traffic_stream(const SimContext *ctx, SimRng *out);
+
+// Envia um registro ao log diferido, ou imprime na hora se não houver um
+void sim_log_emit(const SimContext *ctx, LogFmtId fmt, int nargs, const int32_t *args);
+
+// Botão A: chamada interna para destino aleatório diferente do andar atual.
+// Retorna o andar registrado.
+int sim_press_internal_button(SimContext *ctx);
+
+// Botão B: chamada externa (hall call) em andar aleatório. Retorna o andar
+// registrado, ou -1 se já havia chamada ativa nele.
+int sim_press_external_button(SimContext *ctx);
+
+// Registra as pressões pendentes em ctx->buttons. Chamada a cada pausa do
+// ciclo, inclusive entre andares durante a viagem.
+void sim_poll_buttons(SimContext *ctx);
+
+// Liga o modelo de passageiros (antes do primeiro ciclo)
+void sim_attach_passengers(SimContext *ctx, PassengerModel *m);
+
+// Troca o sorteio de generate_random_hall_calls pela fonte src (antes do
+// primeiro ciclo). Os instantes da fonte contam a partir de agora.
+void sim_attach_source(SimContext *ctx, TrafficSource *src);
+
+// Aplica uma chegada no andar de origem: ativa a chamada ou aumenta o grupo
+// esperando; no modelo individual cria os passageiros com o destino da
+// chegada. Retorna quantas pessoas entraram (0 com o pool cheio).
+int sim_add_arrival(SimContext *ctx, const TrafficArrival *a, uint64_t now_us);
+
+// Desembarque no andar (ocupação, destino interno, log e traço), sem LED nem
+// pausa: sorteado no modelo anônimo, pelo destino de cada passageiro no
+// modelo individual. Retorna quantos desceram.
+int sim_disembark(SimContext *ctx, int floor, bool has_call);
+
+// Embarque no andar atual até a capacidade (conta a parada). Retorna quantos
+// embarcaram.
+int sim_board(SimContext *ctx, int floor);
+
+// Embarque no andar de parada depois do desembarque: chamada atendida,
+// vazia ou deixada para depois com o carro lotado, botão do andar atendido
+// e ocupação no log
+void sim_serve_stop(SimContext *ctx, int floor);
+
+// Início de ciclo de sim_step: conta o ciclo, registra os botões, envelhece
+// as chamadas, aplica o tráfego e mostra o status. O controle por prazos
+// (motion.h) chama a cada tique.
+void sim_begin_cycle(SimContext *ctx);
+
+// Executa um ciclo completo: tráfego, decisão, deslocamento, embarque
+void sim_step(SimContext *ctx);
+
+// Leva o relógio de espera a now e atualiza a ordem de chegada (chamadas
+// que entraram ou saíram, emergências). sim_step faz isso a cada ciclo; o
+// motor de eventos, antes de cada decisão.
+void sim_set_wait_clock(SimContext *ctx, uint32_t now);
+
+// Espera da chamada do andar no relógio de espera do contexto
+static inline int sim_call_wait(const SimContext *ctx, int floor) {
+    return hall_call_wait(&ctx->calls[floor], ctx->wait_clock);
+}
+
+// A chegada da chamada ativa do andar mudou (fila reduzida aos que não
+// couberam, por exemplo)
+void sim_restamp_call(SimContext *ctx, int floor, uint32_t arrival);
+
+// find_emergency_call pela ordem de chegada, sem varrer as chamadas (vale
+// depois da fase de tráfego de sim_step ou de sim_set_wait_clock)
+int sim_emergency_call(const SimContext *ctx);
+
+// Escolhe o próximo andar com base em prioridades realistas
+// Retorna -1 se o elevador deve seguir em movimento contínuo; a regra que
+// decidiu vai em *priority (pode ser NULL)
+int choose_next_floor_realistic(SimContext *ctx, DispatchPriority *priority);
+
+// Próximo andar pela política anexada; sem ela, pela busca com antecipação,
+// se houver uma, ou pela cascata de prioridades (quando a busca não responde)
+int sim_choose_next_floor(SimContext *ctx, DispatchPriority *priority);
+
+// Encontra chamadas em emergência (esperando muito tempo), varrendo as
+// chamadas ativas
+int find_emergency_call(const BuildingConfig *cfg,
+                        const HallCall calls[], const FloorSet *active, uint32_t now);
+
+// Nome curto da prioridade (relatórios e leitor do traço)
+const char *dispatch_priority_name(DispatchPriority priority);
+
+// Remove chamadas "vazias": ativas mas com 0 passageiros, entre as de
+// candidates (active inteiro, ou só as ativadas desde a última limpeza)
+void cleanup_empty_calls(HallCall calls[], FloorSet *active, const FloorSet *candidates);
+
+#endif
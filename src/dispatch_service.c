@@ -0,0 +1,165 @@
+/*
+ * Despacho como serviço: aplica lotes de eventos a uma sessão e responde
+ * com a decisão (ver dispatch_service.h)
+ */
+
+#include "dispatch_service.h"
+#include "hal.h"
+
+#include <string.h>
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+void svc_encode_event(uint8_t out[SVC_FRAME_BYTES], SvcEventType type, int floor, int value,
+                      unsigned flags, uint32_t seq) {
+    out[0] = (uint8_t)type;
+    out[1] = (uint8_t)floor;
+    out[2] = (uint8_t)value;
+    out[3] = (uint8_t)flags;
+    put_u32(out + 4, seq);
+}
+
+void svc_session_init(SvcSession *s, const BuildingConfig *cfg, SvcDecider decider) {
+    sim_clock_init(&s->clock, SIM_CLOCK_FAST, 1.0f);
+    sim_init(&s->sim, cfg, &s->clock, TRAFFIC_MEDIUM, 1, false);
+    s->decider = decider;
+    loghist_reset(&s->latency);
+    s->batches = 0;
+    s->events = 0;
+}
+
+// Carro parado no andar com as portas abertas: a chamada e o destino do
+// andar estão atendidos
+static void serve_floor(SimContext *ctx, int floor) {
+    HallCall *call = &ctx->calls[floor];
+    if (call->active) {
+        call_order_sync(&ctx->order, ctx->calls, &ctx->reg.active);
+        call->active = false;
+        call->est_passengers = 0;
+        floorset_reset(&ctx->reg.active, floor);
+        ctx->stats.total_stops++;
+    }
+    floorset_reset(&ctx->reg.internal, floor);
+}
+
+static SvcStatus apply_event(SvcSession *s, const uint8_t *in) {
+    SimContext *ctx = &s->sim;
+    const int type = in[0];
+    const int floor = in[1];
+    const int value = in[2];
+    const unsigned flags = in[3];
+
+    switch (type) {
+        case SVC_HALL_CALL:
+        case SVC_CAR_CALL:
+        case SVC_CAR_POSITION:
+            if (floor >= ctx->cfg.num_floors) return SVC_BAD_FLOOR;
+            break;
+        case SVC_TICK:
+        case SVC_QUERY:
+        case SVC_STATS:
+            break;
+        default:
+            return SVC_BAD_TYPE;
+    }
+
+    if (type == SVC_HALL_CALL) {
+        TrafficArrival a = { 0, (uint16_t)floor, TRAFFIC_DEST_ANY, (uint16_t)value };
+        sim_add_arrival(ctx, &a, 0);
+    } else if (type == SVC_CAR_CALL) {
+        floorset_set(&ctx->reg.internal, floor);
+    } else if (type == SVC_CAR_POSITION) {
+        ctx->elevator.current_floor = floor;
+        ctx->elevator.direction = (flags & SVC_POS_DOWN) ? -1 : 1;
+        ctx->elevator.occupancy = value;
+        if (flags & SVC_POS_STOP) serve_floor(ctx, floor);
+    } else if (type == SVC_TICK && value > 0) {
+        sim_set_wait_clock(ctx, ctx->wait_clock + (uint32_t)value);
+        if (ctx->elevator.occupancy >= ctx->cfg.car_capacity) {
+            ctx->cycles_at_full_capacity += value;
+        } else {
+            ctx->cycles_at_full_capacity = 0;
+        }
+    }
+    return SVC_OK;
+}
+
+static int decide(SvcSession *s, DispatchPriority *priority) {
+    SimContext *ctx = &s->sim;
+    int floor;
+
+    // Como no início do ciclo de sim_step: chamadas novas sem passageiros
+    // saem antes da decisão
+    cleanup_empty_calls(ctx->calls, &ctx->reg.active, &ctx->fresh_calls);
+    floorset_clear(&ctx->fresh_calls);
+    call_order_sync(&ctx->order, ctx->calls, &ctx->reg.active);
+
+    // A decisão é só uma resposta, que o prédio pode ignorar: as regras
+    // rodam sobre cópias das estatísticas e do contador de lotação. O
+    // contador só zera quando o prédio informa o carro abaixo da lotação
+    // (SVC_CAR_POSITION seguido de SVC_TICK)
+    Stats stats = ctx->stats;
+    int full = ctx->cycles_at_full_capacity;
+
+    if (s->decider == SVC_DECIDE_SMARTSTOP) {
+        floor = smartstop_decide_next_floor(&ctx->cfg, ctx->calls, &ctx->reg.active,
+                                            &ctx->elevator, ctx->wait_clock, &ctx->stats);
+        *priority = floor != -1 ? PRIORITY_SMARTSTOP : PRIORITY_NONE;
+    } else {
+        *priority = PRIORITY_NONE;
+        floor = choose_next_floor_realistic(ctx, priority);
+    }
+
+    ctx->stats = stats;
+    ctx->cycles_at_full_capacity = full;
+    return floor;
+}
+
+size_t svc_session_handle(SvcSession *s, const uint8_t *in, int n, uint8_t *out,
+                          uint64_t start_ns) {
+    uint8_t status[SVC_MAX_BATCH];
+    for (int i = 0; i < n; i++) {
+        status[i] = (uint8_t)apply_event(s, in + i * SVC_FRAME_BYTES);
+    }
+
+    DispatchPriority priority;
+    int floor = decide(s, &priority);
+
+    size_t bytes = 0;
+    for (int i = 0; i < n; i++) {
+        const uint8_t *req = in + i * SVC_FRAME_BYTES;
+        uint8_t *rep = out + bytes;
+        rep[0] = req[0];
+        rep[1] = floor == -1 ? SVC_NO_FLOOR : (uint8_t)floor;
+        rep[2] = (uint8_t)priority;
+        rep[3] = status[i];
+        memcpy(rep + 4, req + 4, 4);
+        bytes += SVC_FRAME_BYTES;
+
+        if (req[0] == SVC_STATS) {
+            uint8_t *p = out + bytes;
+            put_u64(p, s->batches);
+            put_u64(p + 8, s->events);
+            put_u64(p + 16, loghist_quantile_ns(&s->latency, 500));
+            put_u64(p + 24, loghist_quantile_ns(&s->latency, 990));
+            put_u64(p + 32, loghist_quantile_ns(&s->latency, 999));
+            put_u64(p + 40, s->latency.max_ns);
+            bytes += SVC_STATS_BYTES;
+        }
+    }
+
+    s->batches++;
+    s->events += (uint64_t)n;
+    loghist_add(&s->latency, hal_time_ns() - start_ns);
+    return bytes;
+}
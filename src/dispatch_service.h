@@ -0,0 +1,99 @@
+#ifndef DISPATCH_SERVICE_H
+#define DISPATCH_SERVICE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dispatch.h"
+#include "stageprof.h"
+
+// Despacho como serviço (somente host, ver serve_main.c).
+//
+// Um sistema de gestão predial manda eventos do prédio e recebe a decisão
+// de despacho. Cada sessão (uma conexão) tem o próprio SimContext, que só
+// guarda o estado: chamadas, destinos a bordo e posição do carro chegam
+// pelos eventos, e o relógio de espera anda com os eventos SVC_TICK.
+//
+// Protocolo binário em quadros de 8 bytes, little-endian:
+//
+//   pedido:   type u8 | floor u8 | value u8 | flags u8 | seq u32
+//   resposta: type u8 | floor u8 | priority u8 | status u8 | seq u32
+//
+// Os quadros que chegam juntos (uma leitura do socket) formam um lote: os
+// eventos são aplicados em ordem, a decisão é calculada uma vez para o
+// estado final e cada quadro é respondido com ela (type e seq ecoados).
+// floor = SVC_NO_FLOOR quando o carro segue sem parar; priority é a regra
+// da cascata (DispatchPriority). Um quadro inválido é respondido com status
+// diferente de SVC_OK e não muda o estado.
+//
+// Calcular a decisão não muda a sessão: a mesma consulta repetida dá a
+// mesma resposta. O estado só anda com os eventos (chamadas, posição,
+// SVC_TICK); o contador de lotação do desembarque forçado, por exemplo,
+// continua contando até o prédio informar o carro abaixo da lotação.
+//
+// SVC_STATS responde com o quadro seguido de SVC_STATS_BYTES: lotes,
+// eventos e os quantis p50/p99/p999 e o pior tempo de decisão da sessão
+// (ns, u64 cada), medidos da leitura do lote até a resposta pronta.
+
+#define SVC_FRAME_BYTES 8
+#define SVC_STATS_BYTES 48
+#define SVC_NO_FLOOR    0xFF
+#define SVC_MAX_BATCH   512          // quadros por leitura
+
+typedef enum {
+    SVC_HALL_CALL = 1,      // floor, value = pessoas esperando (soma à chamada ativa)
+    SVC_CAR_CALL,           // floor = destino de quem está a bordo
+    SVC_CAR_POSITION,       // floor, value = ocupação, flags SVC_POS_*
+    SVC_TICK,               // value = ciclos de espera a avançar
+    SVC_QUERY,              // só a decisão (nenhum evento)
+    SVC_STATS,              // latência da sessão (resposta estendida)
+} SvcEventType;
+
+#define SVC_POS_DOWN  0x1u          // descendo (senão subindo)
+#define SVC_POS_STOP  0x2u          // parado com portas abertas: atende o andar
+
+typedef enum {
+    SVC_OK = 0,
+    SVC_BAD_TYPE,
+    SVC_BAD_FLOOR,
+} SvcStatus;
+
+// Regra de decisão da sessão
+typedef enum {
+    SVC_DECIDE_CASCADE = 0,         // choose_next_floor_realistic (prioridades 0..7)
+    SVC_DECIDE_SMARTSTOP,           // só smartstop_decide_next_floor
+} SvcDecider;
+
+typedef struct {
+    SimContext sim;
+    SimClock clock;
+    SvcDecider decider;
+
+    LogHist latency;                // tempo por lote (ns)
+    uint64_t batches;
+    uint64_t events;
+} SvcSession;
+
+void svc_session_init(SvcSession *s, const BuildingConfig *cfg, SvcDecider decider);
+
+// Processa um lote de n quadros completos (n <= SVC_MAX_BATCH) e escreve
+// as respostas em out, que precisa de n * SVC_FRAME_BYTES mais
+// SVC_STATS_BYTES por SVC_STATS. Retorna os bytes de resposta. start_ns é
+// o instante da leitura, para a latência.
+size_t svc_session_handle(SvcSession *s, const uint8_t *in, int n, uint8_t *out,
+                          uint64_t start_ns);
+
+// Codificação de um quadro de pedido (para clientes)
+void svc_encode_event(uint8_t out[SVC_FRAME_BYTES], SvcEventType type, int floor, int value,
+                      unsigned flags, uint32_t seq);
+
+static inline uint32_t svc_get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline uint64_t svc_get_u64(const uint8_t *p) {
+    return (uint64_t)svc_get_u32(p) | (uint64_t)svc_get_u32(p + 4) << 32;
+}
+
+#endif
@@ -0,0 +1,357 @@
+/*
+ * Execução Monte Carlo em paralelo com roubo de tarefas
+ *
+ * Cada thread tem uma deque Chase-Lev de índices de tarefa. A dona empilha
+ * e desempilha pelo fundo; threads ociosas roubam pelo topo de uma vítima
+ * aleatória. Uma tarefa = uma simulação completa (ponto da grade, réplica).
+ * Cada tarefa grava o próprio resultado em uma entrada exclusiva, escrita uma
+ * única vez no fim da simulação; a soma por ponto é feita no fim, na ordem das
+ * tarefas, para que as médias em ponto flutuante não dependam de qual thread
+ * executou o quê.
+ *
+ * No motor em passo travado uma tarefa é um lote de execuções consecutivas
+ * (mesma numeração); cada thread reaproveita o seu LockstepBatch.
+ */
+
+#define _GNU_SOURCE
+
+#include "ensemble.h"
+#include "dispatch.h"
+#include "hal.h"
+#include "lockstep.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_LINE 64
+
+// ---------------------------------------------------------------------------
+// Deque Chase-Lev (capacidade fixa, potência de 2)
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_llong top;
+    _Alignas(CACHE_LINE) atomic_llong bottom;
+    _Alignas(CACHE_LINE) _Atomic uint32_t *buf;
+    long long mask;
+} WsDeque;
+
+enum { WS_EMPTY = 0, WS_OK = 1, WS_ABORT = 2 };
+
+static int ws_init(WsDeque *d, long long min_capacity) {
+    long long cap = 1;
+    while (cap < min_capacity) cap <<= 1;
+
+    d->buf = calloc((size_t)cap, sizeof(*d->buf));
+    if (!d->buf) return -1;
+    d->mask = cap - 1;
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+    return 0;
+}
+
+static void ws_free(WsDeque *d) {
+    free((void *)d->buf);
+}
+
+// Somente a dona
+static void ws_push(WsDeque *d, uint32_t v) {
+    long long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    atomic_store_explicit(&d->buf[b & d->mask], v, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+}
+
+// Somente a dona
+static int ws_pop(WsDeque *d, uint32_t *v) {
+    long long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (t > b) {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return WS_EMPTY;
+    }
+
+    *v = atomic_load_explicit(&d->buf[b & d->mask], memory_order_relaxed);
+    if (t == b) {
+        // último elemento: disputa com ladrões
+        int won = atomic_compare_exchange_strong_explicit(
+            &d->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return won ? WS_OK : WS_EMPTY;
+    }
+    return WS_OK;
+}
+
+// Qualquer thread
+static int ws_steal(WsDeque *d, uint32_t *v) {
+    long long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    if (t >= b) return WS_EMPTY;
+
+    *v = atomic_load_explicit(&d->buf[t & d->mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(
+            &d->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return WS_ABORT;
+    }
+    return WS_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Agregação
+// ---------------------------------------------------------------------------
+
+void ensemble_merge_stats(SweepResult *r, const Stats *s, long long cycles) {
+    r->runs++;
+    r->cycles += cycles;
+    r->total_stops += s->total_stops;
+    r->skipped_stops += s->skipped_stops;
+    r->decisions += s->total_cycles;
+    r->total_boarded += s->total_boarded;
+
+    double bpc = cycles > 0 ? (double)s->total_boarded / (double)cycles : 0.0;
+    int considered = s->total_stops + s->skipped_stops;
+    double skip = considered > 0 ? (double)s->skipped_stops / (double)considered : 0.0;
+
+    r->boarded_per_cycle_sum += bpc;
+    r->boarded_per_cycle_sq += bpc * bpc;
+    r->skip_rate_sum += skip;
+    r->skip_rate_sq += skip * skip;
+}
+
+void ensemble_merge_result(SweepResult *dst, const SweepResult *src) {
+    dst->runs += src->runs;
+    dst->cycles += src->cycles;
+    dst->total_stops += src->total_stops;
+    dst->skipped_stops += src->skipped_stops;
+    dst->decisions += src->decisions;
+    dst->total_boarded += src->total_boarded;
+    dst->boarded_per_cycle_sum += src->boarded_per_cycle_sum;
+    dst->boarded_per_cycle_sq += src->boarded_per_cycle_sq;
+    dst->skip_rate_sum += src->skip_rate_sum;
+    dst->skip_rate_sq += src->skip_rate_sq;
+}
+
+// ---------------------------------------------------------------------------
+// Workers
+// ---------------------------------------------------------------------------
+
+typedef struct Worker Worker;
+
+typedef struct {
+    EnsembleJob *job;
+    Worker *workers;
+    SimRng *streams;          // estado inicial do gerador por réplica
+    SweepResult *runs;        // resultado de cada execução (total entradas)
+    long long total;          // execuções
+    int batch;                // execuções por tarefa (1 no motor escalar)
+    atomic_llong remaining;   // tarefas ainda não concluídas
+} Pool;
+
+struct Worker {
+    _Alignas(CACHE_LINE) WsDeque deque;
+    Pool *pool;
+    int id;
+    pthread_t thread;
+    uint32_t victim_seed;
+    uint64_t steals;
+    SimContext sim;
+    SimClock clock;
+    LockstepBatch lanes;
+};
+
+static void run_single(Worker *w, uint32_t task) {
+    const EnsembleJob *job = w->pool->job;
+    int point = (int)(task / (uint32_t)job->runs_per_point);
+    int replica = (int)(task % (uint32_t)job->runs_per_point);
+    const SweepPoint *p = &job->points[point];
+
+    sim_clock_init(&w->clock, SIM_CLOCK_FAST, 1.0f);
+    sim_init(&w->sim, &p->cfg, &w->clock, p->mode, job->seed, false);
+    w->sim.rng = w->pool->streams[replica];
+
+    for (long long c = 0; c < job->cycles_per_run; c++) {
+        sim_step(&w->sim);
+    }
+
+    ensemble_merge_stats(&w->pool->runs[task], &w->sim.stats, job->cycles_per_run);
+}
+
+// Execuções [task * batch, task * batch + batch) em passo travado
+static void run_lockstep(Worker *w, uint32_t task) {
+    const Pool *pool = w->pool;
+    const EnsembleJob *job = pool->job;
+    long long first = (long long)task * pool->batch;
+    long long end = first + pool->batch;
+    if (end > pool->total) end = pool->total;
+
+    lockstep_clear(&w->lanes);
+    for (long long t = first; t < end; t++) {
+        const SweepPoint *p = &job->points[t / job->runs_per_point];
+        lockstep_add(&w->lanes, &p->cfg, p->mode, &pool->streams[t % job->runs_per_point]);
+    }
+    lockstep_run(&w->lanes, job->cycles_per_run);
+
+    for (long long t = first; t < end; t++) {
+        ensemble_merge_stats(&pool->runs[t], &w->lanes.stats[t - first], job->cycles_per_run);
+    }
+}
+
+static void run_task(Worker *w, uint32_t task) {
+    if (w->pool->job->engine_used == ENSEMBLE_LOCKSTEP) run_lockstep(w, task);
+    else run_single(w, task);
+}
+
+static uint32_t next_victim(Worker *w, int n) {
+    // xorshift32: escolha barata de vítima
+    uint32_t x = w->victim_seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    w->victim_seed = x;
+    return x % (uint32_t)n;
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+    Pool *pool = w->pool;
+    const int n = pool->job->num_threads;
+    uint32_t task;
+
+    while (atomic_load_explicit(&pool->remaining, memory_order_acquire) > 0) {
+        int r = ws_pop(&w->deque, &task);
+
+        if (r != WS_OK && n > 1) {
+            // deque vazia: tenta roubar de algumas vítimas
+            for (int attempt = 0; attempt < 2 * n && r != WS_OK; attempt++) {
+                uint32_t v = next_victim(w, n);
+                if ((int)v == w->id) continue;
+                r = ws_steal(&pool->workers[v].deque, &task);
+            }
+            if (r == WS_OK) w->steals++;
+        }
+
+        if (r != WS_OK) {
+            sched_yield();
+            continue;
+        }
+
+        run_task(w, task);
+        atomic_fetch_sub_explicit(&pool->remaining, 1, memory_order_release);
+    }
+    return NULL;
+}
+
+int ensemble_run(EnsembleJob *job) {
+    if (job->num_points <= 0 || job->runs_per_point <= 0) return -1;
+    if (job->num_threads < 1) job->num_threads = 1;
+    if (job->num_threads > ENSEMBLE_MAX_THREADS) job->num_threads = ENSEMBLE_MAX_THREADS;
+
+    const long long total = (long long)job->num_points * job->runs_per_point;
+    if (total > UINT32_MAX) return -1;
+    const int n = job->num_threads;
+
+    // Passo travado só se todos os pontos couberem num lote
+    job->engine_used = job->engine;
+    for (int i = 0; i < job->num_points && job->engine_used == ENSEMBLE_LOCKSTEP; i++) {
+        if (!lockstep_supported(&job->points[i].cfg)) job->engine_used = ENSEMBLE_SCALAR;
+    }
+
+    int status = -1;
+    Pool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.job = job;
+    pool.total = total;
+    pool.batch = 1;
+    if (job->engine_used == ENSEMBLE_LOCKSTEP) {
+        // Lotes cheios, mas ao menos ~4 tarefas por thread para o roubo
+        // equilibrar a carga
+        long long batch = total / (4LL * n);
+        batch = (batch + 15) / 16 * 16;
+        if (batch < 16) batch = 16;
+        if (batch > LOCKSTEP_LANES) batch = LOCKSTEP_LANES;
+        pool.batch = (int)batch;
+    }
+    const long long tasks = (total + pool.batch - 1) / pool.batch;
+    atomic_init(&pool.remaining, tasks);
+    // Fluxos independentes por réplica. A réplica r usa o mesmo fluxo em
+    // todos os pontos da grade (números aleatórios comuns): as diferenças
+    // entre pontos vêm dos parâmetros, não do sorteio, e o resultado não
+    // depende do número de threads.
+    pool.streams = malloc(sizeof(SimRng) * (size_t)job->runs_per_point);
+    if (!pool.streams) goto done;
+    sim_rng_seed(&pool.streams[0], job->seed);
+    for (int r = 1; r < job->runs_per_point; r++) {
+        pool.streams[r] = pool.streams[r - 1];
+        sim_rng_jump(&pool.streams[r]);
+    }
+
+    pool.runs = calloc((size_t)total, sizeof(SweepResult));
+    if (!pool.runs) goto done;
+
+    pool.workers = aligned_alloc(CACHE_LINE, sizeof(Worker) * (size_t)n);
+    if (!pool.workers) goto done;
+    memset(pool.workers, 0, sizeof(Worker) * (size_t)n);
+
+    for (int i = 0; i < n; i++) {
+        Worker *w = &pool.workers[i];
+        w->pool = &pool;
+        w->id = i;
+        w->victim_seed = 0x9E3779B9u ^ (uint32_t)(i + 1) * 2654435761u;
+        if (ws_init(&w->deque, tasks / n + 1) != 0) goto done;
+        if (job->engine_used == ENSEMBLE_LOCKSTEP && !lockstep_init(&w->lanes, pool.batch)) {
+            goto done;
+        }
+    }
+
+    // Distribui blocos contíguos de tarefas; o desequilíbrio é corrigido
+    // pelo roubo (pontos da grade podem ter custos bem diferentes)
+    for (long long t = 0; t < tasks; t++) {
+        int owner = (int)(t * n / tasks);
+        ws_push(&pool.workers[owner].deque, (uint32_t)t);
+    }
+
+    // Se uma thread não sobe, as tarefas da deque dela ficam para as outras
+    // (roubo); a thread principal só sai quando todas terminaram
+    bool started[ENSEMBLE_MAX_THREADS] = { false };
+    uint64_t start = hal_time_us();
+    for (int i = 1; i < n; i++) {
+        started[i] = pthread_create(&pool.workers[i].thread, NULL, worker_main,
+                                    &pool.workers[i]) == 0;
+    }
+    worker_main(&pool.workers[0]);
+    for (int i = 1; i < n; i++) {
+        if (started[i]) pthread_join(pool.workers[i].thread, NULL);
+    }
+    job->wall_seconds = (double)(hal_time_us() - start) / 1e6;
+
+    memset(job->results, 0, sizeof(SweepResult) * (size_t)job->num_points);
+    for (long long t = 0; t < total; t++) {
+        ensemble_merge_result(&job->results[t / job->runs_per_point], &pool.runs[t]);
+    }
+    job->steals = 0;
+    for (int i = 0; i < n; i++) {
+        job->steals += pool.workers[i].steals;
+    }
+    status = 0;
+
+done:
+    // Workers zerados no memset: deque e lote sem memória são liberáveis
+    if (pool.workers) {
+        for (int i = 0; i < n; i++) {
+            ws_free(&pool.workers[i].deque);
+            lockstep_free(&pool.workers[i].lanes);
+        }
+    }
+    free(pool.workers);
+    free(pool.streams);
+    free(pool.runs);
+    return status;
+}
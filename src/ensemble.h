@@ -0,0 +1,72 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <stdint.h>
+
+#include "smartstop.h"
+
+// Execução Monte Carlo em paralelo (somente host, pthreads).
+// Cada ponto da grade de parâmetros é simulado runs_per_point vezes; as
+// execuções são distribuídas entre as threads com roubo de tarefas
+// (work stealing) e os Stats de cada execução são agregados por ponto.
+//
+// Com ENSEMBLE_LOCKSTEP uma tarefa é um lote de até LOCKSTEP_LANES execuções
+// consecutivas simuladas juntas em passo travado (lockstep.h), com os mesmos
+// resultados do motor escalar.
+
+#define ENSEMBLE_MAX_THREADS 256
+
+typedef enum {
+    ENSEMBLE_SCALAR = 0,      // uma sim_step por vez
+    ENSEMBLE_LOCKSTEP,        // lotes em passo travado (cai no escalar se não couber)
+} EnsembleEngine;
+
+// Um ponto da grade: configuração completa do prédio + tráfego
+typedef struct {
+    BuildingConfig cfg;
+    TrafficMode mode;
+} SweepPoint;
+
+// Resultado agregado de um ponto (somatórios em 64 bits)
+typedef struct {
+    int runs;
+    long long cycles;
+    long long total_stops;
+    long long skipped_stops;
+    long long decisions;          // Stats.total_cycles (chamadas ao SmartStop)
+    long long total_boarded;
+
+    // Momentos por execução, para média e desvio padrão entre execuções
+    double boarded_per_cycle_sum;
+    double boarded_per_cycle_sq;
+    double skip_rate_sum;
+    double skip_rate_sq;
+} SweepResult;
+
+typedef struct {
+    const SweepPoint *points;
+    int num_points;
+    int runs_per_point;
+    long long cycles_per_run;
+    int num_threads;
+    uint64_t seed;            // réplica r usa o fluxo seed + r saltos (sim_rng_jump)
+    EnsembleEngine engine;
+
+    SweepResult *results;     // num_points entradas, preenchidas por ensemble_run
+
+    // Preenchidos por ensemble_run
+    double wall_seconds;
+    uint64_t steals;
+    EnsembleEngine engine_used;
+} EnsembleJob;
+
+// Soma os Stats de uma execução de `cycles` ciclos ao resultado do ponto
+void ensemble_merge_stats(SweepResult *r, const Stats *s, long long cycles);
+
+// Soma dois resultados agregados (dst += src)
+void ensemble_merge_result(SweepResult *dst, const SweepResult *src);
+
+// Executa todas as simulações do job. Retorna 0 em caso de sucesso.
+int ensemble_run(EnsembleJob *job);
+
+#endif
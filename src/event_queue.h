@@ -0,0 +1,86 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fila de prioridade de eventos com instante (heap binário mínimo).
+// Eventos no mesmo instante saem na ordem em que foram agendados (seq),
+// o que mantém a simulação determinística para uma semente.
+//
+// O motor de eventos (event_sim.c) mantém poucos eventos pendentes (uma
+// chegada e um evento do carro), então a capacidade é fixa e pequena: o
+// heap inteiro cabe em poucas linhas de cache.
+
+#ifndef EVENT_QUEUE_CAPACITY
+#define EVENT_QUEUE_CAPACITY 64
+#endif
+
+typedef struct {
+    uint64_t time_us;       // instante simulado
+    uint32_t seq;           // ordem de agendamento (desempate)
+    uint16_t type;          // definido pelo motor (SimEventType)
+    int16_t floor;
+} SimEvent;
+
+typedef struct {
+    uint32_t size;
+    uint32_t next_seq;
+    SimEvent heap[EVENT_QUEUE_CAPACITY];
+} EventQueue;
+
+static inline void event_queue_init(EventQueue *q) {
+    q->size = 0;
+    q->next_seq = 0;
+}
+
+static inline bool event_queue_empty(const EventQueue *q) {
+    return q->size == 0;
+}
+
+// a sai antes de b?
+static inline bool event_before(const SimEvent *a, const SimEvent *b) {
+    return a->time_us < b->time_us || (a->time_us == b->time_us && a->seq < b->seq);
+}
+
+// Agenda um evento. Retorna false se a fila estiver cheia.
+static inline bool event_queue_push(EventQueue *q, uint64_t time_us, uint16_t type, int floor) {
+    if (q->size >= EVENT_QUEUE_CAPACITY) return false;
+
+    SimEvent ev = { time_us, q->next_seq++, type, (int16_t)floor };
+
+    // Sobe a lacuna até a posição do novo evento
+    uint32_t i = q->size++;
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!event_before(&ev, &q->heap[parent])) break;
+        q->heap[i] = q->heap[parent];
+        i = parent;
+    }
+    q->heap[i] = ev;
+    return true;
+}
+
+// Retira o próximo evento. Retorna false se a fila estiver vazia.
+static inline bool event_queue_pop(EventQueue *q, SimEvent *out) {
+    if (q->size == 0) return false;
+
+    *out = q->heap[0];
+    SimEvent last = q->heap[--q->size];
+    uint32_t n = q->size;
+
+    // Desce a lacuna da raiz trocando pelo menor filho
+    uint32_t i = 0;
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && event_before(&q->heap[child + 1], &q->heap[child])) child++;
+        if (!event_before(&q->heap[child], &last)) break;
+        q->heap[i] = q->heap[child];
+        i = child;
+    }
+    if (n > 0) q->heap[i] = last;
+    return true;
+}
+
+#endif
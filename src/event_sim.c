@@ -0,0 +1,350 @@
+/*
+ * Motor de eventos discretos do SmartStop
+ *
+ * Cada evento muda o estado do carro ou das chamadas e agenda o próximo.
+ * Pendentes ficam no máximo uma chegada e um evento do carro, então o heap
+ * tem poucas entradas e cada evento custa algumas dezenas de ns; entre
+ * eventos o relógio salta direto (sim_clock_advance_us).
+ */
+
+#include "event_sim.h"
+#include "hal.h"
+
+#include <math.h>
+#include <stdio.h>
+
+uint32_t event_sim_arrival_mean_us(TrafficMode mode) {
+    switch (mode) {
+        case TRAFFIC_LOW:    return 6000000u;
+        case TRAFFIC_HIGH:   return 1000000u;
+        case TRAFFIC_MEDIUM:
+        default:             return 3000000u;
+    }
+}
+
+const char *event_sim_event_name(SimEventType type) {
+    switch (type) {
+        case SIM_EV_CALL_ARRIVAL:  return "CHEGADA";
+        case SIM_EV_DEPART:        return "PARTIDA";
+        case SIM_EV_FLOOR_PASS:    return "ANDAR";
+        case SIM_EV_DOOR_OPEN:     return "PORTA_ABRE";
+        case SIM_EV_BOARDING_DONE: return "EMBARQUE_FIM";
+        case SIM_EV_DOOR_CLOSE:    return "PORTA_FECHA";
+        default:                   return "?";
+    }
+}
+
+// Só há uma chegada e um evento do carro pendentes: a fila nunca enche
+static void schedule(EventSim *es, uint64_t at_us, SimEventType type, int floor) {
+    event_queue_push(&es->queue, at_us, (uint16_t)type, floor);
+}
+
+// Intervalo exponencial entre chegadas (processo de Poisson)
+static uint64_t next_interarrival_us(EventSim *es) {
+    double u = (double)(sim_rng_next(&es->ctx->rng) >> 8) * 0x1p-24;   // [0, 1)
+    return (uint64_t)(-log(1.0 - u) * (double)es->arrival_mean_us) + 1;
+}
+
+// Tempo entre andares (mínimo de 1 us para o tempo sempre avançar)
+static uint64_t travel_us(const EventSim *es) {
+    uint64_t us = (uint64_t)es->ctx->cfg.travel_time_ms * 1000u;
+    return us > 0 ? us : 1;
+}
+
+static uint64_t half_door_us(const EventSim *es) {
+    return (uint64_t)es->ctx->cfg.door_time_ms * 500u;
+}
+
+// Agenda a próxima chegada da fonte anexada, se houver (instantes fora de
+// ordem não voltam o relógio)
+static void schedule_source_arrival(EventSim *es) {
+    const SimContext *ctx = es->ctx;
+    if (!ctx->source_pending) return;
+
+    uint64_t at_us = ctx->source_start_us + ctx->source_next.time_us;
+    schedule(es, at_us > es->now_us ? at_us : es->now_us, SIM_EV_CALL_ARRIVAL,
+             ctx->source_next.origin);
+}
+
+// Ciclo equivalente do instante t (relógio de espera)
+static uint32_t wait_cycles(uint64_t t_us) {
+    return (uint32_t)(t_us / (EVENT_CYCLE_EQUIV_MS * 1000u));
+}
+
+static void set_idle(EventSim *es) {
+    es->phase = CAR_IDLE;
+    es->target = -1;
+    es->idle_since_us = es->now_us;
+}
+
+void event_sim_init(EventSim *es, SimContext *ctx) {
+    es->ctx = ctx;
+    event_queue_init(&es->queue);
+    es->now_us = sim_clock_now_us(ctx->clock);
+    es->arrival_mean_us = event_sim_arrival_mean_us(ctx->mode);
+    es->sweeping = false;
+
+    for (int f = 0; f < MAX_FLOORS; f++) {
+        es->call_since_us[f] = 0;
+        es->call_arrive_sum_us[f] = 0;
+        es->call_waiting[f] = 0;
+    }
+    for (int t = 0; t < SIM_EV_COUNT; t++) {
+        es->events[t] = 0;
+    }
+    es->arrivals = 0;
+    es->wait_sum_ms = 0;
+    es->wait_max_ms = 0;
+    es->idle_us = 0;
+
+    set_idle(es);
+    if (ctx->source) {
+        schedule_source_arrival(es);
+    } else {
+        schedule(es, es->now_us + next_interarrival_us(es), SIM_EV_CALL_ARRIVAL, 0);
+    }
+}
+
+// Decide o próximo destino com as regras do laço fixo e agenda a partida
+static void decide(EventSim *es) {
+    SimContext *ctx = es->ctx;
+    ElevatorState *e = &ctx->elevator;
+
+    // Espera em ciclos equivalentes para emergência e bonificação
+    sim_set_wait_clock(ctx, wait_cycles(es->now_us));
+
+    ctx->total_cycles++;
+    if (e->occupancy >= ctx->cfg.car_capacity) {
+        ctx->cycles_at_full_capacity++;
+    } else {
+        ctx->cycles_at_full_capacity = 0;
+    }
+
+    DispatchPriority priority;
+    int target = sim_choose_next_floor(ctx, &priority);
+    SIM_TRACE(ctx, TRACE_EV_DECISION, e->current_floor, priority, target, 0);
+
+    es->sweeping = (target == -1);
+    if (target == -1) {
+        if (e->occupancy == 0) {
+            set_idle(es);
+            return;
+        }
+        // Movimento contínuo: avança um andar e decide de novo
+        int next = e->current_floor + e->direction;
+        if (next < 0 || next >= ctx->cfg.num_floors) {
+            e->direction = -e->direction;
+            next = e->current_floor + e->direction;
+        }
+        target = next;
+    } else {
+        SIM_LOG(ctx, LOG_DECISION, target);
+    }
+
+    es->target = target;
+    if (target == e->current_floor) {
+        es->phase = CAR_DOORS;
+        schedule(es, es->now_us, SIM_EV_DOOR_OPEN, target);
+        return;
+    }
+
+    e->direction = (target > e->current_floor) ? 1 : -1;
+    es->phase = CAR_MOVING;
+    schedule(es, es->now_us, SIM_EV_DEPART, target);
+}
+
+static void on_arrival(EventSim *es) {
+    SimContext *ctx = es->ctx;
+    TrafficArrival a;
+
+    if (ctx->source) {
+        a = ctx->source_next;
+        ctx->source_pending = traffic_source_next(ctx->source, &ctx->source_next);
+        schedule_source_arrival(es);
+    } else {
+        a.origin = (uint16_t)sim_rng_below(&ctx->rng, ctx->cfg.num_floors);
+        a.dest = TRAFFIC_DEST_ANY;
+        a.group = (uint16_t)estimate_passengers(&ctx->rng, ctx->mode);
+        schedule(es, es->now_us + next_interarrival_us(es), SIM_EV_CALL_ARRIVAL, 0);
+    }
+
+    int floor = a.origin;
+    bool was_active = ctx->calls[floor].active;
+    sim_set_wait_clock(ctx, wait_cycles(es->now_us));
+    int passengers = sim_add_arrival(ctx, &a, es->now_us);
+    if (passengers <= 0) return;
+
+    es->arrivals += (uint64_t)passengers;
+    if (!was_active) {
+        es->call_since_us[floor] = es->now_us;
+        es->call_arrive_sum_us[floor] = 0;
+        es->call_waiting[floor] = 0;
+    }
+    es->call_arrive_sum_us[floor] += es->now_us * (uint64_t)passengers;
+    es->call_waiting[floor] += (uint32_t)passengers;
+
+    if (es->phase == CAR_IDLE) {
+        es->idle_us += es->now_us - es->idle_since_us;
+        decide(es);
+    }
+}
+
+static void on_floor_pass(EventSim *es) {
+    SimContext *ctx = es->ctx;
+    ElevatorState *e = &ctx->elevator;
+
+    e->current_floor += e->direction;
+    int f = e->current_floor;
+
+    if (f == es->target) {
+        if (es->sweeping) {
+            // Desembarque probabilístico em movimento, como continue_moving
+            if (e->occupancy > 0 && !ctx->pax && sim_rng_below(&ctx->rng, 100) < 15) {
+                sim_disembark(ctx, f, false);
+            }
+            decide(es);
+        } else {
+            es->phase = CAR_DOORS;
+            schedule(es, es->now_us, SIM_EV_DOOR_OPEN, f);
+        }
+        return;
+    }
+
+    // Passando por chamada ativa sem parar
+    if (floorset_test(&ctx->reg.active, f) && ctx->calls[f].est_passengers > 0) {
+        SIM_TRACE(ctx, TRACE_EV_SKIP, f, 0, ctx->calls[f].est_passengers, 0);
+        ctx->stats.skipped_stops++;
+    }
+    schedule(es, es->now_us + travel_us(es), SIM_EV_FLOOR_PASS, es->target);
+}
+
+static void on_door_open(EventSim *es, int floor) {
+    SimContext *ctx = es->ctx;
+
+    SIM_LOG(ctx, LOG_ARRIVED, floor);
+    if (ctx->elevator.occupancy > 0) {
+        sim_disembark(ctx, floor, ctx->calls[floor].active);
+    }
+    schedule(es, es->now_us + half_door_us(es), SIM_EV_BOARDING_DONE, floor);
+}
+
+static void on_boarding_done(EventSim *es, int floor) {
+    SimContext *ctx = es->ctx;
+    ElevatorState *e = &ctx->elevator;
+    HallCall *call = &ctx->calls[floor];
+
+    if (call->active && call->est_passengers > 0 && e->occupancy < ctx->cfg.car_capacity) {
+        uint64_t wait_ms = (es->now_us - es->call_since_us[floor]) / 1000u;
+        uint64_t pax_sum_ms = ctx->pax ? ctx->pax->wait.sum_ms : 0;
+        int boarded = sim_board(ctx, floor);
+
+        if (ctx->pax) {
+            // passenger_board já mediu a espera de cada um desde a própria
+            // chegada. Quem não coube continua na fila: a espera da chamada
+            // passa a contar do mais antigo deles
+            const PassengerModel *m = ctx->pax;
+            es->wait_sum_ms += m->wait.sum_ms - pax_sum_ms;
+            if (call->active) {
+                es->call_since_us[floor] = m->pool.slots[m->waiting[floor].head].arrive_us;
+                sim_restamp_call(ctx, floor, wait_cycles(es->call_since_us[floor]));
+            }
+        } else if (es->call_waiting[floor] > 0) {
+            // Modelo agregado: cada embarcado conta a espera média desde a
+            // chegada do próprio grupo (quem não coube sai com a chamada)
+            uint64_t n = es->call_waiting[floor];
+            uint64_t pending_us = es->now_us * n - es->call_arrive_sum_us[floor];
+            es->wait_sum_ms += pending_us * (uint64_t)boarded / n / 1000u;
+            es->call_arrive_sum_us[floor] = 0;
+            es->call_waiting[floor] = 0;
+        }
+        if (wait_ms > es->wait_max_ms) es->wait_max_ms = (uint32_t)wait_ms;
+
+        SIM_LOG(ctx, LOG_BOARDING);
+        SIM_TRACE(ctx, TRACE_EV_BOARD, floor, 0, boarded, call->est_passengers);
+    } else if (call->active && e->occupancy >= ctx->cfg.car_capacity) {
+        SIM_LOG(ctx, LOG_CAR_FULL);
+    }
+    floorset_reset(&ctx->reg.button, floor);
+    if (ctx->button_press_us[floor] != 0) {
+        latency_add(&ctx->button_service, hal_time_us() - ctx->button_press_us[floor]);
+        ctx->button_press_us[floor] = 0;
+    }
+
+    schedule(es, es->now_us + half_door_us(es), SIM_EV_DOOR_CLOSE, floor);
+}
+
+bool event_sim_step(EventSim *es) {
+    SimEvent ev;
+    if (!event_queue_pop(&es->queue, &ev)) return false;
+
+    if (ev.time_us > es->now_us) {
+        sim_clock_advance_us(es->ctx->clock, ev.time_us - es->now_us);
+        es->now_us = ev.time_us;
+    }
+    es->events[ev.type]++;
+
+    switch ((SimEventType)ev.type) {
+        case SIM_EV_CALL_ARRIVAL:
+            on_arrival(es);
+            break;
+        case SIM_EV_DEPART:
+            schedule(es, es->now_us + travel_us(es), SIM_EV_FLOOR_PASS, ev.floor);
+            break;
+        case SIM_EV_FLOOR_PASS:
+            on_floor_pass(es);
+            break;
+        case SIM_EV_DOOR_OPEN:
+            on_door_open(es, ev.floor);
+            break;
+        case SIM_EV_BOARDING_DONE:
+            on_boarding_done(es, ev.floor);
+            break;
+        case SIM_EV_DOOR_CLOSE:
+            decide(es);
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+uint64_t event_sim_run(EventSim *es, uint64_t until_us) {
+    uint64_t n = 0;
+    while (!event_queue_empty(&es->queue) && es->queue.heap[0].time_us <= until_us) {
+        event_sim_step(es);
+        n++;
+    }
+    return n;
+}
+
+uint64_t event_sim_total_events(const EventSim *es) {
+    uint64_t total = 0;
+    for (int t = 0; t < SIM_EV_COUNT; t++) {
+        total += es->events[t];
+    }
+    return total;
+}
+
+void event_sim_print_report(const EventSim *es) {
+    const Stats *s = &es->ctx->stats;
+    uint64_t idle = es->idle_us;
+    if (es->phase == CAR_IDLE) idle += es->now_us - es->idle_since_us;
+
+    printf("\n--- Motor de eventos ---\n");
+    printf("Tempo simulado:     %.1f h\n", (double)es->now_us / 3.6e9);
+    for (int t = 0; t < SIM_EV_COUNT; t++) {
+        printf("  %-18s %llu\n", event_sim_event_name((SimEventType)t),
+               (unsigned long long)es->events[t]);
+    }
+    printf("Passageiros:        %llu chegaram, %d embarcaram\n",
+           (unsigned long long)es->arrivals, s->total_boarded);
+    if (s->total_boarded > 0) {
+        printf("Espera até embarque: média %.1f s | máx %.1f s\n",
+               (double)es->wait_sum_ms / (double)s->total_boarded / 1000.0,
+               (double)es->wait_max_ms / 1000.0);
+    }
+    if (es->now_us > 0) {
+        printf("Carro ocioso:       %.1f %% do tempo\n", 100.0 * (double)idle / (double)es->now_us);
+    }
+    printf("------------------------\n");
+}
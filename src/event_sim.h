@@ -0,0 +1,92 @@
+#ifndef EVENT_SIM_H
+#define EVENT_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dispatch.h"
+#include "event_queue.h"
+
+// Motor de eventos discretos.
+//
+// Alternativa a sim_step: em vez de ciclos fixos (viagem inteira dentro de
+// um ciclo, relógio de espera +1 por ciclo), o tempo salta de evento em evento numa
+// fila de prioridade (event_queue.h). O modelo continua o do SimContext
+// (HallCall, ElevatorState, CallRegistry) e as decisões continuam as de
+// choose_next_floor_realistic; o motor só decide quando cada coisa acontece.
+//
+// - Chegadas de passageiros são um processo de Poisson no prédio inteiro e
+//   acontecem a qualquer momento, inclusive com o carro em viagem. Com uma
+//   fonte anexada (sim_attach_source) vêm dela, e a simulação termina
+//   quando a fonte se esgota e o carro fica ocioso.
+// - A espera é medida em microssegundos desde a primeira chegada da chamada
+//   (relatada em ms). Para as regras calibradas em ciclos (emergência,
+//   bonificação), o relógio de espera do contexto conta ciclos equivalentes
+//   (EVENT_CYCLE_EQUIV_MS) desde o início e a chegada de cada chamada é o
+//   ciclo equivalente em que ela chegou; a espera é a diferença dos dois
+//   (pode ser um ciclo a mais que a espera em us dividida pelo ciclo).
+// - Carro parado sem destino não agenda nada: períodos ociosos custam só
+//   os eventos de chegada.
+
+// Duração de um "ciclo" do laço fixo para converter esperas em ciclos
+#define EVENT_CYCLE_EQUIV_MS 3000
+
+typedef enum {
+    SIM_EV_CALL_ARRIVAL = 0,    // passageiros chegam a um andar
+    SIM_EV_DEPART,              // carro parte rumo ao destino
+    SIM_EV_FLOOR_PASS,          // carro alcança o próximo andar
+    SIM_EV_DOOR_OPEN,
+    SIM_EV_BOARDING_DONE,
+    SIM_EV_DOOR_CLOSE,
+    SIM_EV_COUNT
+} SimEventType;
+
+typedef enum {
+    CAR_IDLE = 0,               // parado, portas fechadas, sem destino
+    CAR_MOVING,
+    CAR_DOORS                   // portas abertas / embarque
+} CarPhase;
+
+typedef struct {
+    SimContext *ctx;            // modelo, gerador, relógio, log e traço
+    EventQueue queue;
+    uint64_t now_us;
+
+    CarPhase phase;
+    int target;                 // destino da viagem atual (-1 = nenhum)
+    bool sweeping;              // movimento contínuo (sem parada no destino)
+    uint32_t arrival_mean_us;   // intervalo médio entre chegadas no prédio
+    uint64_t call_since_us[MAX_FLOORS];  // primeira chegada da chamada ativa
+    uint64_t call_arrive_sum_us[MAX_FLOORS];  // soma dos instantes de chegada por pessoa
+    uint32_t call_waiting[MAX_FLOORS];        // pessoas somadas em call_arrive_sum_us
+
+    // Estatísticas
+    uint64_t events[SIM_EV_COUNT];
+    uint64_t arrivals;          // passageiros chegados
+    uint64_t wait_sum_ms;       // espera até o embarque, por passageiro
+    uint32_t wait_max_ms;
+    uint64_t idle_us;           // tempo com o carro ocioso
+    uint64_t idle_since_us;
+} EventSim;
+
+// Liga o motor a um contexto já iniciado (sim_init, e sim_attach_source se
+// houver fonte) e agenda a primeira chegada. O carro começa ocioso.
+void event_sim_init(EventSim *es, SimContext *ctx);
+
+// Intervalo médio entre chegadas no prédio para cada modo de tráfego
+uint32_t event_sim_arrival_mean_us(TrafficMode mode);
+
+// Processa o próximo evento. Retorna false se a fila estiver vazia.
+bool event_sim_step(EventSim *es);
+
+// Processa eventos até o instante until_us (inclusive). Retorna quantos.
+uint64_t event_sim_run(EventSim *es, uint64_t until_us);
+
+// Total de eventos processados
+uint64_t event_sim_total_events(const EventSim *es);
+
+const char *event_sim_event_name(SimEventType type);
+
+void event_sim_print_report(const EventSim *es);
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ * SmartStop - conferência da pontuação em inteiros
+ *
+ * Compara smartstop_best_floor_fixed com smartstop_best_floor_float em
+ * milhões de estados aleatórios (kernel_check.h), para cada tamanho de
+ * prédio (inclusive os laços especializados de 16, 32 e 64 andares), e
+ * cronometra as duas versões por decisão.
+ *
+ * As duas só podem divergir num empate exato entre uma chamada com e outra
+ * sem bonificação (ou de uma chamada com bonificação e o limiar), que o
+ * arredondamento do float desfaz para um dos lados; a versão inteira fica
+ * com o empate (primeira chamada / aceita). Qualquer outra divergência é
+ * erro e o programa termina com código 1.
+ *
+ * Uso:
+ *   smartstop_fixcheck [--states N] [--floors N] [--max-est E] [--max-wait W]
+ *                      [--threshold T] [--bonus B] [--stop-cost C] [--seed S]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define FIXCHECK_TSC 1
+#endif
+
+#include "hal.h"
+#include "kernel_check.h"
+
+#define FIXCHECK_RING       256         // estados percorridos na cronometragem
+#define FIXCHECK_TIMED      2000000u    // decisões cronometradas por versão
+
+static KernelState ring[FIXCHECK_RING];
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [--states N] [--floors N] [--max-est E] [--max-wait W]\n"
+            "          [--threshold T] [--bonus B] [--stop-cost C] [--seed S]\n",
+            prog);
+}
+
+// Tempo (ns) e, no x86, ciclos do TSC por decisão
+static void time_version(const BuildingConfig *cfg, bool fixed, double *ns, double *cycles) {
+#ifdef FIXCHECK_TSC
+    uint64_t t0 = __rdtsc();
+#endif
+    uint64_t us = kernel_check_time_us(cfg, ring, FIXCHECK_RING, FIXCHECK_TIMED, fixed);
+#ifdef FIXCHECK_TSC
+    *cycles = (double)(__rdtsc() - t0) / FIXCHECK_TIMED;
+#else
+    *cycles = 0.0;
+#endif
+    *ns = (double)us * 1000.0 / FIXCHECK_TIMED;
+}
+
+int main(int argc, char **argv) {
+    BuildingConfig building;
+    building_config_default(&building);
+
+    uint64_t states = 5000000;
+    int only_floors = 0;
+    int max_est = 8;
+    int max_wait = 2 * WAIT_BONUS_AFTER + 10;
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--states") == 0 && val) {
+            states = strtoull(val, NULL, 0);
+            i++;
+        } else if (strcmp(arg, "--floors") == 0 && val) {
+            only_floors = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--max-est") == 0 && val) {
+            max_est = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--max-wait") == 0 && val) {
+            max_wait = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--threshold") == 0 && val) {
+            building.efficiency_threshold = (float)atof(val);
+            i++;
+        } else if (strcmp(arg, "--bonus") == 0 && val) {
+            building.wait_bonus = (float)atof(val);
+            i++;
+        } else if (strcmp(arg, "--stop-cost") == 0 && val) {
+            building.stop_cost = (float)atof(val);
+            i++;
+        } else if (strcmp(arg, "--seed") == 0 && val) {
+            seed = strtoull(val, NULL, 0);
+            i++;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (max_est < 0 || max_wait < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int sizes[] = { DEFAULT_NUM_FLOORS, 16, 32, 64, 100 };
+    int num_sizes = (int)(sizeof(sizes) / sizeof(sizes[0]));
+    if (only_floors) {
+        sizes[0] = only_floors;
+        num_sizes = 1;
+    }
+
+    printf("Pontuação: limiar %.3f, bonificação %.3f, custo de parada %.3f\n",
+           building.efficiency_threshold, building.wait_bonus, building.stop_cost);
+    printf("Estados: %llu por prédio, estimativa 0..%d, espera 0..%d ciclos\n\n",
+           (unsigned long long)states, max_est, max_wait);
+    printf("andares   estados   iguais      empates  divergências  "
+           "float ns  inteiro ns");
+#ifdef FIXCHECK_TSC
+    printf("  float ciclos  inteiro ciclos");
+#endif
+    printf("\n");
+
+    SimRng rng;
+    sim_rng_seed(&rng, seed);
+    uint64_t total_mismatches = 0;
+
+    for (int s = 0; s < num_sizes; s++) {
+        BuildingConfig cfg = building;
+        cfg.num_floors = sizes[s];
+        if (!building_config_apply(&cfg)) {
+            fprintf(stderr, "Configuração inválida (andares 2..%d, bonificação até 65, "
+                            "custo de parada até 1000)\n", MAX_FLOORS);
+            return 1;
+        }
+
+        KernelCheck check = {0};
+        static KernelState st;
+        for (uint64_t k = 0; k < states; k++) {
+            kernel_check_random_state(&cfg, &rng, max_est, max_wait, &st);
+            kernel_check_compare(&cfg, &st, &check);
+        }
+        total_mismatches += check.mismatches;
+
+        for (int k = 0; k < FIXCHECK_RING; k++) {
+            kernel_check_random_state(&cfg, &rng, max_est, max_wait, &ring[k]);
+        }
+        double ns_f, ns_x, cyc_f, cyc_x;
+        time_version(&cfg, false, &ns_f, &cyc_f);
+        time_version(&cfg, true, &ns_x, &cyc_x);
+
+        printf("%7d  %8llu  %8llu  %11llu  %12llu  %8.1f  %10.1f",
+               cfg.num_floors, (unsigned long long)check.states,
+               (unsigned long long)check.same, (unsigned long long)check.tie_breaks,
+               (unsigned long long)check.mismatches, ns_f, ns_x);
+#ifdef FIXCHECK_TSC
+        printf("  %12.1f  %14.1f", cyc_f, cyc_x);
+#else
+        (void)cyc_f;
+        (void)cyc_x;
+#endif
+        printf("\n");
+    }
+
+    if (total_mismatches > 0) {
+        printf("\nERRO: %llu decisões divergentes fora de empates exatos\n",
+               (unsigned long long)total_mismatches);
+        return 1;
+    }
+    printf("\nMesmas decisões (fora de empates exatos) em todos os estados\n");
+    return 0;
+}
@@ -0,0 +1,415 @@
+/*
+ * SmartStop - fotografia e bifurcação "e se" (ver snapshot.h)
+ *
+ * Roda uma simulação base até um ponto de interesse (--cycles ciclos, ou a
+ * primeira chamada esperando --at-emergency ciclos), fotografa o estado e
+ * continua a partir dele em vários ramos: um por combinação dos parâmetros
+ * dados (grade cartesiana, como em smartstop_sweep) e --replicas
+ * continuações por combinação. A réplica 0 segue o mesmo gerador da base;
+ * as demais avançam o gerador (sim_rng_jump) para variar o tráfego dali em
+ * diante. Assim uma situação rara, como uma espera longa, é estudada muitas
+ * vezes sem repetir o aquecimento.
+ *
+ * A fotografia pode ser gravada (--save) e lida de volta (--load) no
+ * formato de sim_snapshot_encode. Sem --load a ferramenta confere que o
+ * ramo sem mudança, aberto da fotografia codificada, repete a continuação
+ * da base passo a passo.
+ *
+ * Cada lista aceita um valor ("0.65") ou um intervalo "início:fim:passo";
+ * sem a lista vale o valor da fotografia.
+ *
+ * Uso:
+ *   smartstop_fork [--cycles N] [--at-emergency W] [--horizon H]
+ *                  [--replicas R] [--threshold L] [--bonus L]
+ *                  [--stop-cost L] [--emergency L] [--full-max L]
+ *                  [--floors N] [--traffic low|medium|high]
+ *                  [--profile PERFIL] [--rate R] [--passengers]
+ *                  [--save arquivo.sss] [--load arquivo.sss] [--seed S]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dispatch.h"
+#include "hal.h"
+#include "snapshot.h"
+#include "value_list.h"
+
+#define FORK_TIMING_REPS 2000
+
+// Indicadores de um ramo, somados sobre as réplicas
+typedef struct {
+    BuildingConfig cfg;
+    uint64_t cycles;
+    uint64_t boarded;
+    uint64_t stops;
+    uint64_t skipped;
+    uint64_t waiting_sum;           // chamadas esperando, a cada ciclo
+    uint64_t age_sum;               // soma das esperas (ciclos) dessas chamadas
+    uint32_t age_max;
+    uint64_t emergency_cycles;      // ciclos com chamada em emergência
+    uint64_t pax_wait_ms;
+    uint64_t pax_waits;
+} BranchResult;
+
+static SimSnapshot snap;
+static SimSnapshot decoded;
+static SimBranch branch;
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [--cycles N] [--at-emergency W] [--horizon H] [--replicas R]\n"
+            "          [--threshold L] [--bonus L] [--stop-cost L] [--emergency L]\n"
+            "          [--full-max L] [--floors N] [--traffic low|medium|high]\n"
+            "          [--profile PERFIL] [--rate R] [--passengers]\n"
+            "          [--save arquivo.sss] [--load arquivo.sss] [--seed S]\n"
+            "  L = valor único ou intervalo inicio:fim:passo\n",
+            prog);
+}
+
+static int max_wait(const SimContext *ctx) {
+    int worst = 0;
+    FLOORSET_FOREACH(&ctx->reg.active, f) {
+        int w = sim_call_wait(ctx, f);
+        if (w > worst) worst = w;
+    }
+    return worst;
+}
+
+static int snapshot_max_wait(const SimSnapshot *s) {
+    int worst = 0;
+    FLOORSET_FOREACH(&s->reg.active, f) {
+        int w = hall_call_wait(&s->calls[f], s->wait_clock);
+        if (w > worst) worst = w;
+    }
+    return worst;
+}
+
+static void run_branch(SimContext *ctx, long long horizon, BranchResult *r) {
+    Stats before = ctx->stats;
+    for (long long c = 0; c < horizon; c++) {
+        sim_step(ctx);
+        r->cycles++;
+        FLOORSET_FOREACH(&ctx->reg.active, f) {
+            uint32_t w = (uint32_t)sim_call_wait(ctx, f);
+            r->waiting_sum++;
+            r->age_sum += w;
+            if (w > r->age_max) r->age_max = w;
+        }
+        if (sim_emergency_call(ctx) >= 0) r->emergency_cycles++;
+    }
+    r->boarded += (uint64_t)(ctx->stats.total_boarded - before.total_boarded);
+    r->stops += (uint64_t)(ctx->stats.total_stops - before.total_stops);
+    r->skipped += (uint64_t)(ctx->stats.skipped_stops - before.skipped_stops);
+}
+
+static bool same_state(const SimContext *a, const SimContext *b) {
+    return memcmp(&a->stats, &b->stats, sizeof(a->stats)) == 0 &&
+           memcmp(&a->elevator, &b->elevator, sizeof(a->elevator)) == 0 &&
+           memcmp(&a->rng, &b->rng, sizeof(a->rng)) == 0 &&
+           a->wait_clock == b->wait_clock &&
+           sim_clock_now_us(a->clock) == sim_clock_now_us(b->clock);
+}
+
+static bool save_file(const char *path, const uint8_t *buf, size_t len) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return false;
+    bool ok = fwrite(buf, 1, len, fp) == len;
+    return fclose(fp) == 0 && ok;
+}
+
+static uint8_t *load_file(const char *path, size_t *len) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return NULL;
+    uint8_t *buf = NULL;
+    long size = -1;
+    if (fseek(fp, 0, SEEK_END) == 0) size = ftell(fp);
+    if (size > 0 && fseek(fp, 0, SEEK_SET) == 0 && (buf = malloc((size_t)size)) != NULL) {
+        if (fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+            free(buf);
+            buf = NULL;
+        }
+    }
+    fclose(fp);
+    *len = (size_t)size;
+    return buf;
+}
+
+int main(int argc, char **argv) {
+    BuildingConfig building;
+    building_config_default(&building);
+
+    ValueList threshold = { { 0 }, 0 };
+    ValueList bonus = { { 0 }, 0 };
+    ValueList stop_cost = { { 0 }, 0 };
+    ValueList emergency = { { 0 }, 0 };
+    ValueList full_max = { { 0 }, 0 };
+    long long cycles = 5000;
+    int at_emergency = 0;
+    long long horizon = 2000;
+    int replicas = 1;
+    TrafficMode traffic = TRAFFIC_MEDIUM;
+    int profile = -1;
+    uint32_t rate = 0;
+    bool passengers = false;
+    const char *save_path = NULL;
+    const char *load_path = NULL;
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool ok = val != NULL;
+
+        if (strcmp(arg, "--passengers") == 0) {
+            passengers = true;
+            continue;
+        } else if (strcmp(arg, "--cycles") == 0 && val) {
+            cycles = atoll(val);
+        } else if (strcmp(arg, "--at-emergency") == 0 && val) {
+            at_emergency = atoi(val);
+        } else if (strcmp(arg, "--horizon") == 0 && val) {
+            horizon = atoll(val);
+        } else if (strcmp(arg, "--replicas") == 0 && val) {
+            replicas = atoi(val);
+        } else if (strcmp(arg, "--threshold") == 0 && val) {
+            ok = value_list_parse(val, &threshold);
+        } else if (strcmp(arg, "--bonus") == 0 && val) {
+            ok = value_list_parse(val, &bonus);
+        } else if (strcmp(arg, "--stop-cost") == 0 && val) {
+            ok = value_list_parse(val, &stop_cost);
+        } else if (strcmp(arg, "--emergency") == 0 && val) {
+            ok = value_list_parse(val, &emergency);
+        } else if (strcmp(arg, "--full-max") == 0 && val) {
+            ok = value_list_parse(val, &full_max);
+        } else if (strcmp(arg, "--floors") == 0 && val) {
+            building.num_floors = atoi(val);
+        } else if (strcmp(arg, "--traffic") == 0 && val) {
+            if (strcmp(val, "low") == 0) traffic = TRAFFIC_LOW;
+            else if (strcmp(val, "medium") == 0) traffic = TRAFFIC_MEDIUM;
+            else if (strcmp(val, "high") == 0) traffic = TRAFFIC_HIGH;
+            else ok = false;
+        } else if (strcmp(arg, "--profile") == 0 && val) {
+            profile = traffic_profile_parse(val);
+            ok = profile >= 0;
+        } else if (strcmp(arg, "--rate") == 0 && val) {
+            rate = (uint32_t)strtoul(val, NULL, 0);
+        } else if (strcmp(arg, "--save") == 0 && val) {
+            save_path = val;
+        } else if (strcmp(arg, "--load") == 0 && val) {
+            load_path = val;
+        } else if (strcmp(arg, "--seed") == 0 && val) {
+            seed = strtoull(val, NULL, 0);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    if (cycles < 0 || horizon < 1 || replicas < 1 || at_emergency < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!building_config_apply(&building)) {
+        fprintf(stderr, "Configuração inválida: andares 2..%d\n", MAX_FLOORS);
+        return 1;
+    }
+
+    // ---- Simulação base e fotografia ----
+    static SimClock base_clock;
+    static SimContext base;
+    static PassengerModel base_pax;
+    static TrafficProfile base_profile;
+    static TrafficSource base_source;
+    bool have_base = load_path == NULL;
+    long long warmup = 0;
+
+    if (have_base) {
+        sim_clock_init(&base_clock, SIM_CLOCK_FAST, 1.0f);
+        sim_init(&base, &building, &base_clock, traffic, seed, false);
+        if (passengers) {
+            sim_attach_passengers(&base, &base_pax);
+        }
+        if (profile >= 0) {
+            SimRng stream;
+            sim_traffic_stream(&base, &stream);
+            traffic_profile_init(&base_profile, &base_source, (TrafficProfileKind)profile,
+                                 building.num_floors, rate, &stream);
+            sim_attach_source(&base, &base_source);
+        }
+
+        // --at-emergency: --cycles vira o limite da procura
+        while (warmup < cycles && (at_emergency == 0 || max_wait(&base) < at_emergency)) {
+            sim_step(&base);
+            warmup++;
+        }
+        if (at_emergency > 0 && max_wait(&base) < at_emergency) {
+            fprintf(stderr, "Nenhuma chamada esperou %d ciclos em %lld ciclos\n",
+                    at_emergency, cycles);
+            return 1;
+        }
+        if (!sim_snapshot_take(&base, &snap)) {
+            fprintf(stderr, "Estado da simulação não pode ser fotografado\n");
+            return 1;
+        }
+    }
+
+    // Daqui em diante toda saída passa por done, que libera os buffers
+    int status = 1;
+    BranchResult *results = NULL;
+    size_t encoded_len = have_base ? sim_snapshot_encode(&snap, NULL, 0) : 0;
+    uint8_t *encoded = have_base ? malloc(encoded_len) : load_file(load_path, &encoded_len);
+    if (!encoded) {
+        fprintf(stderr, have_base ? "Sem memória para a fotografia\n"
+                                  : "Não foi possível ler %s\n", load_path);
+        goto done;
+    }
+    if (have_base) sim_snapshot_encode(&snap, encoded, encoded_len);
+
+    const char *error = NULL;
+    if (!sim_snapshot_decode(&decoded, encoded, encoded_len, &error)) {
+        fprintf(stderr, "Fotografia inválida: %s\n", error);
+        goto done;
+    }
+    if (!have_base) snap = decoded;
+    if (save_path && !save_file(save_path, encoded, encoded_len)) {
+        fprintf(stderr, "Não foi possível gravar %s\n", save_path);
+        goto done;
+    }
+
+    // Custo de fotografar, abrir um ramo e codificar (média de repetições)
+    double take_us = 0.0;
+    if (have_base) {
+        uint64_t t0 = hal_time_us();
+        for (int k = 0; k < FORK_TIMING_REPS; k++) sim_snapshot_take(&base, &snap);
+        take_us = (double)(hal_time_us() - t0) / FORK_TIMING_REPS;
+    }
+    uint64_t t0 = hal_time_us();
+    for (int k = 0; k < FORK_TIMING_REPS; k++) sim_branch_init(&branch, &snap);
+    double fork_us = (double)(hal_time_us() - t0) / FORK_TIMING_REPS;
+    t0 = hal_time_us();
+    for (int k = 0; k < FORK_TIMING_REPS; k++) sim_snapshot_encode(&snap, encoded, encoded_len);
+    double encode_us = (double)(hal_time_us() - t0) / FORK_TIMING_REPS;
+    t0 = hal_time_us();
+    for (int k = 0; k < FORK_TIMING_REPS; k++) sim_snapshot_decode(&decoded, encoded, encoded_len, NULL);
+    double decode_us = (double)(hal_time_us() - t0) / FORK_TIMING_REPS;
+
+    // ---- Conferência: ramo da fotografia lida de volta == base ----
+    bool identical = false;
+    if (have_base) {
+        sim_branch_init(&branch, &decoded);
+        for (long long c = 0; c < horizon; c++) {
+            sim_step(&base);
+            sim_step(&branch.sim);
+        }
+        identical = same_state(&base, &branch.sim) &&
+                    (!passengers || memcmp(&base_pax, &branch.pax, sizeof(base_pax)) == 0);
+    }
+
+    // ---- Ramos ----
+    value_list_default(&threshold, snap.cfg.efficiency_threshold);
+    value_list_default(&bonus, snap.cfg.wait_bonus);
+    value_list_default(&stop_cost, snap.cfg.stop_cost);
+    value_list_default(&emergency, snap.cfg.emergency_wait_time);
+    value_list_default(&full_max, snap.cfg.cycles_full_max);
+
+    int num_branches = threshold.n * bonus.n * stop_cost.n * emergency.n * full_max.n;
+    results = calloc((size_t)num_branches, sizeof(BranchResult));
+    if (!results) {
+        fprintf(stderr, "Sem memória para %d ramos\n", num_branches);
+        goto done;
+    }
+
+    uint64_t run_start = hal_time_us();
+    int p = 0;
+    for (int a = 0; a < threshold.n; a++)
+    for (int b = 0; b < bonus.n; b++)
+    for (int c = 0; c < stop_cost.n; c++)
+    for (int d = 0; d < emergency.n; d++)
+    for (int e = 0; e < full_max.n; e++) {
+        BranchResult *r = &results[p];
+        r->cfg = snap.cfg;
+        r->cfg.efficiency_threshold = (float)threshold.v[a];
+        r->cfg.wait_bonus = (float)bonus.v[b];
+        r->cfg.stop_cost = (float)stop_cost.v[c];
+        r->cfg.emergency_wait_time = (int)emergency.v[d];
+        r->cfg.cycles_full_max = (int)full_max.v[e];
+
+        for (int k = 0; k < replicas; k++) {
+            sim_branch_init(&branch, &snap);
+            if (!sim_branch_configure(&branch, &r->cfg)) {
+                fprintf(stderr, "Ramo inválido (#%d)\n", p);
+                goto done;
+            }
+            for (int j = 0; j < k; j++) {
+                sim_rng_jump(&branch.sim.rng);
+                if (snap.has_profile) sim_rng_jump(&branch.profile.rng);
+            }
+            run_branch(&branch.sim, horizon, r);
+            if (snap.has_pax) {
+                r->pax_wait_ms += branch.pax.wait.sum_ms - snap.pax.wait.sum_ms;
+                r->pax_waits += branch.pax.wait.count - snap.pax.wait.count;
+            }
+        }
+        p++;
+    }
+    double run_s = (double)(hal_time_us() - run_start) / 1e6;
+
+    // ---- Relatório ----
+    static const char *const traffic_names[] = { "low", "medium", "high" };
+    printf("=== Fotografia e ramos \"e se\" ===\n");
+    printf("Prédio: %d andares, capacidade %d | tráfego %s%s%s\n", snap.cfg.num_floors,
+           snap.cfg.car_capacity,
+           snap.has_profile ? traffic_profile_name(snap.profile.kind) : traffic_names[snap.mode],
+           snap.has_profile ? " (perfil)" : " por ciclo",
+           snap.has_pax ? ", passageiros individuais" : "");
+    if (have_base) {
+        printf("Fotografia no ciclo %lld (%lld ciclos de aquecimento, semente %llu)\n",
+               (long long)snap.total_cycles, warmup, (unsigned long long)seed);
+    } else {
+        printf("Fotografia lida de %s (ciclo %lld)\n", load_path, (long long)snap.total_cycles);
+    }
+    printf("Chamadas esperando: %d | maior espera: %d ciclos | emergências: %d\n",
+           floorset_count(&snap.reg.active), snapshot_max_wait(&snap), snap.order.emergencies);
+    printf("Estado: %zu bytes em memória, %zu bytes codificado\n", sizeof(SimSnapshot),
+           encoded_len);
+    if (have_base) printf("Fotografar:       %8.2f us\n", take_us);
+    printf("Abrir um ramo:    %8.2f us\n", fork_us);
+    printf("Codificar:        %8.2f us\n", encode_us);
+    printf("Ler codificação:  %8.2f us\n", decode_us);
+    if (have_base) {
+        printf("Ramo da fotografia codificada x base (%lld ciclos): %s\n", horizon,
+               identical ? "idêntico" : "DIFERENTE");
+    }
+    printf("%d ramos x %d réplicas x %lld ciclos em %.3f s\n\n", num_branches, replicas,
+           horizon, run_s);
+
+    printf("threshold,wait_bonus,stop_cost,emergency_wait,cycles_full_max,"
+           "cycles,boarded,stops,skipped,waiting_mean,wait_mean,wait_max,"
+           "emergency_cycles,pax_wait_s\n");
+    for (int i = 0; i < num_branches; i++) {
+        const BranchResult *r = &results[i];
+        printf("%.4f,%.4f,%.4f,%d,%d,%llu,%llu,%llu,%llu,%.3f,%.2f,%u,%llu,%.1f\n",
+               r->cfg.efficiency_threshold, r->cfg.wait_bonus, r->cfg.stop_cost,
+               r->cfg.emergency_wait_time, r->cfg.cycles_full_max,
+               (unsigned long long)r->cycles, (unsigned long long)r->boarded,
+               (unsigned long long)r->stops, (unsigned long long)r->skipped,
+               r->cycles ? (double)r->waiting_sum / r->cycles : 0.0,
+               r->waiting_sum ? (double)r->age_sum / r->waiting_sum : 0.0, r->age_max,
+               (unsigned long long)r->emergency_cycles,
+               r->pax_waits ? (double)r->pax_wait_ms / r->pax_waits / 1000.0 : 0.0);
+    }
+
+    status = have_base && !identical ? 1 : 0;
+
+done:
+    free(results);
+    free(encoded);
+    return status;
+}
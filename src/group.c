@@ -0,0 +1,248 @@
+/*
+ * Controle de grupo (vários carros) do SmartStop
+ *
+ * A cada ciclo todas as chamadas ativas são (re)atribuídas. O custo é
+ * O(andares x carros), limitado por num_floors x GROUP_MAX_CARS, e o tempo
+ * gasto na atribuição é medido e acumulado em GroupSim.
+ */
+
+#include "group.h"
+#include "dispatch.h"
+#include "hal.h"
+
+#include <stdio.h>
+
+void group_init(GroupSim *g, const BuildingConfig *cfg, int num_cars,
+                SimClock *clock, TrafficMode mode, uint64_t seed, bool verbose) {
+    g->cfg = *cfg;
+
+    ElevatorState first;
+    smartstop_init(&g->cfg, g->calls, &g->active, &first, &g->stats);
+    g->wait_clock = 0;
+    const int top = g->cfg.num_floors - 1;
+
+    if (num_cars < 1) num_cars = 1;
+    if (num_cars > GROUP_MAX_CARS) num_cars = GROUP_MAX_CARS;
+
+    CarBank *cars = &g->cars;
+    cars->num_cars = num_cars;
+    for (int c = 0; c < num_cars; c++) {
+        // distribui os carros ao longo do prédio
+        cars->floor[c] = (c * top) / (num_cars > 1 ? num_cars - 1 : 1);
+        cars->direction[c] = (c % 2 == 0) ? 1 : -1;
+        cars->occupancy[c] = 0;
+        cars->target[c] = -1;
+        cars->committed[c] = 0;
+        cars->stops[c] = 0;
+    }
+
+    for (int i = 0; i < g->cfg.num_floors; i++) {
+        g->assigned_car[i] = -1;
+    }
+
+    g->mode = mode;
+    sim_rng_seed(&g->rng, seed);
+    g->clock = clock;
+    g->verbose = verbose;
+    g->decisions = 0;
+    g->decision_ns_last = 0;
+    g->decision_ns_total = 0;
+    g->decision_ns_max = 0;
+}
+
+void group_assign_calls(GroupSim *g) {
+    CarBank *cars = &g->cars;
+    const int n = cars->num_cars;
+
+    for (int c = 0; c < n; c++) {
+        cars->committed[c] = 0;
+    }
+
+    for (int i = 0; i < g->cfg.num_floors; i++) {
+        g->assigned_car[i] = -1;
+    }
+
+    FLOORSET_FOREACH(&g->active, i) {
+        const HallCall *call = &g->calls[i];
+
+        float best_eff = -1.0f;
+        int best_car = -1;
+
+        // Pontua o par (chamada, carro) para todos os carros
+        for (int c = 0; c < n; c++) {
+            int delta = i - cars->floor[c];
+            int dist = (delta >= 0) ? delta : -delta;
+
+            // Carro em movimento com a chamada atrás dele precisa inverter
+            int behind = (cars->target[c] >= 0) && (delta * cars->direction[c] < 0);
+
+            // Cada chamada já assumida pelo carro conta como uma parada extra
+            int distance = dist + behind * GROUP_REVERSAL_COST + cars->committed[c];
+
+            float eff = smartstop_efficiency(&g->cfg, call->est_passengers, distance,
+                                             hall_call_wait(call, g->wait_clock));
+            if (cars->occupancy[c] >= g->cfg.car_capacity) {
+                eff = -1.0f;   // lotado: não assume novas chamadas
+            }
+
+            if (eff > best_eff) {
+                best_eff = eff;
+                best_car = c;
+            }
+        }
+
+        g->assigned_car[i] = (best_eff >= 0.0f) ? best_car : -1;
+        if (g->assigned_car[i] >= 0) {
+            cars->committed[best_car]++;
+        }
+    }
+}
+
+// Próxima parada do carro: chamada atribuída mais próxima na direção atual,
+// senão a mais próxima em qualquer direção
+static int next_target(const GroupSim *g, int car) {
+    const CarBank *cars = &g->cars;
+    int best_floor = -1;
+    int best_dist = 999;
+    bool best_ahead = false;
+
+    for (int i = 0; i < g->cfg.num_floors; i++) {
+        if (g->assigned_car[i] != car) continue;
+
+        int delta = i - cars->floor[car];
+        int dist = (delta >= 0) ? delta : -delta;
+        bool ahead = (delta * cars->direction[car] >= 0);
+
+        if ((ahead && !best_ahead) ||
+            (ahead == best_ahead && dist < best_dist)) {
+            best_floor = i;
+            best_dist = dist;
+            best_ahead = ahead;
+        }
+    }
+    return best_floor;
+}
+
+// Desembarque probabilístico (sem destino individual por passageiro)
+static void car_disembark(GroupSim *g, int car, int probability) {
+    CarBank *cars = &g->cars;
+    if (cars->occupancy[car] > 0 && sim_rng_below(&g->rng, 100) < probability) {
+        int out = MIN_DISEMBARK_PASSENGERS +
+                  sim_rng_below(&g->rng, MAX_DISEMBARK_PASSENGERS - MIN_DISEMBARK_PASSENGERS + 1);
+        if (out > cars->occupancy[car]) out = cars->occupancy[car];
+        cars->occupancy[car] -= out;
+    }
+}
+
+// Carro sem chamada atribuída mas com passageiros: segue varrendo o prédio
+static void car_sweep(GroupSim *g, int car) {
+    CarBank *cars = &g->cars;
+    const int top = g->cfg.num_floors - 1;
+
+    car_disembark(g, car, 15);
+
+    cars->floor[car] += cars->direction[car];
+    if (cars->floor[car] <= 0) {
+        cars->floor[car] = 0;
+        cars->direction[car] = 1;
+    } else if (cars->floor[car] >= top) {
+        cars->floor[car] = top;
+        cars->direction[car] = -1;
+    }
+}
+
+static void car_stop(GroupSim *g, int car, int floor) {
+    CarBank *cars = &g->cars;
+    HallCall *call = &g->calls[floor];
+
+    car_disembark(g, car, 35);
+
+    int available = g->cfg.car_capacity - cars->occupancy[car];
+    int boarded = call->est_passengers;
+    if (boarded > available) boarded = available;
+    if (boarded < 0) boarded = 0;
+
+    cars->occupancy[car] += boarded;
+    cars->stops[car]++;
+    g->stats.total_boarded += boarded;
+    g->stats.total_stops++;
+
+    if (g->verbose) {
+        printf("  [GRUPO] Carro %d parou no andar %d: %d embarque(s), ocupação %d/%d\n",
+               car, floor, boarded, cars->occupancy[car], g->cfg.car_capacity);
+    }
+
+    call->est_passengers -= boarded;
+    if (call->est_passengers <= 0) {
+        call->active = false;
+        call->est_passengers = 0;
+        floorset_reset(&g->active, floor);
+        g->assigned_car[floor] = -1;
+    }
+}
+
+void group_step(GroupSim *g) {
+    CarBank *cars = &g->cars;
+
+    g->stats.total_cycles++;
+
+    // Nenhum andar é excluído da geração: vários carros dividem o prédio
+    ElevatorState none = { .current_floor = -1, .direction = 1, .occupancy = 0 };
+    g->wait_clock++;
+    generate_random_hall_calls(&g->cfg, &g->rng, g->calls, &g->active, &none, g->mode,
+                               g->wait_clock);
+    cleanup_empty_calls(g->calls, &g->active, &g->active);
+
+    uint64_t t0 = hal_time_ns();
+    group_assign_calls(g);
+    for (int c = 0; c < cars->num_cars; c++) {
+        cars->target[c] = next_target(g, c);
+    }
+    uint64_t dt = hal_time_ns() - t0;
+
+    g->decisions++;
+    g->decision_ns_last = dt;
+    g->decision_ns_total += dt;
+    if (dt > g->decision_ns_max) g->decision_ns_max = dt;
+
+    for (int c = 0; c < cars->num_cars; c++) {
+        int target = cars->target[c];
+        if (target < 0) {
+            // vazio: aguarda no andar; com passageiros: segue viagem
+            if (cars->occupancy[c] > 0) car_sweep(g, c);
+            continue;
+        }
+
+        if (target == cars->floor[c]) {
+            car_stop(g, c, target);
+            continue;
+        }
+
+        cars->direction[c] = (target > cars->floor[c]) ? 1 : -1;
+        cars->floor[c] += cars->direction[c];
+
+        int f = cars->floor[c];
+        if (f != target && floorset_test(&g->active, f)) {
+            g->stats.skipped_stops++;
+        }
+    }
+
+    sim_clock_sleep_ms(g->clock, g->cfg.travel_time_ms);
+}
+
+void group_print_report(const GroupSim *g) {
+    const CarBank *cars = &g->cars;
+
+    printf("\n--- Controle de grupo (%d carros) ---\n", cars->num_cars);
+    for (int c = 0; c < cars->num_cars; c++) {
+        printf("Carro %d: andar %2d | ocupação %d/%d | paradas: %d\n",
+               c, cars->floor[c], cars->occupancy[c], g->cfg.car_capacity, cars->stops[c]);
+    }
+    if (g->decisions > 0) {
+        printf("Atribuições: %llu | tempo médio: %.0f ns | pior caso: %llu ns\n",
+               (unsigned long long)g->decisions,
+               (double)g->decision_ns_total / (double)g->decisions,
+               (unsigned long long)g->decision_ns_max);
+    }
+    printf("------------------------------------\n");
+}
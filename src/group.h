@@ -0,0 +1,60 @@
+#ifndef GROUP_H
+#define GROUP_H
+
+#include <stdint.h>
+
+#include "smartstop.h"
+#include "sim_clock.h"
+
+// Controle de grupo: um banco de N carros atendendo as mesmas hall calls.
+// Cada chamada ativa é atribuída a exatamente um carro, usando a eficiência
+// SmartStop (passageiros / custo) calculada para cada par (chamada, carro).
+
+#define GROUP_MAX_CARS 8
+#define GROUP_REVERSAL_COST 4   // andares extras se a chamada está "atrás" do carro
+
+// Estado dos carros em structure-of-arrays: o laço de pontuação percorre
+// um vetor contíguo por campo em vez de saltar entre structs
+typedef struct {
+    int num_cars;
+    int floor[GROUP_MAX_CARS];
+    int direction[GROUP_MAX_CARS];   // +1 subindo, -1 descendo
+    int occupancy[GROUP_MAX_CARS];
+    int target[GROUP_MAX_CARS];      // próxima parada (-1 = ocioso)
+    int committed[GROUP_MAX_CARS];   // chamadas atribuídas no ciclo atual
+    int stops[GROUP_MAX_CARS];       // paradas realizadas por carro
+} CarBank;
+
+typedef struct {
+    BuildingConfig cfg;
+    HallCall calls[MAX_FLOORS];
+    FloorSet active;                 // andares com hall call ativa
+    uint32_t wait_clock;             // relógio de espera (HallCall.arrival)
+    int assigned_car[MAX_FLOORS];    // carro responsável por cada andar (-1 = nenhum)
+    CarBank cars;
+    Stats stats;
+
+    TrafficMode mode;
+    SimRng rng;                      // gerador próprio (sim_rng_seed)
+    SimClock *clock;
+    bool verbose;
+
+    // Custo computacional da atribuição (por ciclo)
+    uint64_t decisions;
+    uint64_t decision_ns_last;
+    uint64_t decision_ns_total;
+    uint64_t decision_ns_max;
+} GroupSim;
+
+void group_init(GroupSim *g, const BuildingConfig *cfg, int num_cars,
+                SimClock *clock, TrafficMode mode, uint64_t seed, bool verbose);
+
+// Atribui cada chamada ativa ao carro de maior eficiência
+void group_assign_calls(GroupSim *g);
+
+// Um ciclo do grupo: tráfego, atribuição e um andar de deslocamento por carro
+void group_step(GroupSim *g);
+
+void group_print_report(const GroupSim *g);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Camada mínima de hardware usada pela lógica de despacho.
+// hal_pico.c implementa sobre o Pico SDK; hal_host.c sobre POSIX (Linux).
+
+// Tempo monotônico em microssegundos desde o boot / início do processo
+uint64_t hal_time_us(void);
+
+// Tempo monotônico em nanossegundos (no Pico a resolução é de 1 us)
+uint64_t hal_time_ns(void);
+
+// Bloqueia a execução pelo tempo indicado (tempo real)
+void hal_sleep_us(uint64_t us);
+
+// Uma volta de espera ativa (cede a CPU no host)
+void hal_cpu_relax(void);
+
+// Bytes que a saída de texto aceita agora sem bloquear
+// (USB CDC no Pico; no host, ilimitado)
+int hal_console_room(void);
+
+// LED RGB da BitDogLab (no host não faz nada)
+void hal_set_rgb(bool r, bool g, bool b);
+
+#endif
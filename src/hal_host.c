@@ -0,0 +1,43 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "hal.h"
+
+#include <limits.h>
+#include <sched.h>
+#include <time.h>
+
+uint64_t hal_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+uint64_t hal_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void hal_sleep_us(uint64_t us) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(us / 1000000u);
+    ts.tv_nsec = (long)(us % 1000000u) * 1000L;
+    while (nanosleep(&ts, &ts) != 0) {
+        // interrompido por sinal: continua dormindo o restante
+    }
+}
+
+void hal_cpu_relax(void) {
+    sched_yield();
+}
+
+int hal_console_room(void) {
+    return INT_MAX;
+}
+
+void hal_set_rgb(bool r, bool g, bool b) {
+    // Sem LED no host
+    (void)r;
+    (void)g;
+    (void)b;
+}
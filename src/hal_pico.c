@@ -0,0 +1,41 @@
+#include "hal.h"
+
+#include <limits.h>
+
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "hardware/gpio.h"
+#include "tusb.h"
+
+// LEDs RGB da BitDogLab
+#define LED_R 13
+#define LED_G 11
+#define LED_B 12
+
+uint64_t hal_time_us(void) {
+    return time_us_64();
+}
+
+uint64_t hal_time_ns(void) {
+    return time_us_64() * 1000u;
+}
+
+void hal_sleep_us(uint64_t us) {
+    sleep_us(us);
+}
+
+void hal_cpu_relax(void) {
+    tight_loop_contents();
+}
+
+int hal_console_room(void) {
+    // Sem terminal aberto o stdio_usb descarta a saída sem esperar
+    if (!stdio_usb_connected()) return INT_MAX;
+    return (int)tud_cdc_write_available();
+}
+
+void hal_set_rgb(bool r, bool g, bool b) {
+    gpio_put(LED_R, r ? 1 : 0);
+    gpio_put(LED_G, g ? 1 : 0);
+    gpio_put(LED_B, b ? 1 : 0);
+}
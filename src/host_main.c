@@ -0,0 +1,610 @@
+/*
+ * SmartStop Elevator Simulator - build headless para Linux
+ *
+ * Roda a mesma lógica de despacho do firmware (dispatch.c + smartstop.c)
+ * sem o Pico. O relógio pode ser real, acelerado ou virtual ("fast"),
+ * permitindo simular milhões de ciclos em poucos segundos.
+ *
+ * Uso:
+ *   smartstop_host [--cycles N] [--clock fast|realtime|scaled]
+ *                  [--scale X] [--traffic low|medium|high] [--verbose]
+ *                  [--cars N] [--floors N] [--capacity N] [--seed S]
+ *                  [--trace arquivo.sst] [--log direct|deferred]
+ *                  [--split] [--meter] [--press MS]
+ *                  [--engine cycle|event|motion] [--duration S] [--passengers]
+ *                  [--profile up-peak|down-peak|interfloor|lunch|day]
+ *                  [--rate R] [--replay arquivo]
+ *                  [--lookahead H] [--budget US] [--policy SPEC]
+ *                  [--stages] [--deadline US] [--metrics arquivo.ssc]
+ *
+ * Com a mesma semente o traço é idêntico ao do firmware compilado com
+ * -DSMARTSTOP_SEED=S.
+ *
+ * Com --cars N (N > 1) roda o controle de grupo (group.c) em vez do
+ * elevador único.
+ *
+ * Com --trace grava o traço binário de eventos (trace.h), lido por
+ * smartstop_trace.
+ *
+ * --log deferred usa o mesmo caminho do firmware (anel deflog.h, esvaziado
+ * a cada ciclo); a saída é idêntica à de --log direct.
+ *
+ * --split reproduz o firmware com SMARTSTOP_DUAL_CORE: tráfego e log numa
+ * segunda thread (offload.c), no papel do núcleo 1. --meter mede o
+ * trabalho por ciclo do laço de controle e o atraso das pausas.
+ *
+ * --press MS simula a interrupção dos botões: uma thread põe uma pressão
+ * (alternando A e B) na fila de botões a cada MS ms de tempo real, e o
+ * relatório mostra a latência até o registro e até o atendimento.
+ *
+ * --engine event troca o laço de ciclos pelo motor de eventos discretos
+ * (event_sim.c): roda --duration segundos simulados (padrão: 30 dias) e
+ * relata eventos por segundo e a espera dos passageiros em ms.
+ *
+ * --engine motion roda o controle por prazos (motion.c): viagem, portas e
+ * LED sem pausas, com nova decisão a cada andar. --cycles conta os tiques
+ * de tráfego (MOTION_TICK_MS). O relatório traz as decisões por minuto
+ * simulado, que o laço de ciclos também mostra para comparar.
+ *
+ * --passengers liga o modelo de passageiros individuais (passenger.h), com
+ * origem e destino; o relatório traz as distribuições de espera e viagem.
+ *
+ * --profile troca o sorteio por --traffic por um perfil de chegadas por
+ * hora do dia (traffic_source.h), com R grupos por hora no pico (--rate).
+ * --replay reproduz um traço de chegadas gravado (binário de
+ * smartstop_traffic ou CSV), lido do disco em sequência; no motor de
+ * eventos a simulação termina junto com o traço.
+ *
+ * --lookahead H decide pela busca de sequências de até H paradas
+ * (lookahead.c), com no máximo US microssegundos por decisão (--budget;
+ * padrão 0 = sem limite, resultado reprodutível pela semente).
+ *
+ * --policy monta o despacho por estágios (policy.h): "cascade", "lookahead"
+ * ou uma lista como "emergency,button,internal,smartstop,empty". O
+ * relatório traz as decisões por regra e o custo por decisão. O estágio
+ * lookahead usa o horizonte de --lookahead (padrão 4). Para comparar
+ * políticas no mesmo tráfego, use smartstop_ab.
+ *
+ * --stages (build com -DSMARTSTOP_PROFILE=ON) mede o tempo de cada estágio
+ * de sim_step (stageprof.h) e relata média, p50, p99 e pior caso, e as
+ * iterações com trabalho acima de --deadline US (padrão 1000).
+ *
+ * --metrics grava as colunas por ciclo de analisar_smartstop.py numa
+ * tabela colunar em blocos (cycle_table.h) e relata as métricas de
+ * calcular_metricas, calculadas na mesma passada.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dispatch.h"
+#include "event_sim.h"
+#include "group.h"
+#include "hal.h"
+#include "lookahead.h"
+#include "motion.h"
+#include "offload.h"
+#include "policy.h"
+#include "stageprof.h"
+#include "traffic_replay.h"
+
+static void file_sink(void *user, const void *data, size_t len) {
+    fwrite(data, 1, len, (FILE *)user);
+}
+
+static atomic_bool offload_stop;
+
+// Papel do núcleo 1
+static void *offload_thread(void *arg) {
+    SimOffload *o = arg;
+    while (!atomic_load(&offload_stop)) {
+        if (!sim_offload_poll(o)) hal_cpu_relax();
+    }
+    // esvazia o log restante
+    while (sim_offload_poll(o)) {
+    }
+    return NULL;
+}
+
+static atomic_bool presser_stop;
+
+typedef struct {
+    ButtonQueue *queue;
+    uint32_t period_us;
+} Presser;
+
+// Papel da interrupção dos botões
+static void *presser_thread(void *arg) {
+    Presser *p = arg;
+    ButtonId next = BUTTON_ID_A;
+    while (!atomic_load(&presser_stop)) {
+        hal_sleep_us(p->period_us);
+        button_queue_push(p->queue, next, hal_time_us());
+        next = next == BUTTON_ID_A ? BUTTON_ID_B : BUTTON_ID_A;
+    }
+    return NULL;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [--cycles N] [--clock fast|realtime|scaled] [--scale X]\n"
+            "          [--traffic low|medium|high] [--verbose] [--cars N]\n"
+            "          [--floors N] [--capacity N] [--seed S] [--trace ARQ]\n"
+            "          [--log direct|deferred] [--split] [--meter] [--press MS]\n"
+            "          [--engine cycle|event|motion] [--duration S] [--passengers]\n"
+            "          [--profile up-peak|down-peak|interfloor|lunch|day] [--rate R]\n"
+            "          [--replay ARQ] [--lookahead H] [--budget US] [--policy SPEC]\n"
+            "          [--stages] [--deadline US] [--metrics ARQ]\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    long long cycles = 1000000;
+    SimClockMode clock_mode = SIM_CLOCK_FAST;
+    float scale = 1.0f;
+    TrafficMode traffic = TRAFFIC_MEDIUM;
+    bool verbose = false;
+    int cars = 1;
+    uint64_t seed = hal_time_us();
+    const char *trace_path = NULL;
+    bool deferred_log = false;
+    bool split = false;
+    bool meter = false;
+    int press_ms = 0;
+    bool event_engine = false;
+    bool motion_engine = false;
+    double duration_s = 30.0 * 86400.0;
+    bool passengers = false;
+    int profile = -1;
+    uint32_t rate = 0;
+    const char *replay_path = NULL;
+    int horizon = 0;
+    uint32_t budget_us = 0;
+    const char *policy_spec = NULL;
+    bool stages = false;
+    uint32_t deadline_us = PROF_DEFAULT_DEADLINE_US;
+    const char *metrics_path = NULL;
+    BuildingConfig building;
+
+    building_config_default(&building);
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--cycles") == 0 && val) {
+            cycles = atoll(val);
+            i++;
+        } else if (strcmp(arg, "--clock") == 0 && val) {
+            if (strcmp(val, "fast") == 0) {
+                clock_mode = SIM_CLOCK_FAST;
+            } else if (strcmp(val, "realtime") == 0) {
+                clock_mode = SIM_CLOCK_REALTIME;
+            } else if (strcmp(val, "scaled") == 0) {
+                clock_mode = SIM_CLOCK_SCALED;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(arg, "--scale") == 0 && val) {
+            scale = (float)atof(val);
+            i++;
+        } else if (strcmp(arg, "--traffic") == 0 && val) {
+            if (strcmp(val, "low") == 0) {
+                traffic = TRAFFIC_LOW;
+            } else if (strcmp(val, "medium") == 0) {
+                traffic = TRAFFIC_MEDIUM;
+            } else if (strcmp(val, "high") == 0) {
+                traffic = TRAFFIC_HIGH;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(arg, "--cars") == 0 && val) {
+            cars = atoi(val);
+            if (cars < 1 || cars > GROUP_MAX_CARS) {
+                fprintf(stderr, "--cars deve estar entre 1 e %d\n", GROUP_MAX_CARS);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(arg, "--floors") == 0 && val) {
+            building.num_floors = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--capacity") == 0 && val) {
+            building.car_capacity = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--seed") == 0 && val) {
+            seed = strtoull(val, NULL, 0);
+            i++;
+        } else if (strcmp(arg, "--trace") == 0 && val) {
+            trace_path = val;
+            i++;
+        } else if (strcmp(arg, "--log") == 0 && val) {
+            if (strcmp(val, "direct") == 0) {
+                deferred_log = false;
+            } else if (strcmp(val, "deferred") == 0) {
+                deferred_log = true;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(arg, "--split") == 0) {
+            split = true;
+        } else if (strcmp(arg, "--meter") == 0) {
+            meter = true;
+        } else if (strcmp(arg, "--press") == 0 && val) {
+            press_ms = atoi(val);
+            if (press_ms < 1) {
+                fprintf(stderr, "--press deve ser >= 1 ms\n");
+                return 1;
+            }
+            i++;
+        } else if (strcmp(arg, "--engine") == 0 && val) {
+            if (strcmp(val, "cycle") == 0) {
+                event_engine = false;
+                motion_engine = false;
+            } else if (strcmp(val, "event") == 0) {
+                event_engine = true;
+                motion_engine = false;
+            } else if (strcmp(val, "motion") == 0) {
+                event_engine = false;
+                motion_engine = true;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(arg, "--duration") == 0 && val) {
+            duration_s = atof(val);
+            i++;
+        } else if (strcmp(arg, "--profile") == 0 && val) {
+            profile = traffic_profile_parse(val);
+            if (profile < 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(arg, "--rate") == 0 && val) {
+            rate = (uint32_t)strtoul(val, NULL, 0);
+            i++;
+        } else if (strcmp(arg, "--replay") == 0 && val) {
+            replay_path = val;
+            i++;
+        } else if (strcmp(arg, "--lookahead") == 0 && val) {
+            horizon = atoi(val);
+            if (horizon < 1 || horizon > LOOKAHEAD_MAX_HORIZON) {
+                fprintf(stderr, "--lookahead deve estar entre 1 e %d\n", LOOKAHEAD_MAX_HORIZON);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(arg, "--budget") == 0 && val) {
+            budget_us = (uint32_t)strtoul(val, NULL, 0);
+            i++;
+        } else if (strcmp(arg, "--policy") == 0 && val) {
+            policy_spec = val;
+            i++;
+        } else if (strcmp(arg, "--stages") == 0) {
+            stages = true;
+        } else if (strcmp(arg, "--deadline") == 0 && val) {
+            deadline_us = (uint32_t)strtoul(val, NULL, 0);
+            i++;
+        } else if (strcmp(arg, "--metrics") == 0 && val) {
+            metrics_path = val;
+            i++;
+        } else if (strcmp(arg, "--passengers") == 0) {
+            passengers = true;
+        } else if (strcmp(arg, "--verbose") == 0) {
+            verbose = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!building_config_apply(&building)) {
+        fprintf(stderr, "Configuração inválida: andares 2..%d, capacidade >= 1\n", MAX_FLOORS);
+        return 1;
+    }
+
+    if ((trace_path || split || meter || press_ms || passengers) && cars > 1) {
+        fprintf(stderr, "--trace, --split, --meter, --press e --passengers só são suportados "
+                        "com um carro\n");
+        return 1;
+    }
+
+    if (profile >= 0 && replay_path) {
+        fprintf(stderr, "--profile e --replay são excludentes\n");
+        return 1;
+    }
+
+    if ((horizon || policy_spec) && cars > 1) {
+        fprintf(stderr, "--lookahead e --policy só são suportados com um carro\n");
+        return 1;
+    }
+
+    if ((profile >= 0 || replay_path) && (cars > 1 || split)) {
+        fprintf(stderr, "--profile e --replay não suportam --cars nem --split\n");
+        return 1;
+    }
+
+#ifndef SMARTSTOP_PROFILE
+    if (stages) {
+        fprintf(stderr, "--stages requer o build com -DSMARTSTOP_PROFILE=ON\n");
+        return 1;
+    }
+#endif
+    if (stages && (cars > 1 || event_engine || motion_engine)) {
+        fprintf(stderr, "--stages só mede o laço de ciclos com um carro\n");
+        return 1;
+    }
+    if (metrics_path && (cars > 1 || event_engine)) {
+        fprintf(stderr, "--metrics só grava o laço de ciclos com um carro\n");
+        return 1;
+    }
+
+    if (event_engine && (cars > 1 || split || meter || press_ms)) {
+        fprintf(stderr, "--engine event não suporta --cars, --split, --meter nem --press\n");
+        return 1;
+    }
+    if (motion_engine && (cars > 1 || split || meter)) {
+        fprintf(stderr, "--engine motion não suporta --cars, --split nem --meter\n");
+        return 1;
+    }
+
+    static SimClock clock;
+    static SimContext sim;
+    static GroupSim group;
+    static TraceWriter trace;
+    static DeferredLog log;
+    static SimOffload offload;
+    static LoopMeter loop;
+    static ButtonQueue buttons;
+    static Presser presser;
+    static EventSim events;
+    static SimMotion motion;
+    static PassengerModel pax;
+    static TrafficProfile traffic_profile;
+    static TrafficReplay replay;
+    static Lookahead lookahead;
+    static DispatchPolicy policy;
+    static StageProfiler prof;
+    static CycleTable table;
+    TrafficSource source;
+    pthread_t offload_tid;
+    bool offload_started = false;
+    pthread_t presser_tid;
+    bool presser_started = false;
+    FILE *trace_file = NULL;
+    FILE *metrics_file = NULL;
+
+    sim_clock_init(&clock, clock_mode, scale);
+
+    uint64_t start_us = hal_time_us();
+    if (cars > 1) {
+        group_init(&group, &building, cars, &clock, traffic, seed, verbose);
+        for (long long c = 0; c < cycles; c++) {
+            group_step(&group);
+        }
+    } else {
+        sim_init(&sim, &building, &clock, traffic, seed, verbose);
+        if (passengers) {
+            sim_attach_passengers(&sim, &pax);
+        }
+        if (policy_spec) {
+            lookahead_init(&lookahead, horizon ? horizon : 4, budget_us);
+            if (!dispatch_policy_parse(&policy, policy_spec, policy_spec, &lookahead)) {
+                return 1;
+            }
+            policy.timed = true;
+            sim.policy = &policy;
+        } else if (horizon) {
+            lookahead_init(&lookahead, horizon, budget_us);
+            sim.lookahead = &lookahead;
+        }
+        if (profile >= 0) {
+            SimRng stream;
+            sim_traffic_stream(&sim, &stream);
+            traffic_profile_init(&traffic_profile, &source, (TrafficProfileKind)profile,
+                                 sim.cfg.num_floors, rate, &stream);
+            sim_attach_source(&sim, &source);
+        } else if (replay_path) {
+            if (!traffic_replay_open(&replay, &source, replay_path, sim.cfg.num_floors)) {
+                return 1;
+            }
+            sim_attach_source(&sim, &source);
+        }
+        if (stages) {
+            stageprof_init(&prof, deadline_us);
+            sim.prof = &prof;
+        }
+        if (trace_path) {
+            trace_file = fopen(trace_path, "wb");
+            if (!trace_file) {
+                perror(trace_path);
+                return 1;
+            }
+            trace_writer_init(&trace, file_sink, trace_file);
+            trace_begin(&trace, &sim.cfg, seed, sim_clock_now_us(&clock));
+            sim.trace = &trace;
+        }
+        if (metrics_path) {
+            metrics_file = fopen(metrics_path, "wb");
+            if (!metrics_file) {
+                perror(metrics_path);
+                return 1;
+            }
+            cycle_table_init(&table, file_sink, metrics_file);
+            cycle_table_begin(&table, sim.cfg.num_floors, sim.cfg.car_capacity, seed);
+            sim.table = &table;
+        }
+        if (deferred_log || split) {
+            deflog_init(&log);
+            sim.log = &log;
+        }
+        if (split) {
+            sim_offload_attach(&offload, &sim, &log);
+            atomic_store(&offload_stop, false);
+            offload_started = pthread_create(&offload_tid, NULL, offload_thread, &offload) == 0;
+            if (!offload_started) {
+                // sem a segunda thread o laço alimenta a fila: mesmo tráfego
+                fprintf(stderr, "Sem thread para o tráfego; gerando no laço principal\n");
+            }
+        }
+        if (press_ms) {
+            button_queue_init(&buttons);
+            sim.buttons = &buttons;
+            presser.queue = &buttons;
+            presser.period_us = (uint32_t)press_ms * 1000u;
+            atomic_store(&presser_stop, false);
+            presser_started = pthread_create(&presser_tid, NULL, presser_thread, &presser) == 0;
+            if (!presser_started) {
+                fprintf(stderr, "Sem thread para os botões; --press ignorado\n");
+            }
+        }
+        if (event_engine) {
+            event_sim_init(&events, &sim);
+            uint64_t until_us = events.now_us + (uint64_t)(duration_s * 1e6);
+            // Com log diferido, esvazia o anel a cada segundo simulado
+            uint64_t chunk_us = deferred_log ? 1000000u : until_us;
+            for (uint64_t t = events.now_us; t < until_us && !event_queue_empty(&events.queue);) {
+                t = (until_us - t > chunk_us) ? t + chunk_us : until_us;
+                event_sim_run(&events, t);
+                if (deferred_log) {
+                    deflog_drain(&log, DEFLOG_CAPACITY);
+                }
+            }
+        } else if (motion_engine) {
+            sim_motion_init(&motion, &sim, MOTION_TICK_MS);
+            while (sim.total_cycles < cycles) {
+                sim_motion_wait(&motion, sim_motion_poll(&motion));
+                if (deferred_log) {
+                    deflog_drain(&log, DEFLOG_CAPACITY);
+                }
+            }
+        } else {
+            loop_meter_reset(&loop);
+            for (long long c = 0; c < cycles; c++) {
+                if (meter) loop_meter_begin(&loop, &clock);
+                sim_step(&sim);
+                if (meter) loop_meter_end(&loop, &clock);
+                if (deferred_log && !split) {
+                    deflog_drain(&log, DEFLOG_CAPACITY);
+                }
+                if (split && !offload_started) {
+                    sim_offload_poll(&offload);
+                }
+            }
+        }
+        if (presser_started) {
+            atomic_store(&presser_stop, true);
+            pthread_join(presser_tid, NULL);
+        }
+        if (offload_started) {
+            atomic_store(&offload_stop, true);
+            pthread_join(offload_tid, NULL);
+        } else if (split) {
+            while (sim_offload_poll(&offload)) {
+            }
+        }
+        if (trace_file) {
+            trace_flush(&trace);
+            fclose(trace_file);
+        }
+        if (metrics_file) {
+            cycle_table_finish(&table);
+            fclose(metrics_file);
+        }
+    }
+    uint64_t elapsed_us = hal_time_us() - start_us;
+
+    double wall_s = (double)elapsed_us / 1e6;
+    double sim_s = (double)sim_clock_now_us(&clock) / 1e6;
+
+    if (cars > 1) {
+        print_stats(&group.stats);
+        group_print_report(&group);
+    } else {
+        print_stats(&sim.stats);
+        if (event_engine) event_sim_print_report(&events);
+        if (motion_engine) sim_motion_print_report(&motion);
+        if (passengers) passenger_print_report(&pax);
+        if (horizon) lookahead_print_report(&lookahead);
+        if (policy_spec) dispatch_policy_print_report(&policy);
+        if (stages) stageprof_print_report(&prof);
+        if (metrics_file) cycle_table_print_metrics(&table.metrics, sim.cfg.car_capacity);
+    }
+    printf("Semente:             %llu\n", (unsigned long long)seed);
+    if (event_engine) {
+        printf("Eventos processados: %llu\n", (unsigned long long)event_sim_total_events(&events));
+    } else {
+        printf("Ciclos executados:   %lld\n", cycles);
+    }
+    if (cars == 1 && !event_engine && sim_s > 0.0) {
+        double decisions = motion_engine ? (double)motion.decisions : (double)cycles;
+        printf("Decisões por minuto: %.1f (tempo simulado)\n", decisions * 60.0 / sim_s);
+    }
+    if (meter && loop.cycles > 0) {
+        printf("Laço de controle:    trabalho por ciclo mín %u / média %u / máx %u us, "
+               "atraso máx. das pausas %u us\n",
+               loop.busy_min_us, loop_meter_busy_avg_us(&loop), loop.busy_max_us,
+               loop.late_max_us);
+    }
+    if (split) {
+        printf("Tráfego em %s %llu lotes, %u espera(s) pelo gerador\n",
+               offload_started ? "thread:  " : "laço:    ", (unsigned long long)offload.batches,
+               sim.traffic_stalls);
+    }
+    if (presser_started) {
+        const LatencyStat *reg = &sim.button_register;
+        const LatencyStat *svc = &sim.button_service;
+        printf("Botões:              %u pressão(ões), %u descartada(s)\n", reg->count,
+               (unsigned)atomic_load(&buttons.dropped));
+        printf("  até o registro:    média %u / máx %u us\n", latency_avg_us(reg), reg->max_us);
+        printf("  até o atendimento: %u andar(es), média %.1f / máx %.1f ms\n", svc->count,
+               latency_avg_us(svc) / 1000.0, svc->max_us / 1000.0);
+    }
+    if (profile >= 0) {
+        printf("Perfil de tráfego:   %s, %u grupos/h no pico\n", source.name,
+               traffic_profile.arrivals_per_hour);
+    }
+    if (replay_path) {
+        printf("Traço de chegadas:   %s (%s), %llu lidas, %llu rejeitada(s), "
+               "%llu fora de ordem%s\n",
+               replay_path, source.name, (unsigned long long)replay.records,
+               (unsigned long long)replay.rejected, (unsigned long long)replay.reordered,
+               sim.source_pending ? "" : ", fim do traço");
+        traffic_replay_close(&replay);
+    }
+    if (deferred_log || split) {
+        printf("Log diferido:        pico de %u/%d registros, %u descartado(s)\n",
+               log.high_water, DEFLOG_CAPACITY, (unsigned)atomic_load(&log.dropped));
+    }
+    if (trace_file) {
+        printf("Traço binário:       %s (%llu eventos)\n", trace_path,
+               (unsigned long long)trace.records);
+    }
+    if (metrics_file) {
+        printf("Tabela por ciclo:    %s (%.1f MB, %.2f bytes/ciclo)\n", metrics_path,
+               (double)table.bytes / 1e6,
+               table.metrics.rows ? (double)table.bytes / (double)table.metrics.rows : 0.0);
+    }
+    printf("Tempo real:          %.3f s\n", wall_s);
+    printf("Tempo simulado:      %.1f s (%.1f h)\n", sim_s, sim_s / 3600.0);
+    if (wall_s > 0.0) {
+        if (event_engine) {
+            printf("Eventos por segundo: %.0f\n",
+                   (double)event_sim_total_events(&events) / wall_s);
+        } else {
+            printf("Ciclos por segundo:  %.0f\n", (double)cycles / wall_s);
+        }
+        printf("Aceleração:          %.0fx\n", sim_s / wall_s);
+    }
+
+    return 0;
+}
@@ -0,0 +1,420 @@
+/*
+ * SmartStop - leitor de logs textuais do Monitor Serial
+ *
+ * Monta as linhas por ciclo de tools/analisar_smartstop.py (parse_log) a
+ * partir de capturas do Monitor Serial, direto do arquivo mapeado na
+ * memória, e relata as métricas de calcular_metricas.
+ *
+ * O arquivo é lido em lotes de alguns trechos por thread. Cada trecho
+ * começa num cabeçalho de ciclo (log_next_header), então as threads leem
+ * sem depender umas das outras. As linhas saem na ordem do arquivo.
+ *
+ * Uso:
+ *   smartstop_ingest [--threads T] [--csv] [--metrics arquivo.ssc]
+ *                    [--tail] [--poll MS] [--idle S] log.txt [log2.txt ...]
+ *
+ * --csv imprime as linhas com as colunas de save_tables.
+ * --metrics grava as linhas de todos os logs na tabela colunar de
+ * cycle_table.h, que analisar_smartstop.py lê.
+ *
+ * --tail (um arquivo só) lê o que já existe e continua acompanhando o
+ * arquivo enquanto ele cresce, a cada --poll MS (padrão 200). Termina com
+ * Ctrl+C ou depois de --idle S segundos sem crescer (padrão 0 = nunca).
+ * O último ciclo só sai quando chega o cabeçalho do próximo ou no fim.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cycle_table.h"
+#include "hal.h"
+#include "log_ingest.h"
+
+#define INGEST_MAX_THREADS 256
+#define INGEST_CHUNK_BYTES (16u << 20)      // trecho por thread em cada lote
+#define TAIL_BUF_BYTES (1u << 20)
+
+typedef struct {
+    const char *begin;
+    size_t len;
+    bool keep_open;             // último trecho no --tail: sem flush, só linhas completas
+    size_t consumed;
+    LogParser parser;
+    pthread_t thread;
+    bool started;               // thread criada (senão o trecho roda na principal)
+} Chunk;
+
+typedef struct {
+    int threads;
+    bool csv;
+    CycleTable *out;            // --metrics (NULL sem a opção)
+    bool out_started;
+
+    CycleTable *file;           // métricas do arquivo atual
+    bool file_started;
+    int32_t capacity;           // a do primeiro ciclo do arquivo
+    uint64_t capacity_mismatch;
+    uint64_t rows;
+} Ingest;
+
+static CycleTable file_table;
+static CycleTable all_table;
+static CycleTable out_table;
+
+static volatile sig_atomic_t stop_requested;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static void file_sink(void *user, const void *data, size_t len) {
+    fwrite(data, 1, len, (FILE *)user);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [--threads T] [--csv] [--metrics ARQ] [--tail] [--poll MS]\n"
+            "          [--idle S] log.txt [log2.txt ...]\n",
+            prog);
+}
+
+static const char *direction_name(const LogRow *r) {
+    if (r->direction == LOG_DIR_UP) return "Subindo";
+    if (r->direction == LOG_DIR_DOWN) return "Descendo";
+    return r->direction_word;
+}
+
+// Fim de linha \r\n, como o csv.writer do Python em save_tables
+static void print_csv_header(void) {
+    printf("cycle,floor,direction,occupancy,capacity,decision_floor,embarked,disembarked,"
+           "emergency,skipped_calls\r\n");
+}
+
+static void print_csv_row(const LogRow *r) {
+    printf("%lld,%d,%s,%d,%d,", (long long)r->cycle, r->floor, direction_name(r),
+           r->occupancy, r->capacity);
+    if (r->decision != LOG_NO_DECISION) printf("%d", r->decision);
+    printf(",%d,%d,%u,%d\r\n", r->embarked, r->disembarked, r->emergency, r->skipped);
+}
+
+// Linhas prontas, na ordem do arquivo (só a thread principal)
+static void consume_rows(Ingest *in, LogParser *p) {
+    for (size_t i = 0; i < p->count; i++) {
+        const LogRow *r = &p->rows[i];
+        int64_t cols[CT_COL_COUNT];
+        cols[CT_COL_CYCLE] = r->cycle;
+        cols[CT_COL_FLOOR] = r->floor;
+        cols[CT_COL_DIRECTION] = r->direction == LOG_DIR_UP ? 1 : -1;
+        cols[CT_COL_OCCUPANCY] = r->occupancy;
+        cols[CT_COL_DECISION] = r->decision;
+        cols[CT_COL_EMBARKED] = r->embarked;
+        cols[CT_COL_DISEMBARKED] = r->disembarked;
+        cols[CT_COL_EMERGENCY] = r->emergency;
+        cols[CT_COL_SKIPPED] = r->skipped;
+
+        // O cabeçalho da tabela guarda uma capacidade só: a do primeiro ciclo
+        if (!in->file_started) {
+            cycle_table_begin(in->file, 0, r->capacity, 0);
+            in->file_started = true;
+            in->capacity = r->capacity;
+        }
+        if (in->out && !in->out_started) {
+            cycle_table_begin(in->out, 0, r->capacity, 0);
+            in->out_started = true;
+        }
+        if (r->capacity != in->capacity) in->capacity_mismatch++;
+
+        cycle_table_append(in->file, cols);
+        if (in->out) cycle_table_append(in->out, cols);
+        if (in->csv) print_csv_row(r);
+    }
+    in->rows += p->count;
+    if (p->failed) {
+        fprintf(stderr, "Memória insuficiente para as linhas do trecho\n");
+        exit(1);
+    }
+    log_parser_take(p);
+}
+
+static void *chunk_main(void *arg) {
+    Chunk *c = arg;
+    c->consumed = log_parse(&c->parser, c->begin, c->len, !c->keep_open);
+    if (!c->keep_open) log_parser_flush(&c->parser);
+    return NULL;
+}
+
+// Lê buf[0..len) em paralelo. Com tail, o último ciclo e a linha incompleta
+// do fim ficam em *rest; retorna quantos bytes foram consumidos.
+static size_t ingest_parallel(Ingest *in, const char *buf, size_t len, bool tail,
+                              LogParser *rest) {
+    const int n = in->threads;
+    Chunk *chunks = calloc((size_t)n, sizeof(Chunk));
+    if (!chunks) {
+        fprintf(stderr, "Memória insuficiente\n");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++) log_parser_init(&chunks[i].parser);
+
+    size_t start = 0;
+    size_t consumed = len;
+    while (start < len && !stop_requested) {
+        // Cortes nos cabeçalhos perto de start + k * INGEST_CHUNK_BYTES
+        int used = 0;
+        size_t b = start;
+        for (int i = 0; i < n && b < len; i++) {
+            size_t next = (len - b > INGEST_CHUNK_BYTES)
+                        ? log_next_header(buf, len, b + INGEST_CHUNK_BYTES) : len;
+            Chunk *c = &chunks[i];
+            c->begin = buf + b;
+            c->len = next - b;
+            c->keep_open = tail && next == len;
+            used++;
+            b = next;
+        }
+
+        for (int i = 1; i < used; i++) {
+            chunks[i].started =
+                pthread_create(&chunks[i].thread, NULL, chunk_main, &chunks[i]) == 0;
+        }
+        chunk_main(&chunks[0]);
+        for (int i = 1; i < used; i++) {
+            if (chunks[i].started) {
+                pthread_join(chunks[i].thread, NULL);
+            } else {
+                chunk_main(&chunks[i]);
+            }
+        }
+
+        for (int i = 0; i < used; i++) {
+            consume_rows(in, &chunks[i].parser);
+        }
+        if (chunks[used - 1].keep_open) {
+            const Chunk *last = &chunks[used - 1];
+            consumed = (size_t)(last->begin - buf) + last->consumed;
+            *rest = last->parser;
+            log_parser_init(&chunks[used - 1].parser);
+        }
+
+        // As páginas lidas não voltam a ser usadas
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        madvise((void *)(buf + (start & ~(page - 1))), (b & ~(page - 1)) - (start & ~(page - 1)),
+                MADV_DONTNEED);
+        start = b;
+    }
+
+    for (int i = 0; i < n; i++) log_parser_free(&chunks[i].parser);
+    free(chunks);
+    return consumed;
+}
+
+// Acompanha o arquivo a partir de offset, com o ciclo aberto em *p
+static void follow(Ingest *in, int fd, off_t offset, LogParser *p, uint32_t poll_ms,
+                   uint32_t idle_s, const char *path) {
+    char *buf = malloc(TAIL_BUF_BYTES);
+    if (!buf) {
+        fprintf(stderr, "Memória insuficiente\n");
+        exit(1);
+    }
+    size_t have = 0;
+    uint64_t idle_since = hal_time_us();
+
+    while (!stop_requested) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) break;
+        if (st.st_size < offset) {
+            fprintf(stderr, "%s: o arquivo encolheu (rotação?); parando\n", path);
+            break;
+        }
+        if (st.st_size == offset) {
+            if (idle_s && hal_time_us() - idle_since >= (uint64_t)idle_s * 1000000u) break;
+            hal_sleep_us(poll_ms * 1000u);
+            continue;
+        }
+
+        ssize_t got = pread(fd, buf + have, TAIL_BUF_BYTES - have, offset);
+        if (got <= 0) break;
+        offset += got;
+        have += (size_t)got;
+        idle_since = hal_time_us();
+
+        // Uma linha maior que o buffer é lida como está
+        size_t used = log_parse(p, buf, have, false);
+        if (used == 0 && have == TAIL_BUF_BYTES) used = log_parse(p, buf, have, true);
+        memmove(buf, buf + used, have - used);
+        have -= used;
+        consume_rows(in, p);
+        if (in->csv) fflush(stdout);
+    }
+
+    log_parse(p, buf, have, true);
+    log_parser_flush(p);
+    consume_rows(in, p);
+    free(buf);
+}
+
+static bool ingest_file(Ingest *in, const char *path, bool tail, uint32_t poll_ms,
+                        uint32_t idle_s) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        close(fd);
+        return false;
+    }
+
+    cycle_table_init(in->file, NULL, NULL);
+    in->file_started = false;
+    in->capacity_mismatch = 0;
+    in->rows = 0;
+
+    LogParser rest;
+    log_parser_init(&rest);
+    size_t size = (size_t)st.st_size;
+    size_t consumed = 0;
+    uint64_t start = hal_time_us();
+
+    if (size > 0) {
+        void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            perror(path);
+            close(fd);
+            return false;
+        }
+        madvise(map, size, MADV_SEQUENTIAL);
+        consumed = ingest_parallel(in, map, size, tail, &rest);
+        munmap(map, size);
+    }
+    double scan_s = (double)(hal_time_us() - start) / 1e6;
+
+    if (tail) {
+        fprintf(stderr, "Acompanhando %s (Ctrl+C para terminar)\n", path);
+        follow(in, fd, (off_t)consumed, &rest, poll_ms, idle_s, path);
+    }
+    log_parser_free(&rest);
+    close(fd);
+
+    cycle_table_finish(in->file);
+    if (in->csv) return true;
+
+    printf("\n=== %s ===\n", path);
+    printf("Lidos %.1f MB em %.3f s (%.0f MB/s), filtro %s, %d thread(s)\n",
+           (double)size / (1024.0 * 1024.0), scan_s,
+           scan_s > 0 ? (double)size / (1024.0 * 1024.0) / scan_s : 0.0,
+           log_scan_kernel_name(), in->threads);
+    if (in->rows == 0) {
+        printf("(sem ciclos no log)\n");
+        return true;
+    }
+    cycle_table_print_metrics(&in->file->metrics, in->capacity);
+    if (in->capacity_mismatch) {
+        printf("Aviso: %llu ciclo(s) com capacidade diferente de %d (a de >= 80%%)\n",
+               (unsigned long long)in->capacity_mismatch, in->capacity);
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    bool csv = false;
+    const char *metrics_path = NULL;
+    bool tail = false;
+    uint32_t poll_ms = 200;
+    uint32_t idle_s = 0;
+    int first_file = argc;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--threads") == 0 && val) {
+            threads = atol(val);
+            i++;
+        } else if (strcmp(arg, "--csv") == 0) {
+            csv = true;
+        } else if (strcmp(arg, "--metrics") == 0 && val) {
+            metrics_path = val;
+            i++;
+        } else if (strcmp(arg, "--tail") == 0) {
+            tail = true;
+        } else if (strcmp(arg, "--poll") == 0 && val) {
+            poll_ms = (uint32_t)atol(val);
+            i++;
+        } else if (strcmp(arg, "--idle") == 0 && val) {
+            idle_s = (uint32_t)atol(val);
+            i++;
+        } else if (arg[0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            first_file = i;
+            break;
+        }
+    }
+
+    const int files = argc - first_file;
+    if (files < 1 || (tail && files != 1)) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > INGEST_MAX_THREADS) threads = INGEST_MAX_THREADS;
+    if (poll_ms == 0) poll_ms = 1;
+
+    Ingest in;
+    memset(&in, 0, sizeof(in));
+    in.threads = (int)threads;
+    in.csv = csv;
+
+    // Com vários logs, o consolidado usa a mesma tabela das métricas
+    FILE *out = NULL;
+    if (metrics_path) {
+        out = fopen(metrics_path, "wb");
+        if (!out) {
+            perror(metrics_path);
+            return 1;
+        }
+        cycle_table_init(&out_table, file_sink, out);
+        in.out = &out_table;
+    } else if (files > 1) {
+        cycle_table_init(&all_table, NULL, NULL);
+        in.out = &all_table;
+    }
+    in.file = &file_table;
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    if (csv) print_csv_header();
+
+    bool ok = true;
+    for (int i = first_file; i < argc && !stop_requested; i++) {
+        ok &= ingest_file(&in, argv[i], tail, poll_ms, idle_s);
+    }
+
+    if (in.out) {
+        cycle_table_finish(in.out);
+        if (files > 1 && !csv && in.out->metrics.rows > 0) {
+            printf("\n=== Consolidado (%d logs) ===\n", files);
+            cycle_table_print_metrics(&in.out->metrics, in.out->car_capacity);
+        }
+    }
+    if (out) {
+        fclose(out);
+        if (!csv) {
+            printf("Tabela por ciclo: %s (%.2f MB)\n", metrics_path,
+                   (double)out_table.bytes / (1024.0 * 1024.0));
+        }
+    }
+    return ok ? 0 : 1;
+}
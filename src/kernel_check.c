@@ -0,0 +1,95 @@
+/*
+ * Conferência e cronometragem das pontuações SmartStop float e inteira
+ */
+
+#include "kernel_check.h"
+
+#include "hal.h"
+
+void kernel_check_random_state(const BuildingConfig *cfg, SimRng *rng,
+                               int max_est, int max_wait, KernelState *st) {
+    const int n = cfg->num_floors;
+
+    st->e.current_floor = sim_rng_below(rng, (uint32_t)n);
+    // parado (0) de vez em quando: o núcleo considera o prédio todo
+    int d = sim_rng_below(rng, 8);
+    st->e.direction = d == 0 ? 0 : (d & 1) ? 1 : -1;
+    st->e.occupancy = sim_rng_below(rng, (uint32_t)cfg->car_capacity + 1);
+
+    // Densidade de 1 a 64 em 64 por estado: de prédio quase vazio a lotado
+    uint32_t density = (uint32_t)sim_rng_below(rng, 64) + 1u;
+
+    // Relógio em max_wait: a chegada de cada chamada é now - espera
+    st->now = (uint32_t)max_wait;
+    floorset_clear(&st->active);
+    for (int i = 0; i < n; i++) {
+        HallCall *c = &st->calls[i];
+        c->floor = i;
+        c->active = i != st->e.current_floor && (uint32_t)sim_rng_below(rng, 64) < density;
+        c->est_passengers = c->active ? sim_rng_below(rng, (uint32_t)max_est + 1) : 0;
+        c->arrival = st->now - (c->active ? sim_rng_below(rng, (uint32_t)max_wait + 1) : 0);
+        if (c->active) floorset_set(&st->active, i);
+    }
+}
+
+static SmartStopRatio ratio_of(const BuildingConfig *cfg, const KernelState *st, int floor) {
+    int d = floor - st->e.current_floor;
+    return smartstop_efficiency_fixed(cfg, st->calls[floor].est_passengers, d >= 0 ? d : -d,
+                                      hall_call_wait(&st->calls[floor], st->now));
+}
+
+void kernel_check_compare(const BuildingConfig *cfg, const KernelState *st, KernelCheck *out) {
+    bool accept_f, accept_x;
+    int floor_f = smartstop_best_floor_float(cfg, st->calls, &st->active, &st->e, st->now,
+                                             &accept_f);
+    int floor_x = smartstop_best_floor_fixed(cfg, st->calls, &st->active, &st->e, st->now,
+                                             &accept_x);
+
+    out->states++;
+    if (floor_f != -1) {
+        if (accept_f) out->accepted++;
+        else out->skipped++;
+    }
+
+    if (floor_f == floor_x && accept_f == accept_x) {
+        out->same++;
+        return;
+    }
+    if (floor_f == -1 || floor_x == -1) {
+        out->mismatches++;
+        return;
+    }
+
+    // Paradas diferentes: empate se nenhuma das frações exatas supera a outra
+    SmartStopRatio rf = ratio_of(cfg, st, floor_f);
+    SmartStopRatio rx = ratio_of(cfg, st, floor_x);
+    bool tie;
+    if (floor_f != floor_x) {
+        tie = !smartstop_ratio_greater(rf, rx) && !smartstop_ratio_greater(rx, rf);
+    } else {
+        // Mesma parada, aceitação diferente: empate se a fração é o limiar
+        tie = (int64_t)rx.num * 1000 == (int64_t)cfg->threshold_milli * (int64_t)rx.den;
+    }
+    if (tie) out->tie_breaks++;
+    else out->mismatches++;
+}
+
+uint64_t kernel_check_time_us(const BuildingConfig *cfg, const KernelState states[],
+                              int count, uint32_t n, bool fixed) {
+    volatile int sink = 0;
+    int k = 0;
+    bool accept;
+
+    uint64_t start = hal_time_us();
+    for (uint32_t i = 0; i < n; i++) {
+        const KernelState *st = &states[k];
+        int f = fixed
+            ? smartstop_best_floor_fixed(cfg, st->calls, &st->active, &st->e, st->now, &accept)
+            : smartstop_best_floor_float(cfg, st->calls, &st->active, &st->e, st->now, &accept);
+        sink += f + accept;
+        if (++k == count) k = 0;
+    }
+    uint64_t elapsed = hal_time_us() - start;
+    (void)sink;
+    return elapsed;
+}
@@ -0,0 +1,42 @@
+#ifndef KERNEL_CHECK_H
+#define KERNEL_CHECK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "smartstop.h"
+
+// Conferência e cronometragem das duas pontuações SmartStop (float e
+// inteiros, smartstop_best_floor_*) em estados aleatórios do prédio.
+// Usada por smartstop_fixcheck no host e, com SMARTSTOP_KERNEL_BENCH, no
+// boot do firmware para medir ciclos por decisão no RP2040.
+
+typedef struct {
+    HallCall calls[MAX_FLOORS];
+    FloorSet active;
+    ElevatorState e;
+    uint32_t now;               // relógio de espera das chegadas
+} KernelState;
+
+typedef struct {
+    uint64_t states;
+    uint64_t same;              // mesma parada e mesma aceitação
+    uint64_t tie_breaks;        // diferem só num empate exato que o float desfez
+    uint64_t mismatches;        // diferem sem empate (erro da versão inteira)
+    uint64_t accepted;          // decisões de parar (float)
+    uint64_t skipped;           // chamada abaixo do limiar (float)
+} KernelCheck;
+
+// Sorteia carro (andar e direção) e chamadas: cada andar ativo com uma
+// densidade sorteada por estado, estimativa 0..max_est e espera 0..max_wait
+void kernel_check_random_state(const BuildingConfig *cfg, SimRng *rng,
+                               int max_est, int max_wait, KernelState *st);
+
+// Decide st com as duas versões e contabiliza em out
+void kernel_check_compare(const BuildingConfig *cfg, const KernelState *st, KernelCheck *out);
+
+// Tempo em us de n decisões de uma versão, percorrendo states[0..count-1]
+uint64_t kernel_check_time_us(const BuildingConfig *cfg, const KernelState states[],
+                              int count, uint32_t n, bool fixed);
+
+#endif
@@ -0,0 +1,610 @@
+/*
+ * Simulações em passo travado, com a decisão vetorizada entre pistas
+ * (ver lockstep.h)
+ *
+ * As passadas 1 e 3 repetem, pista a pista, sim_begin_cycle e o resto de
+ * sim_step (dispatch.c, policy.c) no modo do ensemble. Os conjuntos de
+ * andares são um uint64_t; "próximo acima/abaixo" e as chamadas puladas
+ * numa viagem viram ctz/clz/popcount. Compilado com -ffp-contract=off.
+ */
+
+#include "lockstep.h"
+#include "dispatch.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && !defined(SMARTSTOP_FIXED_POINT)
+#include <immintrin.h>
+#define LOCKSTEP_X86 1
+#endif
+
+#define LOCKSTEP_ALIGN 64
+#define LOCKSTEP_WIDTH 16      // pistas por vetor AVX-512 (capacidade múltipla)
+
+// ---------------------------------------------------------------------------
+// Conjuntos de andares em 64 bits
+// ---------------------------------------------------------------------------
+
+static inline uint64_t bit(int f) {
+    return 1ull << f;
+}
+
+// Andares [lo, hi) (0 <= lo, hi <= 64)
+static inline uint64_t range_mask(int lo, int hi) {
+    if (lo >= hi) return 0;
+    uint64_t upto = hi >= 64 ? ~0ull : bit(hi) - 1;
+    return upto & (~0ull << lo);
+}
+
+// Menor andar >= f, ou -1 (floorset_next_up)
+static inline int next_up(uint64_t s, int f) {
+    if (f < 0) f = 0;
+    if (f >= 64) return -1;
+    uint64_t m = s & (~0ull << f);
+    return m ? __builtin_ctzll(m) : -1;
+}
+
+// Maior andar <= f, ou -1 (floorset_next_down)
+static inline int next_down(uint64_t s, int f) {
+    if (f < 0) return -1;
+    uint64_t m = s & range_mask(0, f + 1);
+    return m ? 63 - __builtin_clzll(m) : -1;
+}
+
+// Mais próximo de f, empate para baixo (floorset_nearest)
+static inline int nearest(uint64_t s, int f) {
+    int below = next_down(s, f);
+    int above = next_up(s, f + 1);
+    if (below < 0) return above;
+    if (above < 0) return below;
+    return (f - below <= above - f) ? below : above;
+}
+
+// ---------------------------------------------------------------------------
+// Lote
+// ---------------------------------------------------------------------------
+
+static void *lane_array(int lanes, size_t elem) {
+    size_t bytes = (size_t)lanes * elem;
+    bytes = (bytes + LOCKSTEP_ALIGN - 1) / LOCKSTEP_ALIGN * LOCKSTEP_ALIGN;
+    return aligned_alloc(LOCKSTEP_ALIGN, bytes);
+}
+
+bool lockstep_supported(const BuildingConfig *cfg) {
+    return cfg->num_floors >= 2 && cfg->num_floors <= LOCKSTEP_MAX_FLOORS;
+}
+
+bool lockstep_init(LockstepBatch *b, int lanes) {
+    memset(b, 0, sizeof(*b));
+    if (lanes < 1) return false;
+    lanes = (lanes + LOCKSTEP_WIDTH - 1) / LOCKSTEP_WIDTH * LOCKSTEP_WIDTH;
+    b->lanes = lanes;
+
+    b->est = lane_array(lanes * LOCKSTEP_MAX_FLOORS, sizeof(int32_t));
+    b->arrival = lane_array(lanes * LOCKSTEP_MAX_FLOORS, sizeof(uint32_t));
+    b->active = lane_array(lanes, sizeof(uint64_t));
+    b->floor = lane_array(lanes, sizeof(int32_t));
+    b->direction = lane_array(lanes, sizeof(int32_t));
+    b->occupancy = lane_array(lanes, sizeof(int32_t));
+    b->full_cycles = lane_array(lanes, sizeof(int32_t));
+    b->wait_clock = lane_array(lanes, sizeof(uint32_t));
+    b->rng = lane_array(lanes, sizeof(SimRng));
+    b->stats = lane_array(lanes, sizeof(Stats));
+    b->cfg = lane_array(lanes, sizeof(BuildingConfig));
+    b->mode = lane_array(lanes, sizeof(TrafficMode));
+    b->emergency_wait = lane_array(lanes, sizeof(int32_t));
+    b->stop_cost = lane_array(lanes, sizeof(float));
+    b->wait_bonus = lane_array(lanes, sizeof(float));
+    b->threshold = lane_array(lanes, sizeof(float));
+    b->emergency = lane_array(lanes, sizeof(int32_t));
+    b->best = lane_array(lanes, sizeof(int32_t));
+    b->accept = lane_array(lanes, sizeof(int32_t));
+
+    if (!b->est || !b->arrival || !b->active || !b->floor || !b->direction ||
+        !b->occupancy || !b->full_cycles || !b->wait_clock || !b->rng || !b->stats ||
+        !b->cfg || !b->mode || !b->emergency_wait || !b->stop_cost || !b->wait_bonus ||
+        !b->threshold || !b->emergency || !b->best || !b->accept) {
+        lockstep_free(b);
+        return false;
+    }
+    lockstep_clear(b);
+    return true;
+}
+
+void lockstep_free(LockstepBatch *b) {
+    free(b->est);
+    free(b->arrival);
+    free(b->active);
+    free(b->floor);
+    free(b->direction);
+    free(b->occupancy);
+    free(b->full_cycles);
+    free(b->wait_clock);
+    free(b->rng);
+    free(b->stats);
+    free(b->cfg);
+    free(b->mode);
+    free(b->emergency_wait);
+    free(b->stop_cost);
+    free(b->wait_bonus);
+    free(b->threshold);
+    free(b->emergency);
+    free(b->best);
+    free(b->accept);
+    memset(b, 0, sizeof(*b));
+}
+
+void lockstep_clear(LockstepBatch *b) {
+    const int lanes = b->lanes;
+    b->used = 0;
+    b->max_floors = 0;
+
+    // Pistas desligadas: sem chamadas, respostas -1 na passada vetorial
+    memset(b->est, 0, (size_t)lanes * LOCKSTEP_MAX_FLOORS * sizeof(int32_t));
+    memset(b->arrival, 0, (size_t)lanes * LOCKSTEP_MAX_FLOORS * sizeof(uint32_t));
+    for (int l = 0; l < lanes; l++) {
+        b->active[l] = 0;
+        b->floor[l] = 0;
+        b->direction[l] = -1;
+        b->occupancy[l] = 0;
+        b->full_cycles[l] = 0;
+        b->wait_clock[l] = 0;
+        b->emergency_wait[l] = 0;
+        b->stop_cost[l] = 1.0f;
+        b->wait_bonus[l] = 1.0f;
+        b->threshold[l] = 0.0f;
+    }
+}
+
+int lockstep_add(LockstepBatch *b, const BuildingConfig *cfg, TrafficMode mode,
+                 const SimRng *rng) {
+    if (b->used == b->lanes || !lockstep_supported(cfg)) return -1;
+    const int l = b->used++;
+
+    // Estado de sim_init / smartstop_init
+    b->cfg[l] = *cfg;
+    b->mode[l] = mode;
+    b->rng[l] = *rng;
+    b->active[l] = 0;
+    b->floor[l] = cfg->num_floors - 1;
+    b->direction[l] = -1;
+    b->occupancy[l] = 0;
+    b->full_cycles[l] = 0;
+    b->wait_clock[l] = 0;
+    memset(&b->stats[l], 0, sizeof(Stats));
+    for (int f = 0; f < LOCKSTEP_MAX_FLOORS; f++) {
+        b->est[f * b->lanes + l] = 0;
+        b->arrival[f * b->lanes + l] = 0;
+    }
+
+    b->emergency_wait[l] = cfg->emergency_wait_time;
+    b->stop_cost[l] = cfg->stop_cost;
+    b->wait_bonus[l] = cfg->wait_bonus;
+    b->threshold[l] = cfg->efficiency_threshold;
+    if (cfg->num_floors > b->max_floors) b->max_floors = cfg->num_floors;
+    return l;
+}
+
+// ---------------------------------------------------------------------------
+// Passada 2: emergência e pontuação SmartStop, uma pista por elemento
+// ---------------------------------------------------------------------------
+
+typedef void (*ScoreFn)(LockstepBatch *b, int n);
+
+// find_emergency_call e decide_kernel de uma pista
+static void score_scalar(LockstepBatch *b, int n) {
+    const int L = b->lanes;
+    for (int l = 0; l < n; l++) {
+        const BuildingConfig *cfg = &b->cfg[l];
+        const int cur = b->floor[l];
+        const int dir = b->direction[l];
+        const uint32_t now = b->wait_clock[l];
+
+        int worst_wait = 0, worst_floor = -1;
+        int best_floor = -1;
+#ifdef SMARTSTOP_FIXED_POINT
+        SmartStopRatio best = { 0u, 1u };
+#else
+        float best = -1.0f;
+#endif
+        for (int f = 0; f < b->max_floors; f++) {
+            int est = b->est[f * L + l];
+            if (est <= 0) continue;
+            int wait = (int)(now - b->arrival[f * L + l]);
+            if (wait > worst_wait) {
+                worst_wait = wait;
+                worst_floor = f;
+            }
+            if (!((dir == 1 && f > cur) || (dir == -1 && f < cur))) continue;
+            int distance = f > cur ? f - cur : cur - f;
+#ifdef SMARTSTOP_FIXED_POINT
+            SmartStopRatio r = smartstop_efficiency_fixed(cfg, est, distance, wait);
+            if (smartstop_ratio_greater(r, best)) {
+                best = r;
+                best_floor = f;
+            }
+#else
+            float eff = smartstop_efficiency(cfg, est, distance, wait);
+            if (eff > best) {
+                best = eff;
+                best_floor = f;
+            }
+#endif
+        }
+
+        b->emergency[l] = worst_wait >= b->emergency_wait[l] ? worst_floor : -1;
+        b->best[l] = best_floor;
+#ifdef SMARTSTOP_FIXED_POINT
+        b->accept[l] = best_floor != -1 && smartstop_ratio_accepts(cfg, best);
+#else
+        b->accept[l] = best_floor != -1 && !(best < b->threshold[l]);
+#endif
+    }
+}
+
+#ifdef LOCKSTEP_X86
+
+// Mesmas contas de score_scalar, 8 pistas por vez: cvt, soma, divisão e
+// multiplicação em float com arredondamento IEEE, como no escalar
+__attribute__((target("avx2")))
+static void score_avx2(LockstepBatch *b, int n) {
+    const int L = b->lanes;
+    const __m256i none = _mm256_set1_epi32(-1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i bonus_after = _mm256_set1_epi32(WAIT_BONUS_AFTER);
+
+    for (int l = 0; l < n; l += 8) {
+        const __m256i cur = _mm256_load_si256((const __m256i *)&b->floor[l]);
+        const __m256i dir = _mm256_load_si256((const __m256i *)&b->direction[l]);
+        const __m256i now = _mm256_load_si256((const __m256i *)&b->wait_clock[l]);
+        const __m256 stop_cost = _mm256_load_ps(&b->stop_cost[l]);
+        const __m256 bonus = _mm256_load_ps(&b->wait_bonus[l]);
+        const __m256i up = _mm256_cmpeq_epi32(dir, one);
+        const __m256i down = _mm256_cmpeq_epi32(dir, none);
+
+        __m256i worst_wait = zero, worst_floor = none, best_floor = none;
+        __m256 best = _mm256_set1_ps(-1.0f);
+
+        for (int f = 0; f < b->max_floors; f++) {
+            const __m256i fv = _mm256_set1_epi32(f);
+            const __m256i est = _mm256_load_si256((const __m256i *)&b->est[f * L + l]);
+            const __m256i arrival = _mm256_load_si256((const __m256i *)&b->arrival[f * L + l]);
+            const __m256i has = _mm256_cmpgt_epi32(est, zero);
+            const __m256i wait = _mm256_sub_epi32(now, arrival);
+
+            // Maior espera (estrita: em empate fica o andar de baixo)
+            __m256i worse = _mm256_and_si256(has, _mm256_cmpgt_epi32(wait, worst_wait));
+            worst_wait = _mm256_blendv_epi8(worst_wait, wait, worse);
+            worst_floor = _mm256_blendv_epi8(worst_floor, fv, worse);
+
+            // À frente na direção do carro
+            __m256i ahead = _mm256_or_si256(_mm256_and_si256(up, _mm256_cmpgt_epi32(fv, cur)),
+                                            _mm256_and_si256(down, _mm256_cmpgt_epi32(cur, fv)));
+            __m256i delta = _mm256_abs_epi32(_mm256_sub_epi32(fv, cur));
+            __m256 cost = _mm256_add_ps(_mm256_cvtepi32_ps(delta), stop_cost);
+            __m256 eff = _mm256_div_ps(_mm256_cvtepi32_ps(est), cost);
+            __m256 old = _mm256_castsi256_ps(_mm256_cmpgt_epi32(wait, bonus_after));
+            eff = _mm256_blendv_ps(eff, _mm256_mul_ps(eff, bonus), old);
+
+            __m256i better = _mm256_and_si256(
+                _mm256_and_si256(has, ahead),
+                _mm256_castps_si256(_mm256_cmp_ps(eff, best, _CMP_GT_OQ)));
+            best = _mm256_blendv_ps(best, eff, _mm256_castsi256_ps(better));
+            best_floor = _mm256_blendv_epi8(best_floor, fv, better);
+        }
+
+        // worst_wait >= emergency_wait
+        const __m256i ew = _mm256_load_si256((const __m256i *)&b->emergency_wait[l]);
+        __m256i emergency = _mm256_andnot_si256(_mm256_cmpgt_epi32(ew, worst_wait), worst_floor);
+        emergency = _mm256_or_si256(emergency, _mm256_cmpgt_epi32(ew, worst_wait));
+        _mm256_store_si256((__m256i *)&b->emergency[l], emergency);
+        _mm256_store_si256((__m256i *)&b->best[l], best_floor);
+
+        // !(best < threshold), só com andar escolhido
+        const __m256 thr = _mm256_load_ps(&b->threshold[l]);
+        __m256i accept = _mm256_castps_si256(_mm256_cmp_ps(best, thr, _CMP_NLT_UQ));
+        accept = _mm256_andnot_si256(_mm256_cmpeq_epi32(best_floor, none), accept);
+        _mm256_store_si256((__m256i *)&b->accept[l], _mm256_and_si256(accept, one));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void score_avx512(LockstepBatch *b, int n) {
+    const int L = b->lanes;
+    const __m512i none = _mm512_set1_epi32(-1);
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i bonus_after = _mm512_set1_epi32(WAIT_BONUS_AFTER);
+
+    for (int l = 0; l < n; l += 16) {
+        const __m512i cur = _mm512_load_si512(&b->floor[l]);
+        const __m512i dir = _mm512_load_si512(&b->direction[l]);
+        const __m512i now = _mm512_load_si512(&b->wait_clock[l]);
+        const __m512 stop_cost = _mm512_load_ps(&b->stop_cost[l]);
+        const __m512 bonus = _mm512_load_ps(&b->wait_bonus[l]);
+        const __mmask16 up = _mm512_cmpeq_epi32_mask(dir, one);
+        const __mmask16 down = _mm512_cmpeq_epi32_mask(dir, none);
+
+        __m512i worst_wait = zero, worst_floor = none, best_floor = none;
+        __m512 best = _mm512_set1_ps(-1.0f);
+
+        for (int f = 0; f < b->max_floors; f++) {
+            const __m512i fv = _mm512_set1_epi32(f);
+            const __m512i est = _mm512_load_si512(&b->est[f * L + l]);
+            const __m512i arrival = _mm512_load_si512(&b->arrival[f * L + l]);
+            const __mmask16 has = _mm512_cmpgt_epi32_mask(est, zero);
+            const __m512i wait = _mm512_sub_epi32(now, arrival);
+
+            __mmask16 worse = _mm512_mask_cmpgt_epi32_mask(has, wait, worst_wait);
+            worst_wait = _mm512_mask_mov_epi32(worst_wait, worse, wait);
+            worst_floor = _mm512_mask_mov_epi32(worst_floor, worse, fv);
+
+            __mmask16 ahead = (__mmask16)((up & _mm512_cmpgt_epi32_mask(fv, cur)) |
+                                          (down & _mm512_cmpgt_epi32_mask(cur, fv)));
+            __m512i delta = _mm512_abs_epi32(_mm512_sub_epi32(fv, cur));
+            __m512 cost = _mm512_add_ps(_mm512_cvtepi32_ps(delta), stop_cost);
+            __m512 eff = _mm512_div_ps(_mm512_cvtepi32_ps(est), cost);
+            __mmask16 old = _mm512_cmpgt_epi32_mask(wait, bonus_after);
+            eff = _mm512_mask_mul_ps(eff, old, eff, bonus);
+
+            __mmask16 better = _mm512_mask_cmp_ps_mask((__mmask16)(has & ahead), eff, best,
+                                                       _CMP_GT_OQ);
+            best = _mm512_mask_mov_ps(best, better, eff);
+            best_floor = _mm512_mask_mov_epi32(best_floor, better, fv);
+        }
+
+        const __m512i ew = _mm512_load_si512(&b->emergency_wait[l]);
+        __mmask16 reached = _mm512_cmpge_epi32_mask(worst_wait, ew);
+        _mm512_store_si512(&b->emergency[l], _mm512_mask_mov_epi32(none, reached, worst_floor));
+        _mm512_store_si512(&b->best[l], best_floor);
+
+        const __m512 thr = _mm512_load_ps(&b->threshold[l]);
+        __mmask16 accept = _mm512_mask_cmp_ps_mask(_mm512_cmpneq_epi32_mask(best_floor, none),
+                                                   best, thr, _CMP_NLT_UQ);
+        _mm512_store_si512(&b->accept[l], _mm512_maskz_mov_epi32(accept, one));
+    }
+}
+
+#endif
+
+static _Atomic(ScoreFn) score_kernel;
+
+static ScoreFn score_select(void) {
+    ScoreFn fn = atomic_load_explicit(&score_kernel, memory_order_relaxed);
+    if (fn) return fn;
+    fn = score_scalar;
+#ifdef LOCKSTEP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) fn = score_avx512;
+    else if (__builtin_cpu_supports("avx2")) fn = score_avx2;
+#endif
+    atomic_store_explicit(&score_kernel, fn, memory_order_relaxed);
+    return fn;
+}
+
+const char *lockstep_kernel_name(void) {
+    ScoreFn fn = score_select();
+#ifdef LOCKSTEP_X86
+    if (fn == score_avx512) return "avx512";
+    if (fn == score_avx2) return "avx2";
+#endif
+    (void)fn;
+    return "escalar";
+}
+
+bool lockstep_force_kernel(const char *name) {
+    ScoreFn fn = NULL;
+    if (strcmp(name, "escalar") == 0 || strcmp(name, "scalar") == 0) fn = score_scalar;
+#ifdef LOCKSTEP_X86
+    __builtin_cpu_init();
+    if (strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2")) fn = score_avx2;
+    if (strcmp(name, "avx512") == 0 && __builtin_cpu_supports("avx512f")) fn = score_avx512;
+#endif
+    if (!fn) return false;
+    atomic_store_explicit(&score_kernel, fn, memory_order_relaxed);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Passadas 1 e 3: uma pista
+// ---------------------------------------------------------------------------
+
+// sim_begin_cycle: envelhece, sorteia o tráfego, descarta chegadas vazias
+static inline void begin_cycle(LockstepBatch *b, int l) {
+    const int L = b->lanes;
+    const int cur = b->floor[l];
+    const uint32_t now = ++b->wait_clock[l];
+    uint64_t active = b->active[l];
+
+    // A chamada do andar do carro não envelhece
+    if (active & bit(cur)) b->arrival[cur * L + l]++;
+
+    uint8_t passengers[64];
+    uint64_t free = ~active & range_mask(0, b->cfg[l].num_floors) & ~bit(cur);
+    uint64_t arrivals = traffic_draw_free_floors(&b->rng[l], b->mode[l], free, passengers);
+    while (arrivals) {
+        int f = __builtin_ctzll(arrivals);
+        arrivals &= arrivals - 1;
+        b->arrival[f * L + l] = now;
+        if (passengers[f] > 0) {
+            b->est[f * L + l] = passengers[f];
+            active |= bit(f);
+        }
+    }
+    b->active[l] = active;
+
+    if (b->occupancy[l] >= b->cfg[l].car_capacity) b->full_cycles[l]++;
+    else b->full_cycles[l] = 0;
+}
+
+// sim_disembark no modelo anônimo (sem chamadas internas no ensemble)
+static inline void disembark(LockstepBatch *b, int l, int floor, bool has_call) {
+    int occupancy = b->occupancy[l];
+    if (occupancy <= 2) return;
+
+    int exit_probability = 35;
+    if (floor == 0 || floor == b->cfg[l].num_floors - 1) exit_probability = 70;
+    if (has_call) exit_probability += 25;
+
+    if (sim_rng_below(&b->rng[l], 100) < exit_probability) {
+        int count = MIN_DISEMBARK_PASSENGERS +
+                    sim_rng_below(&b->rng[l],
+                                  MAX_DISEMBARK_PASSENGERS - MIN_DISEMBARK_PASSENGERS + 1);
+        if (count > occupancy) count = occupancy;
+        b->occupancy[l] = occupancy - count;
+    }
+}
+
+// dispatch_cascade_decide sem botões nem chamadas internas
+static inline int decide(LockstepBatch *b, int l) {
+    const BuildingConfig *cfg = &b->cfg[l];
+    const uint64_t active = b->active[l];
+    const int cur = b->floor[l];
+    const int dir = b->direction[l];
+    const int occupancy = b->occupancy[l];
+
+    // Emergência: direto se há menos de 2 chamadas no caminho ou carro quase vazio
+    int emergency = b->emergency[l];
+    if (emergency != -1) {
+        uint64_t path = emergency > cur ? range_mask(cur, emergency)
+                                        : range_mask(emergency + 1, cur + 1);
+        if (__builtin_popcountll(active & path) < 2 || occupancy < 2) return emergency;
+    }
+
+    // Desembarque forçado
+    if (occupancy >= cfg->car_capacity && b->full_cycles[l] >= cfg->cycles_full_max) {
+        int next = cur + dir;
+        if (next >= 0 && next < cfg->num_floors) {
+            b->full_cycles[l] = 0;
+            return next;
+        }
+    }
+
+    // Proximidade (até 2 andares na direção)
+    int floor = dir == 1 ? next_up(active, cur) : next_down(active, cur);
+    if (floor != -1 && floor - cur <= 2 && cur - floor <= 2) return floor;
+
+    // SmartStop (passada vetorial)
+    if (occupancy < cfg->car_capacity - 2) {
+        b->stats[l].total_cycles++;
+        if (b->best[l] != -1) {
+            if (b->accept[l]) return b->best[l];
+            b->stats[l].skipped_stops++;
+        }
+    }
+
+    // Lotado: próxima chamada na direção
+    if (occupancy >= cfg->car_capacity - 1) {
+        floor = dir == 1 ? next_up(active, cur + 1) : next_down(active, cur - 1);
+        if (floor != -1) return floor;
+    }
+
+    // Vazio: chamada mais próxima
+    if (occupancy == 0) return nearest(active, cur);
+    return -1;
+}
+
+// continue_moving
+static inline void keep_moving(LockstepBatch *b, int l) {
+    const int top = b->cfg[l].num_floors - 1;
+    if (b->occupancy[l] > 0 && sim_rng_below(&b->rng[l], 100) < 15) {
+        disembark(b, l, b->floor[l], false);
+    }
+
+    int cur = b->floor[l] + b->direction[l];
+    if (cur <= 0) {
+        cur = 0;
+        b->direction[l] = 1;
+    } else if (cur >= top) {
+        cur = top;
+        b->direction[l] = -1;
+    }
+    b->floor[l] = cur;
+}
+
+// travel_and_stop: as chamadas entre a origem e o destino (exclusive) são
+// as puladas; inverte se o destino for um extremo
+static inline void travel_and_stop(LockstepBatch *b, int l, int target) {
+    const int L = b->lanes;
+    const BuildingConfig *cfg = &b->cfg[l];
+    const int cur = b->floor[l];
+    uint64_t active = b->active[l];
+
+    if (target != cur) {
+        uint64_t passed = target > cur ? range_mask(cur + 1, target)
+                                       : range_mask(target + 1, cur);
+        b->stats[l].skipped_stops += __builtin_popcountll(active & passed);
+        b->floor[l] = target;
+        if (target <= 0) b->direction[l] = 1;
+        else if (target >= cfg->num_floors - 1) b->direction[l] = -1;
+        else b->direction[l] = target > cur ? 1 : -1;
+    }
+
+    const bool has_call = active & bit(target);
+    if (b->occupancy[l] > 0) disembark(b, l, target, has_call);
+
+    // sim_serve_stop + smartstop_handle_stop (toda chamada ativa tem passageiros)
+    if (has_call && b->occupancy[l] < cfg->car_capacity) {
+        int32_t *est = &b->est[target * L + l];
+        int boarded = *est;
+        int room = cfg->car_capacity - b->occupancy[l];
+        if (boarded > room) boarded = room;
+        b->occupancy[l] += boarded;
+        b->stats[l].total_boarded += boarded;
+        b->stats[l].total_stops++;
+        *est = 0;
+        b->active[l] = active & ~bit(target);
+    }
+}
+
+// Corpo comum às variantes de lockstep_run: só muda o conjunto de
+// instruções dos popcount/ctz das passadas escalares
+__attribute__((always_inline))
+static inline void run_cycles(LockstepBatch *b, long long cycles, ScoreFn score) {
+    const int n = b->used;
+    const int padded = (n + LOCKSTEP_WIDTH - 1) / LOCKSTEP_WIDTH * LOCKSTEP_WIDTH;
+
+    for (long long c = 0; c < cycles; c++) {
+        for (int l = 0; l < n; l++) {
+            begin_cycle(b, l);
+        }
+        score(b, padded);
+        for (int l = 0; l < n; l++) {
+            int target = decide(b, l);
+            if (target == -1) keep_moving(b, l);
+            else travel_and_stop(b, l, target);
+        }
+    }
+}
+
+typedef void (*RunFn)(LockstepBatch *b, long long cycles, ScoreFn score);
+
+static void run_generic(LockstepBatch *b, long long cycles, ScoreFn score) {
+    run_cycles(b, cycles, score);
+}
+
+#ifdef LOCKSTEP_X86
+// Sem -mpopcnt o __builtin_popcountll vira chamada da libgcc
+__attribute__((target("popcnt")))
+static void run_popcnt(LockstepBatch *b, long long cycles, ScoreFn score) {
+    run_cycles(b, cycles, score);
+}
+#endif
+
+static _Atomic(RunFn) run_kernel;
+
+void lockstep_run(LockstepBatch *b, long long cycles) {
+    RunFn run = atomic_load_explicit(&run_kernel, memory_order_relaxed);
+    if (!run) {
+        run = run_generic;
+#ifdef LOCKSTEP_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("popcnt")) run = run_popcnt;
+#endif
+        atomic_store_explicit(&run_kernel, run, memory_order_relaxed);
+    }
+    run(b, cycles, score_select());
+}
@@ -0,0 +1,97 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "smartstop.h"
+
+// Muitas simulações em passo travado (somente host).
+//
+// Um lote roda até `lanes` prédios independentes, todos no mesmo ciclo. O
+// estado fica em estrutura de vetores: chamadas por andar com um elemento
+// por simulação (est[andar][pista], arrival[andar][pista]), carro,
+// relógio de espera e parâmetros por pista. Cada ciclo tem três passadas:
+//
+//   1. por pista: envelhece as chamadas e sorteia o tráfego (gerador próprio
+//      da pista, os mesmos sorteios de generate_random_hall_calls);
+//   2. vetorial, andar a andar com uma pista por elemento: chamada em
+//      emergência (maior espera) e pontuação SmartStop, comparação com o
+//      limiar e arg-max sobre os andares (AVX-512, AVX2 ou escalar);
+//   3. por pista: a cascata de prioridades com as respostas da passada 2,
+//      o movimento e o embarque, com máscaras de bits no lugar dos laços.
+//
+// Reproduz exatamente sim_step no modo que o ensemble usa (sem log,
+// passageiros individuais, botões, fonte de tráfego ou política): os
+// mesmos sorteios na mesma ordem e a mesma aritmética de float (sem
+// contração em FMA), logo os mesmos Stats por simulação. Com
+// SMARTSTOP_FIXED_POINT a pontuação é a inteira, sem vetor.
+//
+// As passadas 1 e 3 são escalares e dominam o tempo: o ganho sobre
+// sim_step fica perto de 2 vezes numa thread e não cresce com a largura
+// do vetor (AVX-512 não ganha de AVX2).
+//
+// Até LOCKSTEP_MAX_FLOORS andares (um bitmask de 64 bits por pista).
+
+#define LOCKSTEP_MAX_FLOORS 64
+#define LOCKSTEP_LANES      256    // pistas por lote no ensemble
+
+typedef struct {
+    int lanes;                  // capacidade (múltiplo de 16)
+    int used;                   // pistas ligadas (0..used-1)
+    int max_floors;             // maior num_floors entre as pistas ligadas
+
+    // Por andar e pista: [andar * lanes + pista]
+    int32_t *est;               // 0 = sem chamada
+    uint32_t *arrival;
+
+    // Por pista
+    uint64_t *active;           // chamadas ativas (bit = andar)
+    int32_t *floor;
+    int32_t *direction;
+    int32_t *occupancy;
+    int32_t *full_cycles;       // ciclos lotado (cycles_at_full_capacity)
+    uint32_t *wait_clock;
+    SimRng *rng;
+    Stats *stats;
+
+    // Parâmetros por pista (e os da pontuação em vetores, para a passada 2)
+    BuildingConfig *cfg;
+    TrafficMode *mode;
+    int32_t *emergency_wait;
+    float *stop_cost;
+    float *wait_bonus;
+    float *threshold;
+
+    // Respostas da passada vetorial
+    int32_t *emergency;         // andar em emergência ou -1
+    int32_t *best;              // melhor andar SmartStop à frente ou -1
+    int32_t *accept;            // best atinge o limiar (0/1)
+} LockstepBatch;
+
+// true se cfg cabe no lote (até LOCKSTEP_MAX_FLOORS andares)
+bool lockstep_supported(const BuildingConfig *cfg);
+
+// Reserva um lote de até lanes pistas. Retorna false sem memória.
+bool lockstep_init(LockstepBatch *b, int lanes);
+void lockstep_free(LockstepBatch *b);
+
+// Desliga todas as pistas
+void lockstep_clear(LockstepBatch *b);
+
+// Liga a próxima pista com o estado de sim_init(cfg, mode) e o gerador rng.
+// Retorna o índice da pista, ou -1 se o lote está cheio ou cfg não cabe.
+int lockstep_add(LockstepBatch *b, const BuildingConfig *cfg, TrafficMode mode,
+                 const SimRng *rng);
+
+// Avança todas as pistas ligadas cycles ciclos
+void lockstep_run(LockstepBatch *b, long long cycles);
+
+// Núcleo vetorial em uso ("avx512", "avx2" ou "escalar")
+const char *lockstep_kernel_name(void);
+
+// Força um núcleo pelo nome (para conferir e medir); false se a CPU não
+// tiver o conjunto de instruções ou o nome for desconhecido
+bool lockstep_force_kernel(const char *name);
+
+#endif
@@ -0,0 +1,352 @@
+/*
+ * Leitura do log textual: filtro SIMD de palavras-chave + expressões de parse_log
+ */
+
+#include "log_ingest.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LOG_SCAN_X86 1
+#endif
+
+// ---------------------------------------------------------------------------
+// Filtro de linhas: pares de bytes presentes em todas as palavras-chave
+// ("Ciclo:"/"Ocupação:" -> "o:", "DECISÃO"/"EMERGÊNCIA" -> "CI",
+// "EMBARQUE"/"DESEMBARQUE" -> "QU", "ignorando chamada" -> "ig")
+// ---------------------------------------------------------------------------
+
+typedef const char *(*ScanFn)(const char *p, const char *end);
+
+static inline bool key_pair(char a, char b) {
+    return (a == 'o' && b == ':') || (a == 'C' && b == 'I') ||
+           (a == 'Q' && b == 'U') || (a == 'i' && b == 'g');
+}
+
+static const char *scan_scalar(const char *p, const char *end) {
+    for (; end - p >= 2; p++) {
+        if (key_pair(p[0], p[1])) return p;
+    }
+    return end;
+}
+
+#ifdef LOG_SCAN_X86
+
+__attribute__((target("sse2")))
+static const char *scan_sse2(const char *p, const char *end) {
+    const __m128i o = _mm_set1_epi8('o'), colon = _mm_set1_epi8(':');
+    const __m128i c = _mm_set1_epi8('C'), i = _mm_set1_epi8('I');
+    const __m128i q = _mm_set1_epi8('Q'), u = _mm_set1_epi8('U');
+    const __m128i li = _mm_set1_epi8('i'), g = _mm_set1_epi8('g');
+
+    // a = bytes p..p+15, b = os seguintes (p+1..p+16)
+    while (end - p >= 17) {
+        __m128i a = _mm_loadu_si128((const __m128i *)p);
+        __m128i b = _mm_loadu_si128((const __m128i *)(p + 1));
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(a, o), _mm_cmpeq_epi8(b, colon)),
+                         _mm_and_si128(_mm_cmpeq_epi8(a, c), _mm_cmpeq_epi8(b, i))),
+            _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(a, q), _mm_cmpeq_epi8(b, u)),
+                         _mm_and_si128(_mm_cmpeq_epi8(a, li), _mm_cmpeq_epi8(b, g))));
+        int mask = _mm_movemask_epi8(m);
+        if (mask) return p + __builtin_ctz((unsigned)mask);
+        p += 16;
+    }
+    return scan_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char *scan_avx2(const char *p, const char *end) {
+    const __m256i o = _mm256_set1_epi8('o'), colon = _mm256_set1_epi8(':');
+    const __m256i c = _mm256_set1_epi8('C'), i = _mm256_set1_epi8('I');
+    const __m256i q = _mm256_set1_epi8('Q'), u = _mm256_set1_epi8('U');
+    const __m256i li = _mm256_set1_epi8('i'), g = _mm256_set1_epi8('g');
+
+    while (end - p >= 33) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)p);
+        __m256i b = _mm256_loadu_si256((const __m256i *)(p + 1));
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(_mm256_and_si256(_mm256_cmpeq_epi8(a, o), _mm256_cmpeq_epi8(b, colon)),
+                            _mm256_and_si256(_mm256_cmpeq_epi8(a, c), _mm256_cmpeq_epi8(b, i))),
+            _mm256_or_si256(_mm256_and_si256(_mm256_cmpeq_epi8(a, q), _mm256_cmpeq_epi8(b, u)),
+                            _mm256_and_si256(_mm256_cmpeq_epi8(a, li), _mm256_cmpeq_epi8(b, g))));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(m);
+        if (mask) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return scan_sse2(p, end);
+}
+
+#endif
+
+static _Atomic(ScanFn) scan_kernel;
+
+static ScanFn scan_select(void) {
+    ScanFn fn = atomic_load_explicit(&scan_kernel, memory_order_relaxed);
+    if (fn) return fn;
+    fn = scan_scalar;
+#ifdef LOG_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) fn = scan_avx2;
+    else if (__builtin_cpu_supports("sse2")) fn = scan_sse2;
+#endif
+    atomic_store_explicit(&scan_kernel, fn, memory_order_relaxed);
+    return fn;
+}
+
+const char *log_scan_kernel_name(void) {
+    ScanFn fn = scan_select();
+#ifdef LOG_SCAN_X86
+    if (fn == scan_avx2) return "avx2";
+    if (fn == scan_sse2) return "sse2";
+#endif
+    (void)fn;
+    return "escalar";
+}
+
+// ---------------------------------------------------------------------------
+// Expressões de parse_log, sobre os bytes da linha (sem o terminador)
+// ---------------------------------------------------------------------------
+
+static inline bool is_eol(char c) {
+    return c == '\n' || c == '\r';
+}
+
+static const char *find_eol(const char *p, const char *end) {
+    while (p < end && !is_eol(*p)) p++;
+    return p;
+}
+
+// \s do Python (a faixa ASCII; o simulador não escreve outros espaços)
+static inline bool is_space(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r') || (c >= 0x1c && c <= 0x1f);
+}
+
+// \w: letras, dígitos, '_' e qualquer byte de um caractere UTF-8 (acentos)
+static inline bool is_word(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+           c == '_' || c >= 0x80;
+}
+
+static const char *find_lit(const char *s, const char *e, const char *lit, size_t n) {
+    for (const char *p = s; e - p >= (ptrdiff_t)n; p++) {
+        p = memchr(p, lit[0], (size_t)(e - p) - n + 1);
+        if (!p) return NULL;
+        if (memcmp(p, lit, n) == 0) return p;
+    }
+    return NULL;
+}
+
+#define LIT(s) s, sizeof(s) - 1
+
+static bool eat_lit(const char **q, const char *e, const char *lit, size_t n) {
+    if (e - *q < (ptrdiff_t)n || memcmp(*q, lit, n) != 0) return false;
+    *q += n;
+    return true;
+}
+
+// \s+
+static bool eat_spaces(const char **q, const char *e) {
+    const char *p = *q;
+    while (p < e && is_space((unsigned char)*p)) p++;
+    if (p == *q) return false;
+    *q = p;
+    return true;
+}
+
+// (\d+), saturado em max
+static bool eat_num(const char **q, const char *e, int64_t *v, int64_t max) {
+    const char *p = *q;
+    int64_t x = 0;
+    while (p < e && *p >= '0' && *p <= '9') {
+        int d = *p - '0';
+        x = x <= (max - d) / 10 ? x * 10 + d : max;
+        p++;
+    }
+    if (p == *q) return false;
+    *v = x;
+    *q = p;
+    return true;
+}
+
+static bool eat_int(const char **q, const char *e, int64_t *v) {
+    return eat_num(q, e, v, INT32_MAX);
+}
+
+// Ciclo:\s+(\d+)\s+\|\s+Andar:\s+(\d+)\s+\|\s+Dir:\s+(\w+)\s+\|\s+Ocupação:\s+(\d+)/(\d+)
+static bool header_at(const char *q, const char *e, LogRow *r) {
+    int64_t cycle, floor, occupancy, capacity;
+    const char *dir, *dir_end;
+
+    q += sizeof("Ciclo:") - 1;
+    if (!eat_spaces(&q, e) || !eat_num(&q, e, &cycle, INT64_MAX) || !eat_spaces(&q, e) ||
+        !eat_lit(&q, e, LIT("|")) || !eat_spaces(&q, e) || !eat_lit(&q, e, LIT("Andar:")) ||
+        !eat_spaces(&q, e) || !eat_int(&q, e, &floor) || !eat_spaces(&q, e) ||
+        !eat_lit(&q, e, LIT("|")) || !eat_spaces(&q, e) || !eat_lit(&q, e, LIT("Dir:")) ||
+        !eat_spaces(&q, e)) {
+        return false;
+    }
+    dir = q;
+    while (q < e && is_word((unsigned char)*q)) q++;
+    dir_end = q;
+    if (dir_end == dir || !eat_spaces(&q, e) || !eat_lit(&q, e, LIT("|")) ||
+        !eat_spaces(&q, e) || !eat_lit(&q, e, LIT("Ocupação:")) || !eat_spaces(&q, e) ||
+        !eat_int(&q, e, &occupancy) || !eat_lit(&q, e, LIT("/")) ||
+        !eat_int(&q, e, &capacity)) {
+        return false;
+    }
+
+    size_t dir_len = (size_t)(dir_end - dir);
+    memset(r, 0, sizeof(*r));
+    r->cycle = cycle;
+    r->floor = (int32_t)floor;
+    r->occupancy = (int32_t)occupancy;
+    r->capacity = (int32_t)capacity;
+    r->decision = LOG_NO_DECISION;
+    if (dir_len == 7 && memcmp(dir, "Subindo", 7) == 0) r->direction = LOG_DIR_UP;
+    else if (dir_len == 8 && memcmp(dir, "Descendo", 8) == 0) r->direction = LOG_DIR_DOWN;
+    else {
+        r->direction = LOG_DIR_OTHER;
+        if (dir_len >= LOG_DIR_WORD_MAX) dir_len = LOG_DIR_WORD_MAX - 1;
+        memcpy(r->direction_word, dir, dir_len);
+    }
+    return true;
+}
+
+// regex.search: a primeira ocorrência de "Ciclo:" em que a expressão casa
+static bool match_header(const char *s, const char *e, LogRow *r) {
+    for (const char *q = s; (q = find_lit(q, e, LIT("Ciclo:"))) != NULL; q++) {
+        if (header_at(q, e, r)) return true;
+    }
+    return false;
+}
+
+// DECISÃO:\s+Parar no andar\s+(\d+)
+static bool match_decision(const char *s, const char *e, int64_t *v) {
+    for (const char *q = s; (q = find_lit(q, e, LIT("DECISÃO:"))) != NULL; q++) {
+        const char *p = q + sizeof("DECISÃO:") - 1;
+        if (eat_spaces(&p, e) && eat_lit(&p, e, LIT("Parar no andar")) &&
+            eat_spaces(&p, e) && eat_int(&p, e, v)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// DESEMBARQUE:\s+(\d+)
+static bool match_disembark(const char *s, const char *e, int64_t *v) {
+    for (const char *q = s; (q = find_lit(q, e, LIT("DESEMBARQUE:"))) != NULL; q++) {
+        const char *p = q + sizeof("DESEMBARQUE:") - 1;
+        if (eat_spaces(&p, e) && eat_int(&p, e, v)) return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Parser
+// ---------------------------------------------------------------------------
+
+void log_parser_init(LogParser *p) {
+    memset(p, 0, sizeof(*p));
+    scan_select();
+}
+
+void log_parser_free(LogParser *p) {
+    free(p->rows);
+    memset(p, 0, sizeof(*p));
+}
+
+void log_parser_take(LogParser *p) {
+    p->count = 0;
+}
+
+static void emit_row(LogParser *p) {
+    if (p->count == p->capacity) {
+        size_t cap = p->capacity ? p->capacity * 2 : 4096;
+        LogRow *rows = realloc(p->rows, cap * sizeof(LogRow));
+        if (!rows) {
+            p->failed = true;
+            return;
+        }
+        p->rows = rows;
+        p->capacity = cap;
+    }
+    p->rows[p->count++] = p->row;
+}
+
+void log_parser_flush(LogParser *p) {
+    if (p->open) emit_row(p);
+    p->open = false;
+}
+
+// Uma linha com algum par do filtro: as mesmas checagens, na mesma ordem,
+// do laço de parse_log
+static void parse_line(LogParser *p, const char *s, const char *e) {
+    LogRow header;
+    if (match_header(s, e, &header)) {
+        if (p->open) emit_row(p);
+        p->row = header;
+        p->open = true;
+        return;
+    }
+    if (!p->open) return;
+
+    LogRow *r = &p->row;
+    int64_t v;
+    if (match_decision(s, e, &v)) r->decision = (int32_t)v;
+    if (find_lit(s, e, LIT("EMBARQUE"))) r->embarked++;
+    if (match_disembark(s, e, &v)) r->disembarked += (int32_t)v;
+    if (find_lit(s, e, LIT("EMERGÊNCIA"))) r->emergency = 1;
+    if (find_lit(s, e, LIT("ignorando chamada"))) r->skipped++;
+}
+
+size_t log_parse(LogParser *p, const char *buf, size_t len, bool final) {
+    const ScanFn scan = scan_select();
+    const char *end = buf + len;
+    const char *pos = buf;          // linhas antes de pos já foram lidas
+
+    for (;;) {
+        const char *hit = scan(pos, end);
+        if (hit >= end) break;
+
+        const char *ls = hit;
+        while (ls > pos && !is_eol(ls[-1])) ls--;
+        const char *le = find_eol(hit, end);
+        if (le == end && !final) {
+            return (size_t)(ls - buf);
+        }
+        parse_line(p, ls, le);
+        pos = le;
+    }
+
+    if (final) return len;
+    // Sem candidatos no resto: consome até o último terminador
+    const char *last = end;
+    while (last > pos && !is_eol(last[-1])) last--;
+    return (size_t)(last - buf);
+}
+
+size_t log_next_header(const char *buf, size_t len, size_t from) {
+    const ScanFn scan = scan_select();
+    const char *end = buf + len;
+    if (from >= len) return len;
+
+    const char *pos = buf + from;
+    if (from > 0 && !is_eol(buf[from - 1])) pos = find_eol(pos, end);
+
+    LogRow row;
+    while (pos < end) {
+        const char *hit = scan(pos, end);
+        if (hit >= end) break;
+
+        const char *ls = hit;
+        while (ls > pos && !is_eol(ls[-1])) ls--;
+        const char *le = find_eol(hit, end);
+        if (match_header(ls, le, &row)) return (size_t)(ls - buf);
+        pos = le;
+    }
+    return len;
+}
@@ -0,0 +1,80 @@
+#ifndef LOG_INGEST_H
+#define LOG_INGEST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Leitura do log textual do Monitor Serial (somente host).
+//
+// Monta as mesmas linhas por ciclo que parse_log em
+// tools/analisar_smartstop.py. Uma linha de log com o cabeçalho
+// "Ciclo: N | Andar: N | Dir: X | Ocupação: N/N" abre um ciclo. Nas outras
+// linhas, "DECISÃO: Parar no andar N", "EMBARQUE", "DESEMBARQUE: N",
+// "EMERGÊNCIA" e "ignorando chamada" somam no ciclo aberto. O que vem antes
+// do primeiro cabeçalho é descartado. As linhas terminam em \n, \r ou \r\n.
+//
+// Quase todas as linhas do log não têm nenhuma dessas palavras. Um filtro
+// SIMD (SSE2, AVX2 quando a CPU tiver) procura pares de bytes que toda
+// palavra contém ("o:", "CI", "QU", "ig"), e só as linhas com um par passam
+// pelas expressões. As outras linhas não são nem separadas.
+//
+// Como todo ciclo começa num cabeçalho, um trecho que começa num cabeçalho
+// pode ser lido sozinho. log_next_header acha esses pontos de corte para a
+// leitura em paralelo.
+
+#define LOG_DIR_UP     1        // "Subindo"
+#define LOG_DIR_DOWN  -1        // "Descendo"
+#define LOG_DIR_OTHER  0        // outra palavra (o simulador só escreve as duas)
+
+#define LOG_DIR_WORD_MAX 16
+
+#define LOG_NO_DECISION -1
+
+// Um ciclo (mesmos campos de parse_log)
+typedef struct {
+    int64_t cycle;
+    int32_t floor;
+    int32_t occupancy;
+    int32_t capacity;
+    int32_t decision;           // LOG_NO_DECISION = movimento contínuo
+    int32_t embarked;           // linhas com "EMBARQUE" (inclui DESEMBARQUE, como no script)
+    int32_t disembarked;
+    int32_t skipped;
+    int8_t direction;           // LOG_DIR_*
+    uint8_t emergency;
+    char direction_word[LOG_DIR_WORD_MAX];  // LOG_DIR_OTHER: a palavra (cortada)
+} LogRow;
+
+typedef struct {
+    LogRow row;                 // ciclo aberto
+    bool open;
+
+    LogRow *rows;               // ciclos fechados desde log_parser_take
+    size_t count;
+    size_t capacity;
+    bool failed;                // faltou memória para rows
+} LogParser;
+
+void log_parser_init(LogParser *p);
+void log_parser_free(LogParser *p);
+
+// Lê as linhas de buf[0..len). Com final = false só as linhas completas:
+// retorna quantos bytes foram consumidos, e o resto deve voltar na próxima
+// chamada junto com o que chegar depois. Com final = true lê tudo.
+size_t log_parse(LogParser *p, const char *buf, size_t len, bool final);
+
+// Fecha o ciclo aberto (fim do arquivo ou do trecho)
+void log_parser_flush(LogParser *p);
+
+// Esvazia rows (o ciclo aberto continua)
+void log_parser_take(LogParser *p);
+
+// Início da primeira linha de cabeçalho que começa em from ou depois; len se
+// não houver
+size_t log_next_header(const char *buf, size_t len, size_t from);
+
+// "sse2", "avx2" ou "escalar": filtro escolhido para esta CPU
+const char *log_scan_kernel_name(void);
+
+#endif
@@ -0,0 +1,357 @@
+/*
+ * Despacho com antecipação: branch-and-bound sobre sequências de paradas,
+ * aprofundamento iterativo, tabela de transposição e orçamento de tempo
+ */
+
+#include "lookahead.h"
+
+#include <stdio.h>
+
+#include "hal.h"
+
+#define TT_SIZE (1u << LOOKAHEAD_TT_BITS)
+#define NO_STOP 0xFFu
+#define CLOCK_CHECK_MASK 31u        // consulta o relógio a cada 32 nós
+
+void lookahead_init(Lookahead *la, int horizon, uint32_t budget_us) {
+    if (horizon < 1) horizon = 1;
+    if (horizon > LOOKAHEAD_MAX_HORIZON) horizon = LOOKAHEAD_MAX_HORIZON;
+    la->horizon = horizon;
+    la->budget_us = budget_us;
+
+    for (uint32_t i = 0; i < TT_SIZE; i++) {
+        la->table[i].gen = 0;
+    }
+    la->gen = 0;
+
+    la->decisions = 0;
+    la->fallbacks = 0;
+    la->timeouts = 0;
+    la->nodes = 0;
+    la->tt_hits = 0;
+    la->depth_sum = 0;
+    la->time_sum_us = 0;
+    la->time_max_us = 0;
+}
+
+// Candidatas: andares com chamada, destino interno ou botão, das mais
+// próximas do carro para as mais distantes
+static void collect_stops(Lookahead *la, const SimContext *ctx) {
+    const CallRegistry *reg = &ctx->reg;
+    const int cur = ctx->elevator.current_floor;
+    const int n = ctx->cfg.num_floors;
+
+    la->num_stops = 0;
+    for (int d = 0; d < n && la->num_stops < LOOKAHEAD_MAX_STOPS; d++) {
+        int pair[2] = { cur - d, cur + d };
+        for (int k = 0; k < (d == 0 ? 1 : 2) && la->num_stops < LOOKAHEAD_MAX_STOPS; k++) {
+            int f = pair[k];
+            if (f < 0 || f >= n) continue;
+            bool hall = floorset_test(&reg->active, f) && ctx->calls[f].est_passengers > 0;
+            bool internal = floorset_test(&reg->internal, f);
+            bool button = floorset_test(&reg->button, f);
+            if (!hall && !internal && !button) continue;
+
+            int s = la->num_stops++;
+            int waiting = hall ? ctx->calls[f].est_passengers : 0;
+            la->floor[s] = (int16_t)f;
+            la->board[s] = (uint8_t)(waiting > 255 ? 255 : waiting);
+            la->alight[s] = 0;
+
+            uint32_t w = 0;
+            if (hall) {
+                uint32_t age = 1u + (uint32_t)sim_call_wait(ctx, f) / WAIT_BONUS_AFTER;
+                uint32_t people = waiting > 15 ? 15u : (uint32_t)waiting;
+                w = people * (age > 4 ? 4u : age);
+            }
+            if (button) w += LOOKAHEAD_BUTTON_WEIGHT;
+            la->weight[s] = (uint16_t)w;
+        }
+    }
+}
+
+// Quem desce em cada candidata: exato no modelo individual; no anônimo a
+// ocupação dividida entre os destinos internos
+static void estimate_alighting(Lookahead *la, const SimContext *ctx) {
+    const ElevatorState *e = &ctx->elevator;
+
+    if (ctx->pax) {
+        const PassengerModel *m = ctx->pax;
+        for (uint16_t id = m->onboard; id != PASSENGER_NONE; id = m->pool.slots[id].next) {
+            int dest = m->pool.slots[id].dest;
+            for (int s = 0; s < la->num_stops; s++) {
+                if (la->floor[s] == dest && la->alight[s] < 255) {
+                    la->alight[s]++;
+                    break;
+                }
+            }
+        }
+    } else {
+        int internal = floorset_count(&ctx->reg.internal);
+        int share = internal > 0 ? (e->occupancy + internal - 1) / internal : 0;
+        if (share > 255) share = 255;
+        for (int s = 0; s < la->num_stops; s++) {
+            if (floorset_test(&ctx->reg.internal, la->floor[s])) {
+                la->alight[s] = (uint8_t)(share > 0 ? share : 1);
+            }
+        }
+    }
+
+    for (int s = 0; s < la->num_stops; s++) {
+        uint32_t w = (uint32_t)la->weight[s] + la->alight[s];
+        la->weight[s] = (uint16_t)(w > UINT16_MAX ? UINT16_MAX : w);
+    }
+}
+
+static void build_legs(Lookahead *la, const SimContext *ctx) {
+    const BuildingConfig *cfg = &ctx->cfg;
+    const int cur = ctx->elevator.current_floor;
+
+    for (int from = 0; from <= la->num_stops; from++) {
+        int f0 = (from == la->num_stops) ? cur : la->floor[from];
+        for (int to = 0; to < la->num_stops; to++) {
+            int dist = la->floor[to] > f0 ? la->floor[to] - f0 : f0 - la->floor[to];
+            uint32_t ms = (uint32_t)dist * (uint32_t)cfg->travel_time_ms + (uint32_t)cfg->door_time_ms;
+            uint32_t t = ms / LOOKAHEAD_TIME_UNIT_MS;
+            if (t == 0) t = 1;
+            la->leg[from][to] = (uint16_t)(t > UINT16_MAX ? UINT16_MAX : t);
+        }
+    }
+}
+
+// Chave compacta do estado; a posição é o índice da candidata (ou
+// num_stops para o andar inicial do carro)
+static uint64_t state_key(int pos, uint32_t remaining, int occupancy, int depth) {
+    return (uint64_t)remaining | ((uint64_t)pos << 16) | ((uint64_t)(occupancy & 0xFFFF) << 21) |
+           ((uint64_t)depth << 37);
+}
+
+static LookaheadEntry *tt_slot(Lookahead *la, uint64_t key) {
+    uint64_t h = key * 0x9E3779B97F4A7C15ull;
+    return &la->table[h >> (64 - LOOKAHEAD_TT_BITS)];
+}
+
+// Limite inferior das paradas restantes (cada uma alcançada direto da
+// posição atual) e o peso total delas
+static uint32_t lower_bound(const Lookahead *la, int pos, uint32_t remaining, uint32_t *weight) {
+    uint32_t lb = 0, w = 0;
+    for (uint32_t r = remaining; r; r &= r - 1) {
+        int s = __builtin_ctz(r);
+        lb += (uint32_t)la->weight[s] * la->leg[pos][s];
+        w += la->weight[s];
+    }
+    *weight = w;
+    return lb;
+}
+
+// Ocupação depois de parar em s; -1 se a parada não adianta (lotado e
+// ninguém desce)
+static int occupancy_after(const Lookahead *la, int s, int occupancy) {
+    int out = la->alight[s] < occupancy ? la->alight[s] : occupancy;
+    occupancy -= out;
+    int room = la->capacity - occupancy;
+    if (la->board[s] > 0 && room <= 0 && out == 0) return -1;
+    if (room > 0) occupancy += la->board[s] < room ? la->board[s] : room;
+    return occupancy;
+}
+
+// Candidatas restantes da mais próxima para a mais distante
+static int order_children(const Lookahead *la, int pos, uint32_t remaining, uint8_t out[]) {
+    int n = 0;
+    for (uint32_t r = remaining; r; r &= r - 1) {
+        int s = __builtin_ctz(r);
+        int j = n++;
+        while (j > 0 && la->leg[pos][out[j - 1]] > la->leg[pos][s]) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = (uint8_t)s;
+    }
+    return n;
+}
+
+static bool out_of_time(Lookahead *la) {
+    if (!la->aborted && la->deadline_us && (la->nodes & CLOCK_CHECK_MASK) == 0 &&
+        hal_time_us() >= la->deadline_us) {
+        la->aborted = true;
+    }
+    return la->aborted;
+}
+
+// Custo das paradas restantes a partir de pos, com o relógio zerado ao
+// sair de pos. Retorna o valor exato se for menor que limit; senão, algum
+// valor >= limit.
+static uint32_t search(Lookahead *la, int pos, uint32_t remaining, int occupancy, int depth,
+                       uint32_t limit) {
+    la->nodes++;
+    if (remaining == 0) return 0;
+
+    uint32_t total_weight;
+    uint32_t lb = lower_bound(la, pos, remaining, &total_weight);
+    if (depth == 0 || lb >= limit || out_of_time(la)) return lb;
+
+    uint64_t key = state_key(pos, remaining, occupancy, depth);
+    LookaheadEntry *slot = tt_slot(la, key);
+    if (slot->gen == la->gen && slot->key == key) {
+        if (slot->exact || slot->value >= limit) {
+            la->tt_hits++;
+            return slot->value;
+        }
+    }
+
+    uint8_t order[LOOKAHEAD_MAX_STOPS];
+    int n = order_children(la, pos, remaining, order);
+    uint32_t best = limit;
+    bool found = false, feasible = false;
+
+    for (int k = 0; k < n; k++) {
+        int s = order[k];
+        int occ = occupancy_after(la, s, occupancy);
+        if (occ < 0) continue;
+        feasible = true;
+
+        // Todas as restantes (inclusive s) esperam mais esta perna
+        uint32_t step = total_weight * la->leg[pos][s];
+        if (step >= best) break;        // as próximas pernas só são mais longas
+
+        uint32_t sub = search(la, s, remaining & ~(1u << s), occ, depth - 1, best - step);
+        if (la->aborted) return lb;
+        if (step + sub < best) {
+            best = step + sub;
+            found = true;
+        }
+    }
+
+    // Nenhuma parada possível agora (lotado sem destino): vale a estimativa
+    if (!feasible) {
+        best = lb;
+        found = true;
+    }
+
+    slot->key = key;
+    slot->gen = la->gen;
+    slot->value = best;
+    slot->exact = found;
+    return best;
+}
+
+// Uma iteração do aprofundamento: melhor primeira parada para depth
+// paradas, tentando first antes das demais. Retorna NO_STOP se o tempo
+// acabou antes de avaliar alguma candidata por completo.
+static uint8_t search_root(Lookahead *la, int occupancy, int depth, uint8_t first) {
+    const int root = la->num_stops;
+    uint32_t all = (1u << la->num_stops) - 1u;
+    uint32_t total_weight;
+    lower_bound(la, root, all, &total_weight);
+
+    uint8_t order[LOOKAHEAD_MAX_STOPS];
+    int n = order_children(la, root, all, order);
+    if (first != NO_STOP) {
+        for (int k = 0; k < n; k++) {
+            if (order[k] == first) {
+                for (int j = k; j > 0; j--) order[j] = order[j - 1];
+                order[0] = first;
+                break;
+            }
+        }
+    }
+
+    uint32_t best = UINT32_MAX;
+    uint8_t best_stop = NO_STOP;
+    for (int k = 0; k < n; k++) {
+        int s = order[k];
+        int occ = occupancy_after(la, s, occupancy);
+        if (occ < 0) continue;
+
+        uint32_t step = total_weight * la->leg[root][s];
+        if (step >= best) continue;     // ordem alterada por first: não dá para parar aqui
+
+        uint32_t sub = search(la, s, all & ~(1u << s), occ, depth - 1, best - step);
+        if (la->aborted) break;
+        if (step + sub < best) {
+            best = step + sub;
+            best_stop = (uint8_t)s;
+        }
+    }
+    return best_stop;
+}
+
+int lookahead_decide(Lookahead *la, const SimContext *ctx) {
+    // Emergência continua com a regra da cascata (chegar ou adiar pelo caminho)
+    if (sim_emergency_call(ctx) != -1) {
+        la->fallbacks++;
+        return -1;
+    }
+
+    collect_stops(la, ctx);
+    if (la->num_stops == 0) {
+        la->fallbacks++;
+        return -1;
+    }
+
+    uint64_t start_us = hal_time_us();
+    la->deadline_us = la->budget_us ? start_us + la->budget_us : 0;
+    la->aborted = false;
+    la->capacity = ctx->cfg.car_capacity;
+    estimate_alighting(la, ctx);
+    build_legs(la, ctx);
+
+    // Nova geração: entradas de decisões anteriores deixam de valer
+    if (++la->gen == 0) {
+        for (uint32_t i = 0; i < TT_SIZE; i++) {
+            la->table[i].gen = 0;
+        }
+        la->gen = 1;
+    }
+
+    uint8_t best = NO_STOP;
+    int reached = 0;
+    int max_depth = la->horizon < la->num_stops ? la->horizon : la->num_stops;
+    for (int depth = 1; depth <= max_depth; depth++) {
+        uint8_t s = search_root(la, ctx->elevator.occupancy, depth, best);
+        if (la->aborted) {
+            // Iteração incompleta: só vale se uma candidata superou a anterior
+            if (s != NO_STOP) best = s;
+            la->timeouts++;
+            break;
+        }
+        best = s;
+        reached = depth;
+        if (best == NO_STOP) break;     // nenhuma parada possível
+    }
+
+    uint32_t us = (uint32_t)(hal_time_us() - start_us);
+    la->time_sum_us += us;
+    if (us > la->time_max_us) la->time_max_us = us;
+
+    if (best == NO_STOP) {
+        la->fallbacks++;
+        return -1;
+    }
+    la->decisions++;
+    la->depth_sum += (uint64_t)reached;
+    return la->floor[best];
+}
+
+void lookahead_print_report(const Lookahead *la) {
+    uint32_t calls = la->decisions + la->fallbacks;
+    printf("\n--- Antecipação (horizonte %d, orçamento ", la->horizon);
+    if (la->budget_us) {
+        printf("%u us) ---\n", la->budget_us);
+    } else {
+        printf("livre) ---\n");
+    }
+    printf("Decisões pela busca: %u | pela cascata: %u | orçamento estourado: %u\n",
+           la->decisions, la->fallbacks, la->timeouts);
+    if (la->decisions > 0) {
+        printf("Profundidade média:  %.2f paradas\n",
+               (double)la->depth_sum / (double)la->decisions);
+    }
+    printf("Nós avaliados:       %llu (%llu da tabela de transposição)\n",
+           (unsigned long long)la->nodes, (unsigned long long)la->tt_hits);
+    if (calls > 0) {
+        printf("Tempo por decisão:   média %.1f / máx %u us\n",
+               (double)la->time_sum_us / (double)calls, la->time_max_us);
+    }
+    printf("----------------------------------------------\n");
+}
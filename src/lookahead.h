@@ -0,0 +1,92 @@
+#ifndef LOOKAHEAD_H
+#define LOOKAHEAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dispatch.h"
+
+// Despacho com antecipação: em vez de pontuar uma parada por vez, busca a
+// melhor sequência das próximas paradas e devolve a primeira.
+//
+// Custo de uma sequência: soma, por parada, do peso vezes o instante em que
+// o carro chega lá (viagem + portas). Peso de uma chamada externa =
+// passageiros esperando x (1 + espera / WAIT_BONUS_AFTER), mais
+// LOOKAHEAD_BUTTON_WEIGHT se veio dos botões; de um destino interno = quem
+// desce nele. Paradas além do horizonte entram pelo limite inferior (ir
+// direto do último andar até cada uma), que também poda a busca
+// (branch-and-bound).
+//
+// A busca aprofunda um andar por vez (1, 2, ..., horizonte) e guarda os
+// estados já avaliados numa tabela de transposição indexada por (andar do
+// carro, paradas restantes, ocupação, profundidade). Ao estourar o
+// orçamento de tempo fica com a melhor resposta completa até ali; sem
+// nenhuma, ou com chamada em emergência, decide a cascata gulosa
+// (choose_next_floor_realistic).
+//
+// Memória fixa (tabela de 16 KB com os valores padrão), sem malloc: roda no
+// Pico. Com orçamento diferente de zero o resultado depende do tempo real
+// de CPU; com 0 a busca é completa e reprodutível pela semente.
+
+#ifndef LOOKAHEAD_MAX_STOPS
+#define LOOKAHEAD_MAX_STOPS 16      // paradas candidatas (as mais próximas do carro)
+#endif
+
+#ifndef LOOKAHEAD_TT_BITS
+#define LOOKAHEAD_TT_BITS 10        // 2^10 entradas de 16 bytes
+#endif
+
+#define LOOKAHEAD_MAX_HORIZON   8
+#define LOOKAHEAD_BUTTON_WEIGHT 16  // botões A/B continuam à frente das demais
+#define LOOKAHEAD_TIME_UNIT_MS  100 // resolução dos custos
+
+#if LOOKAHEAD_MAX_STOPS > 16
+#error "LOOKAHEAD_MAX_STOPS deve caber na máscara de 16 bits da tabela"
+#endif
+
+typedef struct {
+    uint64_t key;
+    uint32_t value;
+    uint16_t gen;                   // decisão que gravou (entradas antigas valem vazio)
+    uint8_t exact;                  // 0 = só limite inferior (busca podada)
+} LookaheadEntry;
+
+struct Lookahead {
+    int horizon;                    // paradas à frente (1..LOOKAHEAD_MAX_HORIZON)
+    uint32_t budget_us;             // tempo máximo por decisão (0 = sem limite)
+
+    LookaheadEntry table[1u << LOOKAHEAD_TT_BITS];
+    uint16_t gen;
+
+    // Decisão em andamento
+    int num_stops;
+    int16_t floor[LOOKAHEAD_MAX_STOPS];
+    uint16_t weight[LOOKAHEAD_MAX_STOPS];
+    uint8_t board[LOOKAHEAD_MAX_STOPS];     // esperando no andar (0 = só destino)
+    uint8_t alight[LOOKAHEAD_MAX_STOPS];    // descem no andar
+    // Tempo de cada andar candidato (e do carro, na última linha) a cada um
+    uint16_t leg[LOOKAHEAD_MAX_STOPS + 1][LOOKAHEAD_MAX_STOPS];
+    int capacity;
+    uint64_t deadline_us;
+    bool aborted;
+
+    // Estatísticas
+    uint32_t decisions;             // respondidas pela busca
+    uint32_t fallbacks;             // passadas à cascata (emergência, sem resposta)
+    uint32_t timeouts;              // orçamento estourado antes do horizonte
+    uint64_t nodes;
+    uint64_t tt_hits;
+    uint64_t depth_sum;             // profundidade completa alcançada, somada
+    uint64_t time_sum_us;
+    uint32_t time_max_us;
+};
+
+// Horizonte em paradas e orçamento por decisão em us (0 = sem limite)
+void lookahead_init(Lookahead *la, int horizon, uint32_t budget_us);
+
+// Melhor primeira parada para o carro de ctx, ou -1 para a cascata decidir
+int lookahead_decide(Lookahead *la, const SimContext *ctx);
+
+void lookahead_print_report(const Lookahead *la);
+
+#endif
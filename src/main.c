@@ -11,6 +11,58 @@
  *   - Fallback por baixa ocupação (<= 2 passageiros)
  *
  * Saída: logs no terminal (USB serial) mostrando decisões a cada ciclo.
+ * A lógica de despacho fica em dispatch.c (compartilhada com o build host).
+ *
+ * Com SMARTSTOP_TRACE a saída USB passa a ser o traço binário (trace.h)
+ * no lugar do log textual; capture com, por exemplo,
+ *   cat /dev/ttyACM0 > smartstop.sst
+ * e leia com smartstop_trace no host.
+ *
+ * O log textual é diferido (deflog.h): o laço só empilha registros e o texto
+ * é formatado e enviado durante as pausas de viagem/porta. Com o terminal
+ * lento ou fechado, mensagens são descartadas e contadas, sem travar o laço.
+ *
+ * Com SMARTSTOP_DUAL_CORE o núcleo 0 fica só com o laço de despacho e
+ * movimento; o núcleo 1 sorteia o tráfego adiantado e formata/envia o log
+ * (incluindo as estatísticas), trocando dados apenas por filas SPSC
+ * (offload.c). A cada LOOP_REPORT_CYCLES ciclos o log mostra o trabalho por
+ * ciclo do laço e o atraso das pausas, para comparar os dois modos.
+ *
+ * Os botões A/B são lidos por interrupção (borda de descida) com debounce
+ * por alarme: a borda anota o instante e desliga a interrupção do pino; o
+ * alarme confirma o nível baixo BUTTON_DEBOUNCE_US depois e põe o evento
+ * na fila (button_queue.h). O laço registra as pressões a cada pausa,
+ * inclusive entre andares durante a viagem, e o log mostra a latência da
+ * pressão até o registro e até a parada no andar.
+ *
+ * Com SMARTSTOP_PASSENGERS cada passageiro tem origem e destino (pool fixo,
+ * passenger.h): o desembarque segue o destino e o log mostra a distribuição
+ * da espera e da viagem a cada LOOP_REPORT_CYCLES ciclos.
+ *
+ * Com SMARTSTOP_TRAFFIC_PROFILE=PROFILE_DAY (ou outro perfil de
+ * traffic_source.h) as chegadas seguem o perfil pelo relógio desde o boot,
+ * no lugar do sorteio por TrafficMode. Não combina com SMARTSTOP_DUAL_CORE,
+ * que sorteia o tráfego no núcleo 1.
+ *
+ * Com SMARTSTOP_LOOKAHEAD=H o próximo andar vem da busca de sequências de
+ * até H paradas (lookahead.h), limitada a SMARTSTOP_LOOKAHEAD_BUDGET_US por
+ * decisão; o log mostra o tempo das decisões a cada LOOP_REPORT_CYCLES.
+ *
+ * Com SMARTSTOP_FIXED_POINT a pontuação SmartStop usa frações inteiras em vez
+ * de float (o M0+ não tem FPU). Com SMARTSTOP_KERNEL_BENCH o boot confere as
+ * duas versões em estados aleatórios e mostra os ciclos por decisão de cada
+ * uma (kernel_check.h).
+ *
+ * Com SMARTSTOP_PROFILE cada iteração de sim_step é medida por estágio
+ * (stageprof.h). Pela serial, entre ciclos: 'p' mostra média, p50, p99 e
+ * pior caso de cada estágio e os ciclos com trabalho acima de
+ * SMARTSTOP_PROFILE_DEADLINE_US; 'r' zera as medições.
+ *
+ * Com SMARTSTOP_MOTION o laço troca sim_step pelo controle por prazos
+ * (motion.h): viagem, portas e piscas do LED viram prazos, o laço acorda a
+ * cada prazo (ou a cada MOTION_POLL_MAX_MS, pelos botões) e o despacho
+ * decide de novo a cada andar e quando as portas fecham. Os relatórios saem
+ * a cada LOOP_REPORT_CYCLES tiques de tráfego, com as decisões por minuto.
  */
 
 #include <stdio.h>
@@ -18,8 +70,39 @@
 
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
-#include "smartstop.h"
-#include <stdlib.h>
+#include "dispatch.h"
+#include "hal.h"
+
+#ifdef SMARTSTOP_LOOKAHEAD
+#include "lookahead.h"
+#endif
+
+#ifdef SMARTSTOP_KERNEL_BENCH
+#include "hardware/clocks.h"
+#include "kernel_check.h"
+#endif
+
+#ifdef SMARTSTOP_DUAL_CORE
+#include "pico/multicore.h"
+#include "offload.h"
+#endif
+
+#ifdef SMARTSTOP_MOTION
+#ifdef SMARTSTOP_PROFILE
+#error "SMARTSTOP_PROFILE mede os estágios de sim_step, que SMARTSTOP_MOTION não usa"
+#endif
+#include "motion.h"
+#endif
+
+#ifdef SMARTSTOP_PROFILE
+#ifdef SMARTSTOP_TRACE
+#error "SMARTSTOP_PROFILE responde pela serial, que o SMARTSTOP_TRACE ocupa com o traço"
+#endif
+#include "stageprof.h"
+#ifndef SMARTSTOP_PROFILE_DEADLINE_US
+#define SMARTSTOP_PROFILE_DEADLINE_US PROF_DEFAULT_DEADLINE_US
+#endif
+#endif
 
 // LEDs RGB da BitDogLab
 #define LED_R 13
@@ -30,24 +113,9 @@
 #define BUTTON_A 5   // Botão A: chamada interna
 #define BUTTON_B 6   // Botão B: chamada externa
 
-// Constantes realistas
-#define MAX_WAIT_TIME 25           // Tempo máximo de espera aceitável (ciclos)
-#define EMERGENCY_WAIT_TIME 15     // Tempo para prioridade emergencial
-#define CYCLES_FULL_MAX 8          // Ciclos máximos lotado sem desembarcar
-#define MIN_DISEMBARK_PASSENGERS 1 // Mínimo que desembarca por parada
-#define MAX_DISEMBARK_PASSENGERS 4 // Máximo que desembarca por parada
-#define TRAVEL_TIME_MS 400         // Tempo realista entre andares (ms)
-#define DOOR_TIME_MS 800           // Tempo de abertura/fechamento de portas (ms)
-
-// Vetor de chamadas internas (destinos dos passageiros)
-static bool internal_calls[MAX_FLOORS];
-
-// flags para saber quais chamadas vieram dos botões
-static bool internal_from_button[MAX_FLOORS];  // Andares solicitados pelo botão A
-static bool external_from_button[MAX_FLOORS];  // Andares solicitados pelo botão B
+#define BUTTON_DEBOUNCE_US 20000   // contato estável após a borda
 
-static int cycles_at_full_capacity = 0;
-static int total_cycles = 0;
+#define LOOP_REPORT_CYCLES 50
 
 static void leds_init(void) {
     gpio_init(LED_R);
@@ -58,522 +126,281 @@ static void leds_init(void) {
     gpio_set_dir(LED_B, GPIO_OUT);
 }
 
-static void set_rgb(bool r, bool g, bool b) {
-    gpio_put(LED_R, r ? 1 : 0);
-    gpio_put(LED_G, g ? 1 : 0);
-    gpio_put(LED_B, b ? 1 : 0);
+#ifdef SMARTSTOP_TRACE
+// Bytes crus: putchar_raw não converte \n em \r\n
+static void usb_sink(void *user, const void *data, size_t len) {
+    (void)user;
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++) {
+        putchar_raw(p[i]);
+    }
 }
+#endif
 
-static void set_yellow(void) {
-    set_rgb(true, true, false);
-}
+#ifdef SMARTSTOP_DUAL_CORE
+static SimOffload offload;
 
-static void set_cyan(void) {
-    set_rgb(false, true, true);
+// Núcleo 1: tráfego, estatísticas e console
+static void core1_main(void) {
+    while (true) {
+        if (!sim_offload_poll(&offload)) {
+            sleep_us(100);
+        }
+    }
 }
+#endif
 
-static void buttons_init(void) {
-    gpio_init(BUTTON_A);
-    gpio_init(BUTTON_B);
-    gpio_set_dir(BUTTON_A, GPIO_IN);
-    gpio_set_dir(BUTTON_B, GPIO_IN);
-    gpio_pull_up(BUTTON_A);
-    gpio_pull_up(BUTTON_B);
-}
+static ButtonQueue buttons;
+static volatile uint64_t button_edge_us[2];     // por ButtonId
 
-static void internal_calls_init(void) {
-    for (int i = 0; i < MAX_FLOORS; i++) {
-        internal_calls[i] = false;
-        internal_from_button[i] = false;  
-        external_from_button[i] = false;  
-    }
+static ButtonId button_id(uint gpio) {
+    return gpio == BUTTON_A ? BUTTON_ID_A : BUTTON_ID_B;
 }
 
-static bool any_internal_call(void) {
-    for (int i = 0; i < MAX_FLOORS; i++) {
-        if (internal_calls[i]) return true;
-    }
-    return false;
-}
+// Fim do debounce: pressão válida se o pino continua em nível baixo
+static int64_t button_debounce_alarm(alarm_id_t id, void *user) {
+    (void)id;
+    uint gpio = (uint)(uintptr_t)user;
+    ButtonId b = button_id(gpio);
 
-// Simula desembarque realista de passageiros
-static void simulate_disembark(ElevatorState *elevator, int floor, bool has_call) {
-    if (elevator->occupancy <= 2) return;
-    
-    // Chance de alguém descer neste andar
-    bool someone_exits = false;
-    
-    // Térreo e último andar têm maior probabilidade de desembarque
-    int exit_probability = 35; // 35% base
-    if (floor == 0 || floor == (MAX_FLOORS - 1)) {
-        exit_probability = 70; // 70% nos extremos
-    }
-    
-    // Se há chamada externa no andar, aumenta probabilidade (pessoas chegando = pessoas saindo)
-    if (has_call) {
-        exit_probability += 25; // Aumenta 25% se há chamada no andar
-    }
-    
-    // Se há chamada interna para este andar, garantido desembarque
-    if (internal_calls[floor]) {
-        someone_exits = true;
-        internal_calls[floor] = false;
-    } else {
-        someone_exits = (rand() % 100) < exit_probability;
-    }
-    
-    if (someone_exits) {
-        int disembark_count = MIN_DISEMBARK_PASSENGERS + 
-                             (rand() % (MAX_DISEMBARK_PASSENGERS - MIN_DISEMBARK_PASSENGERS + 1));
-        
-        // Não pode desembarcar mais que a ocupação atual
-        if (disembark_count > elevator->occupancy) {
-            disembark_count = elevator->occupancy;
-        }
-        
-        elevator->occupancy -= disembark_count;
-        
-        printf("  >> DESEMBARQUE: %d passageiro(s) saiu/saíram no andar %d\n", 
-               disembark_count, floor);
-        
-        // LED ciano para desembarque
-        set_cyan();
-        sleep_ms(300);
-        set_rgb(false, false, false);
+    if (!gpio_get(gpio)) {
+        button_queue_push(&buttons, b, button_edge_us[b]);
     }
+    // Descarta as bordas do ressalto e volta a ouvir o pino
+    gpio_acknowledge_irq(gpio, GPIO_IRQ_EDGE_FALL);
+    gpio_set_irq_enabled(gpio, GPIO_IRQ_EDGE_FALL, true);
+    return 0;
 }
 
-// Encontra chamadas em emergência (esperando muito tempo)
-// IGNORA chamadas sem passageiros (est_passengers == 0)
-static int find_emergency_call(HallCall calls[]) {
-    int worst_floor = -1;
-    int worst_wait = 0;
-    
-    for (int i = 0; i < MAX_FLOORS; i++) {
-        if (calls[i].active && calls[i].est_passengers > 0 && calls[i].wait_time > worst_wait) {
-            worst_wait = calls[i].wait_time;
-            worst_floor = i;
-        }
-    }
-    
-    if (worst_wait >= EMERGENCY_WAIT_TIME) {
-        return worst_floor;
+static void button_irq(uint gpio, uint32_t events) {
+    (void)events;
+    if (gpio != BUTTON_A && gpio != BUTTON_B) return;
+
+    button_edge_us[button_id(gpio)] = time_us_64();
+    gpio_set_irq_enabled(gpio, GPIO_IRQ_EDGE_FALL, false);
+    if (add_alarm_in_us(BUTTON_DEBOUNCE_US, button_debounce_alarm,
+                        (void *)(uintptr_t)gpio, true) < 0) {
+        // Sem alarme livre: perde esta pressão, mas não o botão
+        gpio_set_irq_enabled(gpio, GPIO_IRQ_EDGE_FALL, true);
     }
-    
-    return -1;
 }
 
+static void buttons_init(void) {
+    button_queue_init(&buttons);
+    gpio_init(BUTTON_A);
+    gpio_init(BUTTON_B);
+    gpio_set_dir(BUTTON_A, GPIO_IN);
+    gpio_set_dir(BUTTON_B, GPIO_IN);
+    gpio_pull_up(BUTTON_A);
+    gpio_pull_up(BUTTON_B);
+    gpio_set_irq_enabled_with_callback(BUTTON_A, GPIO_IRQ_EDGE_FALL, true, button_irq);
+    gpio_set_irq_enabled(BUTTON_B, GPIO_IRQ_EDGE_FALL, true);
+}
 
-// Escolhe o próximo andar com base em prioridades realistas
-// Escolhe o próximo andar com base em prioridades realistas
-static int choose_next_floor_realistic(HallCall calls[], 
-                                       ElevatorState *elevator,
-                                       Stats *stats) {
-
-    // PRIORIDADE 0: Chamadas em emergência (esperando muito tempo)
-    int emergency_floor = find_emergency_call(calls);
-    if (emergency_floor != -1) {
-        // Conta quantas chamadas ativas existem entre aqui e lá
-        int calls_in_path = 0;
-        int direction = (emergency_floor > elevator->current_floor) ? 1 : -1;
-        
-        for (int f = elevator->current_floor; f != emergency_floor; f += direction) {
-            if (calls[f].active && calls[f].est_passengers > 0) {
-                calls_in_path++;
-            }
-        }
-        
-        // Se tiver poucas chamadas no caminho OU o elevador estiver bem vazio,
-        // vai direto para a emergência
-        if (calls_in_path < 2 || elevator->occupancy < 2) {
-            printf("  [EMERGÊNCIA] Andar %d esperando %d ciclos - atendimento prioritário!\n",
-                   emergency_floor, calls[emergency_floor].wait_time);
-            return emergency_floor;
-        } else {
-            printf("  [EMERGÊNCIA DETECTADA] Mas há %d chamadas no caminho - atendendo caminho primeiro\n",
-                   calls_in_path);
-            // não retorna aqui: deixa seguir para outras prioridades (botão, internas, etc.)
-        }
-    }
-
-    // PRIORIDADE 1: Chamadas disparadas manualmente pelos botões A e B
-    int best_btn_floor = -1;
-    int best_btn_dist = 999;
-    for (int i = 0; i < MAX_FLOORS; i++) {
-        if (!(internal_from_button[i] || external_from_button[i])) continue;
-
-        int delta = i - elevator->current_floor;
-        int dist = (delta >= 0) ? delta : -delta;
-        if (dist < best_btn_dist) {
-            best_btn_dist = dist;
-            best_btn_floor = i;
-        }
-    }
-    if (best_btn_floor != -1) {
-        printf("  [PRIORIDADE BOTÃO] Atendendo chamada manual no andar %d\n",
-               best_btn_floor);
-        return best_btn_floor;
-    }
-    
-    // PRIORIDADE 2: Chamadas internas (passageiros já dentro)
-    if (any_internal_call()) {
-        int best_floor = -1;
-        int best_dist = 999;
-        
-        for (int i = 0; i < MAX_FLOORS; i++) {
-            if (!internal_calls[i]) continue;
-            
-            int delta = i - elevator->current_floor;
-            
-            // Prioriza mesma direção
-            if ((elevator->direction == 1 && delta < 0) || 
-                (elevator->direction == -1 && delta > 0)) {
-                continue;
-            }
-            
-            int dist = (delta >= 0) ? delta : -delta;
-            if (dist < best_dist) {
-                best_dist = dist;
-                best_floor = i;
-            }
-        }
-        
-        // Se não achou na direção atual, pega o mais próximo
-        if (best_floor == -1) {
-            for (int i = 0; i < MAX_FLOORS; i++) {
-                if (!internal_calls[i]) continue;
-                int delta = i - elevator->current_floor;
-                int dist = (delta >= 0) ? delta : -delta;
-                if (dist < best_dist) {
-                    best_dist = dist;
-                    best_floor = i;
-                }
-            }
-        }
-        
-        if (best_floor != -1) {
-            printf("  [PRIORIDADE INTERNA] Atendendo destino interno: andar %d\n", 
-                   best_floor);
-            return best_floor;
-        }
-    }
-    
-    // PRIORIDADE 3: Se lotado há muito tempo, FORÇAR desembarque
-    if (elevator->occupancy >= ELEVATOR_CAP && 
-        cycles_at_full_capacity >= CYCLES_FULL_MAX) {
-        
-        int next = elevator->current_floor + elevator->direction;
-        if (next >= 0 && next < MAX_FLOORS) {
-            printf("  [DESEMBARQUE FORÇADO] Elevador lotado há %d ciclos - parando no andar %d\n",
-                   cycles_at_full_capacity, next);
-            cycles_at_full_capacity = 0;
-            return next;
-        }
+#ifdef SMARTSTOP_PROFILE
+// Consulta pela serial sem bloquear: 'p' mostra o relatório, 'r' zera
+static void profile_query(StageProfiler *prof) {
+    int c = getchar_timeout_us(0);
+    if (c == 'p') {
+        stageprof_print_report(prof);
+    } else if (c == 'r') {
+        stageprof_reset(prof);
+        printf("Medições por estágio zeradas\n");
     }
-    
-    // PRIORIDADE 4: Primeiro atende chamadas próximas na direção atual
-    for (int offset = 0; offset <= 2; offset++) {  // até 2 andares de distância
-        int check_floor = elevator->current_floor + (offset * elevator->direction);
-        
-        if (check_floor >= 0 && check_floor < MAX_FLOORS) {
-            if (calls[check_floor].active && calls[check_floor].est_passengers > 0) {
-                printf("  [PROXIMIDADE] Chamada próxima detectada no andar %d\n", check_floor);
-                return check_floor;
-            }
-        }
-    }
-    
-    // PRIORIDADE 5: Se não está muito lotado, usar SmartStop
-    if (elevator->occupancy < ELEVATOR_CAP - 2) {
-        const float efficiency_threshold = 0.65f;
-        int smartstop_floor = smartstop_decide_next_floor(calls, elevator, stats, 
-                                                          efficiency_threshold);
-        if (smartstop_floor != -1) {
-            printf("  [SmartStop] Parada eficiente calculada: andar %d\n", smartstop_floor);
-            return smartstop_floor;
-        }
-    }
-    
-    // PRIORIDADE 6: Se lotado mas não emergencial, buscar chamadas na direção
-    // só considera chamadas COM passageiros
-    if (elevator->occupancy >= ELEVATOR_CAP - 1) {
-        for (int offset = 1; offset < MAX_FLOORS; offset++) {
-            int floor = elevator->current_floor + (offset * elevator->direction);
-            if (floor < 0 || floor >= MAX_FLOORS) break;
-
-            if (calls[floor].active && calls[floor].est_passengers > 0) {
-                printf("  [LOTADO] Buscando desembarque - andar %d na direção\n", floor);
-                return floor;
-            }
-        }
+}
+#endif
+
+#ifdef SMARTSTOP_KERNEL_BENCH
+#define KERNEL_BENCH_STATES    4        // estados percorridos (4 KB cada)
+#define KERNEL_BENCH_CHECKS    20000    // estados conferidos
+#define KERNEL_BENCH_DECISIONS 20000    // decisões cronometradas por versão
+
+// Confere a pontuação inteira contra a float no próprio M0+ (float por
+// software) e mostra os ciclos por decisão de cada uma
+static void kernel_bench(const BuildingConfig *cfg, uint64_t seed) {
+    static KernelState states[KERNEL_BENCH_STATES];
+    SimRng rng;
+    sim_rng_seed(&rng, seed);
+
+    KernelCheck check = {0};
+    for (int k = 0; k < KERNEL_BENCH_CHECKS; k++) {
+        kernel_check_random_state(cfg, &rng, 8, 20, &states[0]);
+        kernel_check_compare(cfg, &states[0], &check);
     }
+    printf("Pontuação inteira x float: %llu estados, %llu iguais, %llu empates, "
+           "%llu divergências\n",
+           (unsigned long long)check.states, (unsigned long long)check.same,
+           (unsigned long long)check.tie_breaks, (unsigned long long)check.mismatches);
 
-    // — FALLBACK REALISTA
-    // Se elevador estiver vazio e existir chamada externa,
-    // vá atender a chamada mais próxima.
-    if (elevator->occupancy == 0) {
-        int best_floor = -1;
-        int best_dist = 999;
-
-        for (int i = 0; i < MAX_FLOORS; i++) {
-            if (calls[i].active && calls[i].est_passengers > 0) {
-                int delta = i - elevator->current_floor;
-                int dist = (delta >= 0) ? delta : -delta;
-                if (dist < best_dist) {
-                    best_dist = dist;
-                    best_floor = i;
-                }
-            }
-        }
-
-        if (best_floor != -1) {
-            printf("  [FALLBACK VAZIO] Elevador sem passageiros - indo atender andar %d\n",
-                   best_floor);
-            return best_floor;
-        }
+    for (int k = 0; k < KERNEL_BENCH_STATES; k++) {
+        kernel_check_random_state(cfg, &rng, 8, 20, &states[k]);
     }
-
-    return -1;
-
-}
-
-// Remove chamadas "vazias": ativas mas com 0 passageiros
-static void cleanup_empty_calls(HallCall calls[]) {
-    for (int i = 0; i < MAX_FLOORS; i++) {
-        if (calls[i].active && calls[i].est_passengers <= 0) {
-            calls[i].active = false;
-            calls[i].est_passengers = 0;
-        }
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000u;
+    for (int fixed = 0; fixed <= 1; fixed++) {
+        uint64_t us = kernel_check_time_us(cfg, states, KERNEL_BENCH_STATES,
+                                           KERNEL_BENCH_DECISIONS, fixed);
+        printf("Pontuação %s: %llu ciclos por decisão (%d andares)\n",
+               fixed ? "inteira" : "float",
+               (unsigned long long)(us * mhz / KERNEL_BENCH_DECISIONS), cfg->num_floors);
     }
+    printf("\n");
 }
-
+#endif
 
 int main() {
     stdio_init_all();
     leds_init();
     buttons_init();
-    internal_calls_init();
 
-    HallCall calls[MAX_FLOORS];
-    ElevatorState elevator;
-    Stats stats;
+    static SimClock clock;
+    static SimContext sim;
+    BuildingConfig building;
+
+    building_config_default(&building);
+    sim_clock_init(&clock, SIM_CLOCK_REALTIME, 1.0f);
+#ifdef SMARTSTOP_SEED
+    // Semente fixa: reproduz no Pico o mesmo traço do build host (--seed)
+    const uint64_t seed = SMARTSTOP_SEED;
+#else
+    const uint64_t seed = hal_time_us();
+#endif
+#ifdef SMARTSTOP_TRACE
+    static TraceWriter trace;
+    sim_init(&sim, &building, &clock, TRAFFIC_MEDIUM, seed, false);
+#ifdef SMARTSTOP_DUAL_CORE
+    sim_offload_attach(&offload, &sim, NULL);
+#endif
 
-    smartstop_init(calls, &elevator, &stats);
-
-    const TrafficMode mode = TRAFFIC_MEDIUM;
+    sleep_ms(2000);
+    trace_writer_init(&trace, usb_sink, NULL);
+    trace_begin(&trace, &sim.cfg, seed, sim_clock_now_us(&clock));
+    sim.trace = &trace;
+#else
+    static DeferredLog log;
+    deflog_init(&log);
+    sim_init(&sim, &building, &clock, TRAFFIC_MEDIUM, seed, true);
+#ifdef SMARTSTOP_DUAL_CORE
+    sim_offload_attach(&offload, &sim, &log);
+#else
+    sim.log = &log;
+    sim_clock_set_idle(&clock, deflog_idle, &log);
+#endif
 
     sleep_ms(2000);
     printf("\n╔═══════════════════════════════════════════════════════════╗\n");
     printf("║  Sistema SmartStop Realista - Simulador de Elevador      ║\n");
     printf("║  Botão A: Chamada Interna | Botão B: Chamada Externa     ║\n");
     printf("╚═══════════════════════════════════════════════════════════╝\n\n");
-
-    bool last_a = true;
-    bool last_b = true;
+#ifdef SMARTSTOP_KERNEL_BENCH
+    kernel_bench(&building, seed);
+#endif
+#endif
+
+#ifdef SMARTSTOP_DUAL_CORE
+    multicore_launch_core1(core1_main);
+#endif
+
+    // Pressões capturadas desde o boot são registradas já no primeiro ciclo
+    sim.buttons = &buttons;
+
+#ifdef SMARTSTOP_PASSENGERS
+    static PassengerModel pax;
+    sim_attach_passengers(&sim, &pax);
+#endif
+
+#ifdef SMARTSTOP_LOOKAHEAD
+    static Lookahead lookahead;
+    lookahead_init(&lookahead, SMARTSTOP_LOOKAHEAD, SMARTSTOP_LOOKAHEAD_BUDGET_US);
+    sim.lookahead = &lookahead;
+#endif
+
+#ifdef SMARTSTOP_TRAFFIC_PROFILE
+#ifdef SMARTSTOP_DUAL_CORE
+#error "SMARTSTOP_TRAFFIC_PROFILE não combina com SMARTSTOP_DUAL_CORE"
+#endif
+    static TrafficProfile profile;
+    static TrafficSource source;
+    SimRng stream;
+    sim_traffic_stream(&sim, &stream);
+    traffic_profile_init(&profile, &source, SMARTSTOP_TRAFFIC_PROFILE, sim.cfg.num_floors, 0,
+                         &stream);
+    sim_attach_source(&sim, &source);
+#endif
+
+#ifdef SMARTSTOP_PROFILE
+    static StageProfiler prof;
+    stageprof_init(&prof, SMARTSTOP_PROFILE_DEADLINE_US);
+    sim.prof = &prof;
+#endif
+
+    static LoopMeter loop;
+    loop_meter_reset(&loop);
+
+#ifdef SMARTSTOP_MOTION
+    static SimMotion motion;
+    sim_motion_init(&motion, &sim, MOTION_TICK_MS);
+    int64_t reported_cycles = 0;
+#endif
 
     while (true) {
-        total_cycles++;
-        set_rgb(false, false, false);
-
-        // Leitura dos botões
-        bool now_a = gpio_get(BUTTON_A);
-        bool now_b = gpio_get(BUTTON_B);
-
-        // BOTÃO A: Chamada interna (destino aleatório diferente do andar atual)
-        if (!now_a && last_a) {
-            int dest = rand() % MAX_FLOORS;
-            if (dest == elevator.current_floor) {
-                dest = (dest + 1) % MAX_FLOORS;
+        loop_meter_begin(&loop, &clock);
+#ifdef SMARTSTOP_MOTION
+        uint64_t deadline = sim_motion_poll(&motion);
+#else
+        sim_step(&sim);
+#endif
+#ifdef SMARTSTOP_TRACE
+        trace_flush(&trace);
+#endif
+        loop_meter_end(&loop, &clock);
+#ifdef SMARTSTOP_PROFILE
+        profile_query(&prof);
+#endif
+
+#ifdef SMARTSTOP_MOTION
+        // O medidor conta acordadas; o relatório segue os tiques de tráfego
+        bool report = sim.total_cycles - reported_cycles >= LOOP_REPORT_CYCLES;
+#else
+        bool report = loop.cycles == LOOP_REPORT_CYCLES;
+#endif
+        if (report) {
+            SIM_LOG(&sim, LOG_LOOP_METER, loop.cycles, loop.busy_min_us,
+                    loop_meter_busy_avg_us(&loop), loop.busy_max_us, loop.late_max_us);
+            loop_meter_reset(&loop);
+#ifdef SMARTSTOP_MOTION
+            reported_cycles = sim.total_cycles;
+            SIM_LOG(&sim, LOG_MOTION_STATS, (int32_t)motion.decisions,
+                    (int32_t)sim_motion_decisions_per_min(&motion), (int32_t)motion.retargets,
+                    (int32_t)motion.reopens);
+#endif
+
+            const LatencyStat *reg = &sim.button_register;
+            const LatencyStat *svc = &sim.button_service;
+            if (reg->count > 0) {
+                SIM_LOG(&sim, LOG_BUTTON_LATENCY, reg->count, latency_avg_us(reg), reg->max_us,
+                        svc->count, latency_avg_us(svc) / 1000, svc->max_us / 1000);
             }
-            internal_calls[dest] = true;
-            internal_from_button[dest] = true;   // 🔴 marca como chamada vinda do botão A
-            printf("\n🔵 [BOTÃO A] Passageiro solicitou andar %d (chamada interna)\n", dest);
-        }
-
-        // BOTÃO B: Chamada externa (hall call)
-        if (!now_b && last_b) {
-            int floor = rand() % MAX_FLOORS;
-            if (!calls[floor].active) {
-                calls[floor].active = true;
-                calls[floor].floor = floor;
-                calls[floor].est_passengers = estimate_passengers(mode);
-                calls[floor].wait_time = 0;
-                external_from_button[floor] = true;  // 🔴 marca como chamada vinda do botão B
-                printf("\n🟢 [BOTÃO B] Chamada HALL no andar %d (%d pessoa(s) esperando)\n",
-                       floor, calls[floor].est_passengers);
-            }
-        }
-
-        last_a = now_a;
-        last_b = now_b;
-
-        // Gera tráfego aleatório
-        generate_random_hall_calls(calls, &elevator, mode);
-        // Limpa chamadas vazias antes de decidir o próximo andar
-cleanup_empty_calls(calls);
-
-
-        // Interface de status
-        printf("\n┌─────────────────────────────────────────────────────────┐\n");
-        printf("│ Ciclo: %3d | Andar: %2d | Dir: %-7s | Ocupação: %d/%d %s│\n",
-               total_cycles,
-               elevator.current_floor,
-               elevator.direction == 1 ? "Subindo" : "Descendo",
-               elevator.occupancy,
-               ELEVATOR_CAP,
-               elevator.occupancy >= ELEVATOR_CAP ? "🔴" : "  ");
-        printf("└─────────────────────────────────────────────────────────┘\n");
-
-        // Lista chamadas ativas
-        bool has_calls = false;
-        for (int i = 0; i < MAX_FLOORS; i++) {
-            if (calls[i].active && calls[i].est_passengers > 0) {
-                if (!has_calls) {
-                    printf("Chamadas ativas:\n");
-                    has_calls = true;
-                }
-                printf("  • Andar %2d: %d pessoa(s) | Espera: %2d ciclos %s\n",
-                       i, calls[i].est_passengers, calls[i].wait_time,
-                       calls[i].wait_time >= EMERGENCY_WAIT_TIME ? "⚠️" : "");
+#ifdef SMARTSTOP_LOOKAHEAD
+            uint32_t decided = lookahead.decisions + lookahead.fallbacks;
+            SIM_LOG(&sim, LOG_LOOKAHEAD_STATS, lookahead.decisions, lookahead.fallbacks,
+                    lookahead.timeouts,
+                    decided ? (int32_t)(lookahead.time_sum_us / decided) : 0,
+                    lookahead.time_max_us);
+#endif
+#ifdef SMARTSTOP_PASSENGERS
+            const DurationHist *hists[2] = { &pax.wait, &pax.journey };
+            const int32_t names[2] = { LOG_STR_WAIT, LOG_STR_JOURNEY };
+            for (int k = 0; k < 2; k++) {
+                const DurationHist *h = hists[k];
+                SIM_LOG(&sim, LOG_PAX_DIST, names[k], h->count, duration_hist_mean_ms(h),
+                        duration_hist_percentile_s(h, 50), duration_hist_percentile_s(h, 90),
+                        h->max_ms);
             }
+#endif
         }
-        
-        if (!has_calls) {
-            printf("(Nenhuma chamada externa ativa)\n");
-        }
-
-        if (elevator.occupancy >= ELEVATOR_CAP) {
-            cycles_at_full_capacity++;
-        } else {
-            cycles_at_full_capacity = 0;
-        }
-
-        // Decide próxima parada
-        int target_floor = choose_next_floor_realistic(calls, &elevator, &stats);
-
-        if (target_floor == -1) {
-            printf("\n→ Movimento contínuo (sem paradas eficientes detectadas)\n");
-            
-            // Simula desembarque probabilístico durante movimento
-            if (elevator.occupancy > 0 && (rand() % 100) < 15) {
-                simulate_disembark(&elevator, elevator.current_floor, false);
-            }
-            
-            elevator.current_floor += elevator.direction;
-
-            if (elevator.current_floor <= 0) {
-                elevator.current_floor = 0;
-                elevator.direction = 1;
-                printf("  ↻ Invertendo direção no térreo\n");
-            } else if (elevator.current_floor >= (MAX_FLOORS - 1)) {
-                elevator.current_floor = MAX_FLOORS - 1;
-                elevator.direction = -1;
-                printf("  ↻ Invertendo direção no último andar\n");
-            }
-
-            set_yellow();
-            sleep_ms(150);
-            set_rgb(false, false, false);
-            
-        } else {
-           printf("\n🎯 DECISÃO: Parar no andar %d\n", target_floor);
-
-// Ajuste inteligente de direção baseado no destino
-if (target_floor > elevator.current_floor) {
-    elevator.direction = 1;   // Sobe diretamente ao destino
-} 
-else if (target_floor < elevator.current_floor) {
-    elevator.direction = -1;  // Desce diretamente ao destino
-}
-
-// Movimento andar por andar
-while (elevator.current_floor != target_floor) {
-    int prev_floor = elevator.current_floor;
-    elevator.current_floor += elevator.direction;
-
-    printf("  ├─ Deslocando: andar %d → %d", prev_floor, elevator.current_floor);
-                
-    // Verifica passagem por chamadas ativas
-    bool skipped = false;
-    for (int f = 0; f < MAX_FLOORS; f++) {
-        if (calls[f].active && calls[f].est_passengers > 0 && 
-            f == elevator.current_floor && f != target_floor) {
-            printf(" [ignorando chamada do andar %d]", f);
-            stats.skipped_stops++;
-            skipped = true;
-        }
-    }
-    printf("\n");
-
-    if (skipped) {
-        set_yellow();
-        sleep_ms(100);
-        set_rgb(false, false, false);
-    }
-
-    // Inverte nos extremos
-    if (elevator.current_floor <= 0) {
-        elevator.current_floor = 0;
-        elevator.direction = 1;
-    } else if (elevator.current_floor >= (MAX_FLOORS - 1)) {
-        elevator.current_floor = (MAX_FLOORS - 1);
-        elevator.direction = -1;
-    }
-
-    sleep_ms(TRAVEL_TIME_MS);
-}
-
-            // CHEGOU NO ANDAR
-            printf("  └─ 🚪 PARADA no andar %d\n", target_floor);
-            
-            // LED verde
-            set_rgb(false, true, false);
-            sleep_ms(DOOR_TIME_MS / 2);
-
-            // 1º: SEMPRE tenta desembarcar (prioridade máxima!)
-            if (elevator.occupancy > 0) {
-                simulate_disembark(&elevator, target_floor, calls[target_floor].active);
-            }
-
-            // 2º: EMBARQUE (só se houver chamada externa e espaço)
-            if (calls[target_floor].active && elevator.occupancy < ELEVATOR_CAP) {
-                // Só embarca se realmente tem pessoas esperando
-                if (calls[target_floor].est_passengers > 0) {
-                    smartstop_handle_stop(calls, &elevator, &stats, target_floor);
-                    printf("  >> EMBARQUE: Passageiros entraram no elevador\n");
-                } else {
-                    // Chamada vazia, apenas remove
-                    calls[target_floor].active = false;
-                    printf("  >> Chamada vazia removida (sem passageiros)\n");
-                }
-            } else if (calls[target_floor].active && elevator.occupancy >= ELEVATOR_CAP) {
-                printf("  ⚠️  Elevador LOTADO - passageiros aguardam próximo elevador\n");
-                // Chamada permanece ativa
-            } else if (calls[target_floor].active && calls[target_floor].est_passengers == 0) {
-                // Remove chamadas vazias mesmo sem embarque
-                calls[target_floor].active = false;
-                printf("  >> Chamada vazia removida (sem passageiros)\n");
-            }
-
-            // 🔴 LIMPA flags de botão para esse andar, pois já foi atendido
-            internal_from_button[target_floor] = false;
-            external_from_button[target_floor] = false;
-
-            printf("  📊 Ocupação atual: %d/%d\n", elevator.occupancy, ELEVATOR_CAP);
-
-            if (elevator.occupancy >= ELEVATOR_CAP) {
-                set_rgb(true, false, false);
-                sleep_ms(300);
-            }
-
-            sleep_ms(DOOR_TIME_MS / 2);
-            set_rgb(false, false, false);
-        }
-
-        print_stats(&stats);
-        printf("\n════════════════════════════════════════════════════════════\n\n");
-
-        sleep_ms(800);
+#ifdef SMARTSTOP_MOTION
+        sim_motion_wait(&motion, deadline);
+#endif
     }
 
     return 0;
@@ -0,0 +1,356 @@
+/*
+ * Controle do carro por prazos (ver motion.h)
+ *
+ * Mesmo modelo e mesmas regras de sim_step (sim_begin_cycle,
+ * sim_choose_next_floor, sim_disembark, sim_serve_stop); só o tempo muda:
+ * cada fase termina num prazo do SimClock em vez de numa pausa.
+ */
+
+#include "motion.h"
+#include "hal.h"
+#include "policy.h"
+
+#include <stdio.h>
+
+// ---- LED ----
+
+static void led_apply(SimMotion *m, uint64_t now) {
+    MotionLed *led = &m->led;
+    if (led->flash_until_us != 0 && now >= led->flash_until_us) {
+        led->flash_until_us = 0;
+    }
+    uint8_t color = led->flash_until_us ? led->flash : led->base;
+    if (color != led->shown) {
+        hal_set_rgb(color & MOTION_LED_RED, color & MOTION_LED_GREEN, color & MOTION_LED_BLUE);
+        led->shown = color;
+    }
+}
+
+// Pisca por cima da cor de fundo (substitui um pisca em andamento)
+static void led_flash(SimMotion *m, uint8_t color, uint32_t ms, uint64_t now) {
+    m->led.flash = color;
+    m->led.flash_until_us = now + (uint64_t)ms * 1000u;
+    led_apply(m, now);
+}
+
+static void led_base(SimMotion *m, uint8_t color, uint64_t now) {
+    m->led.base = color;
+    led_apply(m, now);
+}
+
+// ---- Fases ----
+
+static void enter_idle(SimMotion *m, uint64_t now) {
+    m->phase = MOTION_IDLE;
+    m->target = -1;
+    m->sweeping = false;
+    m->idle_since_us = now;
+}
+
+static int decide(SimMotion *m, DispatchPriority *priority) {
+    SimContext *ctx = m->ctx;
+    *priority = PRIORITY_NONE;
+    int target = sim_choose_next_floor(ctx, priority);
+    SIM_TRACE(ctx, TRACE_EV_DECISION, ctx->elevator.current_floor, *priority, target, 0);
+    m->decisions++;
+    return target;
+}
+
+// A mesma consulta sem efeitos: sem log nem traço, e as estatísticas, o
+// contador de lotação e os contadores da política voltam ao que eram. A
+// maioria das consultas (em viagem, em movimento contínuo, parado sem
+// chamadas) não muda nada; quando muda, a decisão é refeita com decide()
+static int probe(SimMotion *m, DispatchPriority *priority) {
+    SimContext *ctx = m->ctx;
+    bool verbose = ctx->verbose;
+    TraceWriter *trace = ctx->trace;
+    CycleTable *table = ctx->table;
+    Stats stats = ctx->stats;
+    int full = ctx->cycles_at_full_capacity;
+    DispatchPolicy policy;
+    if (ctx->policy) policy = *ctx->policy;
+
+    ctx->verbose = false;
+    ctx->trace = NULL;
+    ctx->table = NULL;
+    *priority = PRIORITY_NONE;
+    int target = sim_choose_next_floor(ctx, priority);
+
+    ctx->verbose = verbose;
+    ctx->trace = trace;
+    ctx->table = table;
+    ctx->stats = stats;
+    ctx->cycles_at_full_capacity = full;
+    if (ctx->policy) *ctx->policy = policy;
+    return target;
+}
+
+static void start_travel(SimMotion *m, uint64_t now) {
+    ElevatorState *e = &m->ctx->elevator;
+    e->direction = (m->target > e->current_floor) ? 1 : -1;
+    m->phase = MOTION_TRAVEL;
+    m->phase_until_us = now + (uint64_t)m->ctx->cfg.travel_time_ms * 1000u;
+}
+
+// Movimento contínuo: mais um andar na direção, invertendo nos extremos
+static void start_sweep(SimMotion *m, uint64_t now) {
+    SimContext *ctx = m->ctx;
+    ElevatorState *e = &ctx->elevator;
+
+    int next = e->current_floor + e->direction;
+    if (next < 0) {
+        e->direction = 1;
+        SIM_LOG(ctx, LOG_REVERSE_GROUND);
+    } else if (next >= ctx->cfg.num_floors) {
+        e->direction = -1;
+        SIM_LOG(ctx, LOG_REVERSE_TOP);
+    }
+    m->target = e->current_floor + e->direction;
+    m->sweeping = true;
+    start_travel(m, now);
+    led_flash(m, MOTION_LED_YELLOW, 150, now);
+}
+
+static void arrive(SimMotion *m, uint64_t now) {
+    SimContext *ctx = m->ctx;
+
+    SIM_LOG(ctx, LOG_ARRIVED, ctx->elevator.current_floor);
+    m->target = ctx->elevator.current_floor;
+    m->sweeping = false;
+    m->reopened = false;
+    m->phase = MOTION_DOORS_OPENING;
+    m->phase_until_us = now + (uint64_t)ctx->cfg.door_time_ms / 2 * 1000u;
+    led_base(m, MOTION_LED_GREEN, now);
+}
+
+// Carro parado, em movimento contínuo ou com as portas fechadas: escolhe o
+// próximo destino
+static void decide_from_rest(SimMotion *m, uint64_t now) {
+    SimContext *ctx = m->ctx;
+    bool was_idle = m->phase == MOTION_IDLE;
+    DispatchPriority priority;
+
+    // Parado sem chamadas ou em movimento contínuo sem parada: segue igual
+    int target = probe(m, &priority);
+    if (target == -1 && (ctx->elevator.occupancy == 0 ? was_idle : m->sweeping)) {
+        if (m->sweeping) start_sweep(m, now);
+        return;
+    }
+    target = decide(m, &priority);
+
+    if (target == -1 && ctx->elevator.occupancy == 0) {
+        if (!was_idle) enter_idle(m, now);
+        return;
+    }
+    if (was_idle) m->idle_us += now - m->idle_since_us;
+
+    if (target == -1) {
+        if (!m->sweeping) SIM_LOG(ctx, LOG_CONTINUE);
+        start_sweep(m, now);
+        return;
+    }
+
+    SIM_LOG(ctx, LOG_DECISION, target);
+    m->target = target;
+    m->sweeping = false;
+    if (target == ctx->elevator.current_floor) {
+        arrive(m, now);
+    } else {
+        start_travel(m, now);
+    }
+}
+
+// Parada no caminho entre o andar atual (inclusive) e o destino
+static bool on_the_way(int floor, int stop, int target, int direction) {
+    return (stop - floor) * direction >= 0 && (target - stop) * direction > 0;
+}
+
+// Em viagem o destino só muda para uma parada no caminho, uma emergência
+// ou um botão
+static bool retargets(const SimMotion *m, int floor, int stop, DispatchPriority priority) {
+    return stop != -1 && stop != m->target &&
+           (on_the_way(floor, stop, m->target, m->ctx->elevator.direction) ||
+            priority == PRIORITY_EMERGENCY || priority == PRIORITY_BUTTON);
+}
+
+// Chegou a mais um andar: decide de novo antes de seguir
+static void floor_pass(SimMotion *m, uint64_t now) {
+    SimContext *ctx = m->ctx;
+    ElevatorState *e = &ctx->elevator;
+
+    int prev = e->current_floor;
+    e->current_floor += e->direction;
+    int f = e->current_floor;
+    m->floor_passes++;
+    SIM_LOG(ctx, LOG_MOVING, prev, f);
+    SIM_LOG(ctx, LOG_NEWLINE);
+
+    if (m->sweeping) {
+        // Desembarque probabilístico em movimento, como continue_moving
+        if (e->occupancy > 0 && !ctx->pax && sim_rng_below(&ctx->rng, 100) < 15) {
+            if (sim_disembark(ctx, f, false) > 0) led_flash(m, MOTION_LED_CYAN, 300, now);
+        }
+        decide_from_rest(m, now);
+        return;
+    }
+
+    if (f != m->target) {
+        DispatchPriority priority;
+        int stop = probe(m, &priority);
+        if (retargets(m, f, stop, priority) &&
+            retargets(m, f, stop = decide(m, &priority), priority)) {
+            SIM_LOG(ctx, LOG_RETARGET, stop, m->target);
+            SIM_LOG(ctx, LOG_DECISION, stop);
+            m->target = stop;
+            m->retargets++;
+        }
+    }
+
+    if (f == m->target) {
+        arrive(m, now);
+        return;
+    }
+
+    // Passa direto por uma chamada ativa
+    if (floorset_test(&ctx->reg.active, f) && ctx->calls[f].est_passengers > 0) {
+        SIM_LOG(ctx, LOG_SKIPPING, f);
+        SIM_LOG(ctx, LOG_NEWLINE);
+        SIM_TRACE(ctx, TRACE_EV_SKIP, f, 0, ctx->calls[f].est_passengers, 0);
+        ctx->stats.skipped_stops++;
+        led_flash(m, MOTION_LED_YELLOW, 100, now);
+    }
+    start_travel(m, now);
+}
+
+// Meio tempo de porta depois da chegada: desembarque, depois embarque
+static void doors_open(SimMotion *m, uint64_t now) {
+    SimContext *ctx = m->ctx;
+    int f = ctx->elevator.current_floor;
+
+    if (ctx->elevator.occupancy > 0 && sim_disembark(ctx, f, ctx->calls[f].active) > 0) {
+        led_flash(m, MOTION_LED_CYAN, 300, now);
+    }
+    sim_serve_stop(ctx, f);
+    if (ctx->elevator.occupancy >= ctx->cfg.car_capacity) {
+        led_flash(m, MOTION_LED_RED, 300, now);
+    }
+    m->phase = MOTION_DOORS_CLOSING;
+    m->phase_until_us = now + (uint64_t)ctx->cfg.door_time_ms / 2 * 1000u;
+}
+
+static void doors_closed(SimMotion *m, uint64_t now) {
+    SimContext *ctx = m->ctx;
+    int f = ctx->elevator.current_floor;
+
+    // Chegou gente no andar com as portas fechando
+    if (!m->reopened && ctx->calls[f].active && ctx->calls[f].est_passengers > 0 &&
+        ctx->elevator.occupancy < ctx->cfg.car_capacity) {
+        SIM_LOG(ctx, LOG_DOOR_REOPEN, f);
+        m->reopened = true;
+        m->reopens++;
+        sim_serve_stop(ctx, f);
+        m->phase_until_us = now + (uint64_t)ctx->cfg.door_time_ms / 2 * 1000u;
+        return;
+    }
+
+    led_base(m, MOTION_LED_OFF, now);
+    decide_from_rest(m, now);
+}
+
+// ---- Laço ----
+
+void sim_motion_init(SimMotion *m, SimContext *ctx, uint32_t tick_ms) {
+    uint64_t now = sim_clock_now_us(ctx->clock);
+
+    m->ctx = ctx;
+    m->tick_us = (tick_ms ? tick_ms : MOTION_TICK_MS) * 1000u;
+    m->next_tick_us = now;
+    m->reopened = false;
+    m->led.base = MOTION_LED_OFF;
+    m->led.flash = MOTION_LED_OFF;
+    m->led.flash_until_us = 0;
+    m->led.shown = MOTION_LED_OFF;
+    hal_set_rgb(false, false, false);
+
+    m->decisions = 0;
+    m->retargets = 0;
+    m->reopens = 0;
+    m->floor_passes = 0;
+    m->idle_us = 0;
+    m->start_us = now;
+    enter_idle(m, now);
+}
+
+uint64_t sim_motion_poll(SimMotion *m) {
+    SimContext *ctx = m->ctx;
+    uint64_t now = sim_clock_now_us(ctx->clock);
+    bool wake = false;
+
+    if (ctx->buttons) {
+        uint32_t registered = ctx->button_register.count;
+        sim_poll_buttons(ctx);
+        wake = ctx->button_register.count != registered;
+    }
+
+    while (now >= m->next_tick_us) {
+        sim_begin_cycle(ctx);
+        m->next_tick_us += m->tick_us;
+        wake = true;
+    }
+
+    // Uma fase vencida pode abrir outra que vence no mesmo instante
+    while (m->phase != MOTION_IDLE && now >= m->phase_until_us) {
+        switch (m->phase) {
+            case MOTION_TRAVEL:        floor_pass(m, m->phase_until_us); break;
+            case MOTION_DOORS_OPENING: doors_open(m, m->phase_until_us); break;
+            case MOTION_DOORS_CLOSING: doors_closed(m, m->phase_until_us); break;
+            default:                   break;
+        }
+    }
+    if (m->phase == MOTION_IDLE && wake) {
+        decide_from_rest(m, now);
+    }
+
+    led_apply(m, now);
+
+    uint64_t next = m->next_tick_us;
+    if (m->phase != MOTION_IDLE && m->phase_until_us < next) next = m->phase_until_us;
+    if (m->led.flash_until_us != 0 && m->led.flash_until_us < next) next = m->led.flash_until_us;
+    return next;
+}
+
+void sim_motion_wait(SimMotion *m, uint64_t deadline_us) {
+    SimClock *clock = m->ctx->clock;
+    uint64_t now = sim_clock_now_us(clock);
+    if (deadline_us <= now) return;
+
+    uint64_t us = deadline_us - now;
+    if (m->ctx->buttons && clock->mode != SIM_CLOCK_FAST &&
+        us > (uint64_t)MOTION_POLL_MAX_MS * 1000u) {
+        us = (uint64_t)MOTION_POLL_MAX_MS * 1000u;
+    }
+    sim_clock_advance_us(clock, us);
+}
+
+double sim_motion_decisions_per_min(const SimMotion *m) {
+    uint64_t elapsed = sim_clock_now_us(m->ctx->clock) - m->start_us;
+    return elapsed ? (double)m->decisions * 60e6 / (double)elapsed : 0.0;
+}
+
+void sim_motion_print_report(const SimMotion *m) {
+    uint64_t now = sim_clock_now_us(m->ctx->clock);
+    uint64_t elapsed = now - m->start_us;
+    uint64_t idle = m->idle_us;
+    if (m->phase == MOTION_IDLE) idle += now - m->idle_since_us;
+
+    printf("\n--- Controle por prazos ---\n");
+    printf("Decisões:           %llu (%.1f por minuto simulado)\n",
+           (unsigned long long)m->decisions, sim_motion_decisions_per_min(m));
+    printf("Andares percorridos: %llu\n", (unsigned long long)m->floor_passes);
+    printf("Destinos trocados:  %llu em viagem\n", (unsigned long long)m->retargets);
+    printf("Portas reabertas:   %llu\n", (unsigned long long)m->reopens);
+    if (elapsed > 0) {
+        printf("Carro parado:       %.1f %% do tempo\n", 100.0 * (double)idle / (double)elapsed);
+    }
+    printf("---------------------------\n");
+}
@@ -0,0 +1,108 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dispatch.h"
+
+// Controle do carro por prazos, sem pausas no caminho de controle.
+//
+// Alternativa a sim_step para o laço de tempo real. Em sim_step um ciclo
+// dorme do começo ao fim: viagem, portas, os piscas do LED (ciano no
+// desembarque, amarelo nas chamadas ignoradas e no movimento contínuo,
+// vermelho com o carro lotado) e a pausa de fim de ciclo. Enquanto isso o
+// despacho não decide nada. Aqui cada fase tem só um prazo, e
+// sim_motion_poll avança o que venceu e volta na hora:
+//
+//   PARADO --decisão--> VIAGEM --andar a andar--> PORTAS ABRINDO
+//      ^                  ^  |                         | desembarque/embarque
+//      |                  +--+ (nova decisão)          v
+//      +----------------------------------------- PORTAS FECHANDO
+//
+// - O LED é um estado (cor de fundo: verde com as portas abertas) mais um
+//   pisca com prazo. Os piscas não atrasam nada.
+// - O despacho decide de novo a cada andar alcançado, quando as portas
+//   fecham e, com o carro parado, a cada tique ou pressão de botão. Em
+//   viagem o destino só muda para uma parada no caminho, ou para uma
+//   emergência ou um botão (sim_choose_next_floor com PRIORITY_EMERGENCY ou
+//   PRIORITY_BUTTON). A consulta em viagem não registra nada (log, traço,
+//   estatísticas, contador de lotação) se o destino não mudar.
+// - Uma chamada que surge no andar enquanto as portas fecham reabre as
+//   portas uma vez.
+// - Tráfego e envelhecimento das chamadas continuam por ciclo
+//   (sim_begin_cycle), num tique fixo de tick_ms. MOTION_TICK_MS é a duração
+//   média de um ciclo de sim_step, para que a espera em ciclos (emergência,
+//   bonificação) e o tráfego por segundo fiquem calibrados como no laço
+//   original.
+//
+// Com o carro vazio e sem destino ele fica parado (sim_step segue em
+// movimento contínuo mesmo vazio).
+
+#define MOTION_TICK_MS      2000   // ciclo de tráfego (média medida de sim_step)
+#define MOTION_POLL_MAX_MS  20     // espera máxima com botões ligados
+
+typedef enum {
+    MOTION_IDLE = 0,        // parado, portas fechadas, sem destino
+    MOTION_TRAVEL,          // a caminho do próximo andar
+    MOTION_DOORS_OPENING,   // chegou; desembarque e embarque no fim da fase
+    MOTION_DOORS_CLOSING    // atendido; decide quando as portas fecham
+} MotionPhase;
+
+// Cores do LED RGB (bits r, g, b)
+#define MOTION_LED_OFF    0u
+#define MOTION_LED_RED    4u
+#define MOTION_LED_GREEN  2u
+#define MOTION_LED_BLUE   1u
+#define MOTION_LED_YELLOW (MOTION_LED_RED | MOTION_LED_GREEN)
+#define MOTION_LED_CYAN   (MOTION_LED_GREEN | MOTION_LED_BLUE)
+
+typedef struct {
+    uint8_t base;               // cor enquanto não há pisca
+    uint8_t flash;              // cor do pisca
+    uint64_t flash_until_us;    // fim do pisca (0 = nenhum)
+    uint8_t shown;              // última cor enviada a hal_set_rgb
+} MotionLed;
+
+typedef struct {
+    SimContext *ctx;            // modelo, relógio, log e traço
+    MotionPhase phase;
+    uint64_t phase_until_us;    // fim da fase atual (não vale em MOTION_IDLE)
+    int target;                 // destino da viagem (-1 = nenhum)
+    bool sweeping;              // movimento contínuo: decide a cada andar
+    bool reopened;              // portas já reabertas nesta parada
+    uint32_t tick_us;
+    uint64_t next_tick_us;
+    MotionLed led;
+
+    // Estatísticas
+    uint64_t decisions;         // decisões que moveram o carro ou trocaram o destino
+    uint64_t retargets;         // destinos trocados em viagem
+    uint64_t reopens;
+    uint64_t floor_passes;
+    uint64_t idle_us;           // tempo parado sem destino
+    uint64_t idle_since_us;
+    uint64_t start_us;
+} SimMotion;
+
+// Liga o controle a um contexto já iniciado. O carro começa parado; o
+// primeiro tique (agora) traz o tráfego e a primeira decisão.
+void sim_motion_init(SimMotion *m, SimContext *ctx, uint32_t tick_ms);
+
+// Registra os botões, roda os tiques e as fases vencidos até o instante
+// atual do relógio e atualiza o LED. Retorna o próximo prazo (fase, tique
+// ou fim de pisca).
+uint64_t sim_motion_poll(SimMotion *m);
+
+// Espera até deadline_us pelo relógio (com o trabalho de fundo dele). Com
+// botões ligados e relógio real acorda a cada MOTION_POLL_MAX_MS no máximo,
+// para registrá-los sem esperar a fase acabar.
+void sim_motion_wait(SimMotion *m, uint64_t deadline_us);
+
+// Decisões por minuto simulado desde sim_motion_init
+double sim_motion_decisions_per_min(const SimMotion *m);
+
+// Decisões, trocas de destino, reaberturas e tempo parado
+void sim_motion_print_report(const SimMotion *m);
+
+#endif
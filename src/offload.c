@@ -0,0 +1,27 @@
+/*
+ * Serviço do segundo núcleo: tráfego adiantado e saída do log
+ */
+
+#include "offload.h"
+
+#define OFFLOAD_LOG_BATCH 8     // registros de log por rodada
+
+void sim_offload_attach(SimOffload *o, SimContext *ctx, DeferredLog *log) {
+    traffic_queue_init(&o->queue);
+    sim_traffic_stream(ctx, &o->rng);
+    o->cfg = ctx->cfg;
+    o->mode = ctx->mode;
+    o->log = log;
+    o->batches = (uint64_t)traffic_queue_fill(&o->queue, &o->cfg, &o->rng, o->mode);
+
+    ctx->traffic = &o->queue;
+    ctx->log = log;
+}
+
+bool sim_offload_poll(SimOffload *o) {
+    int made = traffic_queue_fill(&o->queue, &o->cfg, &o->rng, o->mode);
+    o->batches += (uint64_t)made;
+
+    int written = o->log ? deflog_drain(o->log, OFFLOAD_LOG_BATCH) : 0;
+    return made > 0 || written > 0;
+}
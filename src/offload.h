@@ -0,0 +1,30 @@
+#ifndef OFFLOAD_H
+#define OFFLOAD_H
+
+#include <stdbool.h>
+
+#include "dispatch.h"
+
+// Trabalho tirado do laço de controle e executado em outro núcleo (núcleo 1
+// do RP2040) ou em outra thread (host): geração de tráfego adiantada e
+// formatação/envio do log diferido, que inclui as estatísticas do ciclo.
+// A troca de dados é só pelas duas filas SPSC (TrafficQueue e DeferredLog).
+typedef struct {
+    TrafficQueue queue;
+    SimRng rng;                 // fluxo exclusivo do gerador
+    BuildingConfig cfg;
+    TrafficMode mode;
+    DeferredLog *log;           // NULL = sem log
+    uint64_t batches;           // lotes gerados
+} SimOffload;
+
+// Liga o contexto ao offload: ctx passa a consumir os lotes de o->queue e
+// a registrar o log em log. Já enche a fila, para o primeiro ciclo não
+// esperar. Chamar antes de iniciar o outro núcleo.
+void sim_offload_attach(SimOffload *o, SimContext *ctx, DeferredLog *log);
+
+// Uma rodada de serviço (lado do outro núcleo): completa a fila de tráfego
+// e esvazia parte do log. Retorna false se não havia nada a fazer.
+bool sim_offload_poll(SimOffload *o);
+
+#endif
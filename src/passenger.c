@@ -0,0 +1,203 @@
+/*
+ * Passageiros individuais: pool fixo, filas por andar e distribuições
+ */
+
+#include "passenger.h"
+
+#include <stdio.h>
+
+void duration_hist_reset(DurationHist *h) {
+    for (int i = 0; i < DURATION_HIST_BINS; i++) {
+        h->bins[i] = 0;
+    }
+    h->count = 0;
+    h->max_ms = 0;
+    h->sum_ms = 0;
+}
+
+void duration_hist_add(DurationHist *h, uint64_t us) {
+    uint64_t ms = us / 1000u;
+    uint64_t bin = ms / 1000u;
+    if (bin >= DURATION_HIST_BINS) bin = DURATION_HIST_BINS - 1;
+
+    h->bins[bin]++;
+    h->count++;
+    h->sum_ms += ms;
+    if (ms > h->max_ms) h->max_ms = ms > UINT32_MAX ? UINT32_MAX : (uint32_t)ms;
+}
+
+uint32_t duration_hist_percentile_s(const DurationHist *h, int pct) {
+    if (h->count == 0) return 0;
+
+    // Menor faixa cuja contagem acumulada alcança pct% das amostras
+    uint64_t rank = ((uint64_t)h->count * (uint64_t)pct + 99) / 100;
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < DURATION_HIST_BINS; i++) {
+        seen += h->bins[i];
+        if (seen >= rank) return (uint32_t)(i + 1);
+    }
+    return DURATION_HIST_BINS;
+}
+
+void passenger_model_init(PassengerModel *m) {
+    PassengerPool *p = &m->pool;
+    for (int i = 0; i < PASSENGER_POOL_SIZE; i++) {
+        p->slots[i].next = (i + 1 < PASSENGER_POOL_SIZE) ? (uint16_t)(i + 1) : PASSENGER_NONE;
+    }
+    p->free_head = 0;
+    p->in_use = 0;
+    p->high_water = 0;
+    p->exhausted = 0;
+
+    for (int f = 0; f < MAX_FLOORS; f++) {
+        m->waiting[f].head = PASSENGER_NONE;
+        m->waiting[f].tail = PASSENGER_NONE;
+        m->waiting[f].count = 0;
+    }
+    m->onboard = PASSENGER_NONE;
+    m->onboard_count = 0;
+
+    duration_hist_reset(&m->wait);
+    duration_hist_reset(&m->journey);
+    m->spawned = 0;
+    m->delivered = 0;
+}
+
+static uint16_t pool_alloc(PassengerPool *p) {
+    uint16_t id = p->free_head;
+    if (id == PASSENGER_NONE) {
+        p->exhausted++;
+        return PASSENGER_NONE;
+    }
+    p->free_head = p->slots[id].next;
+    p->in_use++;
+    if (p->in_use > p->high_water) p->high_water = p->in_use;
+    return id;
+}
+
+static void pool_free(PassengerPool *p, uint16_t id) {
+    p->slots[id].next = p->free_head;
+    p->free_head = id;
+    p->in_use--;
+}
+
+int passenger_spawn(PassengerModel *m, SimRng *rng, int num_floors,
+                    int floor, int dest, int count, uint64_t now_us) {
+    PassengerQueue *q = &m->waiting[floor];
+    int spawned = 0;
+
+    for (int k = 0; k < count; k++) {
+        uint16_t id = pool_alloc(&m->pool);
+        if (id == PASSENGER_NONE) break;
+
+        // Destino dado pela fonte de tráfego ou uniforme entre os outros andares
+        int to = dest;
+        if (to < 0) {
+            to = sim_rng_below(rng, (uint32_t)(num_floors - 1));
+            if (to >= floor) to++;
+        }
+
+        Passenger *p = &m->pool.slots[id];
+        p->arrive_us = now_us;
+        p->board_us = 0;
+        p->alight_us = 0;
+        p->origin = (uint8_t)floor;
+        p->dest = (uint8_t)to;
+        p->next = PASSENGER_NONE;
+
+        if (q->tail == PASSENGER_NONE) {
+            q->head = id;
+        } else {
+            m->pool.slots[q->tail].next = id;
+        }
+        q->tail = id;
+        q->count++;
+        spawned++;
+    }
+
+    m->spawned += (uint64_t)spawned;
+    return spawned;
+}
+
+int passenger_board(PassengerModel *m, int floor, int room, uint64_t now_us, FloorSet *dests) {
+    PassengerQueue *q = &m->waiting[floor];
+    int boarded = 0;
+
+    while (boarded < room && q->head != PASSENGER_NONE) {
+        uint16_t id = q->head;
+        Passenger *p = &m->pool.slots[id];
+
+        q->head = p->next;
+        if (q->head == PASSENGER_NONE) q->tail = PASSENGER_NONE;
+        q->count--;
+
+        p->board_us = now_us;
+        duration_hist_add(&m->wait, now_us - p->arrive_us);
+        floorset_set(dests, p->dest);
+
+        p->next = m->onboard;
+        m->onboard = id;
+        m->onboard_count++;
+        boarded++;
+    }
+    return boarded;
+}
+
+int passenger_alight(PassengerModel *m, int floor, uint64_t now_us) {
+    int alighted = 0;
+    uint16_t *link = &m->onboard;
+
+    while (*link != PASSENGER_NONE) {
+        uint16_t id = *link;
+        Passenger *p = &m->pool.slots[id];
+        if (p->dest != floor) {
+            link = &p->next;
+            continue;
+        }
+
+        *link = p->next;
+        p->alight_us = now_us;
+        duration_hist_add(&m->journey, now_us - p->arrive_us);
+        pool_free(&m->pool, id);
+        m->onboard_count--;
+        alighted++;
+    }
+
+    m->delivered += (uint64_t)alighted;
+    return alighted;
+}
+
+// Percentil em texto; a última faixa só tem limite inferior
+static const char *percentile_text(char *buf, size_t size, const DurationHist *h, int pct) {
+    uint32_t s = duration_hist_percentile_s(h, pct);
+    if (s >= DURATION_HIST_BINS) {
+        snprintf(buf, size, ">=%d s", DURATION_HIST_BINS - 1);
+    } else {
+        snprintf(buf, size, "%u s", s);
+    }
+    return buf;
+}
+
+static void print_hist(const char *name, const DurationHist *h) {
+    if (h->count == 0) {
+        printf("%-8s sem amostras\n", name);
+        return;
+    }
+    char p50[16], p90[16], p99[16];
+    printf("%-8s média %.1f s | p50 %s | p90 %s | p99 %s | máx %.1f s\n", name,
+           (double)h->sum_ms / (double)h->count / 1000.0,
+           percentile_text(p50, sizeof(p50), h, 50), percentile_text(p90, sizeof(p90), h, 90),
+           percentile_text(p99, sizeof(p99), h, 99), (double)h->max_ms / 1000.0);
+}
+
+void passenger_print_report(const PassengerModel *m) {
+    printf("\n--- Passageiros ---\n");
+    printf("Chegaram: %llu | entregues: %llu | a bordo: %u | recusados (pool cheio): %u\n",
+           (unsigned long long)m->spawned, (unsigned long long)m->delivered,
+           m->onboard_count, m->pool.exhausted);
+    printf("Pool: pico de %u/%d registros\n", m->pool.high_water, PASSENGER_POOL_SIZE);
+    print_hist("Espera", &m->wait);
+    print_hist("Viagem", &m->journey);
+    printf("-------------------\n");
+}
@@ -0,0 +1,105 @@
+#ifndef PASSENGER_H
+#define PASSENGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "smartstop.h"
+
+// Modelo de passageiros individuais.
+//
+// Cada passageiro tem origem, destino e os instantes de chegada, embarque
+// e desembarque. Os registros vêm de um pool de tamanho fixo com lista de
+// livres (sem malloc, roda igual no Pico) e são encadeados por índice:
+// uma fila FIFO por andar e uma lista para quem está no carro. O
+// desembarque segue o destino de cada passageiro, e as esperas e viagens
+// entram em histogramas.
+
+#ifndef PASSENGER_POOL_SIZE
+#define PASSENGER_POOL_SIZE 256     // máximo de passageiros vivos (esperando + a bordo)
+#endif
+
+#define PASSENGER_NONE 0xFFFFu
+
+#if PASSENGER_POOL_SIZE >= PASSENGER_NONE
+#error "PASSENGER_POOL_SIZE deve caber em um índice de 16 bits"
+#endif
+
+typedef struct {
+    uint64_t arrive_us;     // chegou ao andar de origem
+    uint64_t board_us;      // entrou no carro
+    uint64_t alight_us;     // saiu no destino
+    uint16_t next;          // próximo na lista (fila do andar, carro ou livres)
+    uint8_t origin;
+    uint8_t dest;
+} Passenger;
+
+typedef struct {
+    Passenger slots[PASSENGER_POOL_SIZE];
+    uint16_t free_head;
+    uint16_t in_use;
+    uint16_t high_water;
+    uint32_t exhausted;     // chegadas recusadas com o pool cheio
+} PassengerPool;
+
+// Fila de espera de um andar (índices no pool)
+typedef struct {
+    uint16_t head;
+    uint16_t tail;
+    uint16_t count;
+} PassengerQueue;
+
+// Distribuição de durações em faixas de 1 s; a última faixa acumula o resto
+#define DURATION_HIST_BINS 256
+
+typedef struct {
+    uint32_t bins[DURATION_HIST_BINS];
+    uint32_t count;
+    uint32_t max_ms;
+    uint64_t sum_ms;
+} DurationHist;
+
+typedef struct {
+    PassengerPool pool;
+    PassengerQueue waiting[MAX_FLOORS];
+    uint16_t onboard;       // lista de quem está no carro
+    uint16_t onboard_count;
+
+    DurationHist wait;      // chegada -> embarque
+    DurationHist journey;   // chegada -> desembarque no destino
+
+    uint64_t spawned;
+    uint64_t delivered;
+} PassengerModel;
+
+void passenger_model_init(PassengerModel *m);
+
+// Cria até count passageiros no andar floor indo para dest (dest < 0: cada
+// um sorteia entre os demais andares). Retorna quantos couberam no pool.
+int passenger_spawn(PassengerModel *m, SimRng *rng, int num_floors,
+                    int floor, int dest, int count, uint64_t now_us);
+
+// Embarca até room passageiros da fila do andar (ordem de chegada) e marca
+// os destinos deles em dests. Retorna quantos embarcaram.
+int passenger_board(PassengerModel *m, int floor, int room, uint64_t now_us, FloorSet *dests);
+
+// Desembarca todos os passageiros a bordo com destino floor. Retorna quantos.
+int passenger_alight(PassengerModel *m, int floor, uint64_t now_us);
+
+static inline int passenger_waiting(const PassengerModel *m, int floor) {
+    return m->waiting[floor].count;
+}
+
+void duration_hist_reset(DurationHist *h);
+void duration_hist_add(DurationHist *h, uint64_t us);
+
+// Percentil pct (0..100) em segundos (limite superior da faixa)
+uint32_t duration_hist_percentile_s(const DurationHist *h, int pct);
+
+static inline uint32_t duration_hist_mean_ms(const DurationHist *h) {
+    return h->count ? (uint32_t)(h->sum_ms / h->count) : 0;
+}
+
+void passenger_print_report(const PassengerModel *m);
+
+#endif
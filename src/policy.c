@@ -0,0 +1,336 @@
+/*
+ * Políticas de despacho: as regras da cascata como estágios combináveis
+ */
+
+#include "policy.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+#include "lookahead.h"
+
+// As consultas usam o registro de bits: após cleanup_empty_calls, todo
+// andar em reg.active tem passageiros esperando.
+
+// PRIORIDADE 0: Chamadas em emergência (esperando muito tempo)
+static int stage_emergency(SimContext *ctx, void *state) {
+    (void)state;
+    const BuildingConfig *cfg = &ctx->cfg;
+    const ElevatorState *elevator = &ctx->elevator;
+    const CallRegistry *reg = &ctx->reg;
+    const int cur = elevator->current_floor;
+
+    int emergency_floor = sim_emergency_call(ctx);
+    if (emergency_floor == -1) return -1;
+    int wait = sim_call_wait(ctx, emergency_floor);
+
+    // Conta quantas chamadas ativas existem entre aqui e lá
+    // (do andar atual, inclusive, até a emergência, exclusive)
+    int calls_in_path = (emergency_floor > cur)
+        ? floorset_count_range(&reg->active, cur, emergency_floor)
+        : floorset_count_range(&reg->active, emergency_floor + 1, cur + 1);
+
+    // Passageiros individuais só liberam lugar no destino: lotado, o
+    // carro não atende a emergência antes de passar por um destino
+    bool blocked = ctx->pax && elevator->occupancy >= cfg->car_capacity &&
+                   !floorset_test(&reg->internal, emergency_floor);
+
+    // Se tiver poucas chamadas no caminho OU o elevador estiver bem vazio,
+    // vai direto para a emergência
+    if (!blocked && (calls_in_path < 2 || elevator->occupancy < 2)) {
+        SIM_LOG(ctx, LOG_EMERGENCY, emergency_floor, wait);
+        SIM_TRACE(ctx, TRACE_EV_EMERGENCY, emergency_floor, 1, wait, calls_in_path);
+        return emergency_floor;
+    }
+
+    SIM_LOG(ctx, LOG_EMERGENCY_DEFER, calls_in_path);
+    SIM_TRACE(ctx, TRACE_EV_EMERGENCY, emergency_floor, 0, wait, calls_in_path);
+    // não decide aqui: deixa seguir para outras prioridades (botão, internas, etc.)
+    return -1;
+}
+
+// PRIORIDADE 1: Chamadas disparadas manualmente pelos botões A e B
+static int stage_button(SimContext *ctx, void *state) {
+    (void)state;
+    int floor = floorset_nearest(&ctx->reg.button, ctx->elevator.current_floor);
+    if (floor != -1) {
+        SIM_LOG(ctx, LOG_PRIO_BUTTON, floor);
+    }
+    return floor;
+}
+
+// PRIORIDADE 2: Chamadas internas (passageiros já dentro)
+static int stage_internal(SimContext *ctx, void *state) {
+    (void)state;
+    const FloorSet *internal = &ctx->reg.internal;
+    const int cur = ctx->elevator.current_floor;
+    if (!floorset_any(internal)) return -1;
+
+    // Prioriza mesma direção: o destino mais próximo à frente
+    int floor = (ctx->elevator.direction == 1)
+        ? floorset_next_up(internal, cur)
+        : floorset_next_down(internal, cur);
+
+    // Se não achou na direção atual, pega o mais próximo
+    if (floor == -1) {
+        floor = floorset_nearest(internal, cur);
+    }
+
+    if (floor != -1) {
+        SIM_LOG(ctx, LOG_PRIO_INTERNAL, floor);
+    }
+    return floor;
+}
+
+// PRIORIDADE 3: Se lotado há muito tempo, FORÇAR desembarque
+static int stage_forced(SimContext *ctx, void *state) {
+    (void)state;
+    const BuildingConfig *cfg = &ctx->cfg;
+    const ElevatorState *elevator = &ctx->elevator;
+
+    if (elevator->occupancy < cfg->car_capacity ||
+        ctx->cycles_at_full_capacity < cfg->cycles_full_max) {
+        return -1;
+    }
+
+    int next = elevator->current_floor + elevator->direction;
+    if (next < 0 || next >= cfg->num_floors) return -1;
+
+    SIM_LOG(ctx, LOG_FORCED_DISEMBARK, ctx->cycles_at_full_capacity, next);
+    ctx->cycles_at_full_capacity = 0;
+    return next;
+}
+
+// PRIORIDADE 4: Primeiro atende chamadas próximas na direção atual
+// (até 2 andares de distância)
+static int stage_proximity(SimContext *ctx, void *state) {
+    (void)state;
+    const int cur = ctx->elevator.current_floor;
+    int floor = (ctx->elevator.direction == 1)
+        ? floorset_next_up(&ctx->reg.active, cur)
+        : floorset_next_down(&ctx->reg.active, cur);
+    if (floor != -1 && floor - cur <= 2 && cur - floor <= 2) {
+        SIM_LOG(ctx, LOG_PROXIMITY, floor);
+        return floor;
+    }
+    return -1;
+}
+
+// PRIORIDADE 5: Se não está muito lotado, usar SmartStop
+static int stage_smartstop(SimContext *ctx, void *state) {
+    (void)state;
+    const BuildingConfig *cfg = &ctx->cfg;
+    if (ctx->elevator.occupancy >= cfg->car_capacity - 2) return -1;
+
+    int floor = smartstop_decide_next_floor(cfg, ctx->calls, &ctx->reg.active, &ctx->elevator,
+                                            ctx->wait_clock, &ctx->stats);
+    if (floor != -1) {
+        SIM_LOG(ctx, LOG_SMARTSTOP, floor);
+    }
+    return floor;
+}
+
+// PRIORIDADE 6: Se lotado mas não emergencial, buscar chamadas na direção
+// só considera chamadas COM passageiros
+static int stage_full(SimContext *ctx, void *state) {
+    (void)state;
+    const int cur = ctx->elevator.current_floor;
+    if (ctx->elevator.occupancy < ctx->cfg.car_capacity - 1) return -1;
+
+    int floor = (ctx->elevator.direction == 1)
+        ? floorset_next_up(&ctx->reg.active, cur + 1)
+        : floorset_next_down(&ctx->reg.active, cur - 1);
+    if (floor != -1) {
+        SIM_LOG(ctx, LOG_FULL, floor);
+    }
+    return floor;
+}
+
+// — FALLBACK REALISTA
+// Se elevador estiver vazio e existir chamada externa,
+// vá atender a chamada mais próxima.
+static int stage_empty(SimContext *ctx, void *state) {
+    (void)state;
+    if (ctx->elevator.occupancy != 0) return -1;
+
+    int floor = floorset_nearest(&ctx->reg.active, ctx->elevator.current_floor);
+    if (floor != -1) {
+        SIM_LOG(ctx, LOG_FALLBACK_EMPTY, floor);
+    }
+    return floor;
+}
+
+// Busca com antecipação (estado: Lookahead); -1 em emergência ou sem resposta
+static int stage_lookahead(SimContext *ctx, void *state) {
+    int floor = lookahead_decide(state, ctx);
+    if (floor != -1) {
+        SIM_LOG(ctx, LOG_LOOKAHEAD, floor);
+    }
+    return floor;
+}
+
+static const DispatchStageOps stage_ops[] = {
+    { "emergency", PRIORITY_EMERGENCY,        stage_emergency },
+    { "button",    PRIORITY_BUTTON,           stage_button },
+    { "internal",  PRIORITY_INTERNAL,         stage_internal },
+    { "forced",    PRIORITY_FORCED_DISEMBARK, stage_forced },
+    { "proximity", PRIORITY_PROXIMITY,        stage_proximity },
+    { "smartstop", PRIORITY_SMARTSTOP,        stage_smartstop },
+    { "full",      PRIORITY_FULL,             stage_full },
+    { "empty",     PRIORITY_FALLBACK_EMPTY,   stage_empty },
+    { "lookahead", PRIORITY_LOOKAHEAD,        stage_lookahead },
+};
+
+#define NUM_STAGE_OPS ((int)(sizeof(stage_ops) / sizeof(stage_ops[0])))
+#define LOOKAHEAD_OPS (&stage_ops[8])
+
+const DispatchStage dispatch_cascade[DISPATCH_CASCADE_STAGES] = {
+    { &stage_ops[0], NULL }, { &stage_ops[1], NULL }, { &stage_ops[2], NULL },
+    { &stage_ops[3], NULL }, { &stage_ops[4], NULL }, { &stage_ops[5], NULL },
+    { &stage_ops[6], NULL }, { &stage_ops[7], NULL },
+};
+
+// always_inline e desenrolado: com a cascata constante os estágios viram
+// chamadas diretas em dispatch_cascade_decide (sem chamada indireta)
+static inline __attribute__((always_inline))
+int run_stages(const DispatchStage stages[], int num_stages,
+               SimContext *ctx, DispatchPriority *priority) {
+#pragma GCC unroll 8
+    for (int k = 0; k < num_stages; k++) {
+        int floor = stages[k].ops->decide(ctx, stages[k].state);
+        if (floor != -1) {
+            *priority = stages[k].ops->priority;
+            return floor;
+        }
+    }
+    *priority = PRIORITY_NONE;
+    return -1;
+}
+
+int dispatch_stages_decide(const DispatchStage stages[], int num_stages,
+                           SimContext *ctx, DispatchPriority *priority) {
+    return run_stages(stages, num_stages, ctx, priority);
+}
+
+int dispatch_cascade_decide(SimContext *ctx, DispatchPriority *priority) {
+    return run_stages(dispatch_cascade, DISPATCH_CASCADE_STAGES, ctx, priority);
+}
+
+const DispatchStageOps *dispatch_stage_find(const char *name) {
+    for (int k = 0; k < NUM_STAGE_OPS; k++) {
+        if (strcmp(stage_ops[k].name, name) == 0) return &stage_ops[k];
+    }
+    return NULL;
+}
+
+void dispatch_policy_init(DispatchPolicy *p, const char *name) {
+    memset(p, 0, sizeof(*p));
+    snprintf(p->name, sizeof(p->name), "%s", name);
+}
+
+bool dispatch_policy_add(DispatchPolicy *p, const DispatchStageOps *ops, void *state) {
+    if (p->num_stages >= DISPATCH_MAX_STAGES) return false;
+    p->stages[p->num_stages].ops = ops;
+    p->stages[p->num_stages].state = state;
+    p->num_stages++;
+    return true;
+}
+
+static bool add_cascade(DispatchPolicy *p) {
+    for (int k = 0; k < DISPATCH_CASCADE_STAGES; k++) {
+        if (!dispatch_policy_add(p, dispatch_cascade[k].ops, NULL)) return false;
+    }
+    return true;
+}
+
+bool dispatch_policy_parse(DispatchPolicy *p, const char *name, const char *spec,
+                           Lookahead *la) {
+    dispatch_policy_init(p, name);
+
+    if (strcmp(spec, "cascade") == 0) {
+        return add_cascade(p);
+    }
+    if (strcmp(spec, "lookahead") == 0 && la) {
+        return dispatch_policy_add(p, LOOKAHEAD_OPS, la) && add_cascade(p);
+    }
+
+    const char *s = spec;
+    while (*s) {
+        const char *end = strchr(s, ',');
+        size_t len = end ? (size_t)(end - s) : strlen(s);
+        char stage[16];
+        if (len == 0 || len >= sizeof(stage)) {
+            fprintf(stderr, "Política %s: estágio vazio ou longo demais em \"%s\"\n", name, spec);
+            return false;
+        }
+        memcpy(stage, s, len);
+        stage[len] = '\0';
+
+        const DispatchStageOps *ops = dispatch_stage_find(stage);
+        if (!ops) {
+            fprintf(stderr, "Política %s: estágio desconhecido \"%s\"\n", name, stage);
+            return false;
+        }
+        void *state = NULL;
+        if (ops == LOOKAHEAD_OPS) {
+            if (!la) {
+                fprintf(stderr, "Política %s: lookahead sem busca configurada\n", name);
+                return false;
+            }
+            state = la;
+        }
+        if (!dispatch_policy_add(p, ops, state)) {
+            fprintf(stderr, "Política %s: mais de %d estágios\n", name, DISPATCH_MAX_STAGES);
+            return false;
+        }
+        s += len;
+        if (*s == ',') s++;
+    }
+    if (p->num_stages == 0) {
+        fprintf(stderr, "Política %s: nenhum estágio\n", name);
+        return false;
+    }
+    return true;
+}
+
+int dispatch_policy_decide(DispatchPolicy *p, SimContext *ctx, DispatchPriority *priority) {
+    uint64_t start = p->timed ? hal_time_ns() : 0;
+    int floor = dispatch_stages_decide(p->stages, p->num_stages, ctx, priority);
+    if (p->timed) {
+        uint64_t ns = hal_time_ns() - start;
+        p->time_sum_ns += ns;
+        if (ns > p->time_max_ns) p->time_max_ns = ns;
+    }
+    p->decisions++;
+    p->by_priority[*priority]++;
+    return floor;
+}
+
+void dispatch_policy_describe(const DispatchPolicy *p, char *out, int size) {
+    int n = 0;
+    out[0] = '\0';
+    for (int k = 0; k < p->num_stages && n < size; k++) {
+        n += snprintf(out + n, (size_t)(size - n), "%s%s", k ? "," : "", p->stages[k].ops->name);
+    }
+}
+
+void dispatch_policy_print_report(const DispatchPolicy *p) {
+    char stages[160];
+    dispatch_policy_describe(p, stages, (int)sizeof(stages));
+    printf("\n--- Política %s ---\n", p->name);
+    printf("Estágios:            %s\n", stages);
+    printf("Decisões:            %llu\n", (unsigned long long)p->decisions);
+    for (int r = 0; r <= PRIORITY_LOOKAHEAD; r++) {
+        if (p->by_priority[r] == 0) continue;
+        printf("  %-20s %llu (%.1f %%)\n", dispatch_priority_name((DispatchPriority)r),
+               (unsigned long long)p->by_priority[r],
+               100.0 * (double)p->by_priority[r] / (double)p->decisions);
+    }
+    if (p->timed && p->decisions > 0) {
+        printf("Tempo por decisão:   média %.0f / máx %llu ns\n",
+               (double)p->time_sum_ns / (double)p->decisions,
+               (unsigned long long)p->time_max_ns);
+    }
+    printf("----------------------------------------------\n");
+}
@@ -0,0 +1,87 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dispatch.h"
+
+// Políticas de despacho montadas por estágios.
+//
+// Cada estágio é uma regra da cascata (emergência, botões, internas, ...):
+// olha o contexto e devolve um andar, ou -1 para passar ao seguinte. Um
+// estágio é uma tabela de funções (DispatchStageOps, constante) mais um
+// estado opaco próprio (NULL nas regras da cascata; o Lookahead da busca
+// com antecipação). A política é a lista ordenada de estágios: combinar,
+// reordenar ou trocar regras é montar outra lista, sem tocar no laço.
+//
+// choose_next_floor_realistic é a cascata padrão (dispatch_cascade) e
+// continua sem estatísticas; uma DispatchPolicy anexada ao SimContext
+// (ctx->policy) conta as decisões por regra e, se timed, o custo de cada uma.
+
+#define DISPATCH_MAX_STAGES 12
+
+typedef struct {
+    const char *name;               // nome na especificação ("emergency", ...)
+    DispatchPriority priority;      // regra registrada quando o estágio decide
+    int (*decide)(SimContext *ctx, void *state);    // andar ou -1 (passa adiante)
+} DispatchStageOps;
+
+typedef struct {
+    const DispatchStageOps *ops;
+    void *state;                    // opaco, do estágio
+} DispatchStage;
+
+struct DispatchPolicy {
+    char name[32];
+    int num_stages;
+    DispatchStage stages[DISPATCH_MAX_STAGES];
+
+    // Estatísticas
+    bool timed;                     // mede o custo de cada decisão (hal_time_ns)
+    uint64_t decisions;
+    uint64_t by_priority[PRIORITY_LOOKAHEAD + 1];
+    uint64_t time_sum_ns;
+    uint64_t time_max_ns;
+};
+
+// As oito regras de choose_next_floor_realistic, na ordem original
+#define DISPATCH_CASCADE_STAGES 8
+extern const DispatchStage dispatch_cascade[DISPATCH_CASCADE_STAGES];
+
+// Primeiro andar devolvido pelos estágios, em ordem; -1 (PRIORITY_NONE) se
+// nenhum decidir
+int dispatch_stages_decide(const DispatchStage stages[], int num_stages,
+                           SimContext *ctx, DispatchPriority *priority);
+
+// dispatch_stages_decide sobre dispatch_cascade (choose_next_floor_realistic)
+int dispatch_cascade_decide(SimContext *ctx, DispatchPriority *priority);
+
+// Estágio pelo nome: emergency, button, internal, forced, proximity,
+// smartstop, full, empty, lookahead (estado: Lookahead inicializado)
+const DispatchStageOps *dispatch_stage_find(const char *name);
+
+// Política vazia (sem estágios) e estatísticas zeradas
+void dispatch_policy_init(DispatchPolicy *p, const char *name);
+
+// Acrescenta um estágio ao fim. Retorna false se a lista está cheia.
+bool dispatch_policy_add(DispatchPolicy *p, const DispatchStageOps *ops, void *state);
+
+// Monta a política por uma especificação: "cascade" (a cascata padrão),
+// "lookahead" (busca seguida da cascata) ou estágios separados por vírgula,
+// por exemplo "emergency,button,internal,smartstop,empty". O estágio
+// lookahead usa la (NULL = não permitido). Em caso de erro escreve a causa
+// em stderr e retorna false.
+bool dispatch_policy_parse(DispatchPolicy *p, const char *name, const char *spec,
+                           Lookahead *la);
+
+// Decide pelos estágios da política e atualiza as estatísticas
+int dispatch_policy_decide(DispatchPolicy *p, SimContext *ctx, DispatchPriority *priority);
+
+// Estágios em texto ("emergency,button,..."), para relatórios
+void dispatch_policy_describe(const DispatchPolicy *p, char *out, int size);
+
+// Decisões por regra e custo por decisão
+void dispatch_policy_print_report(const DispatchPolicy *p);
+
+#endif
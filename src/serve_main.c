@@ -0,0 +1,422 @@
+/*
+ * SmartStop - despacho como serviço num socket Unix (ver dispatch_service.h)
+ *
+ * Modo servidor (padrão): escuta em --socket, uma sessão por conexão, com
+ * poll numa única thread. Cada leitura vira um lote. Os sockets não
+ * bloqueiam: a parte da resposta que o socket não aceita fica na sessão e
+ * sai quando ele aceitar (POLLOUT). Enquanto isso a sessão não lê outro
+ * lote, então um cliente que não lê as respostas só atrasa a si mesmo. Ao
+ * receber SIGINT/SIGTERM imprime os quantis do tempo de decisão de todas
+ * as sessões e sai.
+ *
+ * Modo cliente (--client): gerador de carga que conversa com o servidor como
+ * um sistema predial. A cada lote manda a posição do carro (parado no andar
+ * decidido na resposta anterior), um tique de espera e chamadas sorteadas,
+ * até --frames quadros. Imprime quadros/s e decisões/s (uma por lote), o
+ * tempo de ida e volta por lote e os quantis medidos no servidor
+ * (SVC_STATS).
+ *
+ * Uso:
+ *   smartstop_serve [--socket caminho] [--floors N] [--decider cascade|smartstop]
+ *   smartstop_serve --client [--socket caminho] [--floors N] [--frames N]
+ *                   [--batch B] [--seed S]
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "dispatch_service.h"
+#include "hal.h"
+
+#define SERVE_MAX_CLIENTS 64
+#define SERVE_DEFAULT_SOCKET "/tmp/smartstop.sock"
+
+typedef struct {
+    int fd;
+    SvcSession session;
+    uint8_t in[SVC_MAX_BATCH * SVC_FRAME_BYTES];
+    size_t have;                    // bytes lidos, inclusive um quadro incompleto
+    uint8_t out[SVC_MAX_BATCH * (SVC_FRAME_BYTES + SVC_STATS_BYTES)];
+    size_t pending;                 // bytes de resposta em out (0 = nada pendente)
+    size_t sent;                    // deles, já escritos
+} Client;
+
+static volatile sig_atomic_t stop_requested;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [--socket caminho] [--floors N] [--decider cascade|smartstop]\n"
+            "     %s --client [--socket caminho] [--floors N] [--frames N]\n"
+            "          [--batch B] [--seed S]\n",
+            prog, prog);
+}
+
+static bool write_all(int fd, const uint8_t *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+static bool read_all(int fd, uint8_t *p, size_t n) {
+    while (n > 0) {
+        ssize_t r = read(fd, p, n);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= (size_t)r;
+    }
+    return true;
+}
+
+static void hist_merge(LogHist *dst, const LogHist *src) {
+    dst->count += src->count;
+    dst->sum_ns += src->sum_ns;
+    if (src->max_ns > dst->max_ns) dst->max_ns = src->max_ns;
+    for (int i = 0; i < LOGHIST_BINS; i++) dst->bins[i] += src->bins[i];
+}
+
+static void print_latency(const char *label, const LogHist *h) {
+    fprintf(stderr, "%s: %u medidas, média %.2f us, p50 %.2f us, p99 %.2f us, "
+            "p999 %.2f us, pior %.2f us\n",
+            label, h->count, loghist_mean_ns(h) / 1e3,
+            loghist_quantile_ns(h, 500) / 1e3, loghist_quantile_ns(h, 990) / 1e3,
+            loghist_quantile_ns(h, 999) / 1e3, h->max_ns / 1e3);
+}
+
+static int open_socket(const char *path, struct sockaddr_un *addr) {
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        fprintf(stderr, "Caminho do socket longo demais: %s\n", path);
+        return -1;
+    }
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) perror("socket");
+    return fd;
+}
+
+// ---------------------------------------------------------------------------
+// Servidor
+// ---------------------------------------------------------------------------
+
+// Escreve o que o socket aceitar da resposta pendente. false = fechar.
+static bool flush_client(Client *c) {
+    while (c->sent < c->pending) {
+        ssize_t w = write(c->fd, c->out + c->sent, c->pending - c->sent);
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (w <= 0) return false;
+        c->sent += (size_t)w;
+    }
+    c->pending = 0;
+    c->sent = 0;
+    return true;
+}
+
+// Com resposta pendente, continua a escrita; senão lê o que houver e
+// responde a todos os quadros completos. false = fechar.
+static bool serve_client(Client *c) {
+    if (c->pending) return flush_client(c);
+
+    ssize_t r = read(c->fd, c->in + c->have, sizeof(c->in) - c->have);
+    if (r < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+    if (r <= 0) return false;
+    uint64_t start = hal_time_ns();
+    c->have += (size_t)r;
+
+    int n = (int)(c->have / SVC_FRAME_BYTES);
+    if (n == 0) return true;
+    c->pending = svc_session_handle(&c->session, c->in, n, c->out, start);
+    c->sent = 0;
+
+    size_t used = (size_t)n * SVC_FRAME_BYTES;
+    memmove(c->in, c->in + used, c->have - used);
+    c->have -= used;
+    return flush_client(c);
+}
+
+static int run_server(const char *path, const BuildingConfig *cfg, SvcDecider decider) {
+    struct sockaddr_un addr;
+    int listener = open_socket(path, &addr);
+    if (listener < 0) return 1;
+    unlink(path);
+    if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listener, SERVE_MAX_CLIENTS) != 0 ||
+        fcntl(listener, F_SETFL, O_NONBLOCK) != 0) {
+        perror(path);
+        close(listener);
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    Client *clients[SERVE_MAX_CLIENTS] = { 0 };
+    struct pollfd fds[SERVE_MAX_CLIENTS + 1];
+    LogHist total;
+    uint64_t batches = 0, events = 0, sessions = 0;
+    loghist_reset(&total);
+
+    fprintf(stderr, "Escutando em %s (%d andares, decisão %s)\n", path, cfg->num_floors,
+            decider == SVC_DECIDE_SMARTSTOP ? "smartstop" : "cascade");
+
+    while (!stop_requested) {
+        int nfds = 0;
+        fds[nfds++] = (struct pollfd){ .fd = listener, .events = POLLIN };
+        int slot_of[SERVE_MAX_CLIENTS + 1];
+        for (int i = 0; i < SERVE_MAX_CLIENTS; i++) {
+            if (!clients[i]) continue;
+            slot_of[nfds] = i;
+            fds[nfds++] = (struct pollfd){ .fd = clients[i]->fd,
+                                           .events = clients[i]->pending ? POLLOUT : POLLIN };
+        }
+
+        if (poll(fds, (nfds_t)nfds, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+
+        for (int k = 1; k < nfds; k++) {
+            if (!fds[k].revents) continue;
+            Client *c = clients[slot_of[k]];
+            if (serve_client(c)) continue;
+
+            hist_merge(&total, &c->session.latency);
+            batches += c->session.batches;
+            events += c->session.events;
+            close(c->fd);
+            free(c);
+            clients[slot_of[k]] = NULL;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK);
+            if (fd < 0) continue;
+            int slot = 0;
+            while (slot < SERVE_MAX_CLIENTS && clients[slot]) slot++;
+            Client *c = slot < SERVE_MAX_CLIENTS ? malloc(sizeof(Client)) : NULL;
+            if (!c) {
+                close(fd);
+                continue;
+            }
+            c->fd = fd;
+            c->have = 0;
+            c->pending = 0;
+            c->sent = 0;
+            svc_session_init(&c->session, cfg, decider);
+            clients[slot] = c;
+            sessions++;
+        }
+    }
+
+    for (int i = 0; i < SERVE_MAX_CLIENTS; i++) {
+        if (!clients[i]) continue;
+        hist_merge(&total, &clients[i]->session.latency);
+        batches += clients[i]->session.batches;
+        events += clients[i]->session.events;
+        close(clients[i]->fd);
+        free(clients[i]);
+    }
+    close(listener);
+    unlink(path);
+
+    fprintf(stderr, "%llu sessões, %llu lotes, %llu eventos\n", (unsigned long long)sessions,
+            (unsigned long long)batches, (unsigned long long)events);
+    print_latency("Decisão por lote", &total);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Cliente (gerador de carga)
+// ---------------------------------------------------------------------------
+
+static int run_client(const char *path, int floors, long long frames, int batch,
+                      uint64_t seed) {
+    struct sockaddr_un addr;
+    int fd = open_socket(path, &addr);
+    if (fd < 0) return 1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror(path);
+        close(fd);
+        return 1;
+    }
+
+    static uint8_t req[SVC_MAX_BATCH * SVC_FRAME_BYTES];
+    static uint8_t rep[SVC_MAX_BATCH * SVC_FRAME_BYTES + SVC_STATS_BYTES];
+    SimRng rng;
+    sim_rng_seed(&rng, seed);
+    LogHist rtt;
+    loghist_reset(&rtt);
+
+    int floor = floors - 1, direction = -1, occupancy = 0;
+    bool stopped = false;
+    uint32_t seq = 0;
+    long long sent = 0, batches = 0, stops = 0;
+    uint64_t start = hal_time_ns();
+
+    while (sent < frames) {
+        int n = 0;
+        // Posição (e parada) do carro e um tique por lote; o resto são
+        // chamadas. Com lotes de 1 quadro os tipos se alternam.
+        int kind = batch == 1 ? (int)(seq % 3) : 0;
+        while (n < batch) {
+            uint8_t *p = req + n * SVC_FRAME_BYTES;
+            if (kind == 0) {
+                svc_encode_event(p, SVC_CAR_POSITION, floor, occupancy,
+                                 (direction < 0 ? SVC_POS_DOWN : 0u) |
+                                 (stopped ? SVC_POS_STOP : 0u), seq);
+            } else if (kind == 1) {
+                svc_encode_event(p, SVC_TICK, 0, 1, 0, seq);
+            } else if (sim_rng_below(&rng, 4) == 0) {
+                svc_encode_event(p, SVC_CAR_CALL, sim_rng_below(&rng, (uint32_t)floors), 0, 0,
+                                 seq);
+            } else {
+                svc_encode_event(p, SVC_HALL_CALL, sim_rng_below(&rng, (uint32_t)floors),
+                                 1 + sim_rng_below(&rng, 4), 0, seq);
+            }
+            n++;
+            seq++;
+            kind = kind < 2 ? kind + 1 : 2;
+        }
+
+        uint64_t t0 = hal_time_ns();
+        if (!write_all(fd, req, (size_t)n * SVC_FRAME_BYTES) ||
+            !read_all(fd, rep, (size_t)n * SVC_FRAME_BYTES)) {
+            fprintf(stderr, "Conexão encerrada pelo servidor\n");
+            close(fd);
+            return 1;
+        }
+        loghist_add(&rtt, hal_time_ns() - t0);
+        sent += n;
+        batches++;
+
+        // O carro vai ao andar decidido e para lá no próximo lote
+        const uint8_t *last = rep + (n - 1) * SVC_FRAME_BYTES;
+        if (last[1] != SVC_NO_FLOOR) {
+            if (last[1] != floor) direction = last[1] > floor ? 1 : -1;
+            floor = last[1];
+            occupancy = sim_rng_below(&rng, 9);
+            stopped = true;
+            stops++;
+        } else {
+            stopped = false;
+            floor += direction;
+            if (floor <= 0) {
+                floor = 0;
+                direction = 1;
+            } else if (floor >= floors - 1) {
+                floor = floors - 1;
+                direction = -1;
+            }
+        }
+    }
+    double seconds = (double)(hal_time_ns() - start) / 1e9;
+
+    // Quantis medidos no servidor
+    svc_encode_event(req, SVC_STATS, 0, 0, 0, seq);
+    if (!write_all(fd, req, SVC_FRAME_BYTES) ||
+        !read_all(fd, rep, SVC_FRAME_BYTES + SVC_STATS_BYTES)) {
+        fprintf(stderr, "Conexão encerrada pelo servidor\n");
+        close(fd);
+        return 1;
+    }
+    close(fd);
+
+    const uint8_t *st = rep + SVC_FRAME_BYTES;
+    // Uma decisão por lote, respondida em todos os quadros dele
+    printf("%lld quadros em %lld lotes de %d: %.3f s (%.0f quadros/s, %.0f decisões/s, "
+           "%lld paradas)\n",
+           sent, batches, batch, seconds, seconds > 0.0 ? (double)sent / seconds : 0.0,
+           seconds > 0.0 ? (double)batches / seconds : 0.0, stops);
+    printf("Ida e volta por lote: p50 %.2f us, p99 %.2f us, p999 %.2f us, pior %.2f us\n",
+           loghist_quantile_ns(&rtt, 500) / 1e3, loghist_quantile_ns(&rtt, 990) / 1e3,
+           loghist_quantile_ns(&rtt, 999) / 1e3, rtt.max_ns / 1e3);
+    printf("Servidor (%llu lotes, %llu eventos): p50 %.2f us, p99 %.2f us, p999 %.2f us, "
+           "pior %.2f us\n",
+           (unsigned long long)svc_get_u64(st), (unsigned long long)svc_get_u64(st + 8),
+           svc_get_u64(st + 16) / 1e3, svc_get_u64(st + 24) / 1e3,
+           svc_get_u64(st + 32) / 1e3, svc_get_u64(st + 40) / 1e3);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *path = SERVE_DEFAULT_SOCKET;
+    bool client = false;
+    SvcDecider decider = SVC_DECIDE_CASCADE;
+    long long frames = 100000;
+    int batch = 1;
+    uint64_t seed = 1;
+    BuildingConfig cfg;
+
+    building_config_default(&cfg);
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool ok = val != NULL;
+
+        if (strcmp(arg, "--client") == 0) {
+            client = true;
+            continue;
+        } else if (strcmp(arg, "--socket") == 0 && val) {
+            path = val;
+        } else if (strcmp(arg, "--floors") == 0 && val) {
+            cfg.num_floors = atoi(val);
+        } else if (strcmp(arg, "--decider") == 0 && val) {
+            if (strcmp(val, "cascade") == 0) decider = SVC_DECIDE_CASCADE;
+            else if (strcmp(val, "smartstop") == 0) decider = SVC_DECIDE_SMARTSTOP;
+            else ok = false;
+        } else if (strcmp(arg, "--frames") == 0 && val) {
+            frames = atoll(val);
+        } else if (strcmp(arg, "--batch") == 0 && val) {
+            batch = atoi(val);
+        } else if (strcmp(arg, "--seed") == 0 && val) {
+            seed = strtoull(val, NULL, 0);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    // O protocolo leva o andar num byte (SVC_NO_FLOOR reservado)
+    if (!building_config_apply(&cfg) || cfg.num_floors >= SVC_NO_FLOOR ||
+        frames < 1 || batch < 1 || batch > SVC_MAX_BATCH) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    return client ? run_client(path, cfg.num_floors, frames, batch, seed)
+                  : run_server(path, &cfg, decider);
+}
@@ -0,0 +1,92 @@
+#include "sim_clock.h"
+#include "hal.h"
+
+#include <stddef.h>
+
+void sim_clock_init(SimClock *c, SimClockMode mode, float scale) {
+    c->mode = mode;
+    c->scale = (scale > 0.0f) ? scale : 1.0f;
+    c->virtual_us = 0;
+    c->idle = NULL;
+    c->idle_user = NULL;
+    c->slept_us = 0;
+    c->late_us_sum = 0;
+    c->late_us_max = 0;
+    c->pauses = 0;
+}
+
+void sim_clock_set_idle(SimClock *c, SimClockIdleFn fn, void *user) {
+    c->idle = fn;
+    c->idle_user = user;
+}
+
+static void sleep_real_us(SimClock *c, uint64_t us) {
+    uint64_t deadline = hal_time_us() + us;
+
+    if (c->idle) {
+        c->idle(c->idle_user, deadline);
+        uint64_t now = hal_time_us();
+        if (now < deadline) {
+            hal_sleep_us(deadline - now);
+        }
+    } else {
+        hal_sleep_us(us);
+    }
+
+    uint64_t now = hal_time_us();
+    uint32_t late = now > deadline ? (uint32_t)(now - deadline) : 0;
+    c->slept_us += us;
+    c->late_us_sum += late;
+    if (late > c->late_us_max) c->late_us_max = late;
+    c->pauses++;
+}
+
+uint64_t sim_clock_now_us(const SimClock *c) {
+    return c->virtual_us;
+}
+
+void sim_clock_sleep_ms(SimClock *c, uint32_t ms) {
+    sim_clock_advance_us(c, (uint64_t)ms * 1000u);
+}
+
+void sim_clock_advance_us(SimClock *c, uint64_t us) {
+    c->virtual_us += us;
+
+    switch (c->mode) {
+        case SIM_CLOCK_REALTIME:
+            sleep_real_us(c, us);
+            break;
+        case SIM_CLOCK_SCALED:
+            sleep_real_us(c, (uint64_t)((float)us / c->scale));
+            break;
+        case SIM_CLOCK_FAST:
+        default:
+            break;
+    }
+}
+
+void loop_meter_reset(LoopMeter *m) {
+    m->cycles = 0;
+    m->busy_min_us = UINT32_MAX;
+    m->busy_max_us = 0;
+    m->busy_sum_us = 0;
+    m->late_max_us = 0;
+}
+
+void loop_meter_begin(LoopMeter *m, const SimClock *c) {
+    m->start_us = hal_time_us();
+    m->slept_at_start = c->slept_us;
+}
+
+void loop_meter_end(LoopMeter *m, SimClock *c) {
+    uint64_t wall = hal_time_us() - m->start_us;
+    uint64_t slept = c->slept_us - m->slept_at_start;
+    uint32_t busy = wall > slept ? (uint32_t)(wall - slept) : 0;
+
+    m->cycles++;
+    m->busy_sum_us += busy;
+    if (busy < m->busy_min_us) m->busy_min_us = busy;
+    if (busy > m->busy_max_us) m->busy_max_us = busy;
+    if (c->late_us_max > m->late_max_us) m->late_max_us = c->late_us_max;
+    c->late_us_max = 0;
+}
@@ -0,0 +1,73 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+
+// Relógio da simulação.
+// Toda pausa da lógica (viagem entre andares, portas, LEDs) passa por aqui,
+// o que permite rodar em tempo real (Pico), acelerado ou sem pausa alguma.
+typedef enum {
+    SIM_CLOCK_REALTIME = 0,  // dorme o tempo pedido (comportamento original)
+    SIM_CLOCK_SCALED,        // dorme tempo / scale (ex.: scale 10 = 10x mais rápido)
+    SIM_CLOCK_FAST           // não dorme: apenas avança o tempo virtual
+} SimClockMode;
+
+// Chamada no início de cada pausa real com o instante (hal_time_us) em que
+// a pausa termina; deve retornar antes dele. O restante é dormido.
+typedef void (*SimClockIdleFn)(void *user, uint64_t deadline_us);
+
+typedef struct {
+    SimClockMode mode;
+    float scale;            // usado apenas em SIM_CLOCK_SCALED
+    uint64_t virtual_us;    // tempo simulado acumulado
+    SimClockIdleFn idle;    // trabalho de fundo durante as pausas (opcional)
+    void *idle_user;
+
+    // Pausas reais (REALTIME/SCALED): tempo pedido e atraso ao acordar
+    uint64_t slept_us;
+    uint64_t late_us_sum;
+    uint32_t late_us_max;
+    uint32_t pauses;
+} SimClock;
+
+// Medição do laço de controle: trabalho por ciclo (tempo de parede menos
+// as pausas pedidas ao relógio) e o atraso ao acordar das pausas. A
+// variação do trabalho entre ciclos é o jitter do laço.
+typedef struct {
+    uint32_t cycles;
+    uint32_t busy_min_us;
+    uint32_t busy_max_us;
+    uint64_t busy_sum_us;
+    uint32_t late_max_us;
+
+    uint64_t start_us;
+    uint64_t slept_at_start;
+} LoopMeter;
+
+void sim_clock_init(SimClock *c, SimClockMode mode, float scale);
+
+// Aproveita as pausas (viagem, portas) para trabalho de fundo, como
+// esvaziar o log diferido
+void sim_clock_set_idle(SimClock *c, SimClockIdleFn fn, void *user);
+
+// Tempo simulado atual em microssegundos
+uint64_t sim_clock_now_us(const SimClock *c);
+
+// Avança o tempo simulado (e dorme de verdade conforme o modo)
+void sim_clock_sleep_ms(SimClock *c, uint32_t ms);
+
+// Como sim_clock_sleep_ms, em microssegundos (motor de eventos: salta até
+// o próximo evento)
+void sim_clock_advance_us(SimClock *c, uint64_t us);
+
+void loop_meter_reset(LoopMeter *m);
+
+// Delimitam um ciclo do laço de controle
+void loop_meter_begin(LoopMeter *m, const SimClock *c);
+void loop_meter_end(LoopMeter *m, SimClock *c);
+
+static inline uint32_t loop_meter_busy_avg_us(const LoopMeter *m) {
+    return m->cycles ? (uint32_t)(m->busy_sum_us / m->cycles) : 0;
+}
+
+#endif
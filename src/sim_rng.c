@@ -0,0 +1,58 @@
+#include "sim_rng.h"
+
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void sim_rng_seed(SimRng *rng, uint64_t seed) {
+    uint64_t x = seed;
+    uint64_t a = splitmix64(&x);
+    uint64_t b = splitmix64(&x);
+    rng->s[0] = (uint32_t)a;
+    rng->s[1] = (uint32_t)(a >> 32);
+    rng->s[2] = (uint32_t)b;
+    rng->s[3] = (uint32_t)(b >> 32);
+
+    // estado todo zero é inválido para o xoshiro
+    if ((rng->s[0] | rng->s[1] | rng->s[2] | rng->s[3]) == 0) {
+        rng->s[0] = 1;
+    }
+}
+
+static void apply_jump(SimRng *rng, const uint32_t poly[4]) {
+    uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 32; b++) {
+            if (poly[i] & (1u << b)) {
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+            }
+            sim_rng_next(rng);
+        }
+    }
+
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+}
+
+void sim_rng_jump(SimRng *rng) {
+    static const uint32_t JUMP[4] = {
+        0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b
+    };
+    apply_jump(rng, JUMP);
+}
+
+void sim_rng_long_jump(SimRng *rng) {
+    static const uint32_t LONG_JUMP[4] = {
+        0xb523952e, 0x0b6f099f, 0xccf5a0ef, 0x1c580662
+    };
+    apply_jump(rng, LONG_JUMP);
+}
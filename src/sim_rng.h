@@ -0,0 +1,49 @@
+#ifndef SIM_RNG_H
+#define SIM_RNG_H
+
+#include <stdint.h>
+
+// Gerador pseudoaleatório da simulação: xoshiro128** (Blackman & Vigna).
+// Usa apenas operações de 32 bits (rápido no Cortex-M0+) e produz a mesma
+// sequência no host e no Pico para a mesma semente. O estado fica dentro do
+// contexto de cada simulação, então simulações concorrentes não disputam
+// um gerador global como o rand().
+typedef struct {
+    uint32_t s[4];
+} SimRng;
+
+// Inicializa o estado a partir de uma semente de 64 bits (via splitmix64)
+void sim_rng_seed(SimRng *rng, uint64_t seed);
+
+// Avança 2^64 passos: cada chamada gera um fluxo independente, sem
+// sobreposição, para execuções em paralelo (fluxo k = semente + k saltos)
+void sim_rng_jump(SimRng *rng);
+
+// Avança 2^96 passos (separa grupos de fluxos)
+void sim_rng_long_jump(SimRng *rng);
+
+static inline uint32_t sim_rng_rotl(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+static inline uint32_t sim_rng_next(SimRng *rng) {
+    uint32_t *s = rng->s;
+    const uint32_t result = sim_rng_rotl(s[1] * 5u, 7) * 9u;
+    const uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = sim_rng_rotl(s[3], 11);
+
+    return result;
+}
+
+// Inteiro uniforme em [0, n) por multiplicação (sem divisão)
+static inline int sim_rng_below(SimRng *rng, uint32_t n) {
+    return (int)(((uint64_t)sim_rng_next(rng) * n) >> 32);
+}
+
+#endif
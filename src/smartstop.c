@@ -1,106 +1,427 @@
 #include "smartstop.h"
+#include "deflog.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include "pico/time.h"
 
-void smartstop_init(HallCall calls[], ElevatorState *e, Stats *s) {
+// Laços quentes especializados por número de andares.
+// Os núcleos abaixo são "templates": funções always_inline que recebem o
+// número de andares; cada especialização os chama com uma constante, e o
+// compilador gera laços com limite fixo (e, até FLOORSET_WORD_BITS andares,
+// varredura de uma única palavra do bitmask, sem o nível de resumo).
+struct SmartStopKernels {
+    int num_floors;   // 0 = caminho genérico (cfg->num_floors)
+    void (*generate)(const BuildingConfig *cfg, SimRng *rng, HallCall calls[],
+                     FloorSet *active, const ElevatorState *e, TrafficMode mode,
+                     uint32_t now);
+    int (*decide)(const BuildingConfig *cfg, const HallCall calls[],
+                  const FloorSet *active, const ElevatorState *e, uint32_t now,
+                  float *best_eff);
+    int (*decide_fixed)(const BuildingConfig *cfg, const HallCall calls[],
+                        const FloorSet *active, const ElevatorState *e, uint32_t now,
+                        SmartStopRatio *best);
+};
+
+#define SMARTSTOP_INLINE static inline __attribute__((always_inline))
+
+void building_config_default(BuildingConfig *cfg) {
+    cfg->num_floors = DEFAULT_NUM_FLOORS;
+    cfg->car_capacity = ELEVATOR_CAP;
+    cfg->travel_time_ms = TRAVEL_TIME_MS;
+    cfg->door_time_ms = DOOR_TIME_MS;
+    cfg->max_wait_time = MAX_WAIT_TIME;
+    cfg->emergency_wait_time = EMERGENCY_WAIT_TIME;
+    cfg->cycles_full_max = CYCLES_FULL_MAX;
+    cfg->efficiency_threshold = EFFICIENCY_THRESHOLD;
+    cfg->wait_bonus = WAIT_BONUS;
+    cfg->stop_cost = STOP_COST;
+    cfg->kernels = NULL;
+    building_config_apply(cfg);
+}
+
+void smartstop_init(const BuildingConfig *cfg,
+                    HallCall calls[], FloorSet *active, ElevatorState *e, Stats *s) {
+    floorset_clear(active);
     for (int i = 0; i < MAX_FLOORS; i++) {
         calls[i].active = false;
         calls[i].floor = i;
         calls[i].est_passengers = 0;
-        calls[i].wait_time = 0;
+        calls[i].arrival = 0;
     }
 
-    e->current_floor = MAX_FLOORS - 1; // começa no último andar
-    e->direction = -1;                 // descendo
-    e->occupancy = 0;                  // vazio
+    e->current_floor = cfg->num_floors - 1; // começa no último andar
+    e->direction = -1;                      // descendo
+    e->occupancy = 0;                       // vazio
 
     s->total_stops = 0;
     s->skipped_stops = 0;
     s->total_cycles = 0;
     s->total_boarded = 0;
-
-    // Semente para números aleatórios
-    uint64_t t = time_us_64();
-    srand((unsigned int)(t ^ (t >> 32)));
 }
 
-int estimate_passengers(TrafficMode mode) {
+int estimate_passengers(SimRng *rng, TrafficMode mode) {
     switch (mode) {
         case TRAFFIC_LOW:
-            return rand() % 2;   // 0 a 1
+            return sim_rng_below(rng, 2);   // 0 a 1
         case TRAFFIC_MEDIUM:
-            return rand() % 4;   // 0 a 3
+            return sim_rng_below(rng, 4);   // 0 a 3
         case TRAFFIC_HIGH:
-            return rand() % 6;   // 0 a 5
+            return sim_rng_below(rng, 6);   // 0 a 5
         default:
-            return rand() % 3;
+            return sim_rng_below(rng, 3);
     }
 }
 
-void generate_random_hall_calls(HallCall calls[],
-                                ElevatorState *e,
-                                TrafficMode mode) {
-    // Probabilidade simples de surgir nova chamada por andar
-    for (int i = 0; i < MAX_FLOORS; i++) {
-        // Não gera chamada no andar atual (já está ali)
-        if (i == e->current_floor) {
+// Chance de surgir chamada num andar livre por ciclo: 10% (ajuste se
+// quiser, junto com a tabela abaixo)
+//
+// Em vez de um sorteio por andar, sorteia quantos andares passam sem
+// chegada até a próxima (distância geométrica): ARRIVAL_GAP[j] é
+// ⌊2^32 · 0,9^(j+1)⌋, e u < ARRIVAL_GAP[j] tem a chance de j+1 andares
+// seguidos sem chegada (a menos de 2^-32).
+static const uint32_t ARRIVAL_GAP[16] = {
+    0xe6666666u, 0xcf5c28f5u, 0xba9fbe76u, 0xa7f62b6au,
+    0x972a5a46u, 0x880c8472u, 0x7a71aa67u, 0x6e33195cu,
+    0x632dfd3au, 0x5942fd81u, 0x5055e427u, 0x484d4d56u,
+    0x41125f34u, 0x3a9088e2u, 0x34b547feu, 0x2f6ff3feu,
+};
+
+SMARTSTOP_INLINE int arrival_gap(SimRng *rng) {
+    int gap = 0;
+    for (;;) {
+        uint32_t u = sim_rng_next(rng);
+        if (u < ARRIVAL_GAP[15]) {
+            // 16 ou mais: sem memória, conta 16 e sorteia o resto
+            gap += 16;
             continue;
         }
+        // quantos limiares estão acima de u (busca binária na tabela, sem
+        // desvios: a resposta é aleatória e o preditor erraria)
+        int c = 0;
+        c += (u < ARRIVAL_GAP[c + 7]) << 3;
+        c += (u < ARRIVAL_GAP[c + 3]) << 2;
+        c += (u < ARRIVAL_GAP[c + 1]) << 1;
+        c += (u < ARRIVAL_GAP[c]);
+        return gap + c;
+    }
+}
 
-        if (!calls[i].active) {
-            int r = rand() % 100;
-            // 10% de chance de surgir nova chamada (ajuste se quiser)
-            if (r < 10) {
-                calls[i].active = true;
-                calls[i].floor = i;
-                calls[i].est_passengers = estimate_passengers(mode);
-                calls[i].wait_time = 0;
-            }
-        } else {
-            // aumenta tempo de espera simulado
-            calls[i].wait_time++;
+// n-ésimo (a partir de 0) andar livre em [from, num_floors): sem chamada
+// ativa e diferente de skip; -1 se não houver
+SMARTSTOP_INLINE int nth_free_floor(int num_floors, const FloorSet *active, int skip,
+                                    int from, int n) {
+    const floorset_word_t all = ~(floorset_word_t)0;
+    for (int k = from / FLOORSET_WORD_BITS; k * FLOORSET_WORD_BITS < num_floors; k++) {
+        int base = k * FLOORSET_WORD_BITS;
+        floorset_word_t m = ~active->w[k];
+        if (from > base) m &= all << (from - base);
+        if (num_floors - base < FLOORSET_WORD_BITS) {
+            m &= (FLOORSET_ONE << (num_floors - base)) - 1;
         }
+        if (skip >= base && skip < base + FLOORSET_WORD_BITS) {
+            m &= ~(FLOORSET_ONE << (skip - base));
+        }
+
+        int c = FLOORSET_POPCOUNT(m);
+        if (n >= c) {
+            n -= c;
+            continue;
+        }
+        while (n-- > 0) m &= m - 1;
+        return base + FLOORSET_CTZ(m);
     }
+    return -1;
 }
 
-int smartstop_decide_next_floor(HallCall calls[],
-                                ElevatorState *e,
-                                Stats *s,
-                                float efficiency_threshold) {
-    s->total_cycles++;
+SMARTSTOP_INLINE void generate_kernel(int num_floors,
+                                      SimRng *rng,
+                                      HallCall calls[],
+                                      FloorSet *active,
+                                      const ElevatorState *e,
+                                      TrafficMode mode,
+                                      uint32_t now) {
+    // Probabilidade simples de surgir nova chamada por andar livre: só
+    // andares sem chamada, e não no andar atual (já está ali). Os sorteios
+    // são um por chegada, não um por andar.
+    for (int i = nth_free_floor(num_floors, active, e->current_floor, 0, arrival_gap(rng));
+         i >= 0;
+         i = nth_free_floor(num_floors, active, e->current_floor, i + 1, arrival_gap(rng))) {
+        calls[i].active = true;
+        calls[i].floor = i;
+        calls[i].est_passengers = estimate_passengers(rng, mode);
+        calls[i].arrival = now;
+        floorset_set(active, i);
+    }
+}
+
+SMARTSTOP_INLINE void score_floor(const BuildingConfig *cfg,
+                                  const HallCall calls[], const ElevatorState *e, int i,
+                                  uint32_t now, float *best_efficiency, int *best_floor) {
+    int delta = i - e->current_floor;
 
+    int est = calls[i].est_passengers;
+
+    if (est <= 0) return; // sem ganho não faz sentido
+
+    // custo simples: diferença de andares + custo fixo de parada,
+    // com bonificação se a chamada está esperando há muito tempo
+    float eff = smartstop_efficiency(cfg, est, delta >= 0 ? delta : -delta,
+                                     hall_call_wait(&calls[i], now));
+
+    if (eff > *best_efficiency) {
+        *best_efficiency = eff;
+        *best_floor = i;
+    }
+}
+
+SMARTSTOP_INLINE void score_floor_fixed(const BuildingConfig *cfg,
+                                        const HallCall calls[], const ElevatorState *e, int i,
+                                        uint32_t now, SmartStopRatio *best, int *best_floor) {
+    int delta = i - e->current_floor;
+
+    int est = calls[i].est_passengers;
+
+    if (est <= 0) return;
+
+    SmartStopRatio r = smartstop_efficiency_fixed(cfg, est, delta >= 0 ? delta : -delta,
+                                                  hall_call_wait(&calls[i], now));
+
+    // best começa em 0/1: a primeira chamada com passageiros sempre entra
+    if (smartstop_ratio_greater(r, *best)) {
+        *best = r;
+        *best_floor = i;
+    }
+}
+
+// Percorre as chamadas ativas à frente do carro e pontua cada uma com
+// score_floor (float) ou score_floor_fixed (inteiros)
+SMARTSTOP_INLINE int decide_kernel(int num_floors,
+                                   const BuildingConfig *cfg,
+                                   const HallCall calls[],
+                                   const FloorSet *active,
+                                   const ElevatorState *e,
+                                   uint32_t now,
+                                   bool fixed,
+                                   float *best_eff,
+                                   SmartStopRatio *best_ratio) {
     // Procura chamadas ativas na direção do movimento
     float best_efficiency = -1.0f;
+    SmartStopRatio best = { 0u, 1u };
     int best_floor = -1;
 
-    for (int i = 0; i < MAX_FLOORS; i++) {
-        if (!calls[i].active) continue;
+    // só considera andares "à frente" na direção atual: percorre apenas os
+    // bits ativos acima (subindo) ou abaixo (descendo) do andar atual
+    int lo = 0;
+    int hi = num_floors;
+    if (e->direction == 1) lo = e->current_floor + 1;   // subindo
+    if (e->direction == -1) hi = e->current_floor;      // descendo
+
+#define SCORE(i)                                                            \
+    do {                                                                    \
+        if (fixed) score_floor_fixed(cfg, calls, e, (i), now, &best, &best_floor); \
+        else score_floor(cfg, calls, e, (i), now, &best_efficiency, &best_floor); \
+    } while (0)
+
+    if (num_floors <= FLOORSET_WORD_BITS) {
+        // prédio cabe em uma palavra: máscara da faixa [lo, hi) e ctz
+        floorset_word_t all = ~(floorset_word_t)0;
+        floorset_word_t m = active->w[0];
+        m &= (lo >= FLOORSET_WORD_BITS) ? 0 : (all << lo);
+        m &= (hi >= FLOORSET_WORD_BITS) ? all : ((FLOORSET_ONE << hi) - 1);
+        while (m) {
+            int i = FLOORSET_CTZ(m);
+            m &= m - 1;
+            SCORE(i);
+        }
+    } else {
+        for (int i = floorset_next_up(active, lo);
+             i >= 0 && i < hi;
+             i = floorset_next_up(active, i + 1)) {
+            SCORE(i);
+        }
+    }
+#undef SCORE
 
-        int delta = i - e->current_floor;
+    if (fixed) *best_ratio = best;
+    else *best_eff = best_efficiency;
+    return best_floor;
+}
 
-        // só considera andares "à frente" na direção atual
-        if (e->direction == 1 && delta <= 0) continue;  // subindo
-        if (e->direction == -1 && delta >= 0) continue; // descendo
+// Caminho genérico: número de andares lido da configuração
+static void generate_generic(const BuildingConfig *cfg, SimRng *rng, HallCall calls[],
+                             FloorSet *active, const ElevatorState *e, TrafficMode mode,
+                             uint32_t now) {
+    generate_kernel(cfg->num_floors, rng, calls, active, e, mode, now);
+}
 
-        int est = calls[i].est_passengers;
+static int decide_generic(const BuildingConfig *cfg, const HallCall calls[],
+                          const FloorSet *active, const ElevatorState *e, uint32_t now,
+                          float *best_eff) {
+    return decide_kernel(cfg->num_floors, cfg, calls, active, e, now, false, best_eff, NULL);
+}
 
-        if (est <= 0) continue; // sem ganho não faz sentido
+static int decide_fixed_generic(const BuildingConfig *cfg, const HallCall calls[],
+                                const FloorSet *active, const ElevatorState *e, uint32_t now,
+                                SmartStopRatio *best) {
+    return decide_kernel(cfg->num_floors, cfg, calls, active, e, now, true, NULL, best);
+}
 
-        // custo simples: diferença de andares + custo fixo de parada
-        float cost = (float)(delta >= 0 ? delta : -delta) + 2.0f;
-        float eff = (float)est / cost;
+static const SmartStopKernels kernels_generic = {
+    0, generate_generic, decide_generic, decide_fixed_generic
+};
+
+// Gera generate_N/decide_N/decide_fixed_N com N constante e a tabela kernels_N
+#define SMARTSTOP_SPECIALIZE(N)                                                      \
+    static void generate_##N(const BuildingConfig *cfg, SimRng *rng,                 \
+                             HallCall calls[], FloorSet *active,                     \
+                             const ElevatorState *e, TrafficMode mode,               \
+                             uint32_t now) {                                         \
+        (void)cfg;                                                                   \
+        generate_kernel(N, rng, calls, active, e, mode, now);                        \
+    }                                                                                \
+    static int decide_##N(const BuildingConfig *cfg, const HallCall calls[],         \
+                          const FloorSet *active, const ElevatorState *e,            \
+                          uint32_t now, float *best_eff) {                           \
+        return decide_kernel(N, cfg, calls, active, e, now, false, best_eff, NULL);  \
+    }                                                                                \
+    static int decide_fixed_##N(const BuildingConfig *cfg, const HallCall calls[],   \
+                                const FloorSet *active, const ElevatorState *e,      \
+                                uint32_t now, SmartStopRatio *best) {                \
+        return decide_kernel(N, cfg, calls, active, e, now, true, NULL, best);       \
+    }                                                                                \
+    static const SmartStopKernels kernels_##N = {                                    \
+        N, generate_##N, decide_##N, decide_fixed_##N                                \
+    };
+
+#if MAX_FLOORS >= 16
+SMARTSTOP_SPECIALIZE(16)
+#endif
+#if MAX_FLOORS >= 32
+SMARTSTOP_SPECIALIZE(32)
+#endif
+#if MAX_FLOORS >= 64
+SMARTSTOP_SPECIALIZE(64)
+#endif
+
+bool building_config_apply(BuildingConfig *cfg) {
+    if (cfg->num_floors < 2 || cfg->num_floors > MAX_FLOORS) return false;
+    if (cfg->car_capacity < 1) return false;
+    if (cfg->travel_time_ms < 0 || cfg->door_time_ms < 0) return false;
+    if (!(cfg->stop_cost > 0.0f) || !(cfg->wait_bonus > 0.0f)) return false;
+    // limites que mantêm os produtos cruzados da pontuação inteira em 64 bits
+    if (cfg->stop_cost > 1000.0f || cfg->wait_bonus > 65.0f) return false;
+    if (!(fabsf(cfg->efficiency_threshold) <= 1000.0f)) return false;
+
+    cfg->threshold_milli = (int32_t)lroundf(cfg->efficiency_threshold * 1000.0f);
+    cfg->wait_bonus_milli = (uint32_t)lroundf(cfg->wait_bonus * 1000.0f);
+    cfg->stop_cost_milli = (uint32_t)lroundf(cfg->stop_cost * 1000.0f);
+
+    switch (cfg->num_floors) {
+#if MAX_FLOORS >= 16
+        case 16: cfg->kernels = &kernels_16; break;
+#endif
+#if MAX_FLOORS >= 32
+        case 32: cfg->kernels = &kernels_32; break;
+#endif
+#if MAX_FLOORS >= 64
+        case 64: cfg->kernels = &kernels_64; break;
+#endif
+        default: cfg->kernels = &kernels_generic; break;
+    }
+    return true;
+}
 
-        // bonificação se a chamada está esperando há muito tempo
-        if (calls[i].wait_time > 5) {
-            eff *= 1.2f;
-        }
+static const SmartStopKernels *kernels_for(const BuildingConfig *cfg) {
+    return cfg->kernels ? cfg->kernels : &kernels_generic;
+}
 
-        if (eff > best_efficiency) {
-            best_efficiency = eff;
-            best_floor = i;
-        }
+void generate_random_hall_calls(const BuildingConfig *cfg,
+                                SimRng *rng,
+                                HallCall calls[],
+                                FloorSet *active,
+                                ElevatorState *e,
+                                TrafficMode mode,
+                                uint32_t now) {
+    kernels_for(cfg)->generate(cfg, rng, calls, active, e, mode, now);
+}
+
+void traffic_draw_batch(const BuildingConfig *cfg, SimRng *rng, TrafficMode mode,
+                        TrafficBatch *b) {
+    floorset_clear(&b->arrivals);
+    // Mesma chance por andar de generate_random_hall_calls, com a distância
+    // até a próxima chegada sorteada de uma vez
+    for (int i = arrival_gap(rng); i < cfg->num_floors; i += 1 + arrival_gap(rng)) {
+        floorset_set(&b->arrivals, i);
+        b->passengers[i] = (uint8_t)estimate_passengers(rng, mode);
     }
+}
+
+uint64_t traffic_draw_free_floors(SimRng *rng, TrafficMode mode, uint64_t free,
+                                  uint8_t passengers[64]) {
+    uint64_t arrivals = 0;
+    // Mesma sequência de generate_kernel: um sorteio de distância por busca
+    // (inclusive a que não acha andar) e a estimativa de cada chegada
+    for (;;) {
+        int n = arrival_gap(rng);
+        uint64_t m = free;
+        while (m && n-- > 0) m &= m - 1;
+        if (!m) break;
+        int i = __builtin_ctzll(m);
+        arrivals |= 1ull << i;
+        passengers[i] = (uint8_t)estimate_passengers(rng, mode);
+        free &= ~(1ull << i) & (~0ull << i);
+    }
+    return arrivals;
+}
+
+void traffic_apply_batch(const BuildingConfig *cfg, const TrafficBatch *b,
+                         HallCall calls[], FloorSet *active, const ElevatorState *e,
+                         uint32_t now) {
+    (void)cfg;
+    const int cur = e->current_floor;
+
+    FLOORSET_FOREACH(&b->arrivals, i) {
+        if (i == cur || calls[i].active) continue;
+        calls[i].active = true;
+        calls[i].floor = i;
+        calls[i].est_passengers = b->passengers[i];
+        calls[i].arrival = now;
+        floorset_set(active, i);
+    }
+}
+
+int smartstop_best_floor_float(const BuildingConfig *cfg, const HallCall calls[],
+                               const FloorSet *active, const ElevatorState *e,
+                               uint32_t now, bool *accept) {
+    float best_efficiency;
+    int best_floor = kernels_for(cfg)->decide(cfg, calls, active, e, now, &best_efficiency);
+    *accept = best_floor != -1 && !(best_efficiency < cfg->efficiency_threshold);
+    return best_floor;
+}
+
+int smartstop_best_floor_fixed(const BuildingConfig *cfg, const HallCall calls[],
+                               const FloorSet *active, const ElevatorState *e,
+                               uint32_t now, bool *accept) {
+    SmartStopRatio best;
+    int best_floor = kernels_for(cfg)->decide_fixed(cfg, calls, active, e, now, &best);
+    *accept = best_floor != -1 && smartstop_ratio_accepts(cfg, best);
+    return best_floor;
+}
+
+int smartstop_decide_next_floor(const BuildingConfig *cfg,
+                                const HallCall calls[],
+                                const FloorSet *active,
+                                ElevatorState *e,
+                                uint32_t now,
+                                Stats *s) {
+    s->total_cycles++;
+
+    bool accept;
+#ifdef SMARTSTOP_FIXED_POINT
+    int best_floor = smartstop_best_floor_fixed(cfg, calls, active, e, now, &accept);
+#else
+    int best_floor = smartstop_best_floor_float(cfg, calls, active, e, now, &accept);
+#endif
 
     if (best_floor == -1) {
         // nenhuma chamada na direção atual
@@ -108,7 +429,7 @@ int smartstop_decide_next_floor(HallCall calls[],
     }
 
     // Se eficiência for baixa, o algoritmo prefere "passar direto"
-    if (best_efficiency < efficiency_threshold) {
+    if (!accept) {
         // Contabiliza que existe chamado, mas foi ignorado neste ciclo
         s->skipped_stops++;
         return -1;
@@ -117,7 +438,9 @@ int smartstop_decide_next_floor(HallCall calls[],
     return best_floor;
 }
 
-void smartstop_handle_stop(HallCall calls[],
+void smartstop_handle_stop(const BuildingConfig *cfg,
+                           HallCall calls[],
+                           FloorSet *active,
                            ElevatorState *e,
                            Stats *s,
                            int floor) {
@@ -129,7 +452,7 @@ void smartstop_handle_stop(HallCall calls[],
     int est = calls[floor].est_passengers;
     if (est < 0) est = 0;
 
-    int available_capacity = ELEVATOR_CAP - e->occupancy;
+    int available_capacity = cfg->car_capacity - e->occupancy;
     if (available_capacity < 0) available_capacity = 0;
 
     int boarded = est;
@@ -138,8 +461,8 @@ void smartstop_handle_stop(HallCall calls[],
     }
 
     e->occupancy += boarded;
-    if (e->occupancy > ELEVATOR_CAP) {
-        e->occupancy = ELEVATOR_CAP;
+    if (e->occupancy > cfg->car_capacity) {
+        e->occupancy = cfg->car_capacity;
     }
 
     s->total_boarded += boarded;
@@ -148,28 +471,28 @@ void smartstop_handle_stop(HallCall calls[],
     // Limpa chamada do andar
     calls[floor].active = false;
     calls[floor].est_passengers = 0;
-    calls[floor].wait_time = 0;
+    floorset_reset(active, floor);
 }
 
-void print_simulation_header(const ElevatorState *e) {
+void print_simulation_header(const BuildingConfig *cfg, const ElevatorState *e) {
     printf("=== Simulacao SmartStop (BitDogLab) ===\n");
     printf("Andar atual: %d | Direcao: %s | Ocupacao: %d/%d\n",
            e->current_floor,
            (e->direction == 1 ? "Subindo" : "Descendo"),
            e->occupancy,
-           ELEVATOR_CAP);
+           cfg->car_capacity);
 }
 
-void print_calls_info(const HallCall calls[]) {
+void print_calls_info(const BuildingConfig *cfg, const HallCall calls[], uint32_t now) {
     printf("Chamadas externas ativas:\n");
 
     bool any = false;
-    for (int i = 0; i < MAX_FLOORS; i++) {
+    for (int i = 0; i < cfg->num_floors; i++) {
         if (calls[i].active) {
             printf(" - Andar %2d | estimados: %d | espera: %d ciclos\n",
                    i,
                    calls[i].est_passengers,
-                   calls[i].wait_time);
+                   hall_call_wait(&calls[i], now));
             any = true;
         }
     }
@@ -180,16 +503,14 @@ void print_calls_info(const HallCall calls[]) {
 }
 
 void print_stats(const Stats *s) {
-    printf("\n--- Estatisticas aproximadas ---\n");
-    printf("Ciclos simulados:  %d\n", s->total_cycles);
-    printf("Paradas realizadas:%d\n", s->total_stops);
-    printf("Paradas ignoradas: %d\n", s->skipped_stops);
-    printf("Passageiros embarcados (simulados): %d\n", s->total_boarded);
+    DEFLOG_PRINT(LOG_STATS_HEADER);
+    DEFLOG_PRINT(LOG_STATS_CYCLES, (int32_t)s->total_cycles);
+    DEFLOG_PRINT(LOG_STATS_STOPS, s->total_stops);
+    DEFLOG_PRINT(LOG_STATS_SKIPPED, s->skipped_stops);
+    DEFLOG_PRINT(LOG_STATS_BOARDED, s->total_boarded);
 
     if (s->total_stops + s->skipped_stops > 0) {
-        float skip_rate = (float)s->skipped_stops /
-                          (float)(s->total_stops + s->skipped_stops) * 100.0f;
-        printf("Taxa de paradas evitadas: %.1f %%\n", skip_rate);
+        DEFLOG_PRINT(LOG_STATS_SKIP_RATE, deflog_f32(stats_skip_rate(s)));
     }
-    printf("--------------------------------\n\n");
+    DEFLOG_PRINT(LOG_STATS_FOOTER);
 }
@@ -2,17 +2,51 @@
 #define SMARTSTOP_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
-#define MAX_FLOORS   10
-#define ELEVATOR_CAP 8
+#include "callset.h"
+#include "sim_rng.h"
 
+// Capacidade máxima de andares dos vetores (o prédio simulado usa
+// BuildingConfig.num_floors, definido em tempo de execução)
+#ifndef MAX_FLOORS
+#define MAX_FLOORS   FLOORSET_CAPACITY
+#endif
+
+#if MAX_FLOORS > FLOORSET_CAPACITY
+#error "MAX_FLOORS excede a capacidade do registro de chamadas (FLOORSET_CAPACITY)"
+#endif
+
+// Valores padrão do prédio (BitDogLab)
+#define DEFAULT_NUM_FLOORS  10
+#define ELEVATOR_CAP        8          // Capacidade padrão do carro
+#define MAX_WAIT_TIME       25         // Tempo máximo de espera aceitável (ciclos)
+#define EMERGENCY_WAIT_TIME 15         // Tempo para prioridade emergencial
+#define CYCLES_FULL_MAX     8          // Ciclos máximos lotado sem desembarcar
+#define TRAVEL_TIME_MS      400        // Tempo realista entre andares (ms)
+#define DOOR_TIME_MS        800        // Tempo de abertura/fechamento de portas (ms)
+
+// Parâmetros padrão da pontuação SmartStop
+#define EFFICIENCY_THRESHOLD 0.65f     // eficiência mínima para parar
+#define WAIT_BONUS           1.2f      // bonificação para chamadas antigas
+#define WAIT_BONUS_AFTER     5         // ciclos de espera para ganhar a bonificação
+#define STOP_COST            2.0f      // custo fixo de uma parada (em andares)
+
+// A espera é guardada como instante de chegada no relógio de espera (um
+// tique por ciclo, mantido por quem chama): envelhecer as chamadas é
+// avançar o relógio, sem tocar em cada uma.
 typedef struct {
     bool active;
     int floor;
     int est_passengers;   // passageiros estimados esperando
-    int wait_time;        // "tempo de espera" simulado em ciclos
+    uint32_t arrival;     // chegada no relógio de espera (ciclos)
 } HallCall;
 
+// Espera da chamada em ciclos no instante now do relógio de espera
+static inline int hall_call_wait(const HallCall *c, uint32_t now) {
+    return (int)(now - c->arrival);
+}
+
 typedef enum {
     TRAFFIC_LOW = 0,
     TRAFFIC_MEDIUM,
@@ -28,37 +62,171 @@ typedef struct {
 typedef struct {
     int total_stops;
     int skipped_stops;
-    int total_cycles;
+    int64_t total_cycles;
     int total_boarded;
 } Stats;
 
-// Inicialização
-void smartstop_init(HallCall calls[], ElevatorState *e, Stats *s);
+typedef struct SmartStopKernels SmartStopKernels;
+
+// Geometria e limites do prédio, passados a todas as funções de despacho
+typedef struct {
+    int num_floors;            // andares do prédio (2..MAX_FLOORS)
+    int car_capacity;          // passageiros por carro
+    int travel_time_ms;        // tempo entre andares
+    int door_time_ms;          // abertura + fechamento de portas
+    int max_wait_time;         // espera máxima aceitável (ciclos)
+    int emergency_wait_time;   // espera que vira emergência (ciclos)
+    int cycles_full_max;       // ciclos lotado antes de forçar desembarque
+
+    // Pontuação SmartStop (ajustável por varredura de parâmetros)
+    float efficiency_threshold;
+    float wait_bonus;
+    float stop_cost;
+
+    // Os mesmos parâmetros em milésimos, para a pontuação em inteiros
+    // (preenchidos por building_config_apply)
+    int32_t threshold_milli;
+    uint32_t wait_bonus_milli;
+    uint32_t stop_cost_milli;
+
+    // Laços especializados para o número de andares (building_config_apply)
+    const SmartStopKernels *kernels;
+} BuildingConfig;
+
+// Preenche a configuração padrão (10 andares, 8 passageiros, tempos do firmware)
+void building_config_default(BuildingConfig *cfg);
+
+// Valida a configuração, converte a pontuação para milésimos e seleciona os
+// laços especializados em tempo de compilação para 16, 32 e 64 andares
+// (demais tamanhos usam o caminho genérico). Deve ser chamada após alterar
+// num_floors ou os parâmetros da pontuação. Retorna false se inválida.
+bool building_config_apply(BuildingConfig *cfg);
+
+// Pontuação SmartStop: passageiros por "custo" (andares + custo fixo de parada),
+// com bonificação para chamadas esperando há muito tempo
+static inline float smartstop_efficiency(const BuildingConfig *cfg,
+                                         int est_passengers, int distance, int wait_time) {
+    float cost = (float)distance + cfg->stop_cost;
+    float eff = (float)est_passengers / cost;
+    if (wait_time > WAIT_BONUS_AFTER) {
+        eff *= cfg->wait_bonus;
+    }
+    return eff;
+}
 
-// Geração de tráfego (cria chamadas externas aleatórias)
-void generate_random_hall_calls(HallCall calls[],
+// A mesma pontuação como fração exata, sem float nem divisão (Cortex-M0+ não
+// tem FPU nem divisor de hardware): num / den com bonificação e custo em
+// milésimos. Estimativa limitada a 65535 e parâmetros limitados em
+// building_config_apply, de modo que os produtos cruzados cabem em 64 bits.
+typedef struct {
+    uint32_t num;   // passageiros x bonificação (milésimos)
+    uint32_t den;   // andares + custo de parada (milésimos)
+} SmartStopRatio;
+
+static inline SmartStopRatio smartstop_efficiency_fixed(const BuildingConfig *cfg,
+                                                        int est_passengers, int distance,
+                                                        int wait_time) {
+    uint32_t est = est_passengers <= 0 ? 0u
+                 : est_passengers > 0xFFFF ? 0xFFFFu : (uint32_t)est_passengers;
+    SmartStopRatio r;
+    r.num = est * (wait_time > WAIT_BONUS_AFTER ? cfg->wait_bonus_milli : 1000u);
+    r.den = (uint32_t)distance * 1000u + cfg->stop_cost_milli;
+    return r;
+}
+
+// a > b por produto cruzado
+static inline bool smartstop_ratio_greater(SmartStopRatio a, SmartStopRatio b) {
+    return (uint64_t)a.num * b.den > (uint64_t)b.num * a.den;
+}
+
+// a >= limiar (em milésimos), como !(eff < efficiency_threshold) no float
+static inline bool smartstop_ratio_accepts(const BuildingConfig *cfg, SmartStopRatio a) {
+    return (int64_t)a.num * 1000 >= (int64_t)cfg->threshold_milli * (int64_t)a.den;
+}
+
+// Inicialização (zera também o conjunto de chamadas ativas).
+// A semente do gerador fica com o chamador (ver sim_rng_seed).
+void smartstop_init(const BuildingConfig *cfg,
+                    HallCall calls[], FloorSet *active, ElevatorState *e, Stats *s);
+
+// Geração de tráfego (cria chamadas externas aleatórias, com chegada now;
+// não envelhece as chamadas já ativas: isso é avançar o relógio de espera)
+void generate_random_hall_calls(const BuildingConfig *cfg,
+                                SimRng *rng,
+                                HallCall calls[],
+                                FloorSet *active,
                                 ElevatorState *e,
-                                TrafficMode mode);
+                                TrafficMode mode,
+                                uint32_t now);
+
+// Chegadas de um ciclo sorteadas sem olhar o estado do prédio, para que
+// outro núcleo/thread possa gerar o tráfego adiantado (ver traffic_queue.h).
+// Aplicar o lote tem a mesma distribuição que generate_random_hall_calls:
+// 10% por andar livre, estimativa de passageiros conforme o modo.
+typedef struct {
+    FloorSet arrivals;                 // andares com nova chamada
+    uint8_t passengers[MAX_FLOORS];    // estimativa por andar (só os de arrivals)
+} TrafficBatch;
+
+// Sorteia as chegadas de um ciclo (não toca em calls)
+void traffic_draw_batch(const BuildingConfig *cfg, SimRng *rng, TrafficMode mode,
+                        TrafficBatch *b);
+
+// Ativa as chegadas em andares livres (exceto o andar atual) com chegada
+// now, como generate_random_hall_calls
+void traffic_apply_batch(const BuildingConfig *cfg, const TrafficBatch *b,
+                         HallCall calls[], FloorSet *active, const ElevatorState *e,
+                         uint32_t now);
+
+// As chegadas de um ciclo num prédio de até 64 andares, com os mesmos
+// sorteios de generate_random_hall_calls: free tem um bit por andar livre
+// (sem chamada, fora o andar do carro). Retorna os andares sorteados e
+// escreve a estimativa de cada um em passengers[andar]. Para quem guarda as
+// chamadas em outro formato (ver lockstep.h).
+uint64_t traffic_draw_free_floors(SimRng *rng, TrafficMode mode, uint64_t free,
+                                  uint8_t passengers[64]);
 
 // Função que estima passageiros em cada chamada (0..N)
-int estimate_passengers(TrafficMode mode);
+int estimate_passengers(SimRng *rng, TrafficMode mode);
 
-// Decide a próxima parada / ou se segue sem parar
+// Chamada de melhor pontuação à frente do carro e, em *accept, se ela atinge
+// cfg->efficiency_threshold (esperas pelo relógio now). Retorna -1 se não houver chamada com passageiros
+// na direção atual. As duas versões tomam a mesma decisão salvo em empates
+// exatos que o arredondamento do float desfaz (ver smartstop_fixcheck).
+int smartstop_best_floor_float(const BuildingConfig *cfg, const HallCall calls[],
+                               const FloorSet *active, const ElevatorState *e,
+                               uint32_t now, bool *accept);
+int smartstop_best_floor_fixed(const BuildingConfig *cfg, const HallCall calls[],
+                               const FloorSet *active, const ElevatorState *e,
+                               uint32_t now, bool *accept);
+
+// Decide a próxima parada / ou se segue sem parar, com a pontuação em float
+// ou, com SMARTSTOP_FIXED_POINT, em inteiros.
 // Retorna -1 se não houver parada a fazer neste ciclo
-int smartstop_decide_next_floor(HallCall calls[],
+int smartstop_decide_next_floor(const BuildingConfig *cfg,
+                                const HallCall calls[],
+                                const FloorSet *active,
                                 ElevatorState *e,
-                                Stats *s,
-                                float efficiency_threshold);
+                                uint32_t now,
+                                Stats *s);
 
 // Atualiza ocupação e limpa chamada do andar atendido
-void smartstop_handle_stop(HallCall calls[],
+void smartstop_handle_stop(const BuildingConfig *cfg,
+                           HallCall calls[],
+                           FloorSet *active,
                            ElevatorState *e,
                            Stats *s,
                            int floor);
 
 // Funções de log para o Monitor Serial
-void print_simulation_header(const ElevatorState *e);
-void print_calls_info(const HallCall calls[]);
+void print_simulation_header(const BuildingConfig *cfg, const ElevatorState *e);
+void print_calls_info(const BuildingConfig *cfg, const HallCall calls[], uint32_t now);
+
+// Percentual de paradas evitadas (chamar só se houve parada ou salto)
+static inline float stats_skip_rate(const Stats *s) {
+    return (float)s->skipped_stops / (float)(s->total_stops + s->skipped_stops) * 100.0f;
+}
+
 void print_stats(const Stats *s);
 
 #endif
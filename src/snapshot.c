@@ -0,0 +1,584 @@
+/*
+ * Fotografia de uma simulação: salvar, restaurar e bifurcar (ver snapshot.h)
+ */
+
+#include "snapshot.h"
+
+#include <string.h>
+
+_Static_assert(sizeof(SimSnapshotHeader) == SIM_SNAPSHOT_HEADER_BYTES,
+               "SimSnapshotHeader deve ter 32 bytes");
+
+// ---- Em memória ----
+
+bool sim_snapshot_take(const SimContext *ctx, SimSnapshot *s) {
+    const TrafficProfile *profile = NULL;
+    if (ctx->traffic) return false;
+    if (ctx->source) {
+        profile = traffic_source_profile(ctx->source);
+        if (!profile) return false;
+    }
+
+    const int n = ctx->cfg.num_floors;
+    s->cfg = ctx->cfg;
+    memcpy(s->calls, ctx->calls, (size_t)n * sizeof(s->calls[0]));
+    s->elevator = ctx->elevator;
+    s->stats = ctx->stats;
+    s->reg = ctx->reg;
+    s->wait_clock = ctx->wait_clock;
+    s->order = ctx->order;
+    s->fresh_calls = ctx->fresh_calls;
+    s->cycles_at_full_capacity = ctx->cycles_at_full_capacity;
+    s->total_cycles = ctx->total_cycles;
+    s->mode = ctx->mode;
+    s->rng = ctx->rng;
+    s->clock_us = sim_clock_now_us(ctx->clock);
+
+    s->button_register = ctx->button_register;
+    s->button_service = ctx->button_service;
+    memcpy(s->button_press_us, ctx->button_press_us, (size_t)n * sizeof(s->button_press_us[0]));
+
+    s->has_profile = profile != NULL;
+    if (profile) {
+        s->profile = *profile;
+        s->source_next = ctx->source_next;
+        s->source_pending = ctx->source_pending;
+        s->source_start_us = ctx->source_start_us;
+    }
+
+    s->has_pax = ctx->pax != NULL;
+    if (ctx->pax) {
+        s->pax = *ctx->pax;
+    }
+    return true;
+}
+
+bool sim_snapshot_restore(SimContext *ctx, const SimSnapshot *s) {
+    TrafficProfile *profile = ctx->source ? traffic_source_profile(ctx->source) : NULL;
+    if (ctx->traffic) return false;
+    if (s->has_pax != (ctx->pax != NULL)) return false;
+    if (s->has_profile != (profile != NULL) || (ctx->source && !profile)) return false;
+
+    const int n = s->cfg.num_floors;
+    ctx->cfg = s->cfg;
+    memcpy(ctx->calls, s->calls, (size_t)n * sizeof(ctx->calls[0]));
+    for (int f = n; f < MAX_FLOORS; f++) {
+        ctx->calls[f].active = false;
+        ctx->calls[f].floor = f;
+        ctx->calls[f].est_passengers = 0;
+        ctx->calls[f].arrival = 0;
+    }
+    ctx->elevator = s->elevator;
+    ctx->stats = s->stats;
+    ctx->reg = s->reg;
+    ctx->wait_clock = s->wait_clock;
+    ctx->order = s->order;
+    ctx->fresh_calls = s->fresh_calls;
+    ctx->cycles_at_full_capacity = s->cycles_at_full_capacity;
+    ctx->total_cycles = s->total_cycles;
+    ctx->mode = s->mode;
+    ctx->rng = s->rng;
+    ctx->clock->virtual_us = s->clock_us;
+
+    ctx->button_register = s->button_register;
+    ctx->button_service = s->button_service;
+    memcpy(ctx->button_press_us, s->button_press_us, (size_t)n * sizeof(ctx->button_press_us[0]));
+    for (int f = n; f < MAX_FLOORS; f++) {
+        ctx->button_press_us[f] = 0;
+    }
+
+    if (profile) {
+        *profile = s->profile;
+        ctx->source_next = s->source_next;
+        ctx->source_pending = s->source_pending;
+        ctx->source_start_us = s->source_start_us;
+    }
+    if (ctx->pax) {
+        *ctx->pax = s->pax;
+    }
+    return true;
+}
+
+void sim_branch_init(SimBranch *b, const SimSnapshot *s) {
+    sim_clock_init(&b->clock, SIM_CLOCK_FAST, 1.0f);
+    sim_init(&b->sim, &s->cfg, &b->clock, s->mode, 0, false);
+    if (s->has_pax) {
+        sim_attach_passengers(&b->sim, &b->pax);
+    }
+    if (s->has_profile) {
+        // A fonte aponta para b->profile; o estado vem da fotografia
+        traffic_profile_init(&b->profile, &b->source, s->profile.kind, s->profile.num_floors,
+                             s->profile.arrivals_per_hour, &s->profile.rng);
+        b->sim.source = &b->source;
+    }
+    sim_snapshot_restore(&b->sim, s);
+}
+
+bool sim_branch_configure(SimBranch *b, const BuildingConfig *cfg) {
+    SimContext *ctx = &b->sim;
+    BuildingConfig next = *cfg;
+    if (!building_config_apply(&next) || next.num_floors != ctx->cfg.num_floors) return false;
+
+    ctx->cfg = next;
+    if (ctx->order.emergency_wait != next.emergency_wait_time) {
+        // Mesmos andares e chegadas da lista atual, prefixo recontado
+        HallCall stamped[MAX_FLOORS];
+        CallOrder *o = &ctx->order;
+        FloorSet tracked = o->tracked;
+        FLOORSET_FOREACH(&tracked, f) {
+            stamped[f].arrival = o->arrival[f];
+        }
+        call_order_init(o, next.emergency_wait_time, o->now);
+        call_order_sync(o, stamped, &tracked);
+    }
+    return true;
+}
+
+// ---- Codificação ----
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t pos;
+} SnapWriter;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    bool bad;
+} SnapReader;
+
+static void put(SnapWriter *w, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++, w->pos++) {
+        if (w->pos < w->cap) w->buf[w->pos] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint64_t get(SnapReader *r, int bytes) {
+    if (r->bad || r->len - r->pos < (size_t)bytes) {
+        r->bad = true;
+        return 0;
+    }
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) {
+        v |= (uint64_t)r->buf[r->pos++] << (8 * i);
+    }
+    return v;
+}
+
+#define PUT8(w, v)  put((w), (uint64_t)(uint8_t)(v), 1)
+#define PUT16(w, v) put((w), (uint64_t)(uint16_t)(v), 2)
+#define PUT32(w, v) put((w), (uint64_t)(uint32_t)(v), 4)
+#define PUT64(w, v) put((w), (uint64_t)(v), 8)
+#define GET8(r)     ((uint8_t)get((r), 1))
+#define GET16(r)    ((uint16_t)get((r), 2))
+#define GET32(r)    ((uint32_t)get((r), 4))
+#define GET64(r)    get((r), 8)
+
+static void put_f32(SnapWriter *w, float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    PUT32(w, bits);
+}
+
+static float get_f32(SnapReader *r) {
+    uint32_t bits = GET32(r);
+    float x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+// Conjunto de andares em num_floors bits
+static void put_floorset(SnapWriter *w, const FloorSet *set, int n) {
+    for (int base = 0; base < n; base += 8) {
+        uint8_t byte = 0;
+        for (int b = 0; b < 8 && base + b < n; b++) {
+            if (floorset_test(set, base + b)) byte |= (uint8_t)(1u << b);
+        }
+        PUT8(w, byte);
+    }
+}
+
+static void get_floorset(SnapReader *r, FloorSet *set, int n) {
+    floorset_clear(set);
+    for (int base = 0; base < n; base += 8) {
+        uint8_t byte = GET8(r);
+        for (int b = 0; b < 8 && base + b < n; b++) {
+            if (byte & (1u << b)) floorset_set(set, base + b);
+        }
+    }
+}
+
+static void put_rng(SnapWriter *w, const SimRng *rng) {
+    for (int k = 0; k < 4; k++) PUT32(w, rng->s[k]);
+}
+
+static void get_rng(SnapReader *r, SimRng *rng) {
+    for (int k = 0; k < 4; k++) rng->s[k] = GET32(r);
+}
+
+static void put_latency(SnapWriter *w, const LatencyStat *l) {
+    PUT32(w, l->count);
+    PUT32(w, l->max_us);
+    PUT64(w, l->sum_us);
+}
+
+static void get_latency(SnapReader *r, LatencyStat *l) {
+    l->count = GET32(r);
+    l->max_us = GET32(r);
+    l->sum_us = GET64(r);
+}
+
+static void put_hist(SnapWriter *w, const DurationHist *h) {
+    for (int b = 0; b < DURATION_HIST_BINS; b++) PUT32(w, h->bins[b]);
+    PUT32(w, h->count);
+    PUT32(w, h->max_ms);
+    PUT64(w, h->sum_ms);
+}
+
+static void get_hist(SnapReader *r, DurationHist *h) {
+    for (int b = 0; b < DURATION_HIST_BINS; b++) h->bins[b] = GET32(r);
+    h->count = GET32(r);
+    h->max_ms = GET32(r);
+    h->sum_ms = GET64(r);
+}
+
+// Ordem de chegada como a lista da cabeça à cauda; ligações e conjunto são
+// refeitos na leitura
+static void put_order(SnapWriter *w, const CallOrder *o) {
+    PUT32(w, o->emergency_wait);
+    PUT32(w, o->now);
+    PUT32(w, o->emergencies);
+    PUT16(w, o->boundary);
+    PUT16(w, floorset_count(&o->tracked));
+    for (uint16_t f = o->head; f != CALL_ORDER_NONE; f = o->next[f]) {
+        PUT16(w, f);
+        PUT32(w, o->arrival[f]);
+    }
+}
+
+static void get_order(SnapReader *r, CallOrder *o, int n) {
+    int emergency_wait = (int32_t)GET32(r);
+    uint32_t now = GET32(r);
+    call_order_init(o, emergency_wait, now);
+    o->emergencies = (int32_t)GET32(r);
+    o->boundary = GET16(r);
+    if (o->boundary != CALL_ORDER_NONE && o->boundary >= n) r->bad = true;
+
+    int count = GET16(r);
+    uint16_t prev = CALL_ORDER_NONE;
+    for (int k = 0; k < count && !r->bad; k++) {
+        uint16_t f = GET16(r);
+        if (f >= n || floorset_test(&o->tracked, f)) {
+            r->bad = true;
+            break;
+        }
+        o->arrival[f] = GET32(r);
+        o->prev[f] = prev;
+        o->next[f] = CALL_ORDER_NONE;
+        if (prev == CALL_ORDER_NONE) o->head = f;
+        else o->next[prev] = f;
+        floorset_set(&o->tracked, f);
+        prev = f;
+    }
+    o->tail = prev;
+    if (o->boundary != CALL_ORDER_NONE && !floorset_test(&o->tracked, o->boundary)) r->bad = true;
+}
+
+static void put_profile(SnapWriter *w, const SimSnapshot *s) {
+    const TrafficProfile *p = &s->profile;
+    PUT8(w, p->kind);
+    PUT16(w, p->num_floors);
+    PUT32(w, p->arrivals_per_hour);
+    PUT8(w, p->lobby_share_pct);
+    put_rng(w, &p->rng);
+    PUT64(w, p->now_us);
+    PUT8(w, p->num_segments);
+    for (int k = 0; k < p->num_segments; k++) {
+        PUT32(w, p->segments[k].start_s);
+        PUT8(w, p->segments[k].kind);
+        PUT16(w, p->segments[k].rate_pct);
+    }
+    PUT64(w, s->source_next.time_us);
+    PUT16(w, s->source_next.origin);
+    PUT16(w, s->source_next.dest);
+    PUT16(w, s->source_next.group);
+    PUT8(w, s->source_pending);
+    PUT64(w, s->source_start_us);
+}
+
+static void get_profile(SnapReader *r, SimSnapshot *s) {
+    TrafficProfile *p = &s->profile;
+    p->kind = (TrafficProfileKind)GET8(r);
+    p->num_floors = GET16(r);
+    p->arrivals_per_hour = GET32(r);
+    p->lobby_share_pct = GET8(r);
+    get_rng(r, &p->rng);
+    p->now_us = GET64(r);
+    p->num_segments = GET8(r);
+    if (p->kind >= PROFILE_COUNT || p->num_floors != s->cfg.num_floors ||
+        p->num_segments < 1 || p->num_segments > PROFILE_MAX_SEGMENTS) {
+        r->bad = true;
+        return;
+    }
+    for (int k = 0; k < p->num_segments; k++) {
+        p->segments[k].start_s = GET32(r);
+        p->segments[k].kind = GET8(r);
+        p->segments[k].rate_pct = GET16(r);
+    }
+    s->source_next.time_us = GET64(r);
+    s->source_next.origin = GET16(r);
+    s->source_next.dest = GET16(r);
+    s->source_next.group = GET16(r);
+    s->source_pending = GET8(r) != 0;
+    s->source_start_us = GET64(r);
+    if (s->source_next.origin >= p->num_floors) r->bad = true;
+}
+
+static void put_pax(SnapWriter *w, const PassengerModel *m, int n) {
+    const PassengerPool *p = &m->pool;
+    for (int i = 0; i < PASSENGER_POOL_SIZE; i++) {
+        const Passenger *x = &p->slots[i];
+        PUT64(w, x->arrive_us);
+        PUT64(w, x->board_us);
+        PUT64(w, x->alight_us);
+        PUT16(w, x->next);
+        PUT8(w, x->origin);
+        PUT8(w, x->dest);
+    }
+    PUT16(w, p->free_head);
+    PUT16(w, p->in_use);
+    PUT16(w, p->high_water);
+    PUT32(w, p->exhausted);
+    for (int f = 0; f < n; f++) {
+        PUT16(w, m->waiting[f].head);
+        PUT16(w, m->waiting[f].tail);
+        PUT16(w, m->waiting[f].count);
+    }
+    PUT16(w, m->onboard);
+    PUT16(w, m->onboard_count);
+    put_hist(w, &m->wait);
+    put_hist(w, &m->journey);
+    PUT64(w, m->spawned);
+    PUT64(w, m->delivered);
+}
+
+// Índice no pool ou PASSENGER_NONE
+static uint16_t get_slot(SnapReader *r) {
+    uint16_t i = GET16(r);
+    if (i != PASSENGER_NONE && i >= PASSENGER_POOL_SIZE) r->bad = true;
+    return i;
+}
+
+static void get_pax(SnapReader *r, PassengerModel *m, int n) {
+    passenger_model_init(m);
+    PassengerPool *p = &m->pool;
+    for (int i = 0; i < PASSENGER_POOL_SIZE; i++) {
+        Passenger *x = &p->slots[i];
+        x->arrive_us = GET64(r);
+        x->board_us = GET64(r);
+        x->alight_us = GET64(r);
+        x->next = get_slot(r);
+        x->origin = GET8(r);
+        x->dest = GET8(r);
+    }
+    p->free_head = get_slot(r);
+    p->in_use = GET16(r);
+    p->high_water = GET16(r);
+    p->exhausted = GET32(r);
+    for (int f = 0; f < n; f++) {
+        m->waiting[f].head = get_slot(r);
+        m->waiting[f].tail = get_slot(r);
+        m->waiting[f].count = GET16(r);
+    }
+    m->onboard = get_slot(r);
+    m->onboard_count = GET16(r);
+    get_hist(r, &m->wait);
+    get_hist(r, &m->journey);
+    m->spawned = GET64(r);
+    m->delivered = GET64(r);
+}
+
+static void put_payload(SnapWriter *w, const SimSnapshot *s) {
+    const BuildingConfig *cfg = &s->cfg;
+    const int n = cfg->num_floors;
+
+    PUT32(w, cfg->num_floors);
+    PUT32(w, cfg->car_capacity);
+    PUT32(w, cfg->travel_time_ms);
+    PUT32(w, cfg->door_time_ms);
+    PUT32(w, cfg->max_wait_time);
+    PUT32(w, cfg->emergency_wait_time);
+    PUT32(w, cfg->cycles_full_max);
+    put_f32(w, cfg->efficiency_threshold);
+    put_f32(w, cfg->wait_bonus);
+    put_f32(w, cfg->stop_cost);
+
+    for (int f = 0; f < n; f++) {
+        PUT8(w, s->calls[f].active);
+        PUT32(w, s->calls[f].est_passengers);
+        PUT32(w, s->calls[f].arrival);
+    }
+    PUT32(w, s->elevator.current_floor);
+    PUT32(w, s->elevator.direction);
+    PUT32(w, s->elevator.occupancy);
+    PUT32(w, s->stats.total_stops);
+    PUT32(w, s->stats.skipped_stops);
+    PUT64(w, s->stats.total_cycles);
+    PUT32(w, s->stats.total_boarded);
+
+    put_floorset(w, &s->reg.active, n);
+    put_floorset(w, &s->reg.internal, n);
+    put_floorset(w, &s->reg.button, n);
+    put_floorset(w, &s->fresh_calls, n);
+    PUT32(w, s->wait_clock);
+    put_order(w, &s->order);
+
+    PUT32(w, s->cycles_at_full_capacity);
+    PUT64(w, s->total_cycles);
+    PUT8(w, s->mode);
+    put_rng(w, &s->rng);
+
+    put_latency(w, &s->button_register);
+    put_latency(w, &s->button_service);
+    for (int f = 0; f < n; f++) PUT64(w, s->button_press_us[f]);
+
+    if (s->has_profile) put_profile(w, s);
+    if (s->has_pax) put_pax(w, &s->pax, n);
+}
+
+static uint32_t fnv1a(const uint8_t *p, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+size_t sim_snapshot_encode(const SimSnapshot *s, uint8_t *buf, size_t cap) {
+    SnapWriter w = { buf, cap, SIM_SNAPSHOT_HEADER_BYTES };
+    put_payload(&w, s);
+    size_t total = w.pos;
+    if (total > cap) return total;
+
+    size_t payload = total - SIM_SNAPSHOT_HEADER_BYTES;
+    w.pos = 0;
+    PUT32(&w, SIM_SNAPSHOT_MAGIC);
+    PUT16(&w, SIM_SNAPSHOT_VERSION);
+    PUT16(&w, SIM_SNAPSHOT_HEADER_BYTES);
+    PUT32(&w, payload);
+    PUT32(&w, (s->has_pax ? SIM_SNAPSHOT_PAX : 0u) | (s->has_profile ? SIM_SNAPSHOT_PROFILE : 0u));
+    PUT16(&w, s->cfg.num_floors);
+    PUT16(&w, s->has_pax ? PASSENGER_POOL_SIZE : 0);
+    PUT32(&w, fnv1a(buf + SIM_SNAPSHOT_HEADER_BYTES, payload));
+    PUT64(&w, s->clock_us);
+    return total;
+}
+
+bool sim_snapshot_decode(SimSnapshot *s, const uint8_t *buf, size_t len, const char **error) {
+    const char *unused;
+    if (!error) error = &unused;
+
+    SnapReader r = { buf, len, 0, false };
+    SimSnapshotHeader h;
+    h.magic = GET32(&r);
+    h.version = GET16(&r);
+    h.header_size = GET16(&r);
+    h.payload_bytes = GET32(&r);
+    h.flags = GET32(&r);
+    h.num_floors = GET16(&r);
+    h.pool_size = GET16(&r);
+    h.checksum = GET32(&r);
+    h.clock_us = GET64(&r);
+
+    if (r.bad || h.magic != SIM_SNAPSHOT_MAGIC) {
+        *error = "não é uma fotografia do SmartStop";
+        return false;
+    }
+    if (h.version != SIM_SNAPSHOT_VERSION || h.header_size != SIM_SNAPSHOT_HEADER_BYTES) {
+        *error = "versão da fotografia não suportada";
+        return false;
+    }
+    if (len - SIM_SNAPSHOT_HEADER_BYTES < h.payload_bytes) {
+        *error = "fotografia truncada";
+        return false;
+    }
+    if (fnv1a(buf + SIM_SNAPSHOT_HEADER_BYTES, h.payload_bytes) != h.checksum) {
+        *error = "soma de verificação não confere";
+        return false;
+    }
+    if (h.num_floors < 2 || h.num_floors > MAX_FLOORS) {
+        *error = "número de andares fora da faixa";
+        return false;
+    }
+    if ((h.flags & SIM_SNAPSHOT_PAX) && h.pool_size != PASSENGER_POOL_SIZE) {
+        *error = "pool de passageiros de outro tamanho (PASSENGER_POOL_SIZE)";
+        return false;
+    }
+    r.len = SIM_SNAPSHOT_HEADER_BYTES + h.payload_bytes;
+
+    BuildingConfig *cfg = &s->cfg;
+    building_config_default(cfg);
+    cfg->num_floors = (int32_t)GET32(&r);
+    cfg->car_capacity = (int32_t)GET32(&r);
+    cfg->travel_time_ms = (int32_t)GET32(&r);
+    cfg->door_time_ms = (int32_t)GET32(&r);
+    cfg->max_wait_time = (int32_t)GET32(&r);
+    cfg->emergency_wait_time = (int32_t)GET32(&r);
+    cfg->cycles_full_max = (int32_t)GET32(&r);
+    cfg->efficiency_threshold = get_f32(&r);
+    cfg->wait_bonus = get_f32(&r);
+    cfg->stop_cost = get_f32(&r);
+    if (r.bad || cfg->num_floors != h.num_floors || !building_config_apply(cfg)) {
+        *error = "configuração do prédio inválida";
+        return false;
+    }
+    const int n = cfg->num_floors;
+
+    for (int f = 0; f < MAX_FLOORS; f++) {
+        s->calls[f].active = f < n ? GET8(&r) != 0 : false;
+        s->calls[f].floor = f;
+        s->calls[f].est_passengers = f < n ? (int32_t)GET32(&r) : 0;
+        s->calls[f].arrival = f < n ? GET32(&r) : 0;
+    }
+    s->elevator.current_floor = (int32_t)GET32(&r);
+    s->elevator.direction = (int32_t)GET32(&r);
+    s->elevator.occupancy = (int32_t)GET32(&r);
+    s->stats.total_stops = (int32_t)GET32(&r);
+    s->stats.skipped_stops = (int32_t)GET32(&r);
+    s->stats.total_cycles = (int64_t)GET64(&r);
+    s->stats.total_boarded = (int32_t)GET32(&r);
+    if (s->elevator.current_floor < 0 || s->elevator.current_floor >= n) r.bad = true;
+
+    get_floorset(&r, &s->reg.active, n);
+    get_floorset(&r, &s->reg.internal, n);
+    get_floorset(&r, &s->reg.button, n);
+    get_floorset(&r, &s->fresh_calls, n);
+    s->wait_clock = GET32(&r);
+    get_order(&r, &s->order, n);
+
+    s->cycles_at_full_capacity = (int32_t)GET32(&r);
+    s->total_cycles = (int64_t)GET64(&r);
+    s->mode = (TrafficMode)GET8(&r);
+    if (s->mode > TRAFFIC_HIGH) r.bad = true;
+    get_rng(&r, &s->rng);
+    s->clock_us = h.clock_us;
+
+    get_latency(&r, &s->button_register);
+    get_latency(&r, &s->button_service);
+    for (int f = 0; f < MAX_FLOORS; f++) {
+        s->button_press_us[f] = f < n ? GET64(&r) : 0;
+    }
+
+    s->has_profile = (h.flags & SIM_SNAPSHOT_PROFILE) != 0;
+    if (s->has_profile) get_profile(&r, s);
+    s->has_pax = (h.flags & SIM_SNAPSHOT_PAX) != 0;
+    if (s->has_pax) get_pax(&r, &s->pax, n);
+
+    if (r.bad || r.pos != r.len) {
+        *error = "conteúdo da fotografia inconsistente";
+        return false;
+    }
+    return true;
+}
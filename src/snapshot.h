@@ -0,0 +1,137 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dispatch.h"
+
+// Fotografia de uma simulação: salvar, restaurar e bifurcar.
+//
+// SimSnapshot guarda por valor tudo o que define a continuação de um
+// SimContext: prédio, chamadas, carro, estatísticas, registro de chamadas,
+// relógio de espera e ordem de chegada, gerador, relógio simulado,
+// latências dos botões e, quando anexados, o modelo de passageiros e o
+// perfil de tráfego (com a próxima chegada já lida). Tirar e restaurar são
+// cópias de memória, sem alocação: microssegundos.
+//
+// Uma fotografia restaurada continua exatamente como a simulação original
+// continuaria (mesmo gerador). Bifurcar é restaurar a mesma fotografia em
+// vários SimBranch e mudar alguma coisa em cada um (o limiar, por exemplo)
+// antes de seguir. Sem mudança, os ramos repetem a original passo a passo.
+//
+// O que não entra: as ligações externas do contexto (log, traço, tabela,
+// botões, busca com antecipação, política, medição por estágio), que ficam
+// com quem restaura, e o estado que não dá para copiar: a fila de tráfego de
+// outro núcleo (--split) e traços de chegadas lidos de arquivo. Com eles
+// sim_snapshot_take falha.
+//
+// A fotografia cobre só o laço de ciclos (sim_step). Os outros motores
+// guardam estado fora do SimContext: a fila de eventos, a fase e os
+// instantes das chamadas de EventSim, e a fase, os prazos e o LED de
+// SimMotion. Fotografar um contexto dirigido por event_sim ou motion perde
+// esse estado, e a continuação restaurada não repete a original.
+//
+// Para guardar em arquivo ou mandar pela serial há uma codificação explícita
+// (little-endian, campo a campo, só os num_floors andares usados),
+// independente do tamanho de palavra e do alinhamento da plataforma:
+//
+//   SimSnapshotHeader (32 bytes), carga com soma FNV-1a no cabeçalho
+//
+// O cabeçalho traz a versão. A leitura recusa outra versão, soma errada,
+// andares fora da faixa e um pool de passageiros de outro tamanho.
+
+#define SIM_SNAPSHOT_MAGIC   0x4E535353u   // "SSSN"
+#define SIM_SNAPSHOT_VERSION 2
+
+#define SIM_SNAPSHOT_PAX     0x1u          // flags: modelo de passageiros
+#define SIM_SNAPSHOT_PROFILE 0x2u          // flags: perfil de tráfego
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;       // 32
+    uint32_t payload_bytes;
+    uint32_t flags;             // SIM_SNAPSHOT_*
+    uint16_t num_floors;
+    uint16_t pool_size;         // PASSENGER_POOL_SIZE (0 sem passageiros)
+    uint32_t checksum;          // FNV-1a da carga
+    uint64_t clock_us;          // tempo simulado da fotografia
+} SimSnapshotHeader;
+
+#define SIM_SNAPSHOT_HEADER_BYTES 32
+
+typedef struct {
+    BuildingConfig cfg;
+    HallCall calls[MAX_FLOORS];         // só os num_floors primeiros valem
+    ElevatorState elevator;
+    Stats stats;
+    CallRegistry reg;
+    uint32_t wait_clock;
+    CallOrder order;
+    FloorSet fresh_calls;
+    int cycles_at_full_capacity;
+    int64_t total_cycles;
+    TrafficMode mode;
+    SimRng rng;
+    uint64_t clock_us;
+
+    LatencyStat button_register;
+    LatencyStat button_service;
+    uint64_t button_press_us[MAX_FLOORS];
+
+    // Perfil de tráfego anexado (has_profile) e a próxima chegada dele
+    bool has_profile;
+    TrafficProfile profile;
+    TrafficArrival source_next;
+    bool source_pending;
+    uint64_t source_start_us;
+
+    bool has_pax;
+    PassengerModel pax;
+} SimSnapshot;
+
+// Continuação independente de uma fotografia, com relógio, passageiros e
+// fonte de tráfego próprios
+typedef struct {
+    SimContext sim;
+    SimClock clock;
+    PassengerModel pax;
+    TrafficProfile profile;
+    TrafficSource source;
+} SimBranch;
+
+// Fotografa ctx (só o laço de ciclos, ver acima). Retorna false se ele usa
+// a fila de tráfego de outro núcleo ou uma fonte de chegadas que não é um
+// perfil.
+bool sim_snapshot_take(const SimContext *ctx, SimSnapshot *s);
+
+// Volta ctx ao estado de s, relógio simulado incluído. ctx precisa ter os
+// mesmos anexos de estado da fotografia (passageiros, perfil); as ligações
+// externas continuam as dele. Retorna false se os anexos não batem.
+bool sim_snapshot_restore(SimContext *ctx, const SimSnapshot *s);
+
+// Abre um ramo a partir de s: contexto novo com relógio virtual (SIM_CLOCK_FAST),
+// sem log e com os anexos da fotografia. Quem chama pode trocar a
+// configuração (sim_branch_configure) ou ligar política, traço etc. antes de
+// continuar com sim_step.
+void sim_branch_init(SimBranch *b, const SimSnapshot *s);
+
+// Troca os parâmetros do despacho do ramo (limiar, bonificação, custo de
+// parada, espera de emergência...) no meio da simulação. A ordem de chegada
+// é refeita para a nova espera de emergência. Retorna false se cfg for
+// inválida ou tiver outro número de andares.
+bool sim_branch_configure(SimBranch *b, const BuildingConfig *cfg);
+
+// Codifica s em buf (até cap bytes). Retorna o tamanho da codificação;
+// maior que cap quer dizer que buf não coube e nada útil foi escrito (buf
+// pode ser NULL para só medir).
+size_t sim_snapshot_encode(const SimSnapshot *s, uint8_t *buf, size_t cap);
+
+// Lê uma codificação de sim_snapshot_encode. Retorna false (com o motivo
+// em *error, se não for NULL) se estiver truncada, corrompida ou for de
+// outra versão.
+bool sim_snapshot_decode(SimSnapshot *s, const uint8_t *buf, size_t len, const char **error);
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * Tempo por estágio do laço de controle e histogramas logarítmicos
+ */
+
+#include "stageprof.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *const stage_names[PROF_STAGE_COUNT] = {
+    "outros", "botões", "tráfego", "console", "decisão", "movimento", "pausas",
+};
+
+const char *stageprof_stage_name(ProfStage stage) {
+    return (unsigned)stage < PROF_STAGE_COUNT ? stage_names[stage] : "?";
+}
+
+void loghist_reset(LogHist *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+// Faixa de ns: 0..3 exatos; acima, 4 faixas por potência de 2 (os 2 bits
+// abaixo do mais significativo)
+static inline int loghist_bin(uint64_t ns) {
+    if (ns < (1u << LOGHIST_SUB_BITS)) return (int)ns;
+    int msb = 63 - __builtin_clzll(ns);
+    int bin = ((msb - LOGHIST_SUB_BITS + 1) << LOGHIST_SUB_BITS) +
+              (int)((ns >> (msb - LOGHIST_SUB_BITS)) & ((1u << LOGHIST_SUB_BITS) - 1));
+    return bin < LOGHIST_BINS ? bin : LOGHIST_BINS - 1;
+}
+
+// Maior valor da faixa
+static uint64_t loghist_bin_upper(int bin) {
+    const int sub_count = 1 << LOGHIST_SUB_BITS;
+    if (bin < sub_count) return (uint64_t)bin;
+    int shift = (bin >> LOGHIST_SUB_BITS) - 1;
+    uint64_t sub = (uint64_t)(bin & (sub_count - 1));
+    return ((sub_count + sub + 1) << shift) - 1;
+}
+
+void loghist_add(LogHist *h, uint64_t ns) {
+    h->count++;
+    h->sum_ns += ns;
+    if (ns > h->max_ns) h->max_ns = ns;
+    h->bins[loghist_bin(ns)]++;
+}
+
+uint64_t loghist_quantile_ns(const LogHist *h, int permille) {
+    if (h->count == 0) return 0;
+
+    // Menor faixa cuja contagem acumulada alcança a fração pedida
+    uint64_t rank = ((uint64_t)h->count * (uint64_t)permille + 999) / 1000;
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < LOGHIST_BINS; i++) {
+        seen += h->bins[i];
+        if (seen >= rank) {
+            uint64_t upper = loghist_bin_upper(i);
+            return upper < h->max_ns ? upper : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+void stageprof_init(StageProfiler *p, uint32_t deadline_us) {
+    memset(p, 0, sizeof(*p));
+    p->deadline_ns = (uint64_t)deadline_us * 1000u;
+}
+
+void stageprof_reset(StageProfiler *p) {
+    stageprof_init(p, (uint32_t)(p->deadline_ns / 1000u));
+}
+
+void stageprof_begin(StageProfiler *p) {
+    uint64_t now = hal_time_ns();
+    p->iter_start_ns = now;
+    p->mark_ns = now;
+    p->current = PROF_OTHER;
+    p->running = true;
+}
+
+void stageprof_end(StageProfiler *p) {
+    if (!p->running) return;
+    uint64_t now = hal_time_ns();
+    p->iter_ns[p->current] += now - p->mark_ns;
+    p->running = false;
+
+    uint64_t total = now - p->iter_start_ns;
+    uint64_t busy = total - p->iter_ns[PROF_SLEEP];
+    loghist_add(&p->loop, total);
+    loghist_add(&p->busy, busy);
+    if (p->deadline_ns && busy > p->deadline_ns) {
+        p->deadline_misses++;
+    }
+
+    // Só os estágios que rodaram nesta iteração
+    for (int s = 0; s < PROF_STAGE_COUNT; s++) {
+        if (p->iter_ns[s] == 0) continue;
+        loghist_add(&p->stage[s], p->iter_ns[s]);
+        p->iter_ns[s] = 0;
+    }
+}
+
+// Largura em caracteres (os nomes têm acentos em UTF-8)
+static int text_width(const char *s) {
+    int w = 0;
+    for (; *s; s++) {
+        if (((unsigned char)*s & 0xC0) != 0x80) w++;
+    }
+    return w;
+}
+
+static void print_row(const char *name, const LogHist *h) {
+    printf("  %s%*s %10u %10.1f %10.1f %10.1f %10.1f\n", name, 18 - text_width(name), "",
+           h->count, loghist_mean_ns(h) / 1000.0, loghist_quantile_ns(h, 500) / 1000.0,
+           loghist_quantile_ns(h, 990) / 1000.0, h->max_ns / 1000.0);
+}
+
+void stageprof_print_report(const StageProfiler *p) {
+    printf("Tempo por estágio (us por iteração):\n");
+    printf("  estágio            iterações      média        p50        p99       pior\n");
+    for (int s = 0; s < PROF_STAGE_COUNT; s++) {
+        print_row(stage_names[s], &p->stage[s]);
+    }
+    print_row("iteração", &p->loop);
+    print_row("trabalho", &p->busy);
+    if (p->deadline_ns) {
+        printf("  Prazo de %llu us no trabalho: %u de %u iteração(ões) acima (%.3f%%)\n",
+               (unsigned long long)(p->deadline_ns / 1000u), p->deadline_misses, p->busy.count,
+               p->busy.count ? 100.0 * p->deadline_misses / p->busy.count : 0.0);
+    }
+}
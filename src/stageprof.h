@@ -0,0 +1,129 @@
+#ifndef STAGEPROF_H
+#define STAGEPROF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal.h"
+
+// Tempo por estágio do laço de controle (sim_step).
+//
+// Cada iteração é dividida em estágios (botões, tráfego, console, decisão,
+// movimento, pausas); PROF_SCOPE marca um bloco como de um estágio e o
+// tempo vai sempre para o estágio mais interno aberto (as pausas dentro do
+// movimento contam como pausa, os botões lidos dentro da pausa como
+// botões). O que não está em bloco nenhum fica em "outros".
+//
+// Ao fim da iteração o tempo de cada estágio entra num histograma
+// logarítmico de memória fixa (4 faixas por potência de 2), junto com a
+// iteração inteira e o trabalho (iteração sem as pausas). O trabalho acima
+// do prazo conta como prazo perdido.
+//
+// Sem SMARTSTOP_PROFILE as macros somem e o laço não lê o relógio; com ele,
+// só mede se houver um StageProfiler anexado (ctx->prof).
+
+typedef enum {
+    PROF_OTHER = 0,                 // fora de qualquer bloco
+    PROF_BUTTONS,                   // sim_poll_buttons
+    PROF_TRAFFIC,                   // geração/aplicação de chegadas e limpeza
+    PROF_CONSOLE,                   // status e estatísticas no log
+    PROF_DECISION,                  // sim_choose_next_floor
+    PROF_MOVE,                      // viagem, parada ou movimento contínuo
+    PROF_SLEEP,                     // pausas do relógio (LEDs, portas, viagem)
+    PROF_STAGE_COUNT
+} ProfStage;
+
+#define LOGHIST_SUB_BITS 2                      // 4 faixas por potência de 2
+#define LOGHIST_BINS     128                    // até ~8,6 s em ns
+
+typedef struct {
+    uint32_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint32_t bins[LOGHIST_BINS];
+} LogHist;
+
+#define PROF_DEFAULT_DEADLINE_US 1000
+
+typedef struct StageProfiler {
+    LogHist stage[PROF_STAGE_COUNT];            // tempo por iteração em cada estágio
+    LogHist loop;                               // iteração inteira
+    LogHist busy;                               // iteração sem as pausas
+    uint64_t deadline_ns;                       // 0 = sem prazo
+    uint32_t deadline_misses;
+
+    // Iteração em andamento
+    uint64_t iter_ns[PROF_STAGE_COUNT];
+    uint64_t iter_start_ns;
+    uint64_t mark_ns;                           // início do trecho do estágio atual
+    int current;
+    bool running;
+} StageProfiler;
+
+void loghist_reset(LogHist *h);
+void loghist_add(LogHist *h, uint64_t ns);
+
+// Quantil em milésimos (500 = mediana, 990 = p99): limite superior da
+// faixa, no máximo o maior valor visto
+uint64_t loghist_quantile_ns(const LogHist *h, int permille);
+
+static inline uint64_t loghist_mean_ns(const LogHist *h) {
+    return h->count ? h->sum_ns / h->count : 0;
+}
+
+void stageprof_init(StageProfiler *p, uint32_t deadline_us);
+
+// Zera as medições (mantém o prazo)
+void stageprof_reset(StageProfiler *p);
+
+// Delimitam uma iteração do laço
+void stageprof_begin(StageProfiler *p);
+void stageprof_end(StageProfiler *p);
+
+// Entra no estágio; retorna o estágio anterior, que stageprof_leave
+// restaura (sempre -1, para encerrar o for de PROF_SCOPE)
+static inline int stageprof_enter(StageProfiler *p, int stage) {
+    if (!p || !p->running) return PROF_OTHER;
+    uint64_t now = hal_time_ns();
+    p->iter_ns[p->current] += now - p->mark_ns;
+    p->mark_ns = now;
+    int prev = p->current;
+    p->current = stage;
+    return prev;
+}
+
+static inline int stageprof_leave(StageProfiler *p, int prev) {
+    if (!p || !p->running) return -1;
+    uint64_t now = hal_time_ns();
+    p->iter_ns[p->current] += now - p->mark_ns;
+    p->mark_ns = now;
+    p->current = prev;
+    return -1;
+}
+
+const char *stageprof_stage_name(ProfStage stage);
+
+// Tabela por estágio (média, p50, p99, pior) e prazos perdidos
+void stageprof_print_report(const StageProfiler *p);
+
+#ifdef SMARTSTOP_PROFILE
+// PROF_SCOPE(ctx, PROF_DECISION) { ... } cronometra o bloco (sem return
+// nem break dentro dele)
+#define PROF_SCOPE(ctx, stage)                                                 \
+    for (int prof_prev_ = stageprof_enter((ctx)->prof, (stage)); prof_prev_ >= 0; \
+         prof_prev_ = stageprof_leave((ctx)->prof, prof_prev_))
+#define PROF_BEGIN(ctx)                                                        \
+    do {                                                                       \
+        if ((ctx)->prof) stageprof_begin((ctx)->prof);                         \
+    } while (0)
+#define PROF_END(ctx)                                                          \
+    do {                                                                       \
+        if ((ctx)->prof) stageprof_end((ctx)->prof);                           \
+    } while (0)
+#else
+#define PROF_SCOPE(ctx, stage)
+#define PROF_BEGIN(ctx) do { } while (0)
+#define PROF_END(ctx)   do { } while (0)
+#endif
+
+#endif
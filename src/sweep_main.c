@@ -0,0 +1,200 @@
+/*
+ * SmartStop - varredura de parâmetros (Monte Carlo em paralelo)
+ *
+ * Monta a grade cartesiana dos parâmetros do despacho, roda runs_per_point
+ * simulações independentes por ponto em todas as threads (ensemble.c) e
+ * imprime um CSV com os resultados agregados por ponto.
+ *
+ * Cada lista aceita um valor ("0.65") ou um intervalo "início:fim:passo".
+ *
+ * O motor padrão simula as execuções em lotes em passo travado, com a
+ * pontuação vetorizada entre simulações (lockstep.h); --engine scalar usa
+ * uma sim_step por vez. Os dois dão o mesmo CSV.
+ *
+ * Uso:
+ *   smartstop_sweep [--threshold L] [--bonus L] [--stop-cost L]
+ *                   [--emergency L] [--full-max L]
+ *                   [--runs R] [--cycles C] [--threads T]
+ *                   [--floors N] [--traffic low|medium|high] [--seed S]
+ *                   [--engine lockstep|scalar] [--simd auto|avx512|avx2|scalar]
+ *
+ * O resultado é reprodutível: depende apenas da semente, não do número de
+ * threads nem da ordem de execução.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ensemble.h"
+#include "lockstep.h"
+#include "value_list.h"
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [--threshold L] [--bonus L] [--stop-cost L] [--emergency L]\n"
+            "          [--full-max L] [--runs R] [--cycles C] [--threads T]\n"
+            "          [--floors N] [--traffic low|medium|high] [--seed S]\n"
+            "          [--engine lockstep|scalar] [--simd auto|avx512|avx2|scalar]\n"
+            "  L = valor único ou intervalo inicio:fim:passo\n",
+            prog);
+}
+
+static void stddev_pair(double sum, double sq, int n, double *mean, double *sd) {
+    *mean = n > 0 ? sum / n : 0.0;
+    double var = n > 1 ? (sq - sum * sum / n) / (n - 1) : 0.0;
+    *sd = var > 0.0 ? sqrt(var) : 0.0;
+}
+
+int main(int argc, char **argv) {
+    ValueList threshold = { { EFFICIENCY_THRESHOLD }, 1 };
+    ValueList bonus = { { WAIT_BONUS }, 1 };
+    ValueList stop_cost = { { STOP_COST }, 1 };
+    ValueList emergency = { { EMERGENCY_WAIT_TIME }, 1 };
+    ValueList full_max = { { CYCLES_FULL_MAX }, 1 };
+    int runs = 100;
+    long long cycles = 10000;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    TrafficMode traffic = TRAFFIC_MEDIUM;
+    uint64_t seed = 1;
+    EnsembleEngine engine = ENSEMBLE_LOCKSTEP;
+    const char *simd = "auto";
+    BuildingConfig base;
+
+    building_config_default(&base);
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool ok = val != NULL;
+
+        if (strcmp(arg, "--threshold") == 0 && val) {
+            ok = value_list_parse(val, &threshold);
+        } else if (strcmp(arg, "--bonus") == 0 && val) {
+            ok = value_list_parse(val, &bonus);
+        } else if (strcmp(arg, "--stop-cost") == 0 && val) {
+            ok = value_list_parse(val, &stop_cost);
+        } else if (strcmp(arg, "--emergency") == 0 && val) {
+            ok = value_list_parse(val, &emergency);
+        } else if (strcmp(arg, "--full-max") == 0 && val) {
+            ok = value_list_parse(val, &full_max);
+        } else if (strcmp(arg, "--runs") == 0 && val) {
+            runs = atoi(val);
+        } else if (strcmp(arg, "--cycles") == 0 && val) {
+            cycles = atoll(val);
+        } else if (strcmp(arg, "--threads") == 0 && val) {
+            threads = atol(val);
+        } else if (strcmp(arg, "--seed") == 0 && val) {
+            seed = strtoull(val, NULL, 0);
+        } else if (strcmp(arg, "--floors") == 0 && val) {
+            base.num_floors = atoi(val);
+        } else if (strcmp(arg, "--traffic") == 0 && val) {
+            if (strcmp(val, "low") == 0) traffic = TRAFFIC_LOW;
+            else if (strcmp(val, "medium") == 0) traffic = TRAFFIC_MEDIUM;
+            else if (strcmp(val, "high") == 0) traffic = TRAFFIC_HIGH;
+            else ok = false;
+        } else if (strcmp(arg, "--engine") == 0 && val) {
+            if (strcmp(val, "lockstep") == 0) engine = ENSEMBLE_LOCKSTEP;
+            else if (strcmp(val, "scalar") == 0) engine = ENSEMBLE_SCALAR;
+            else ok = false;
+        } else if (strcmp(arg, "--simd") == 0 && val) {
+            simd = val;
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    if (runs < 1 || cycles < 1 || threads < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (strcmp(simd, "auto") != 0 && !lockstep_force_kernel(simd)) {
+        fprintf(stderr, "Núcleo vetorial indisponível: %s\n", simd);
+        return 1;
+    }
+
+    int num_points = threshold.n * bonus.n * stop_cost.n * emergency.n * full_max.n;
+    SweepPoint *points = calloc((size_t)num_points, sizeof(SweepPoint));
+    SweepResult *results = calloc((size_t)num_points, sizeof(SweepResult));
+    if (!points || !results) {
+        fprintf(stderr, "Sem memória para %d pontos\n", num_points);
+        return 1;
+    }
+
+    // Grade cartesiana
+    int p = 0;
+    for (int a = 0; a < threshold.n; a++)
+    for (int b = 0; b < bonus.n; b++)
+    for (int c = 0; c < stop_cost.n; c++)
+    for (int d = 0; d < emergency.n; d++)
+    for (int e = 0; e < full_max.n; e++) {
+        BuildingConfig cfg = base;
+        cfg.efficiency_threshold = (float)threshold.v[a];
+        cfg.wait_bonus = (float)bonus.v[b];
+        cfg.stop_cost = (float)stop_cost.v[c];
+        cfg.emergency_wait_time = (int)emergency.v[d];
+        cfg.cycles_full_max = (int)full_max.v[e];
+        if (!building_config_apply(&cfg)) {
+            fprintf(stderr, "Ponto de grade inválido (#%d)\n", p);
+            return 1;
+        }
+        points[p].cfg = cfg;
+        points[p].mode = traffic;
+        p++;
+    }
+
+    EnsembleJob job = {
+        .points = points,
+        .num_points = num_points,
+        .runs_per_point = runs,
+        .cycles_per_run = cycles,
+        .num_threads = (int)threads,
+        .seed = seed,
+        .engine = engine,
+        .results = results,
+    };
+
+    if (ensemble_run(&job) != 0) {
+        fprintf(stderr, "Falha ao executar o ensemble\n");
+        return 1;
+    }
+
+    printf("threshold,wait_bonus,stop_cost,emergency_wait,cycles_full_max,"
+           "runs,cycles,stops,skipped,boarded,"
+           "boarded_per_cycle_mean,boarded_per_cycle_sd,skip_rate_mean,skip_rate_sd\n");
+    for (int i = 0; i < num_points; i++) {
+        const BuildingConfig *cfg = &points[i].cfg;
+        const SweepResult *r = &results[i];
+        double bpc_mean, bpc_sd, skip_mean, skip_sd;
+        stddev_pair(r->boarded_per_cycle_sum, r->boarded_per_cycle_sq, r->runs,
+                    &bpc_mean, &bpc_sd);
+        stddev_pair(r->skip_rate_sum, r->skip_rate_sq, r->runs, &skip_mean, &skip_sd);
+
+        printf("%.4f,%.4f,%.4f,%d,%d,%d,%lld,%lld,%lld,%lld,%.6f,%.6f,%.6f,%.6f\n",
+               cfg->efficiency_threshold, cfg->wait_bonus, cfg->stop_cost,
+               cfg->emergency_wait_time, cfg->cycles_full_max,
+               r->runs, r->cycles, r->total_stops, r->skipped_stops, r->total_boarded,
+               bpc_mean, bpc_sd, skip_mean, skip_sd);
+    }
+
+    long long total_cycles = (long long)num_points * runs * cycles;
+    fprintf(stderr,
+            "%d pontos x %d execuções x %lld ciclos em %d threads: %.3f s "
+            "(%.0f ciclos/s, %llu roubos, motor %s)\n",
+            num_points, runs, cycles, job.num_threads, job.wall_seconds,
+            job.wall_seconds > 0.0 ? (double)total_cycles / job.wall_seconds : 0.0,
+            (unsigned long long)job.steals,
+            job.engine_used == ENSEMBLE_LOCKSTEP ? lockstep_kernel_name() : "escalar");
+
+    free(points);
+    free(results);
+    return 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * Emissor do traço binário (comum ao firmware e ao host)
+ */
+
+#include "trace.h"
+
+#include <string.h>
+
+void trace_writer_init(TraceWriter *w, TraceSinkFn sink, void *user) {
+    w->sink = sink;
+    w->user = user;
+    w->records = 0;
+    w->count = 0;
+}
+
+void trace_begin(TraceWriter *w, const BuildingConfig *cfg, uint64_t seed,
+                 uint64_t start_us) {
+    TraceHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = TRACE_MAGIC;
+    h.version = TRACE_VERSION;
+    h.record_size = sizeof(TraceRecord);
+    h.num_floors = (uint16_t)cfg->num_floors;
+    h.car_capacity = (uint16_t)cfg->car_capacity;
+    h.seed = seed;
+    h.start_us = start_us;
+    w->sink(w->user, &h, sizeof(h));
+}
+
+void trace_flush(TraceWriter *w) {
+    if (w->count > 0) {
+        w->sink(w->user, w->buffer, sizeof(TraceRecord) * (size_t)w->count);
+        w->count = 0;
+    }
+}
+
+const char *trace_event_name(TraceEventType type) {
+    switch (type) {
+        case TRACE_EV_CYCLE:     return "cycle";
+        case TRACE_EV_DECISION:  return "decision";
+        case TRACE_EV_BOARD:     return "board";
+        case TRACE_EV_DISEMBARK: return "disembark";
+        case TRACE_EV_SKIP:      return "skip";
+        case TRACE_EV_EMERGENCY: return "emergency";
+        default:                 return "?";
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "smartstop.h"
+
+// Traço binário de eventos.
+//
+// Alternativa ao log textual do Monitor Serial: cada evento é um registro
+// de tamanho fixo (24 bytes), precedido por um cabeçalho versionado de
+// 32 bytes. O leitor mapeia o arquivo e percorre o vetor de registros
+// direto, sem interpretar texto. Formato little-endian (RP2040 e x86/ARM
+// no host), sem padding.
+//
+// Versão 2: time_ms passou a 64 bits (na versão 1, com 32 bits, o tempo
+// dava a volta depois de ~49,7 dias simulados).
+
+#define TRACE_MAGIC   0x52545353u   // "SSTR"
+#define TRACE_VERSION 2
+
+typedef enum {
+    TRACE_EV_CYCLE = 1,     // início de ciclo: aux = direção, value = chamadas
+                            // ativas, extra = ciclos lotado
+    TRACE_EV_DECISION,      // aux = prioridade (DispatchPriority), value = alvo
+                            // (-1 = movimento contínuo)
+    TRACE_EV_BOARD,         // embarque: value = passageiros
+    TRACE_EV_DISEMBARK,     // desembarque: value = passageiros
+    TRACE_EV_SKIP,          // chamada ignorada no caminho: value = esperando
+    TRACE_EV_EMERGENCY,     // value = espera (ciclos), extra = chamadas no caminho,
+                            // aux = 1 atendida já / 0 adiada
+    TRACE_EV_COUNT
+} TraceEventType;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;       // sizeof(TraceRecord)
+    uint16_t num_floors;
+    uint16_t car_capacity;
+    uint32_t reserved;
+    uint64_t seed;
+    uint64_t start_us;          // tempo simulado do primeiro registro
+} TraceHeader;
+
+typedef struct {
+    uint32_t cycle;
+    uint8_t type;               // TraceEventType
+    uint8_t floor;
+    uint8_t occupancy;          // ocupação após o evento (saturada em 255)
+    int8_t aux;                 // direção no CYCLE, prioridade no DECISION
+    uint64_t time_ms;           // tempo simulado (SimClock) em ms
+    int16_t value;
+    int16_t extra;
+    uint32_t reserved;
+} TraceRecord;
+
+_Static_assert(sizeof(TraceHeader) == 32, "TraceHeader deve ter 32 bytes");
+_Static_assert(sizeof(TraceRecord) == 24, "TraceRecord deve ter 24 bytes");
+
+// Destino dos bytes (arquivo no host, USB/serial no Pico)
+typedef void (*TraceSinkFn)(void *user, const void *data, size_t len);
+
+#define TRACE_BUFFER_RECORDS 64
+
+// Emissor com buffer: o destino só é chamado a cada TRACE_BUFFER_RECORDS
+// registros (ou em trace_flush)
+typedef struct {
+    TraceSinkFn sink;
+    void *user;
+    uint64_t records;           // total emitido
+    int count;                  // registros pendentes no buffer
+    TraceRecord buffer[TRACE_BUFFER_RECORDS];
+} TraceWriter;
+
+void trace_writer_init(TraceWriter *w, TraceSinkFn sink, void *user);
+
+// Escreve o cabeçalho; chamar uma vez antes do primeiro evento
+void trace_begin(TraceWriter *w, const BuildingConfig *cfg, uint64_t seed,
+                 uint64_t start_us);
+
+static inline void trace_emit(TraceWriter *w, uint32_t cycle, uint64_t now_us,
+                              TraceEventType type, int floor, int occupancy,
+                              int aux, int value, int extra) {
+    TraceRecord *r = &w->buffer[w->count];
+    r->cycle = cycle;
+    r->time_ms = now_us / 1000u;
+    r->type = (uint8_t)type;
+    r->floor = (uint8_t)floor;
+    r->occupancy = (uint8_t)(occupancy > 255 ? 255 : occupancy);
+    r->aux = (int8_t)aux;
+    r->value = (int16_t)value;
+    r->extra = (int16_t)extra;
+    r->reserved = 0;
+    w->records++;
+    if (++w->count == TRACE_BUFFER_RECORDS) {
+        w->sink(w->user, w->buffer, sizeof(w->buffer));
+        w->count = 0;
+    }
+}
+
+// Envia os registros pendentes ao destino
+void trace_flush(TraceWriter *w);
+
+const char *trace_event_name(TraceEventType type);
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ * SmartStop - leitor do traço binário
+ *
+ * Mapeia o arquivo gravado por smartstop_host --trace (ou capturado da
+ * USB do firmware compilado com SMARTSTOP_TRACE) e resume os eventos em
+ * uma única passada, sem parsing por linha.
+ *
+ * Uso:
+ *   smartstop_trace arquivo.sst           resumo
+ *   smartstop_trace --csv arquivo.sst     um evento por linha (CSV)
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dispatch.h"
+#include "hal.h"
+#include "trace_view.h"
+
+#define PRIORITY_COUNT (PRIORITY_LOOKAHEAD + 1)
+
+typedef struct {
+    uint64_t events[TRACE_EV_COUNT];
+    uint64_t decisions[PRIORITY_COUNT];
+    uint64_t boarded;
+    uint64_t disembarked;
+    uint64_t emergencies_served;
+    uint64_t emergencies_deferred;
+    uint64_t occupancy_sum;         // soma da ocupação no início de cada ciclo
+    uint64_t active_calls_sum;
+    uint32_t first_cycle;
+    uint32_t last_cycle;
+    uint64_t last_time_ms;
+} TraceSummary;
+
+static void summarize(const TraceView *v, TraceSummary *s) {
+    memset(s, 0, sizeof(*s));
+    if (v->count > 0) {
+        s->first_cycle = v->records[0].cycle;
+    }
+
+    for (size_t i = 0; i < v->count; i++) {
+        const TraceRecord *r = &v->records[i];
+        if (r->type >= TRACE_EV_COUNT) continue;
+        s->events[r->type]++;
+
+        switch (r->type) {
+            case TRACE_EV_CYCLE:
+                s->occupancy_sum += r->occupancy;
+                s->active_calls_sum += (uint64_t)r->value;
+                break;
+            case TRACE_EV_DECISION:
+                if ((uint8_t)r->aux < PRIORITY_COUNT) s->decisions[(uint8_t)r->aux]++;
+                break;
+            case TRACE_EV_BOARD:
+                s->boarded += (uint64_t)r->value;
+                break;
+            case TRACE_EV_DISEMBARK:
+                s->disembarked += (uint64_t)r->value;
+                break;
+            case TRACE_EV_EMERGENCY:
+                if (r->aux) s->emergencies_served++;
+                else s->emergencies_deferred++;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (v->count > 0) {
+        s->last_cycle = v->records[v->count - 1].cycle;
+        s->last_time_ms = v->records[v->count - 1].time_ms;
+    }
+}
+
+static void print_summary(const TraceView *v, const TraceSummary *s, double scan_s) {
+    const TraceHeader *h = v->header;
+    uint64_t cycles = s->events[TRACE_EV_CYCLE];
+
+    printf("Traço v%u: %u andares, capacidade %u, semente %llu\n",
+           h->version, h->num_floors, h->car_capacity, (unsigned long long)h->seed);
+    printf("Registros:           %zu (%.1f MB)\n", v->count,
+           (double)v->map_size / (1024.0 * 1024.0));
+    printf("Ciclos:              %llu (%u..%u), %.1f s simulados\n",
+           (unsigned long long)cycles, s->first_cycle, s->last_cycle,
+           (double)s->last_time_ms / 1000.0);
+
+    printf("\nEventos:\n");
+    for (int t = TRACE_EV_CYCLE; t < TRACE_EV_COUNT; t++) {
+        printf("  %-22s %llu\n", trace_event_name((TraceEventType)t),
+               (unsigned long long)s->events[t]);
+    }
+
+    printf("\nDecisões por prioridade:\n");
+    uint64_t decisions = s->events[TRACE_EV_DECISION];
+    for (int p = 0; p < PRIORITY_COUNT; p++) {
+        printf("  %-22s %10llu  (%5.1f%%)\n", dispatch_priority_name((DispatchPriority)p),
+               (unsigned long long)s->decisions[p],
+               decisions > 0 ? 100.0 * (double)s->decisions[p] / (double)decisions : 0.0);
+    }
+
+    printf("\nPassageiros embarcados:    %llu\n", (unsigned long long)s->boarded);
+    printf("Passageiros desembarcados: %llu\n", (unsigned long long)s->disembarked);
+    printf("Paradas ignoradas:         %llu\n", (unsigned long long)s->events[TRACE_EV_SKIP]);
+    printf("Emergências:               %llu atendidas, %llu adiadas\n",
+           (unsigned long long)s->emergencies_served,
+           (unsigned long long)s->emergencies_deferred);
+    if (cycles > 0) {
+        printf("Ocupação média:            %.2f\n", (double)s->occupancy_sum / (double)cycles);
+        printf("Chamadas ativas (média):   %.2f\n", (double)s->active_calls_sum / (double)cycles);
+    }
+    if (scan_s > 0.0) {
+        printf("\nVarredura: %.3f s (%.0f MB/s)\n", scan_s,
+               (double)v->map_size / (1024.0 * 1024.0) / scan_s);
+    }
+}
+
+static void print_csv(const TraceView *v) {
+    printf("cycle,time_ms,event,floor,occupancy,aux,value,extra\n");
+    for (size_t i = 0; i < v->count; i++) {
+        const TraceRecord *r = &v->records[i];
+        printf("%u,%llu,%s,%u,%u,%d,%d,%d\n", r->cycle, (unsigned long long)r->time_ms,
+               trace_event_name((TraceEventType)r->type), r->floor, r->occupancy,
+               r->aux, r->value, r->extra);
+    }
+}
+
+int main(int argc, char **argv) {
+    bool csv = false;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "Uso: %s [--csv] arquivo.sst\n", argv[0]);
+        return 1;
+    }
+
+    TraceView view;
+    if (!trace_view_open(&view, path)) {
+        return 1;
+    }
+
+    if (csv) {
+        print_csv(&view);
+    } else {
+        TraceSummary summary;
+        uint64_t start_us = hal_time_us();
+        summarize(&view, &summary);
+        double scan_s = (double)(hal_time_us() - start_us) / 1e6;
+        print_summary(&view, &summary, scan_s);
+    }
+
+    trace_view_close(&view);
+    return 0;
+}
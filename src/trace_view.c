@@ -0,0 +1,70 @@
+/*
+ * Leitor do traço binário (host): mmap + validação do cabeçalho
+ */
+
+#include "trace_view.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool trace_view_open(TraceView *v, const char *path) {
+    memset(v, 0, sizeof(*v));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        close(fd);
+        return false;
+    }
+    if ((size_t)st.st_size < sizeof(TraceHeader)) {
+        fprintf(stderr, "%s: arquivo menor que o cabeçalho do traço\n", path);
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return false;
+    }
+    // Varredura linear: o kernel pode ler adiante agressivamente
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    const TraceHeader *h = map;
+    if (h->magic != TRACE_MAGIC) {
+        fprintf(stderr, "%s: não é um traço SmartStop\n", path);
+        munmap(map, (size_t)st.st_size);
+        return false;
+    }
+    if (h->version != TRACE_VERSION || h->record_size != sizeof(TraceRecord)) {
+        fprintf(stderr, "%s: versão %u (registro de %u bytes) não suportada; esperado %u (%zu)\n",
+                path, h->version, h->record_size, TRACE_VERSION, sizeof(TraceRecord));
+        munmap(map, (size_t)st.st_size);
+        return false;
+    }
+
+    v->map = map;
+    v->map_size = (size_t)st.st_size;
+    v->header = h;
+    v->records = (const TraceRecord *)((const char *)map + sizeof(TraceHeader));
+    v->count = (v->map_size - sizeof(TraceHeader)) / sizeof(TraceRecord);
+    return true;
+}
+
+void trace_view_close(TraceView *v) {
+    if (v->map) {
+        munmap(v->map, v->map_size);
+    }
+    memset(v, 0, sizeof(*v));
+}
@@ -0,0 +1,27 @@
+#ifndef TRACE_VIEW_H
+#define TRACE_VIEW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "trace.h"
+
+// Leitura do traço binário via mmap (somente host).
+// Os registros são acessados direto na página mapeada: nada é copiado nem
+// interpretado, então o custo de varrer o arquivo é o de ler a memória.
+typedef struct {
+    const TraceHeader *header;
+    const TraceRecord *records;
+    size_t count;               // registros completos (um final truncado é ignorado)
+
+    void *map;
+    size_t map_size;
+} TraceView;
+
+// Abre e valida o arquivo. Em caso de erro escreve a causa em stderr e
+// retorna false.
+bool trace_view_open(TraceView *v, const char *path);
+
+void trace_view_close(TraceView *v);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef TRAFFIC_QUEUE_H
+#define TRAFFIC_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "smartstop.h"
+
+// Fila SPSC de lotes de tráfego entre o gerador (núcleo 1 do RP2040 ou
+// uma thread no host) e o laço de controle. Sem cópias: o produtor escreve
+// direto no slot reservado e o consumidor lê o lote no lugar.
+// Como o gerador sorteia os lotes em sequência com um fluxo próprio, o
+// conteúdo do k-ésimo lote não depende do ritmo entre os dois lados.
+
+#define TRAFFIC_QUEUE_DEPTH 8           // potência de 2
+
+typedef struct {
+    _Atomic uint32_t head;              // só o produtor escreve
+    _Atomic uint32_t tail;              // só o consumidor escreve
+    TrafficBatch slots[TRAFFIC_QUEUE_DEPTH];
+} TrafficQueue;
+
+static inline void traffic_queue_init(TrafficQueue *q) {
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+}
+
+// Produtor: slot livre para preencher, ou NULL se a fila está cheia
+static inline TrafficBatch *traffic_queue_reserve(TrafficQueue *q) {
+    uint32_t h = atomic_load_explicit(&q->head, memory_order_relaxed);
+    uint32_t t = atomic_load_explicit(&q->tail, memory_order_acquire);
+    if (h - t >= TRAFFIC_QUEUE_DEPTH) return NULL;
+    return &q->slots[h & (TRAFFIC_QUEUE_DEPTH - 1)];
+}
+
+// Produtor: publica o slot obtido em traffic_queue_reserve
+static inline void traffic_queue_commit(TrafficQueue *q) {
+    uint32_t h = atomic_load_explicit(&q->head, memory_order_relaxed);
+    atomic_store_explicit(&q->head, h + 1, memory_order_release);
+}
+
+// Consumidor: lote mais antigo, ou NULL se a fila está vazia
+static inline const TrafficBatch *traffic_queue_front(TrafficQueue *q) {
+    uint32_t t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    uint32_t h = atomic_load_explicit(&q->head, memory_order_acquire);
+    if (t == h) return NULL;
+    return &q->slots[t & (TRAFFIC_QUEUE_DEPTH - 1)];
+}
+
+// Consumidor: libera o lote obtido em traffic_queue_front
+static inline void traffic_queue_pop(TrafficQueue *q) {
+    uint32_t t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    atomic_store_explicit(&q->tail, t + 1, memory_order_release);
+}
+
+// Produtor: completa a fila com novos lotes. Retorna quantos gerou.
+static inline int traffic_queue_fill(TrafficQueue *q, const BuildingConfig *cfg,
+                                     SimRng *rng, TrafficMode mode) {
+    int n = 0;
+    TrafficBatch *b;
+    while ((b = traffic_queue_reserve(q)) != NULL) {
+        traffic_draw_batch(cfg, rng, mode, b);
+        traffic_queue_commit(q);
+        n++;
+    }
+    return n;
+}
+
+#endif
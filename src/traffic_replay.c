@@ -0,0 +1,190 @@
+/*
+ * Reprodução de traços de chegadas (host): mmap em sequência, binário ou CSV
+ */
+
+#include "traffic_replay.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Devolve ao kernel as páginas inteiras já consumidas. O mapeamento é
+// privado e só de leitura: se forem tocadas de novo, voltam do arquivo.
+static void release_consumed(TrafficReplay *r) {
+    if (r->pos - r->released < TRAFFIC_REPLAY_RELEASE_BYTES) return;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t end = r->pos / page * page;
+    if (end > r->released) {
+        madvise((void *)(r->map + r->released), end - r->released, MADV_DONTNEED);
+        r->released = end;
+    }
+}
+
+// Lê um inteiro sem sinal; retorna false se não houver dígito
+static bool parse_uint(const char **p, const char *end, uint64_t *out) {
+    const char *s = *p;
+    uint64_t v = 0;
+    if (s >= end || *s < '0' || *s > '9') return false;
+    while (s < end && *s >= '0' && *s <= '9') {
+        v = v * 10u + (uint64_t)(*s - '0');
+        s++;
+    }
+    *p = s;
+    *out = v;
+    return true;
+}
+
+static bool expect_comma(const char **p, const char *end) {
+    if (*p < end && **p == ',') {
+        (*p)++;
+        return true;
+    }
+    return false;
+}
+
+// Próxima linha de dados do CSV; false no fim do arquivo. Linhas mal
+// formadas contam como rejeitadas.
+static bool next_csv(TrafficReplay *r, uint64_t *time_ms, TrafficArrival *a) {
+    const char *end = r->map + r->map_size;
+
+    while (r->pos < r->map_size) {
+        const char *line = r->map + r->pos;
+        const char *eol = memchr(line, '\n', (size_t)(end - line));
+        if (!eol) eol = end;
+        r->pos = (size_t)(eol - r->map) + (eol < end ? 1 : 0);
+
+        if (line == eol || *line < '0' || *line > '9') continue;
+
+        const char *p = line;
+        uint64_t t, origin, dest = TRAFFIC_DEST_ANY, group;
+        bool ok = parse_uint(&p, eol, &t) && expect_comma(&p, eol) &&
+                  parse_uint(&p, eol, &origin) && expect_comma(&p, eol);
+        if (ok && p < eol && *p == '-') {
+            p++;
+        } else if (ok && p < eol && *p != ',') {
+            ok = parse_uint(&p, eol, &dest);
+        }
+        ok = ok && expect_comma(&p, eol) && parse_uint(&p, eol, &group);
+        if (!ok || origin > UINT16_MAX || dest > UINT16_MAX || group > UINT16_MAX) {
+            r->rejected++;
+            continue;
+        }
+
+        *time_ms = t;
+        a->origin = (uint16_t)origin;
+        a->dest = (uint16_t)dest;
+        a->group = (uint16_t)group;
+        return true;
+    }
+    return false;
+}
+
+static bool next_binary(TrafficReplay *r, uint64_t *time_ms, TrafficArrival *a) {
+    if (r->map_size - r->pos < sizeof(TrafficFileRecord)) return false;
+
+    TrafficFileRecord rec;
+    memcpy(&rec, r->map + r->pos, sizeof(rec));
+    r->pos += sizeof(rec);
+
+    *time_ms = rec.time_ms;
+    a->origin = rec.origin;
+    a->dest = rec.dest;
+    a->group = rec.group;
+    return true;
+}
+
+static bool replay_next(void *state, TrafficArrival *out) {
+    TrafficReplay *r = state;
+    uint64_t time_ms;
+
+    for (;;) {
+        bool got = r->binary ? next_binary(r, &time_ms, out) : next_csv(r, &time_ms, out);
+        release_consumed(r);
+        if (!got) return false;
+
+        // Chegadas que não cabem no prédio simulado ficam de fora
+        if (out->origin >= r->num_floors || out->group == 0 ||
+            (out->dest != TRAFFIC_DEST_ANY &&
+             (out->dest >= r->num_floors || out->dest == out->origin))) {
+            r->rejected++;
+            continue;
+        }
+        break;
+    }
+
+    uint64_t us = time_ms * 1000u;
+    if (us < r->last_us) {
+        r->reordered++;
+        us = r->last_us;
+    }
+    r->last_us = us;
+    out->time_us = us;
+    r->records++;
+    return true;
+}
+
+bool traffic_replay_open(TrafficReplay *r, TrafficSource *src, const char *path, int num_floors) {
+    memset(r, 0, sizeof(*r));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        fprintf(stderr, "%s: arquivo vazio\n", path);
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return false;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    r->map = map;
+    r->map_size = (size_t)st.st_size;
+    r->num_floors = num_floors;
+
+    TrafficFileHeader h = {0};
+    if (r->map_size >= sizeof(h)) {
+        memcpy(&h, map, sizeof(h));
+        r->binary = (h.magic == TRAFFIC_MAGIC);
+    }
+    if (r->binary) {
+        if (h.version != TRAFFIC_VERSION || h.record_size != sizeof(TrafficFileRecord)) {
+            fprintf(stderr, "%s: versão %u (registro de %u bytes) não suportada; esperado %u (%zu)\n",
+                    path, h.version, h.record_size, TRAFFIC_VERSION, sizeof(TrafficFileRecord));
+            traffic_replay_close(r);
+            return false;
+        }
+        r->file_floors = h.num_floors;
+        r->pos = sizeof(h);
+    }
+
+    src->next = replay_next;
+    src->state = r;
+    src->name = r->binary ? "traço binário" : "traço CSV";
+    return true;
+}
+
+void traffic_replay_close(TrafficReplay *r) {
+    if (r->map) {
+        munmap((void *)r->map, r->map_size);
+    }
+    memset(r, 0, sizeof(*r));
+}
@@ -0,0 +1,72 @@
+#ifndef TRAFFIC_REPLAY_H
+#define TRAFFIC_REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "traffic_source.h"
+
+// Reprodução de traços de chegadas gravados (somente host).
+//
+// Dois formatos, reconhecidos pelo início do arquivo:
+//   - binário: TrafficFileHeader seguido de TrafficFileRecord (12 bytes por
+//     chegada), gravado por smartstop_traffic;
+//   - CSV: uma chegada por linha, "time_ms,origin,dest,group". dest vazio
+//     ou "-" deixa o destino para o simulador; linhas que não começam com
+//     dígito (cabeçalho, comentários) são ignoradas.
+//
+// O arquivo é mapeado (mmap) e lido em sequência; as páginas já
+// consumidas são devolvidas ao kernel a cada TRAFFIC_REPLAY_RELEASE_BYTES,
+// então um traço de meses de um prédio grande ocupa só a janela corrente
+// de RAM.
+
+#define TRAFFIC_MAGIC   0x41545353u     // "SSTA" em little-endian
+#define TRAFFIC_VERSION 1
+
+#define TRAFFIC_REPLAY_RELEASE_BYTES (64u << 20)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;           // sizeof(TrafficFileRecord)
+    uint16_t num_floors;            // prédio em que o traço foi gravado
+    uint16_t reserved;
+    uint32_t reserved2;
+} TrafficFileHeader;
+
+typedef struct {
+    uint32_t time_ms;               // desde o início do traço (até ~49 dias)
+    uint16_t origin;
+    uint16_t dest;                  // TRAFFIC_DEST_ANY = sem destino
+    uint16_t group;
+    uint16_t reserved;
+} TrafficFileRecord;
+
+_Static_assert(sizeof(TrafficFileHeader) == 16, "TrafficFileHeader deve ter 16 bytes");
+_Static_assert(sizeof(TrafficFileRecord) == 12, "TrafficFileRecord deve ter 12 bytes");
+
+typedef struct {
+    const char *map;
+    size_t map_size;
+    size_t pos;                     // próximo byte a ler
+    size_t released;                // páginas antes disto já foram devolvidas
+    bool binary;
+    uint16_t file_floors;           // 0 no CSV
+
+    int num_floors;                 // prédio simulado
+    uint64_t last_us;
+
+    // Contadores da leitura
+    uint64_t records;               // chegadas entregues
+    uint64_t rejected;              // andar fora do prédio, origem = destino, grupo 0
+    uint64_t reordered;             // instante anterior ao da chegada anterior
+} TrafficReplay;
+
+// Abre o traço para um prédio de num_floors andares e prepara a fonte que o
+// lê. Em caso de erro escreve a causa em stderr e retorna false.
+bool traffic_replay_open(TrafficReplay *r, TrafficSource *src, const char *path, int num_floors);
+
+void traffic_replay_close(TrafficReplay *r);
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * Perfis de tráfego paramétricos (pico de subida, de descida, entre
+ * andares, almoço e o dia útil completo)
+ *
+ * Cada perfil é um processo de Poisson com taxa constante por trecho do
+ * dia. Ao cruzar o fim de um trecho o sorteio recomeça na fronteira com a
+ * taxa nova (o processo não tem memória, então isso é exato).
+ */
+
+#include "traffic_source.h"
+
+#include <math.h>
+#include <string.h>
+
+#define DAY_S 86400u
+#define LOBBY_SHARE_PCT 85
+
+// Dia útil: padrão e taxa (% do pico) por trecho
+static const ProfileSegment day_schedule[] = {
+    {     0, PROFILE_INTERFLOOR,   2 },     // madrugada
+    { 25200, PROFILE_INTERFLOOR,  20 },     // 07:00
+    { 28800, PROFILE_UP_PEAK,    100 },     // 08:00 entrada
+    { 34200, PROFILE_INTERFLOOR,  30 },     // 09:30
+    { 43200, PROFILE_LUNCH,       70 },     // 12:00 almoço
+    { 48600, PROFILE_INTERFLOOR,  30 },     // 13:30
+    { 61200, PROFILE_DOWN_PEAK,  100 },     // 17:00 saída
+    { 66600, PROFILE_INTERFLOOR,  10 },     // 18:30
+};
+
+_Static_assert(sizeof(day_schedule) / sizeof(day_schedule[0]) <= PROFILE_MAX_SEGMENTS,
+               "day_schedule excede PROFILE_MAX_SEGMENTS");
+
+static const char *const profile_names[PROFILE_COUNT] = {
+    "up-peak", "down-peak", "interfloor", "lunch", "day",
+};
+
+const char *traffic_profile_name(TrafficProfileKind kind) {
+    return (unsigned)kind < PROFILE_COUNT ? profile_names[kind] : "?";
+}
+
+int traffic_profile_parse(const char *name) {
+    for (int k = 0; k < PROFILE_COUNT; k++) {
+        if (strcmp(name, profile_names[k]) == 0) return k;
+    }
+    return -1;
+}
+
+// Andar acima do térreo, uniforme
+static int upper_floor(TrafficProfile *p) {
+    return 1 + sim_rng_below(&p->rng, (uint32_t)(p->num_floors - 1));
+}
+
+// Origem e destino distintos, uniformes
+static void interfloor_trip(TrafficProfile *p, int *origin, int *dest) {
+    *origin = sim_rng_below(&p->rng, (uint32_t)p->num_floors);
+    *dest = sim_rng_below(&p->rng, (uint32_t)(p->num_floors - 1));
+    if (*dest >= *origin) (*dest)++;
+}
+
+static void draw_trip(TrafficProfile *p, TrafficProfileKind kind, int *origin, int *dest) {
+    bool lobby = sim_rng_below(&p->rng, 100) < p->lobby_share_pct;
+
+    switch (kind) {
+        case PROFILE_UP_PEAK:
+            if (!lobby) break;
+            *origin = 0;
+            *dest = upper_floor(p);
+            return;
+        case PROFILE_DOWN_PEAK:
+            if (!lobby) break;
+            *origin = upper_floor(p);
+            *dest = 0;
+            return;
+        case PROFILE_LUNCH:
+            if (!lobby) break;
+            if (sim_rng_below(&p->rng, 2) == 0) {
+                *origin = upper_floor(p);
+                *dest = 0;
+            } else {
+                *origin = 0;
+                *dest = upper_floor(p);
+            }
+            return;
+        default:
+            break;
+    }
+    interfloor_trip(p, origin, dest);
+}
+
+// Grupo de 1 (70%), 2 (20%) ou 3 (10%) pessoas
+static int draw_group(TrafficProfile *p) {
+    int r = sim_rng_below(&p->rng, 10);
+    return r < 7 ? 1 : (r < 9 ? 2 : 3);
+}
+
+static bool profile_next(void *state, TrafficArrival *out) {
+    TrafficProfile *p = state;
+    const ProfileSegment *seg;
+
+    for (;;) {
+        // Trecho do dia que contém now_us e o instante em que ele termina
+        uint64_t day_start_us = p->now_us / (DAY_S * 1000000ull) * (DAY_S * 1000000ull);
+        uint32_t tod_s = (uint32_t)((p->now_us - day_start_us) / 1000000u);
+        int i = p->num_segments - 1;
+        while (i > 0 && p->segments[i].start_s > tod_s) i--;
+        seg = &p->segments[i];
+        uint32_t end_s = (i + 1 < p->num_segments) ? p->segments[i + 1].start_s : DAY_S;
+        uint64_t seg_end_us = day_start_us + (uint64_t)end_s * 1000000u;
+
+        double per_us = (double)p->arrivals_per_hour * seg->rate_pct / 100.0 / 3.6e9;
+        if (per_us <= 0.0) {
+            p->now_us = seg_end_us;
+            continue;
+        }
+
+        double u = (double)(sim_rng_next(&p->rng) >> 8) * 0x1p-24;   // [0, 1)
+        uint64_t dt = (uint64_t)(-log(1.0 - u) / per_us) + 1;
+        if (p->now_us + dt >= seg_end_us) {
+            p->now_us = seg_end_us;
+            continue;
+        }
+        p->now_us += dt;
+        break;
+    }
+
+    int origin, dest;
+    draw_trip(p, (TrafficProfileKind)seg->kind, &origin, &dest);
+    out->time_us = p->now_us;
+    out->origin = (uint16_t)origin;
+    out->dest = (uint16_t)dest;
+    out->group = (uint16_t)draw_group(p);
+    return true;
+}
+
+void traffic_profile_init(TrafficProfile *p, TrafficSource *src, TrafficProfileKind kind,
+                          int num_floors, uint32_t arrivals_per_hour, const SimRng *rng) {
+    p->kind = kind;
+    p->num_floors = num_floors;
+    p->arrivals_per_hour = arrivals_per_hour ? arrivals_per_hour : 10u * (uint32_t)num_floors;
+    p->lobby_share_pct = LOBBY_SHARE_PCT;
+    p->rng = *rng;
+    p->now_us = 0;
+
+    if (kind == PROFILE_DAY) {
+        p->num_segments = (int)(sizeof(day_schedule) / sizeof(day_schedule[0]));
+        memcpy(p->segments, day_schedule, sizeof(day_schedule));
+    } else {
+        // Padrão único o dia todo, na taxa de pico
+        p->num_segments = 1;
+        p->segments[0].start_s = 0;
+        p->segments[0].kind = (uint8_t)kind;
+        p->segments[0].rate_pct = 100;
+    }
+
+    src->next = profile_next;
+    src->state = p;
+    src->name = traffic_profile_name(kind);
+}
+
+TrafficProfile *traffic_source_profile(const TrafficSource *src) {
+    return src->next == profile_next ? (TrafficProfile *)src->state : NULL;
+}
@@ -0,0 +1,85 @@
+#ifndef TRAFFIC_SOURCE_H
+#define TRAFFIC_SOURCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sim_rng.h"
+
+// Fonte de tráfego: sequência de chegadas com instante, origem, destino e
+// tamanho do grupo, em ordem de tempo. Substitui o sorteio plano de
+// generate_random_hall_calls quando anexada ao SimContext (laço de ciclos)
+// ou ao EventSim (motor de eventos).
+//
+// Implementações: perfis paramétricos por hora do dia (este arquivo,
+// portáveis, rodam no Pico) e reprodução de traços gravados em arquivo
+// (traffic_replay.h, só no host).
+
+#define TRAFFIC_DEST_ANY 0xFFFFu    // destino sorteado pelo simulador
+
+typedef struct {
+    uint64_t time_us;               // desde o início da simulação
+    uint16_t origin;
+    uint16_t dest;                  // TRAFFIC_DEST_ANY = sem destino registrado
+    uint16_t group;                 // pessoas chegando juntas
+} TrafficArrival;
+
+// Próxima chegada; false quando a fonte terminou
+typedef bool (*TrafficNextFn)(void *state, TrafficArrival *out);
+
+typedef struct {
+    TrafficNextFn next;
+    void *state;
+    const char *name;
+} TrafficSource;
+
+static inline bool traffic_source_next(TrafficSource *src, TrafficArrival *out) {
+    return src->next(src->state, out);
+}
+
+// ---- Perfis paramétricos ----
+
+typedef enum {
+    PROFILE_UP_PEAK = 0,            // entrada da manhã: do térreo para cima
+    PROFILE_DOWN_PEAK,              // saída da tarde: de cima para o térreo
+    PROFILE_INTERFLOOR,             // entre andares, origem e destino uniformes
+    PROFILE_LUNCH,                  // almoço: metade desce, metade volta
+    PROFILE_DAY,                    // dia útil: os anteriores por hora do dia
+    PROFILE_COUNT
+} TrafficProfileKind;
+
+// Trecho do dia com padrão e taxa constantes
+typedef struct {
+    uint32_t start_s;               // segundos desde 00:00
+    uint8_t kind;                   // TrafficProfileKind (exceto PROFILE_DAY)
+    uint16_t rate_pct;              // taxa em % de arrivals_per_hour
+} ProfileSegment;
+
+#define PROFILE_MAX_SEGMENTS 8
+
+typedef struct {
+    TrafficProfileKind kind;
+    int num_floors;
+    uint32_t arrivals_per_hour;     // grupos por hora no pico
+    uint8_t lobby_share_pct;        // % das viagens de pico que tocam o térreo
+
+    SimRng rng;                     // fluxo próprio (ver sim_traffic_stream)
+    uint64_t now_us;
+    int num_segments;
+    ProfileSegment segments[PROFILE_MAX_SEGMENTS];
+} TrafficProfile;
+
+// Prepara o perfil (taxa padrão: 10 grupos/h por andar) e a fonte que o lê.
+// O perfil não tem fim: a simulação decide quando parar.
+void traffic_profile_init(TrafficProfile *p, TrafficSource *src, TrafficProfileKind kind,
+                          int num_floors, uint32_t arrivals_per_hour, const SimRng *rng);
+
+const char *traffic_profile_name(TrafficProfileKind kind);
+
+// Nome em linha de comando ("up-peak", "day", ...) -> perfil; -1 se inválido
+int traffic_profile_parse(const char *name);
+
+// Perfil lido pela fonte, ou NULL se a fonte for outra (traço gravado)
+TrafficProfile *traffic_source_profile(const TrafficSource *src);
+
+#endif
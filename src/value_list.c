@@ -0,0 +1,61 @@
+/*
+ * Listas de parâmetros da linha de comando (host)
+ */
+
+#include <stdlib.h>
+
+#include "value_list.h"
+
+// Número em p que termina exatamente em stop; *next aponta depois dele
+static bool read_number(const char *p, char stop, double *v, const char **next) {
+    char *end;
+    *v = strtod(p, &end);
+    if (end == p || *end != stop) return false;
+    *next = (stop == '\0') ? end : end + 1;
+    return true;
+}
+
+bool value_list_parse(const char *text, ValueList *out) {
+    double a, b, step;
+    const char *p;
+    out->n = 0;
+
+    if (read_number(text, '\0', &a, &p)) {
+        out->v[out->n++] = a;
+        return true;
+    }
+    if (!read_number(text, ':', &a, &p) || !read_number(p, ':', &b, &p) ||
+        !read_number(p, '\0', &step, &p))
+        return false;
+    if (step <= 0.0 || b < a) return false;
+
+    // tolerância para acumular o último valor apesar do arredondamento
+    for (int i = 0;; i++) {
+        double x = a + step * i;
+        if (x > b + step * 1e-6) break;
+        if (out->n == VALUE_LIST_MAX) return false;
+        out->v[out->n++] = x;
+    }
+    return out->n > 0;
+}
+
+void value_list_default(ValueList *l, double v) {
+    if (l->n == 0) {
+        l->v[0] = v;
+        l->n = 1;
+    }
+}
+
+int int_list_parse(const char *text, int out[], int max) {
+    int n = 0;
+    while (*text) {
+        char *end;
+        long v = strtol(text, &end, 10);
+        if (end == text || n == max) return -1;
+        out[n++] = (int)v;
+        if (*end == ',') end++;
+        else if (*end) return -1;
+        text = end;
+    }
+    return n;
+}
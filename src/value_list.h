@@ -0,0 +1,27 @@
+#ifndef VALUE_LIST_H
+#define VALUE_LIST_H
+
+#include <stdbool.h>
+
+// Listas de parâmetros da linha de comando das ferramentas do host
+// (smartstop_sweep, smartstop_fork, smartstop_bench). O texto inteiro tem
+// de ser consumido: "0.5,0.7" é rejeitado em vez de virar só 0.5.
+
+#define VALUE_LIST_MAX 64
+
+typedef struct {
+    double v[VALUE_LIST_MAX];
+    int n;                          // 0 = nenhum valor dado
+} ValueList;
+
+// "X" (um valor) ou "A:B:PASSO" (de A até B inclusive). Falha se o texto
+// tiver sobras, se o intervalo for vazio ou passar de VALUE_LIST_MAX valores.
+bool value_list_parse(const char *text, ValueList *out);
+
+// Se a lista está vazia, passa a conter só v
+void value_list_default(ValueList *l, double v);
+
+// Inteiros separados por vírgula; retorna quantos, ou -1 se inválida
+int int_list_parse(const char *text, int out[], int max);
+
+#endif // VALUE_LIST_H
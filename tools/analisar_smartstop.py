@@ -2,6 +2,7 @@ import re
 import csv
 import os
 import glob
+import numpy as np
 import pandas as pd
 from textwrap import dedent
 
@@ -106,6 +107,248 @@ def parse_log(log_path: str):
     return dados
 
 
+# -------------------------------------------------------
+# TRAÇO BINÁRIO (.sst)
+# -------------------------------------------------------
+# Gerado por `smartstop_host --trace` ou pelo firmware com SMARTSTOP_TRACE.
+# Layout em src/trace.h: cabeçalho de 32 bytes + registros de 24 bytes.
+
+TRACE_MAGIC = 0x52545353
+TRACE_VERSION = 2
+
+TRACE_HEADER = np.dtype([
+    ("magic", "<u4"), ("version", "<u2"), ("record_size", "<u2"),
+    ("num_floors", "<u2"), ("car_capacity", "<u2"), ("reserved", "<u4"),
+    ("seed", "<u8"), ("start_us", "<u8"),
+])
+
+TRACE_RECORD = np.dtype([
+    ("cycle", "<u4"), ("type", "u1"), ("floor", "u1"), ("occupancy", "u1"),
+    ("aux", "i1"), ("time_ms", "<u8"), ("value", "<i2"), ("extra", "<i2"),
+    ("reserved", "<u4"),
+])
+
+EV_CYCLE, EV_DECISION, EV_BOARD, EV_DISEMBARK, EV_SKIP, EV_EMERGENCY = range(1, 7)
+
+
+def parse_trace(trace_path: str):
+    """Lê o traço binário via memmap e devolve as mesmas linhas de parse_log."""
+    header = np.fromfile(trace_path, dtype=TRACE_HEADER, count=1)
+    if len(header) == 0 or header["magic"][0] != TRACE_MAGIC:
+        print(f"ERRO: {trace_path} não é um traço SmartStop")
+        return []
+    if header["version"][0] != TRACE_VERSION or header["record_size"][0] != TRACE_RECORD.itemsize:
+        print(f"ERRO: versão de traço não suportada em {trace_path}")
+        return []
+
+    n = (os.path.getsize(trace_path) - TRACE_HEADER.itemsize) // TRACE_RECORD.itemsize
+    if n <= 0:
+        return []
+    rec = np.memmap(trace_path, dtype=TRACE_RECORD, mode="r",
+                    offset=TRACE_HEADER.itemsize, shape=(n,))
+
+    kind = rec["type"]
+    cycles = rec["cycle"][kind == EV_CYCLE]
+    base = cycles[0] if len(cycles) else 0
+    size = int(rec["cycle"].max()) - int(base) + 1
+
+    def por_ciclo(mask, valores):
+        # soma por ciclo sem laço em Python
+        return np.bincount(rec["cycle"][mask] - base, weights=valores, minlength=size)
+
+    head = rec[kind == EV_CYCLE]
+    idx = head["cycle"] - base
+
+    dec = rec[kind == EV_DECISION]
+    decision = np.full(size, -1, dtype=np.int64)
+    decision[dec["cycle"] - base] = dec["value"]
+
+    board = kind == EV_BOARD
+    dis = kind == EV_DISEMBARK
+    emerg = kind == EV_EMERGENCY
+    skip = kind == EV_SKIP
+
+    df = pd.DataFrame({
+        "cycle": head["cycle"].astype(np.int64),
+        "floor": head["floor"].astype(np.int64),
+        "direction": np.where(head["aux"] > 0, "Subindo", "Descendo"),
+        "occupancy": head["occupancy"].astype(np.int64),
+        "capacity": int(header["car_capacity"][0]),
+        "decision_floor": decision[idx],
+        "embarked": por_ciclo(board, None)[idx].astype(np.int64),
+        "disembarked": por_ciclo(dis, rec["value"][dis])[idx].astype(np.int64),
+        "emergency": (por_ciclo(emerg, None)[idx] > 0).astype(np.int64),
+        "skipped_calls": por_ciclo(skip, None)[idx].astype(np.int64),
+    })
+    # sem decisão (movimento contínuo) fica vazio, como em parse_log
+    alvo = decision[idx].astype(object)
+    alvo[decision[idx] < 0] = None
+    df["decision_floor"] = alvo
+    return df.to_dict("records")
+
+
+# -------------------------------------------------------
+# TABELA COLUNAR POR CICLO (.ssc)
+# -------------------------------------------------------
+# Gerada por `smartstop_host --metrics`. Layout em src/cycle_table.h:
+# cabeçalho de 32 bytes, blocos de linhas com uma seção por coluna
+# (mínimo/máximo + valores empacotados em palavras de 64 bits) e rodapé
+# com as métricas de calcular_metricas já calculadas pelo simulador.
+
+TABLE_MAGIC = 0x54435353
+TABLE_VERSION = 2
+GROUP_MAGIC = 0x47525353
+FOOTER_MAGIC = 0x544D5353
+END_MAGIC = 0x45435353
+ENC_FOR, ENC_DELTA = 0, 1
+
+TABLE_COLUMNS = [
+    "cycle", "floor", "direction", "occupancy", "decision_floor",
+    "embarked", "disembarked", "emergency", "skipped_calls",
+]
+
+TABLE_HEADER = np.dtype([
+    ("magic", "<u4"), ("version", "<u2"), ("num_columns", "<u2"),
+    ("group_rows", "<u4"), ("num_floors", "<u2"), ("car_capacity", "<u2"),
+    ("seed", "<u8"), ("reserved", "<u8"),
+])
+
+GROUP_HEADER = np.dtype([
+    ("magic", "<u4"), ("rows", "<u4"), ("bytes", "<u4"), ("reserved", "<u4"),
+    ("cycle_base", "<i8"),
+])
+
+COLUMN_CHUNK = np.dtype([
+    ("encoding", "u1"), ("bits", "u1"), ("reserved", "<u2"), ("min", "<i4"),
+    ("max", "<i4"), ("ref", "<i4"), ("first", "<i4"), ("bytes", "<u4"),
+])
+
+TABLE_FOOTER = np.dtype([
+    ("magic", "<u4"), ("reserved", "<u4"), ("rows", "<u8"), ("occupancy_sum", "<u8"),
+    ("occupancy_max", "<u4"), ("groups", "<u4"), ("rows_above_80", "<u8"),
+    ("emergencies", "<u8"), ("skips", "<u8"), ("rows_with_skip", "<u8"),
+    ("embarked", "<u8"), ("disembarked", "<u8"),
+    ("top_floor", "<i4", 3), ("top_count", "<u4", 3),
+])
+
+
+def _abrir_tabela(path: str):
+    """Mapeia o arquivo e confere o cabeçalho; devolve (memmap, cabeçalho)."""
+    buf = np.memmap(path, dtype=np.uint8, mode="r")
+    if len(buf) < TABLE_HEADER.itemsize:
+        return None, None
+    header = buf[:TABLE_HEADER.itemsize].view(TABLE_HEADER)[0]
+    if header["magic"] != TABLE_MAGIC or header["version"] != TABLE_VERSION \
+            or header["num_columns"] != len(TABLE_COLUMNS):
+        return None, None
+    return buf, header
+
+
+def _decodificar(buf, pos: int, chunk, rows: int):
+    """Valores de uma coluna do bloco (sem laço em Python)."""
+    bits = int(chunk["bits"])
+    if bits == 0:
+        vals = np.zeros(rows, dtype=np.int64)
+    else:
+        per_word = 64 // bits
+        words = buf[pos:pos + int(chunk["bytes"])].view("<u8")
+        i = np.arange(rows)
+        shift = ((i % per_word) * bits).astype(np.uint64)
+        mask = np.uint64((1 << bits) - 1)
+        vals = ((words[i // per_word] >> shift) & mask).astype(np.int64)
+    vals += int(chunk["ref"])
+    if chunk["encoding"] == ENC_DELTA:
+        vals[0] = int(chunk["first"])
+        vals = np.cumsum(vals)
+    return vals
+
+
+def ler_tabela_colunar(path: str, colunas=None, filtro=None):
+    """Lê a tabela .ssc num DataFrame.
+
+    colunas: nomes a decodificar (padrão: todas).
+    filtro: {coluna: (mín, máx)}; blocos cujo mínimo/máximo não cruzam a
+    faixa são pulados sem decodificar, e as linhas fora dela são removidas.
+    """
+    buf, header = _abrir_tabela(path)
+    if buf is None:
+        print(f"ERRO: {path} não é uma tabela por ciclo SmartStop")
+        return pd.DataFrame()
+
+    colunas = list(colunas or TABLE_COLUMNS)
+    filtro = filtro or {}
+    ler = [c for c in TABLE_COLUMNS if c in colunas or c in filtro]
+    partes = {c: [] for c in ler}
+
+    fim = len(buf) - 8 - TABLE_FOOTER.itemsize
+    pos = TABLE_HEADER.itemsize
+    n_chunks = len(TABLE_COLUMNS)
+    while pos + GROUP_HEADER.itemsize <= fim:
+        g = buf[pos:pos + GROUP_HEADER.itemsize].view(GROUP_HEADER)[0]
+        if g["magic"] != GROUP_MAGIC:
+            break
+        inicio = pos + GROUP_HEADER.itemsize
+        chunks = buf[inicio:inicio + n_chunks * COLUMN_CHUNK.itemsize].view(COLUMN_CHUNK)
+        rows = int(g["rows"])
+
+        # o ciclo é gravado relativo ao primeiro do bloco
+        base = {c: int(g["cycle_base"]) if c == "cycle" else 0 for c in TABLE_COLUMNS}
+        pula = any(int(chunks[TABLE_COLUMNS.index(c)]["max"]) + base[c] < lo or
+                   int(chunks[TABLE_COLUMNS.index(c)]["min"]) + base[c] > hi
+                   for c, (lo, hi) in filtro.items())
+        if not pula:
+            dados = inicio + n_chunks * COLUMN_CHUNK.itemsize
+            for k, nome in enumerate(TABLE_COLUMNS):
+                if nome in partes:
+                    partes[nome].append(_decodificar(buf, dados, chunks[k], rows) + base[nome])
+                dados += int(chunks[k]["bytes"])
+        pos += int(g["bytes"])
+
+    df = pd.DataFrame({c: (np.concatenate(v) if v else np.zeros(0, dtype=np.int64))
+                       for c, v in partes.items()})
+    for c, (lo, hi) in filtro.items():
+        df = df[(df[c] >= lo) & (df[c] <= hi)]
+    if "direction" in df:
+        df["direction"] = np.where(df["direction"] > 0, "Subindo", "Descendo")
+    if "decision_floor" in df:
+        df["decision_floor"] = df["decision_floor"].where(df["decision_floor"] >= 0)
+    df["capacity"] = int(header["car_capacity"])
+    return df[[c for c in colunas if c in df] + ["capacity"]].reset_index(drop=True)
+
+
+def ler_metricas_colunar(path: str):
+    """Métricas do rodapé, no formato de calcular_metricas (sem ler as linhas)."""
+    buf, header = _abrir_tabela(path)
+    if buf is None or len(buf) < TABLE_HEADER.itemsize + TABLE_FOOTER.itemsize + 8:
+        return None
+    tamanho, magic = buf[-8:].view("<u4")
+    if magic != END_MAGIC or tamanho != TABLE_FOOTER.itemsize:
+        print(f"ERRO: {path} sem rodapé (gravação interrompida?)")
+        return None
+    f = buf[-8 - TABLE_FOOTER.itemsize:-8].view(TABLE_FOOTER)[0]
+    if f["magic"] != FOOTER_MAGIC:
+        return None
+
+    total = int(f["rows"])
+    cap = float(header["car_capacity"])
+    pct = 100.0 / total if total > 0 else 0.0
+    return {
+        "total_ciclos": total,
+        "ocupacao_media": float(f["occupancy_sum"]) / cap * pct if total > 0 else 0.0,
+        "ocupacao_max": float(f["occupancy_max"]) / cap * 100,
+        "ciclos_acima_80": int(f["rows_above_80"]),
+        "perc_acima_80": int(f["rows_above_80"]) * pct,
+        "total_emergencias": int(f["emergencies"]),
+        "perc_emergencias": int(f["emergencies"]) * pct,
+        "total_skips": int(f["skips"]),
+        "ciclos_com_skip": int(f["rows_with_skip"]),
+        "perc_ciclos_com_skip": int(f["rows_with_skip"]) * pct,
+        "total_embarked": int(f["embarked"]),
+        "total_disembarked": int(f["disembarked"]),
+        "top_floors": {int(a): int(n) for a, n in zip(f["top_floor"], f["top_count"]) if a >= 0},
+    }
+
+
 # -------------------------------------------------------
 # GERAÇÃO DE CSV / XLSX
 # -------------------------------------------------------
@@ -307,6 +550,10 @@ def main():
         if ("log" in name) and ("data" not in name) and ("summary" not in name):
             log_files.append(path)
 
+    # Traços binários e tabelas por ciclo não precisam de regex
+    log_files += glob.glob(os.path.join(BASE_DIR, "*.sst"))
+    log_files += glob.glob(os.path.join(BASE_DIR, "*.ssc"))
+
     if not log_files:
         print("Nenhum arquivo de log encontrado (com 'log' no nome).")
         return
@@ -323,14 +570,29 @@ def main():
 
         print(f"\n=== Processando log: {log_name} ===")
 
-        dados = parse_log(log_path)
+        summary_path = os.path.join(BASE_DIR, f"{base_name}_summary.txt")
+
+        # Tabela por ciclo: as métricas já vêm no rodapé; as linhas ficam no
+        # formato colunar (ler_tabela_colunar), sem CSV/XLSX
+        if log_path.endswith(".ssc"):
+            metricas = ler_metricas_colunar(log_path)
+            if not metricas:
+                print("  (sem dados válidos, ignorando este log)")
+                continue
+            salvar_relatorio_individual(metricas, summary_path, log_name)
+            resumos.append({"log_name": log_name, "metricas": metricas})
+            continue
+
+        if log_path.endswith(".sst"):
+            dados = parse_trace(log_path)
+        else:
+            dados = parse_log(log_path)
         if not dados:
             print("  (sem dados válidos, ignorando este log)")
             continue
 
         csv_path = os.path.join(BASE_DIR, f"{base_name}_data.csv")
         xlsx_path = os.path.join(BASE_DIR, f"{base_name}_data.xlsx")
-        summary_path = os.path.join(BASE_DIR, f"{base_name}_summary.txt")
 
         df = save_tables(dados, csv_path, xlsx_path)
         metricas = calcular_metricas(df)